@@ -267,6 +267,13 @@ static const uint PLUGIN_OPTION_SEND_PROGRAM_CHANGES = 0x200;
  */
 static const uint PLUGIN_OPTION_SKIP_SENDING_NOTES = 0x400;
 
+/*!
+ * Process bridged plugins one block ahead, without waiting for the bridge in the audio thread.
+ * The extra block is reported as plugin latency.
+ * This is off-by-default and only available for bridged plugins.
+ */
+static const uint PLUGIN_OPTION_PIPELINED_PROCESSING = 0x800;
+
 /*!
  * Special flag to indicate that plugin options are not yet set.
  * This flag exists because 0x0 as an option value is a valid one, so we need something else to indicate "null-ness".
@@ -1103,7 +1110,7 @@ typedef enum {
      * A cancelable action has been started or stopped.
      * @a pluginId Plugin Id the action relates to, -1 for none
      * @a value1   1 for action started, 0 for stopped
-     * @a valueStr Action name
+     * @a valueStr Action name, started may be sent again with a new name to show progress
      */
     ENGINE_CALLBACK_CANCELABLE_ACTION = 35,
 
@@ -1494,7 +1501,42 @@ typedef enum {
     /*!
      * Treat loaded plugins as standalone (that is, there is no host UI to manage them)
      */
-    ENGINE_OPTION_PLUGINS_ARE_STANDALONE = 35
+    ENGINE_OPTION_PLUGINS_ARE_STANDALONE = 35,
+
+    /*!
+     * Number of extra threads used to process independent plugins in parallel in patchbay mode.
+     * Default is 0, meaning all plugins are processed serially in the audio thread.
+     * @note Only applied when the engine starts
+     */
+    ENGINE_OPTION_PATCHBAY_THREADS = 36,
+
+    /*!
+     * Number of threads used to instantiate plugins in parallel when loading a project.
+     * Only LV2, LADSPA, internal, SFZ and bridged plugins are loaded this way, other formats stay on the main thread.
+     * Default is 0, meaning all plugins are loaded one after the other.
+     */
+    ENGINE_OPTION_LOADER_THREADS = 37,
+
+    /*!
+     * Minimum change of an output parameter, in thousandths of its range, before it is sent again as a control event.
+     * Only applies to output parameters mapped to a MIDI CC.
+     * Default is 0, meaning any change is sent.
+     */
+    ENGINE_OPTION_CONTROL_OUTPUT_THRESHOLD = 38,
+
+    /*!
+     * Minimum time in milliseconds between two control events of the same output parameter.
+     * Only applies to output parameters mapped to a MIDI CC, the latest value is sent once the time has passed.
+     * Default is 0, meaning no limit.
+     */
+    ENGINE_OPTION_CONTROL_OUTPUT_RATE_LIMIT = 39,
+
+    /*!
+     * Time in milliseconds a plugin's output must stay silent, while its input is silent, before it stops being processed.
+     * Auto-suspended plugins are woken up as soon as they receive non-silent audio or any event.
+     * Default is 0, meaning plugins are always processed.
+     */
+    ENGINE_OPTION_AUTO_SUSPEND_TIME = 40
 
 } EngineOption;
 
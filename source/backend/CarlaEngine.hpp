@@ -243,6 +243,11 @@ struct CARLA_API EngineOptions {
     bool preferUiBridges;
     bool uisAlwaysOnTop;
     bool pluginsAreStandalone;
+    uint patchbayThreads;
+    uint loaderThreads;
+    uint controlOutputThreshold;
+    uint controlOutputRateLimit;
+    uint autoSuspendTime;
     uint bgColor;
     uint fgColor;
     float uiScale;
@@ -622,8 +627,11 @@ public:
 protected:
     const EngineProcessMode kProcessMode;
     EngineEvent* fBuffer;
+    uint32_t* fBufferCount; // number of events in fBuffer, the engine one when sharing its buffer
+    uint32_t fOwnBufferCount;
     friend class CarlaPluginInstance;
     friend class CarlaEngineCVSourcePorts;
+    friend class CarlaPlugin;
 
     CARLA_DECLARE_NON_COPY_CLASS(CarlaEngineEventPort)
 #endif
@@ -1121,10 +1129,17 @@ public:
 
     /*!
      * Get a plugin's peak values.
+     * Plugins are only metered while someone keeps reading their values, the first read after a while returns zeros.
      * @note not thread-safe if pluginId == MAIN_CARLA_PLUGIN_ID
      */
     const float* getPeaks(uint pluginId) const noexcept;
 
+    /*!
+     * Get a plugin's RMS values, in the same order as getPeaks().
+     * @note not thread-safe if pluginId == MAIN_CARLA_PLUGIN_ID
+     */
+    const float* getRmsValues(uint pluginId) const noexcept;
+
     /*!
      * Get a plugin's input peak value.
      */
@@ -1192,6 +1207,28 @@ public:
      * Force the engine to resend all patchbay clients, ports and connections again.
      */
     virtual bool patchbayRefresh(bool sendHost, bool sendOSC, bool external);
+
+    /*!
+     * Start a batch of internal patchbay changes.
+     * Connections, disconnections and added or removed plugins are not heard until the batch is committed,
+     * so that the internal graph is rebuilt only once for all of them.
+     * Batches can be nested, each call must be matched by patchbayCommitBatch().
+     */
+    void patchbayBeginBatch() noexcept;
+
+    /*!
+     * Commit a batch of internal patchbay changes started with patchbayBeginBatch().
+     * Once the outermost batch is committed the internal graph is rebuilt right away,
+     * and the new version takes over at the start of the next audio block.
+     */
+    void patchbayCommitBatch() noexcept;
+
+    /*!
+     * Mark the plugins whose output only ends up in plugin @a id, directly or through each other.
+     * @a upstream is indexed by plugin id and must hold getCurrentPluginCount() values.
+     * In rack mode these are the plugins before it, when its audio inputs replace their output.
+     */
+    void getExclusiveUpstreamPlugins(uint id, bool* upstream) const;
 #endif
 
     // -------------------------------------------------------------------
@@ -1217,6 +1254,38 @@ public:
      */
     virtual void transportRelocate(uint64_t frame) noexcept;
 
+    // -------------------------------------------------------------------
+    // Offline rendering
+
+    /*!
+     * Render the engine output into an audio file, as fast as possible.
+     * Covers the transport frames from @a startFrame up to, but not including, @a endFrame.
+     * The file format is taken from the @a filename extension, either ".wav" or ".flac".
+     * On success @a speedUp is set to how many times faster than realtime the render went.
+     * Only supported by the Dummy driver.
+     */
+    virtual bool renderToFile(const char* filename, uint64_t startFrame, uint64_t endFrame, double& speedUp);
+
+    /*!
+     * Offline render callback, gets the engine output of every processed cycle.
+     * Returning false stops rendering.
+     */
+    typedef bool (*OfflineRenderFunc)(void* ptr, const float* const* audioOut, uint32_t frames);
+
+    /*!
+     * Check if the current driver can render offline, see renderOffline().
+     */
+    virtual bool supportsOfflineRendering() const noexcept;
+
+    /*!
+     * Process the engine as fast as possible over the same transport range as renderToFile(),
+     * passing the output of each cycle to @a func instead of writing a file.
+     * Fails if the transport is moved or stopped meanwhile, or if @a func returns false,
+     * in which case setting the error is left to the caller.
+     * May be called from any thread, only one render can run at a time.
+     */
+    virtual bool renderOffline(uint64_t startFrame, uint64_t endFrame, OfflineRenderFunc func, void* ptr);
+
     // -------------------------------------------------------------------
     // Error handling
 
@@ -1250,6 +1319,13 @@ public:
      * TODO.
      */
     bool isLoadingProject() const noexcept;
+
+    /*!
+     * Check if the calling thread is one of the threads instantiating plugins during a parallel project load.
+     * Such threads must not call idle(), the thread loading the project takes care of it.
+     * @see ENGINE_OPTION_LOADER_THREADS
+     */
+    bool isProjectLoaderThread() const noexcept;
 #endif
 
     /*!
@@ -1308,6 +1384,7 @@ protected:
     friend class CarlaEngineThread;
     friend class CarlaPluginInstance;
     friend class EngineInternalGraph;
+    friend class EngineProjectLoader;
     friend class PendingRtEventsRunner;
     friend class ScopedActionLock;
     friend class ScopedEngineEnvironmentLocker;
@@ -1336,10 +1413,24 @@ protected:
     void offlineModeChanged(bool isOffline);
 
     /*!
-     * Set a plugin (stereo) peak values.
+     * Check if a plugin's peak and RMS values are wanted in the current audio cycle.
+     * @note RT call, must be called once per cycle and before setPluginPeaksRT()
+     */
+    bool isPluginMeteredRT(uint pluginId, uint32_t frames) noexcept;
+
+    /*!
+     * Set a plugin (stereo) peak and RMS values, input left/right followed by output left/right.
      * @note RT call
      */
-    void setPluginPeaksRT(uint pluginId, float const inPeaks[2], float const outPeaks[2]) noexcept;
+    void setPluginPeaksRT(uint pluginId, float const peaks[4], float const rms[4]) noexcept;
+
+    /*!
+     * Create a new plugin instance with id @a id, without adding it to the engine.
+     * Returns null and sets the last error on failure.
+     */
+    CarlaPluginPtr createPlugin(uint id, BinaryType btype, PluginType ptype,
+                                const char* filename, const char* name, const char* label, int64_t uniqueId,
+                                const void* extra, uint options);
 
     /*!
      * Common save project function for main engine and plugin.
@@ -1360,6 +1451,12 @@ protected:
      */
     EngineEvent* getInternalEventBuffer(bool isInput) const noexcept;
 
+    /*!
+     * Return the number of events in the buffer returned by getInternalEventBuffer().
+     * @note RT call
+     */
+    uint32_t* getInternalEventCount(bool isInput) const noexcept;
+
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
     // -------------------------------------------------------------------
     // Patchbay stuff
@@ -574,6 +574,20 @@ CARLA_EXPORT bool carla_patchbay_set_group_pos(CarlaHostHandle handle, bool exte
  */
 CARLA_EXPORT bool carla_patchbay_refresh(CarlaHostHandle handle, bool external);
 
+/*!
+ * Start a batch of internal patchbay changes.
+ * Connections, disconnections and added or removed plugins are applied together when the batch is committed,
+ * so that the internal graph is rebuilt only once for all of them.
+ * Batches can be nested, each call must be matched by carla_patchbay_commit_batch().
+ * Only valid in patchbay engine mode, other modes will ignore this.
+ */
+CARLA_EXPORT void carla_patchbay_begin_batch(CarlaHostHandle handle);
+
+/*!
+ * Commit a batch of internal patchbay changes started with carla_patchbay_begin_batch().
+ */
+CARLA_EXPORT void carla_patchbay_commit_batch(CarlaHostHandle handle);
+
 /*!
  * Start playback of the engine transport.
  */
@@ -603,6 +617,16 @@ CARLA_EXPORT uint64_t carla_get_current_transport_frame(CarlaHostHandle handle);
  * Get the engine transport information.
  */
 CARLA_EXPORT const CarlaTransportInfo* carla_get_transport_info(CarlaHostHandle handle);
+
+/*!
+ * Render the engine output offline into an audio file, as fast as possible.
+ * Covers the transport frames from @a startFrame up to, but not including, @a endFrame.
+ * The file format is taken from the filename extension, either ".wav" or ".flac".
+ * Only supported by the Dummy driver.
+ * Returns how many times faster than realtime the render went, or 0.0 on failure.
+ * @see carla_get_last_error()
+ */
+CARLA_EXPORT double carla_render_to_file(CarlaHostHandle handle, const char* filename, uint64_t startFrame, uint64_t endFrame);
 #endif
 
 /*!
@@ -698,6 +722,33 @@ CARLA_EXPORT bool carla_save_plugin_state(CarlaHostHandle handle, uint pluginId,
  */
 CARLA_EXPORT bool carla_export_plugin_lv2(CarlaHostHandle handle, uint pluginId, const char* lv2path);
 
+#ifndef BUILD_BRIDGE
+/*!
+ * Freeze a plugin, rendering its output over a transport range into an audio file,
+ * which is then played back instead of processing it while the transport plays within that range.
+ * The engine is rendered offline in the background, with progress and cancelation through
+ * ENGINE_CALLBACK_CANCELABLE_ACTION, ENGINE_CALLBACK_UPDATE is sent once the plugin is frozen.
+ * Only supported by engine drivers that can render offline, currently the Dummy one.
+ * Changing parameters, programs or custom data of the plugin, or of its chain, unfreezes it.
+ * @param pluginId   Plugin
+ * @param filename   Path to the audio file to render into
+ * @param startFrame First transport frame to render
+ * @param endFrame   Transport frame to stop rendering at, not included
+ * @param chain      Also skip the plugins that only feed into this one while it plays back
+ * @see carla_unfreeze_plugin()
+ */
+CARLA_EXPORT bool carla_freeze_plugin(CarlaHostHandle handle, uint pluginId, const char* filename,
+                                      uint64_t startFrame, uint64_t endFrame, bool chain);
+
+/*!
+ * Unfreeze a plugin, going back to processing it.
+ * The audio file used for freezing is kept.
+ * @param pluginId Plugin
+ * @see carla_freeze_plugin()
+ */
+CARLA_EXPORT bool carla_unfreeze_plugin(CarlaHostHandle handle, uint pluginId);
+#endif
+
 /*!
  * Get information from a plugin.
  * @param pluginId Plugin
@@ -895,10 +946,18 @@ CARLA_EXPORT float carla_get_internal_parameter_value(CarlaHostHandle handle, ui
 
 /*!
  * Get a plugin's peak values.
+ * Plugins are only metered while their values are being read, each read keeps that going for about a second.
+ * The first read after such a lapse returns zeros, real values follow once the engine processed the next audio cycle.
  * @param pluginId Plugin
  */
 CARLA_EXPORT const float* carla_get_peak_values(CarlaHostHandle handle, uint pluginId);
 
+/*!
+ * Get a plugin's RMS values, in the same order as carla_get_peak_values().
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT const float* carla_get_rms_values(CarlaHostHandle handle, uint pluginId);
+
 /*!
  * Get a plugin's input peak value.
  * @param pluginId Plugin
@@ -55,6 +55,18 @@ struct EngineEvent;
 
 // -----------------------------------------------------------------------
 
+/*!
+ * Idle-side consumers of output parameter changes.
+ * Each consumer keeps its own set of pending changes, so they do not steal them from each other.
+ */
+enum ParameterOutputConsumer {
+    kParameterOutputConsumerEngineThread = 0,
+    kParameterOutputConsumerNativeUI = 1,
+    kParameterOutputConsumerCount = 2
+};
+
+// -----------------------------------------------------------------------
+
 /*!
  * Carla Backend base plugin class
  *
@@ -252,6 +264,19 @@ public:
      */
     bool isParameterOutput(uint32_t parameterId) const noexcept;
 
+    /*!
+     * Take the output parameters changed since the last call by @a consumer,
+     * as a bitmask for parameters [word*32, word*32+32).
+     * Plugins that do not track output changes report all of their output parameters.
+     */
+    uint32_t takeParameterOutputChanges(ParameterOutputConsumer consumer, uint32_t word) const noexcept;
+
+    /*!
+     * Mark all output parameters as changed for @a consumer, so its next takes report every one of them.
+     * Used when a custom UI gets shown, as output changes are consumed while it is hidden.
+     */
+    void markParameterOutputsChanged(ParameterOutputConsumer consumer) const noexcept;
+
     /*!
      * Get the MIDI program at @a index.
      *
@@ -745,6 +770,68 @@ public:
      */
     void unlock() noexcept;
 
+    /*!
+     * Check if there are notes waiting to be sent to the plugin from outside the engine event buffers.
+     * @see sendMidiSingleNote()
+     */
+    bool hasPendingExternalNotes() const noexcept;
+
+#ifndef BUILD_BRIDGE
+    // -------------------------------------------------------------------
+    // Freeze
+
+    /*!
+     * Start rendering the plugin's output over the transport range from @a startFrame up to, but not including,
+     * @a endFrame into @a filename, then play that file back instead of processing the plugin while the transport
+     * plays within that range. Outside of it, or while stopped, the plugin is processed as usual.
+     * The whole engine is rendered offline on a separate thread, so the plugin gets its real audio and MIDI input,
+     * which needs an engine driver that can render offline, see CarlaEngine::renderOffline().
+     * With @a withChain the plugins that only feed into this one are skipped as well while it plays back.
+     * Returns once rendering has started, progress is reported through ENGINE_CALLBACK_CANCELABLE_ACTION.
+     * Once done, playback starts on idle() and ENGINE_CALLBACK_UPDATE is sent, or ENGINE_CALLBACK_ERROR on failure.
+     * Only plugins with 1 or 2 audio outputs, no CV ports and at most 1 event port each way can be frozen,
+     * in rack or patchbay processing modes.
+     * Changing parameters, programs or custom data of the plugin, or of its chain, unfreezes it or cancels the render.
+     */
+    bool freeze(const char* filename, uint64_t startFrame, uint64_t endFrame, bool withChain);
+
+    /*!
+     * Play back a file previously rendered by freeze(), without rendering it again.
+     * The range and chain must be the ones it was rendered with, an @a endFrame of 0 covers the whole file.
+     */
+    bool loadFrozenFile(const char* filename, uint64_t startFrame, uint64_t endFrame, bool withChain);
+
+    /*!
+     * Go back to processing the plugin, canceling a render in progress.
+     */
+    void unfreeze();
+
+    /*!
+     * Check if the plugin is currently frozen.
+     */
+    bool isFrozen() const noexcept;
+
+    /*!
+     * Get the file a frozen plugin is playing back, or null if not frozen.
+     */
+    const char* getFrozenFilename() const noexcept;
+
+    /*!
+     * Write the frozen output into @a audioOut, or silence if the plugin is skipped as part of a frozen chain.
+     * Returns false if this cycle is not covered by a frozen range, in which case the plugin must be processed
+     * as usual and postProcessFrozen() called afterwards.
+     * @note Must be called with the plugin locked, see tryLock().
+     */
+    bool processFrozen(float* const* audioOut, uint32_t frames) noexcept;
+
+    /*!
+     * Complete a processed cycle, writing the frozen output over the part of it within the frozen range,
+     * or passing the output on to a render in progress.
+     * @note Must be called with the plugin locked, see tryLock().
+     */
+    void postProcessFrozen(float* const* audioOut, uint32_t frames) noexcept;
+#endif
+
     // -------------------------------------------------------------------
     // Plugin buffers
 
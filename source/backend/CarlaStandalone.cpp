@@ -390,6 +390,15 @@ static void carla_engine_init_common(const CarlaHostStandalone& standalone, Carl
     engine->setOption(CB::ENGINE_OPTION_CLIENT_NAME_PREFIX, 0, standalone.engineOptions.clientNamePrefix);
 
     engine->setOption(CB::ENGINE_OPTION_PLUGINS_ARE_STANDALONE, standalone.engineOptions.pluginsAreStandalone, nullptr);
+
+    engine->setOption(CB::ENGINE_OPTION_PATCHBAY_THREADS, static_cast<int>(standalone.engineOptions.patchbayThreads), nullptr);
+
+    engine->setOption(CB::ENGINE_OPTION_LOADER_THREADS, static_cast<int>(standalone.engineOptions.loaderThreads), nullptr);
+
+    engine->setOption(CB::ENGINE_OPTION_CONTROL_OUTPUT_THRESHOLD, static_cast<int>(standalone.engineOptions.controlOutputThreshold), nullptr);
+    engine->setOption(CB::ENGINE_OPTION_CONTROL_OUTPUT_RATE_LIMIT, static_cast<int>(standalone.engineOptions.controlOutputRateLimit), nullptr);
+
+    engine->setOption(CB::ENGINE_OPTION_AUTO_SUSPEND_TIME, static_cast<int>(standalone.engineOptions.autoSuspendTime), nullptr);
 #endif // BUILD_BRIDGE
 }
 
@@ -996,6 +1005,31 @@ void carla_set_engine_option(CarlaHostHandle handle, EngineOption option, int va
             CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
             shandle.engineOptions.pluginsAreStandalone = (value != 0);
             break;
+
+        case CB::ENGINE_OPTION_PATCHBAY_THREADS:
+            CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 64,);
+            shandle.engineOptions.patchbayThreads = static_cast<uint>(value);
+            break;
+
+        case CB::ENGINE_OPTION_LOADER_THREADS:
+            CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 64,);
+            shandle.engineOptions.loaderThreads = static_cast<uint>(value);
+            break;
+
+        case CB::ENGINE_OPTION_CONTROL_OUTPUT_THRESHOLD:
+            CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 1000,);
+            shandle.engineOptions.controlOutputThreshold = static_cast<uint>(value);
+            break;
+
+        case CB::ENGINE_OPTION_CONTROL_OUTPUT_RATE_LIMIT:
+            CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 10000,);
+            shandle.engineOptions.controlOutputRateLimit = static_cast<uint>(value);
+            break;
+
+        case CB::ENGINE_OPTION_AUTO_SUSPEND_TIME:
+            CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 60000,);
+            shandle.engineOptions.autoSuspendTime = static_cast<uint>(value);
+            break;
         }
     }
 
@@ -1129,6 +1163,24 @@ bool carla_patchbay_refresh(CarlaHostHandle handle, bool external)
     return handle->engine->patchbayRefresh(true, false, external);
 }
 
+void carla_patchbay_begin_batch(CarlaHostHandle handle)
+{
+    CARLA_SAFE_ASSERT_RETURN(handle->engine != nullptr,);
+
+    carla_debug("carla_patchbay_begin_batch(%p)", handle);
+
+    handle->engine->patchbayBeginBatch();
+}
+
+void carla_patchbay_commit_batch(CarlaHostHandle handle)
+{
+    CARLA_SAFE_ASSERT_RETURN(handle->engine != nullptr,);
+
+    carla_debug("carla_patchbay_commit_batch(%p)", handle);
+
+    handle->engine->patchbayCommitBatch();
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 
 void carla_transport_play(CarlaHostHandle handle)
@@ -1174,6 +1226,22 @@ uint64_t carla_get_current_transport_frame(CarlaHostHandle handle)
     return handle->engine->getTimeInfo().frame;
 }
 
+double carla_render_to_file(CarlaHostHandle handle, const char* filename, uint64_t startFrame, uint64_t endFrame)
+{
+    CARLA_SAFE_ASSERT_WITH_LAST_ERROR_RETURN(handle->engine != nullptr && handle->engine->isRunning(),
+                                             "Engine is not running", 0.0);
+    CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', 0.0);
+
+    carla_debug("carla_render_to_file(%p, \"%s\", " P_UINT64 ", " P_UINT64 ")", handle, filename, startFrame, endFrame);
+
+    double speedUp = 0.0;
+
+    if (! handle->engine->renderToFile(filename, startFrame, endFrame, speedUp))
+        return 0.0;
+
+    return speedUp;
+}
+
 const CarlaTransportInfo* carla_get_transport_info(CarlaHostHandle handle)
 {
     static CarlaTransportInfo retTransInfo;
@@ -1330,6 +1398,36 @@ bool carla_export_plugin_lv2(CarlaHostHandle handle, uint pluginId, const char*
     return false;
 }
 
+#ifndef BUILD_BRIDGE
+bool carla_freeze_plugin(CarlaHostHandle handle, uint pluginId, const char* filename,
+                         uint64_t startFrame, uint64_t endFrame, bool chain)
+{
+    CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+    CARLA_SAFE_ASSERT_WITH_LAST_ERROR_RETURN(handle->engine != nullptr, "Engine is not initialized", false);
+    carla_debug("carla_freeze_plugin(%p, %i, \"%s\", " P_UINT64 ", " P_UINT64 ", %s)",
+                handle, pluginId, filename, startFrame, endFrame, bool2str(chain));
+
+    if (const CarlaPluginPtr plugin = handle->engine->getPlugin(pluginId))
+        return plugin->freeze(filename, startFrame, endFrame, chain);
+
+    return false;
+}
+
+bool carla_unfreeze_plugin(CarlaHostHandle handle, uint pluginId)
+{
+    CARLA_SAFE_ASSERT_WITH_LAST_ERROR_RETURN(handle->engine != nullptr, "Engine is not initialized", false);
+    carla_debug("carla_unfreeze_plugin(%p, %i)", handle, pluginId);
+
+    if (const CarlaPluginPtr plugin = handle->engine->getPlugin(pluginId))
+    {
+        plugin->unfreeze();
+        return true;
+    }
+
+    return false;
+}
+#endif
+
 // --------------------------------------------------------------------------------------------------------------------
 
 const CarlaPluginInfo* carla_get_plugin_info(CarlaHostHandle handle, uint pluginId)
@@ -1967,6 +2065,13 @@ const float* carla_get_peak_values(CarlaHostHandle handle, uint pluginId)
     return handle->engine->getPeaks(pluginId);
 }
 
+const float* carla_get_rms_values(CarlaHostHandle handle, uint pluginId)
+{
+    CARLA_SAFE_ASSERT_RETURN(handle->engine != nullptr, nullptr);
+
+    return handle->engine->getRmsValues(pluginId);
+}
+
 float carla_get_input_peak_value(CarlaHostHandle handle, uint pluginId, bool isLeft)
 {
     CARLA_SAFE_ASSERT_RETURN(handle->engine != nullptr, 0.0f);
@@ -2261,7 +2366,12 @@ void carla_show_custom_ui(CarlaHostHandle handle, uint pluginId, bool yesNo)
     CARLA_SAFE_ASSERT_RETURN(handle->engine != nullptr,);
 
     if (const CarlaPluginPtr plugin = handle->engine->getPlugin(pluginId))
+    {
+        if (yesNo)
+            plugin->markParameterOutputsChanged(CB::kParameterOutputConsumerEngineThread);
+
         plugin->showCustomUI(yesNo);
+    }
 }
 
 void* carla_embed_custom_ui(CarlaHostHandle handle, uint pluginId, void* ptr)
@@ -21,6 +21,7 @@
 #include "CarlaBackend.h"
 
 #ifdef __cplusplus
+using CarlaBackend::BinaryType;
 using CarlaBackend::PluginCategory;
 using CarlaBackend::PluginType;
 #endif
@@ -44,6 +45,12 @@ typedef void* CarlaPipeClientHandle;
  */
 typedef void (*CarlaPipeCallbackFunc)(void* ptr, const char* msg);
 
+/*!
+ * Opaque handle to a plugin discovery scan.
+ * @see carla_plugin_discovery_start()
+ */
+typedef void* CarlaPluginDiscoveryHandle;
+
 /*!
  * Information about a cached plugin.
  * @see carla_get_cached_plugin_info()
@@ -138,6 +145,94 @@ typedef struct _CarlaCachedPluginInfo {
 
 } CarlaCachedPluginInfo;
 
+/*!
+ * Information about a plugin found by a discovery scan.
+ * @see carla_plugin_discovery_get_plugin_info()
+ */
+typedef struct _CarlaDiscoveredPluginInfo {
+    /*!
+     * Binary type of the plugin file.
+     */
+    BinaryType btype;
+
+    /*!
+     * Plugin category.
+     */
+    PluginCategory category;
+
+    /*!
+     * Plugin hints.
+     * @see PluginHints
+     */
+    uint hints;
+
+    /*!
+     * Number of audio inputs.
+     */
+    uint32_t audioIns;
+
+    /*!
+     * Number of audio outputs.
+     */
+    uint32_t audioOuts;
+
+    /*!
+     * Number of CV inputs.
+     */
+    uint32_t cvIns;
+
+    /*!
+     * Number of CV outputs.
+     */
+    uint32_t cvOuts;
+
+    /*!
+     * Number of MIDI inputs.
+     */
+    uint32_t midiIns;
+
+    /*!
+     * Number of MIDI outputs.
+     */
+    uint32_t midiOuts;
+
+    /*!
+     * Number of input parameters.
+     */
+    uint32_t parameterIns;
+
+    /*!
+     * Number of output parameters.
+     */
+    uint32_t parameterOuts;
+
+    /*!
+     * Plugin unique Id, if the plugin format has one.
+     */
+    int64_t uniqueId;
+
+    /*!
+     * Filename the plugin was found in.
+     */
+    const char* filename;
+
+    /*!
+     * Plugin name.
+     */
+    const char* name;
+
+    /*!
+     * Plugin label, or URI for LV2 plugins.
+     */
+    const char* label;
+
+    /*!
+     * Plugin author/maker.
+     */
+    const char* maker;
+
+} CarlaDiscoveredPluginInfo;
+
 /* --------------------------------------------------------------------------------------------------------------------
  * cached plugins */
 
@@ -157,6 +252,57 @@ CARLA_EXPORT uint carla_get_cached_plugin_count(PluginType ptype, const char* pl
  */
 CARLA_EXPORT const CarlaCachedPluginInfo* carla_get_cached_plugin_info(PluginType ptype, uint index);
 
+/* --------------------------------------------------------------------------------------------------------------------
+ * plugin discovery */
+
+/*!
+ * Start checking a list of plugin files in the background, using @a discoveryTool (a carla-discovery binary).
+ * Up to @a workerCount files are checked in parallel, each in its own process,
+ *  so that a plugin crashing or hanging for longer than @a timeoutMs only fails its own file.
+ * Results are kept in @a databaseFile, keyed by filename, size and modification time,
+ *  so unchanged files are not checked again on the next scan.
+ *
+ * @param discoveryTool Full path to the carla-discovery binary for the plugins' architecture
+ * @param ptype         Plugin type to discover
+ * @param filenames     Null-terminated list of plugin files to check
+ * @param workerCount   Number of files to check in parallel, 0 for the number of CPUs
+ * @param timeoutMs     Time a single file may take before its check is aborted
+ * @param databaseFile  Result database to use, or null for the default one of this tool and plugin type
+ */
+CARLA_EXPORT CarlaPluginDiscoveryHandle carla_plugin_discovery_start(const char* discoveryTool, PluginType ptype,
+                                                                     const char* const* filenames,
+                                                                     uint workerCount, uint timeoutMs,
+                                                                     const char* databaseFile);
+
+/*!
+ * Get how many files have been checked so far, taken from the database or not.
+ */
+CARLA_EXPORT uint carla_plugin_discovery_get_checked_count(CarlaPluginDiscoveryHandle handle);
+
+/*!
+ * Check if all files have been checked.
+ * Results are only available after this returns true.
+ */
+CARLA_EXPORT bool carla_plugin_discovery_is_finished(CarlaPluginDiscoveryHandle handle);
+
+/*!
+ * Get how many plugins were found.
+ */
+CARLA_EXPORT uint carla_plugin_discovery_get_plugin_count(CarlaPluginDiscoveryHandle handle);
+
+/*!
+ * Get information about a found plugin.
+ * Returned pointer is only valid until the next call to this function.
+ */
+CARLA_EXPORT const CarlaDiscoveredPluginInfo* carla_plugin_discovery_get_plugin_info(CarlaPluginDiscoveryHandle handle,
+                                                                                     uint index);
+
+/*!
+ * Stop a discovery scan and free its handle, aborting any checks still running.
+ * Files already checked are kept in the database.
+ */
+CARLA_EXPORT void carla_plugin_discovery_stop(CarlaPluginDiscoveryHandle handle);
+
 #ifndef CARLA_HOST_H_INCLUDED
 /* --------------------------------------------------------------------------------------------------------------------
  * information */
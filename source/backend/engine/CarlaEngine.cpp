@@ -520,6 +520,74 @@ bool CarlaEngine::addPlugin(const BinaryType btype,
 #endif
     }
 
+    const CarlaPluginPtr plugin = createPlugin(id, btype, ptype, filename, name, label, uniqueId, extra, options);
+
+    if (plugin.get() == nullptr)
+        return false;
+
+    EnginePluginData& pluginData(pData->plugins[id]);
+    pluginData.plugin = plugin;
+    pluginData.autoSuspend.reset();
+    pluginData.meter.reset();
+
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+    if (oldPlugin.get() != nullptr)
+    {
+        CARLA_SAFE_ASSERT(! pData->loadingProject);
+
+        const ScopedThreadStopper sts(this);
+
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+            pData->graph.replacePlugin(oldPlugin, plugin);
+
+        const bool  wasActive = oldPlugin->getInternalParameterValue(PARAMETER_ACTIVE) >= 0.5f;
+        const float oldDryWet = oldPlugin->getInternalParameterValue(PARAMETER_DRYWET);
+        const float oldVolume = oldPlugin->getInternalParameterValue(PARAMETER_VOLUME);
+
+        oldPlugin->prepareForDeletion();
+        pData->pluginsToDelete.push_back(oldPlugin);
+
+        if (plugin->getHints() & PLUGIN_CAN_DRYWET)
+            plugin->setDryWet(oldDryWet, true, true);
+
+        if (plugin->getHints() & PLUGIN_CAN_VOLUME)
+            plugin->setVolume(oldVolume, true, true);
+
+        plugin->setActive(wasActive, true, true);
+        plugin->setEnabled(true);
+
+        callback(true, true, ENGINE_CALLBACK_RELOAD_ALL, id, 0, 0, 0, 0.0f, nullptr);
+    }
+    else if (! pData->loadingProject)
+#endif
+    {
+        plugin->setEnabled(true);
+
+        ++pData->curPluginCount;
+        callback(true, true, ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0, 0.0f, plugin->getName());
+
+        if (getType() != kEngineTypeBridge)
+            plugin->setActive(true, true, true);
+
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+            pData->graph.addPlugin(plugin);
+#endif
+    }
+
+    return true;
+}
+
+CarlaPluginPtr CarlaEngine::createPlugin(const uint id,
+                                         const BinaryType btype,
+                                         const PluginType ptype,
+                                         const char* const filename,
+                                         const char* const name,
+                                         const char* const label,
+                                         const int64_t uniqueId,
+                                         const void* const extra,
+                                         const uint options)
+{
     CarlaPlugin::Initializer initializer = {
         this,
         id,
@@ -647,7 +715,7 @@ bool CarlaEngine::addPlugin(const BinaryType btype,
         else
         {
             setLastError("This Carla build cannot handle this binary");
-            return false;
+            return nullptr;
         }
     }
     else
@@ -738,7 +806,7 @@ bool CarlaEngine::addPlugin(const BinaryType btype,
     }
 
     if (plugin.get() == nullptr)
-        return false;
+        return nullptr;
 
     plugin->reload();
 
@@ -767,59 +835,10 @@ bool CarlaEngine::addPlugin(const BinaryType btype,
 
     if (! canRun)
     {
-        return false;
+        return nullptr;
     }
 
-    EnginePluginData& pluginData(pData->plugins[id]);
-    pluginData.plugin = plugin;
-    carla_zeroFloats(pluginData.peaks, 4);
-
-#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
-    if (oldPlugin.get() != nullptr)
-    {
-        CARLA_SAFE_ASSERT(! pData->loadingProject);
-
-        const ScopedThreadStopper sts(this);
-
-        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
-            pData->graph.replacePlugin(oldPlugin, plugin);
-
-        const bool  wasActive = oldPlugin->getInternalParameterValue(PARAMETER_ACTIVE) >= 0.5f;
-        const float oldDryWet = oldPlugin->getInternalParameterValue(PARAMETER_DRYWET);
-        const float oldVolume = oldPlugin->getInternalParameterValue(PARAMETER_VOLUME);
-
-        oldPlugin->prepareForDeletion();
-        pData->pluginsToDelete.push_back(oldPlugin);
-
-        if (plugin->getHints() & PLUGIN_CAN_DRYWET)
-            plugin->setDryWet(oldDryWet, true, true);
-
-        if (plugin->getHints() & PLUGIN_CAN_VOLUME)
-            plugin->setVolume(oldVolume, true, true);
-
-        plugin->setActive(wasActive, true, true);
-        plugin->setEnabled(true);
-
-        callback(true, true, ENGINE_CALLBACK_RELOAD_ALL, id, 0, 0, 0, 0.0f, nullptr);
-    }
-    else if (! pData->loadingProject)
-#endif
-    {
-        plugin->setEnabled(true);
-
-        ++pData->curPluginCount;
-        callback(true, true, ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0, 0.0f, plugin->getName());
-
-        if (getType() != kEngineTypeBridge)
-            plugin->setActive(true, true, true);
-
-#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
-        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
-            pData->graph.addPlugin(plugin);
-#endif
-    }
-
-    return true;
+    return plugin;
 }
 
 bool CarlaEngine::addPlugin(const PluginType ptype,
@@ -869,7 +888,7 @@ bool CarlaEngine::removePlugin(const uint id)
 #else
     pData->curPluginCount = 0;
     pData->plugins[0].plugin = nullptr;
-    carla_zeroStruct(pData->plugins[0].peaks);
+    pData->plugins[0].meter.reset();
 #endif
 
     plugin->prepareForDeletion();
@@ -914,7 +933,8 @@ bool CarlaEngine::removeAllPlugins()
         pData->pluginsToDelete.push_back(pluginData.plugin);
 
         pluginData.plugin.reset();
-        carla_zeroStruct(pluginData.peaks);
+        pluginData.autoSuspend.reset();
+        pluginData.meter.reset();
 
         callback(true, true, ENGINE_CALLBACK_PLUGIN_REMOVED, id, 0, 0, 0, 0.0f, nullptr);
         callback(true, false, ENGINE_CALLBACK_IDLE, 0, 0, 0, 0, 0.0f, nullptr);
@@ -1474,10 +1494,13 @@ const float* CarlaEngine::getPeaks(const uint pluginId) const noexcept
         // get peak from first plugin, if available
         if (const uint count = pData->curPluginCount)
         {
-            pData->peaks[0] = pData->plugins[0].peaks[0];
-            pData->peaks[1] = pData->plugins[0].peaks[1];
-            pData->peaks[2] = pData->plugins[count-1].peaks[2];
-            pData->peaks[3] = pData->plugins[count-1].peaks[3];
+            const EnginePluginMeter::Values& first(pData->plugins[0].meter.read());
+            const EnginePluginMeter::Values& last(pData->plugins[count-1].meter.read());
+
+            pData->peaks[0] = first.peaks[0];
+            pData->peaks[1] = first.peaks[1];
+            pData->peaks[2] = last.peaks[2];
+            pData->peaks[3] = last.peaks[3];
         }
         else
         {
@@ -1489,7 +1512,37 @@ const float* CarlaEngine::getPeaks(const uint pluginId) const noexcept
 
     CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount, kFallback);
 
-    return pData->plugins[pluginId].peaks;
+    return pData->plugins[pluginId].meter.read().peaks;
+}
+
+const float* CarlaEngine::getRmsValues(const uint pluginId) const noexcept
+{
+    static const float kFallback[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    if (pluginId == MAIN_CARLA_PLUGIN_ID)
+    {
+        // get rms from first plugin, if available
+        if (const uint count = pData->curPluginCount)
+        {
+            const EnginePluginMeter::Values& first(pData->plugins[0].meter.read());
+            const EnginePluginMeter::Values& last(pData->plugins[count-1].meter.read());
+
+            pData->rms[0] = first.rms[0];
+            pData->rms[1] = first.rms[1];
+            pData->rms[2] = last.rms[2];
+            pData->rms[3] = last.rms[3];
+        }
+        else
+        {
+            carla_zeroFloats(pData->rms, 4);
+        }
+
+        return pData->rms;
+    }
+
+    CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount, kFallback);
+
+    return pData->plugins[pluginId].meter.read().rms;
 }
 
 float CarlaEngine::getInputPeak(const uint pluginId, const bool isLeft) const noexcept
@@ -1498,13 +1551,13 @@ float CarlaEngine::getInputPeak(const uint pluginId, const bool isLeft) const no
     {
         // get peak from first plugin, if available
         if (pData->curPluginCount > 0)
-            return pData->plugins[0].peaks[isLeft ? 0 : 1];
+            return pData->plugins[0].meter.read().peaks[isLeft ? 0 : 1];
         return 0.0f;
     }
 
     CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount, 0.0f);
 
-    return pData->plugins[pluginId].peaks[isLeft ? 0 : 1];
+    return pData->plugins[pluginId].meter.read().peaks[isLeft ? 0 : 1];
 }
 
 float CarlaEngine::getOutputPeak(const uint pluginId, const bool isLeft) const noexcept
@@ -1513,13 +1566,13 @@ float CarlaEngine::getOutputPeak(const uint pluginId, const bool isLeft) const n
     {
         // get peak from last plugin, if available
         if (pData->curPluginCount > 0)
-            return pData->plugins[pData->curPluginCount-1].peaks[isLeft ? 2 : 3];
+            return pData->plugins[pData->curPluginCount-1].meter.read().peaks[isLeft ? 2 : 3];
         return 0.0f;
     }
 
     CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount, 0.0f);
 
-    return pData->plugins[pluginId].peaks[isLeft ? 2 : 3];
+    return pData->plugins[pluginId].meter.read().peaks[isLeft ? 2 : 3];
 }
 
 // -----------------------------------------------------------------------
@@ -1543,6 +1596,12 @@ void CarlaEngine::callback(const bool sendHost, const bool sendOSC,
                     static_cast<double>(valuef), valueStr);
 #endif
 
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+    // plugins being loaded in parallel are not known to the host yet
+    if (pData->projectLoader != nullptr && pData->projectLoader->isLoaderThread())
+        return;
+#endif
+
     if (sendHost && pData->callback != nullptr)
     {
         if (action == ENGINE_CALLBACK_IDLE)
@@ -1727,6 +1786,27 @@ void CarlaEngine::transportRelocate(const uint64_t frame) noexcept
     pData->time.relocate(frame);
 }
 
+// -----------------------------------------------------------------------
+// Offline rendering
+
+bool CarlaEngine::renderToFile(const char* const, const uint64_t, const uint64_t, double& speedUp)
+{
+    speedUp = 0.0;
+    setLastError("Offline rendering is not supported by the current driver");
+    return false;
+}
+
+bool CarlaEngine::supportsOfflineRendering() const noexcept
+{
+    return false;
+}
+
+bool CarlaEngine::renderOffline(const uint64_t, const uint64_t, const OfflineRenderFunc, void* const)
+{
+    setLastError("Offline rendering is not supported by the current driver");
+    return false;
+}
+
 // -----------------------------------------------------------------------
 // Error handling
 
@@ -1737,6 +1817,12 @@ const char* CarlaEngine::getLastError() const noexcept
 
 void CarlaEngine::setLastError(const char* const error) const noexcept
 {
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+    // plugins being loaded in parallel keep their own error
+    if (pData->projectLoader != nullptr && pData->projectLoader->setLastErrorForLoaderThread(error))
+        return;
+#endif
+
     pData->lastError = error;
 }
 
@@ -1762,6 +1848,11 @@ bool CarlaEngine::isLoadingProject() const noexcept
 {
     return pData->loadingProject;
 }
+
+bool CarlaEngine::isProjectLoaderThread() const noexcept
+{
+    return pData->projectLoader != nullptr && pData->projectLoader->isLoaderThread();
+}
 #endif
 
 void CarlaEngine::setActionCanceled(const bool canceled) noexcept
@@ -1786,6 +1877,7 @@ void CarlaEngine::setOption(const EngineOption option, const int value, const ch
         switch (option)
         {
         case ENGINE_OPTION_PROCESS_MODE:
+        case ENGINE_OPTION_PATCHBAY_THREADS:
         case ENGINE_OPTION_AUDIO_TRIPLE_BUFFER:
         case ENGINE_OPTION_AUDIO_DRIVER:
         case ENGINE_OPTION_AUDIO_DEVICE:
@@ -2131,6 +2223,31 @@ void CarlaEngine::setOption(const EngineOption option, const int value, const ch
         CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
         pData->options.pluginsAreStandalone = (value != 0);
         break;
+
+    case ENGINE_OPTION_PATCHBAY_THREADS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 64,);
+        pData->options.patchbayThreads = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_LOADER_THREADS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 64,);
+        pData->options.loaderThreads = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_CONTROL_OUTPUT_THRESHOLD:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 1000,);
+        pData->options.controlOutputThreshold = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_CONTROL_OUTPUT_RATE_LIMIT:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 10000,);
+        pData->options.controlOutputRateLimit = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_AUTO_SUSPEND_TIME:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 60000,);
+        pData->options.autoSuspendTime = static_cast<uint>(value);
+        break;
     }
 }
 
@@ -2247,14 +2364,18 @@ void CarlaEngine::offlineModeChanged(const bool isOfflineNow)
     }
 }
 
-void CarlaEngine::setPluginPeaksRT(const uint pluginId, float const inPeaks[2], float const outPeaks[2]) noexcept
+bool CarlaEngine::isPluginMeteredRT(const uint pluginId, const uint32_t frames) noexcept
+{
+    return pData->plugins[pluginId].meter.isSubscribedRT(frames, pData->sampleRate);
+}
+
+void CarlaEngine::setPluginPeaksRT(const uint pluginId, float const peaks[4], float const rms[4]) noexcept
 {
-    EnginePluginData& pluginData(pData->plugins[pluginId]);
+    EnginePluginMeter::Values values;
+    carla_copyFloats(values.peaks, peaks, 4);
+    carla_copyFloats(values.rms, rms, 4);
 
-    pluginData.peaks[0]  = inPeaks[0];
-    pluginData.peaks[1]  = inPeaks[1];
-    pluginData.peaks[2] = outPeaks[0];
-    pluginData.peaks[3] = outPeaks[1];
+    pData->plugins[pluginId].meter.publishRT(values);
 }
 
 void CarlaEngine::saveProjectInternal(water::MemoryOutputStream& outStream) const
@@ -2613,6 +2734,9 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc, const bool alw
     }
 
     const CarlaScopedValueSetter<bool> csvs(pData->loadingProject, true, false);
+
+    // plugins and connections get rendered together once the project is fully loaded
+    const ScopedPatchbayBatch spb(this);
 #endif
 
     // completely load file
@@ -2781,6 +2905,15 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc, const bool alw
         }
     }
 
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+    // plugins can only be created outside the main thread when their ports are not exposed directly
+    CarlaScopedPointer<EngineProjectLoader> loader;
+
+    if (! isPreset && pData->options.loaderThreads != 0 &&
+        (isPatchbay || pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK))
+        loader = new EngineProjectLoader(this, pData->options.loaderThreads);
+#endif
+
     // and we handle plugins
     for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
     {
@@ -2788,7 +2921,8 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc, const bool alw
 
         if (isPreset || tagName == "Plugin")
         {
-            CarlaStateSave stateSave;
+            CarlaScopedPointer<CarlaStateSave> stateSavePtr(new CarlaStateSave);
+            CarlaStateSave& stateSave(*stateSavePtr);
             stateSave.fillFromXmlElement(isPreset ? xmlElement.get() : elem);
 
             if (pData->aboutToClose)
@@ -2807,6 +2941,10 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc, const bool alw
             // FIXME Remove on 2.1 release
             if (std::strcmp(stateSave.type, "GIG") == 0)
             {
+                // added right away, so plugins queued before it must be added first
+                if (loader != nullptr && ! loader->loadAndCommit())
+                    return pData->aboutToClose;
+
                 if (addPlugin(PLUGIN_LV2, "", stateSave.name, "http://linuxsampler.org/plugins/linuxsampler", 0, nullptr))
                 {
                     const uint pluginId = pData->curPluginCount;
@@ -2864,6 +3002,9 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc, const bool alw
 # ifdef SFZ_FILES_USING_SFIZZ
             if (std::strcmp(stateSave.type, "SFZ") == 0)
             {
+                if (loader != nullptr && ! loader->loadAndCommit())
+                    return pData->aboutToClose;
+
                 if (addPlugin(PLUGIN_LV2, "", stateSave.name, "http://sfztools.github.io/sfizz", 0, nullptr))
                 {
                     const uint pluginId = pData->curPluginCount;
@@ -3008,6 +3149,14 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc, const bool alw
                 break;
             }
 
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+            if (loader != nullptr)
+            {
+                loader->addPlugin(stateSavePtr.release(), btype, ptype, extraStuff);
+                continue;
+            }
+#endif
+
             if (addPlugin(btype, ptype, stateSave.binary,
                           stateSave.name, stateSave.label, stateSave.uniqueId, extraStuff, stateSave.options))
             {
@@ -3071,6 +3220,15 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc, const bool alw
     }
 
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+    if (loader != nullptr)
+    {
+        const bool loaded = loader->loadAndCommit();
+        loader = nullptr;
+
+        if (! loaded)
+            return pData->aboutToClose;
+    }
+
     // tell bridges we're done loading
     for (uint i=0; i < pData->curPluginCount; ++i)
     {
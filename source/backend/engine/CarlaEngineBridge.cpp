@@ -106,6 +106,7 @@ public:
         : CarlaEngine(),
           CarlaThread("CarlaEngineBridge"),
           fShmAudioPool(),
+          fShmChunkPool(),
           fShmRtClientControl(),
           fShmNonRtClientControl(),
           fShmNonRtServerControl(),
@@ -116,6 +117,8 @@ public:
           fClosingDown(false),
           fIsOffline(false),
           fFirstIdle(true),
+          fChunkPoolResizeRequested(false),
+          fServerApiVersion(0),
           fLastPingTime(-1)
     {
         carla_debug("CarlaEngineBridge::CarlaEngineBridge(\"%s\", \"%s\", \"%s\", \"%s\")", audioPoolBaseName, rtClientBaseName, nonRtClientBaseName, nonRtServerBaseName);
@@ -204,6 +207,8 @@ public:
         const uint32_t apiVersion = fShmNonRtClientControl.readUInt();
         CARLA_SAFE_ASSERT_RETURN(apiVersion >= CARLA_PLUGIN_BRIDGE_API_VERSION_MINIMUM, false);
 
+        fServerApiVersion = apiVersion;
+
         const uint32_t shmRtClientDataSize = fShmNonRtClientControl.readUInt();
         CARLA_SAFE_ASSERT_INT2(shmRtClientDataSize == sizeof(BridgeRtClientData), shmRtClientDataSize, sizeof(BridgeRtClientData));
 
@@ -752,6 +757,7 @@ public:
     void clear() noexcept
     {
         fShmAudioPool.clear();
+        fShmChunkPool.clear();
         fShmRtClientControl.clear();
         fShmNonRtClientControl.clear();
         fShmNonRtServerControl.clear();
@@ -931,6 +937,35 @@ public:
                 break;
             }
 
+            case kPluginBridgeNonRtClientSetChunkPool: {
+                const uint64_t poolSize(fShmNonRtClientControl.readULong());
+                CARLA_SAFE_ASSERT_BREAK(poolSize > 0);
+
+                if (! jackbridge_shm_is_valid(fShmChunkPool.shm))
+                {
+                    CARLA_SAFE_ASSERT_BREAK(fShmChunkPool.attachClient(fBaseNameAudioPool));
+                }
+
+                fShmChunkPool.resize(static_cast<std::size_t>(poolSize));
+                break;
+            }
+
+            case kPluginBridgeNonRtClientSetChunkDataShm: {
+                const uint64_t dataSize(fShmNonRtClientControl.readULong());
+
+                if (plugin->isEnabled() && fShmChunkPool.data != nullptr && dataSize <= fShmChunkPool.dataSize)
+                {
+                    CARLA_SAFE_ASSERT(dataSize > 0);
+                    plugin->setChunkData(fShmChunkPool.data, static_cast<std::size_t>(dataSize));
+                }
+
+                // server can write to the pool again
+                const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
+                fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerChunkPoolReleased);
+                fShmNonRtServerControl.commitWrite();
+                break;
+            }
+
             case kPluginBridgeNonRtClientSetCtrlChannel: {
                 const int16_t channel(fShmNonRtClientControl.readShort());
                 CARLA_SAFE_ASSERT_BREAK(channel >= -1 && channel < MAX_MIDI_CHANNELS);
@@ -1054,25 +1089,57 @@ public:
                     {
                         CARLA_SAFE_ASSERT_BREAK(data != nullptr);
 
-                        CarlaString dataBase64 = CarlaString::asBase64(data, dataSize);
-                        CARLA_SAFE_ASSERT_BREAK(dataBase64.length() > 0);
+                        // kPluginBridgeNonRtServerSetChunkDataShm was added in API 9
+                        const bool canUseChunkPool = fServerApiVersion >= 9;
 
-                        String filePath(File::getSpecialLocation(File::tempDirectory).getFullPathName());
+                        if (canUseChunkPool && dataSize > fShmChunkPool.dataSize && ! fChunkPoolResizeRequested)
+                        {
+                            // server will resize the pool and ask us to save again, we skip sending "saved" for now
+                            fChunkPoolResizeRequested = true;
 
-                        filePath += CARLA_OS_SEP_STR ".CarlaChunk_";
-                        filePath += fShmAudioPool.getFilenameSuffix();
+                            const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
 
-                        if (File(filePath).replaceWithText(dataBase64.buffer()))
+                            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerResizeChunkPool);
+                            fShmNonRtServerControl.writeULong(static_cast<uint64_t>(dataSize));
+                            fShmNonRtServerControl.commitWrite();
+                            break;
+                        }
+
+                        fChunkPoolResizeRequested = false;
+
+                        if (canUseChunkPool && dataSize <= fShmChunkPool.dataSize)
                         {
-                            const uint32_t ulength(static_cast<uint32_t>(filePath.length()));
+                            std::memcpy(fShmChunkPool.data, data, dataSize);
 
                             const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
 
-                            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerSetChunkDataFile);
-                            fShmNonRtServerControl.writeUInt(ulength);
-                            fShmNonRtServerControl.writeCustomData(filePath.toRawUTF8(), ulength);
+                            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerSetChunkDataShm);
+                            fShmNonRtServerControl.writeULong(static_cast<uint64_t>(dataSize));
                             fShmNonRtServerControl.commitWrite();
                         }
+                        else
+                        {
+                            // fallback for old servers, or if server could not resize the pool
+                            CarlaString dataBase64 = CarlaString::asBase64(data, dataSize);
+                            CARLA_SAFE_ASSERT_BREAK(dataBase64.length() > 0);
+
+                            String filePath(File::getSpecialLocation(File::tempDirectory).getFullPathName());
+
+                            filePath += CARLA_OS_SEP_STR ".CarlaChunk_";
+                            filePath += fShmAudioPool.getFilenameSuffix();
+
+                            if (File(filePath).replaceWithText(dataBase64.buffer()))
+                            {
+                                const uint32_t ulength(static_cast<uint32_t>(filePath.length()));
+
+                                const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
+
+                                fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerSetChunkDataFile);
+                                fShmNonRtServerControl.writeUInt(ulength);
+                                fShmNonRtServerControl.writeCustomData(filePath.toRawUTF8(), ulength);
+                                fShmNonRtServerControl.commitWrite();
+                            }
+                        }
                     }
                 }
 
@@ -1092,7 +1159,10 @@ public:
 
             case kPluginBridgeNonRtClientShowUI:
                 if (plugin->isEnabled())
+                {
+                    plugin->markParameterOutputsChanged(kParameterOutputConsumerEngineThread);
                     plugin->showCustomUI(true);
+                }
                 break;
 
             case kPluginBridgeNonRtClientHideUI:
@@ -1415,17 +1485,16 @@ protected:
                     carla_zeroBytes(midiData, kBridgeBaseMidiOutHeaderSize);
                     std::size_t curMidiDataPos = 0;
 
-                    if (pData->events.in[0].type != kEngineEventTypeNull)
-                        carla_zeroStructs(pData->events.in, kMaxEngineEventInternalCount);
+                    clearEngineEvents(pData->events.in, pData->events.inCount);
 
-                    if (pData->events.out[0].type != kEngineEventTypeNull)
+                    if (pData->events.outCount != 0)
                     {
-                        for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+                        for (uint32_t i=0; i < pData->events.outCount; ++i)
                         {
                             const EngineEvent& event(pData->events.out[i]);
 
                             if (event.type == kEngineEventTypeNull)
-                                break;
+                                continue;
 
                             if (event.type == kEngineEventTypeControl)
                             {
@@ -1491,7 +1560,7 @@ protected:
                             curMidiDataPos + kBridgeBaseMidiOutHeaderSize < kBridgeRtClientDataMidiOutSize)
                             carla_zeroBytes(midiData, kBridgeBaseMidiOutHeaderSize);
 
-                        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+                        clearEngineEvents(pData->events.out, pData->events.outCount);
                     }
 
                 }   break;
@@ -1523,14 +1592,10 @@ protected:
     // called from process thread above
     EngineEvent* getNextFreeInputEvent() const noexcept
     {
-        for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
-        {
-            EngineEvent* const event(&pData->events.in[i]);
+        if (pData->events.inCount >= kMaxEngineEventInternalCount)
+            return nullptr;
 
-            if (event->type == kEngineEventTypeNull)
-                return event;
-        }
-        return nullptr;
+        return &pData->events.in[pData->events.inCount++];
     }
 
     void latencyChanged(const uint32_t samples) noexcept override
@@ -1546,6 +1611,7 @@ protected:
 
 private:
     BridgeAudioPool          fShmAudioPool;
+    BridgeChunkPool          fShmChunkPool;
     BridgeRtClientControl    fShmRtClientControl;
     BridgeNonRtClientControl fShmNonRtClientControl;
     BridgeNonRtServerControl fShmNonRtServerControl;
@@ -1558,6 +1624,8 @@ private:
     bool fClosingDown;
     bool fIsOffline;
     bool fFirstIdle;
+    bool fChunkPoolResizeRequested;
+    uint32_t fServerApiVersion;
     int64_t fLastPingTime;
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineBridge)
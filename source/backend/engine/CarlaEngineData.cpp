@@ -210,6 +210,11 @@ EngineOptions::EngineOptions() noexcept
 #endif
       uisAlwaysOnTop(true),
       pluginsAreStandalone(false),
+      patchbayThreads(0),
+      loaderThreads(0),
+      controlOutputThreshold(0),
+      controlOutputRateLimit(0),
+      autoSuspendTime(0),
       bgColor(0x000000ff),
       fgColor(0xffffffff),
       uiScale(1.0f),
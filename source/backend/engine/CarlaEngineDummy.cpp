@@ -19,6 +19,8 @@
 #include "CarlaEngineInit.hpp"
 #include "CarlaEngineInternal.hpp"
 
+#include "CarlaAudioFileWriter.hpp"
+
 #include <ctime>
 #include <sys/time.h>
 
@@ -34,7 +36,9 @@ public:
     CarlaEngineDummy()
         : CarlaEngine(),
           CarlaThread("CarlaEngineDummy"),
-          fRunning(false)
+          fRunning(false),
+          fOffline(false),
+          fRenderMutex()
     {
         carla_debug("CarlaEngineDummy::CarlaEngineDummy()");
 
@@ -114,7 +118,7 @@ public:
 
     bool isOffline() const noexcept override
     {
-        return false;
+        return fOffline;
     }
 
     EngineType getType() const noexcept override
@@ -185,6 +189,145 @@ public:
     }
 
     // -------------------------------------------------------------------
+    // Offline rendering
+
+    bool renderToFile(const char* const filename, const uint64_t startFrame, const uint64_t endFrame,
+                      double& speedUp) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+        carla_debug("CarlaEngineDummy::renderToFile(\"%s\", " P_UINT64 ", " P_UINT64 ")", filename, startFrame, endFrame);
+
+        speedUp = 0.0;
+
+        if (endFrame <= startFrame)
+        {
+            setLastError("Invalid render range");
+            return false;
+        }
+
+        CarlaAudioFileWriter writer;
+
+        if (! writer.open(filename, 2, pData->sampleRate))
+        {
+            setLastError(writer.getLastError());
+            return false;
+        }
+
+        const int64_t startTime = getTimeInMicroseconds();
+        const bool ok = renderOffline(startFrame, endFrame, _writeToFile, &writer);
+        const int64_t renderTime = getTimeInMicroseconds() - startTime;
+
+        writer.close();
+
+        if (! ok)
+        {
+            if (writer.getLastError()[0] != '\0')
+                setLastError(writer.getLastError());
+            return false;
+        }
+
+        const double renderedTime = static_cast<double>(endFrame - startFrame) / pData->sampleRate;
+
+        speedUp = renderTime > 0 ? renderedTime * 1000000.0 / static_cast<double>(renderTime) : 0.0;
+
+        carla_debug("CarlaEngineDummy rendered %.3f seconds of audio, %.1fx faster than realtime",
+                    renderedTime, speedUp);
+        return true;
+    }
+
+    bool supportsOfflineRendering() const noexcept override
+    {
+        return true;
+    }
+
+    bool renderOffline(const uint64_t startFrame, const uint64_t endFrame,
+                       const OfflineRenderFunc func, void* const ptr) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(func != nullptr, false);
+        carla_debug("CarlaEngineDummy::renderOffline(" P_UINT64 ", " P_UINT64 ", %p, %p)", startFrame, endFrame, func, ptr);
+
+        if (endFrame <= startFrame)
+        {
+            setLastError("Invalid render range");
+            return false;
+        }
+
+        const CarlaMutexTryLocker cmtl(fRenderMutex);
+
+        if (cmtl.wasNotLocked())
+        {
+            setLastError("Another offline render is in progress");
+            return false;
+        }
+
+        const uint32_t bufferSize = pData->bufferSize;
+        float* buffers;
+
+        try {
+            buffers = new float[bufferSize * 4];
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaEngineDummy::renderOffline", false);
+
+        float* audioIns[2]  = { buffers, buffers + bufferSize };
+        float* audioOuts[2] = { buffers + bufferSize * 2, buffers + bufferSize * 3 };
+
+        carla_zeroFloats(audioIns[0], bufferSize * 2);
+
+        // take over from the realtime audio thread, and let plugins know they can take their time
+        stopThread(-1);
+
+        fOffline = true;
+        offlineModeChanged(true);
+
+        const bool wasPlaying = pData->timeInfo.playing;
+        transportRelocate(startFrame);
+        transportPlay();
+
+        clearEngineEvents(pData->events.in, pData->events.inCount);
+
+        bool ok = true;
+
+        for (uint64_t frame = startFrame; ok && frame < endFrame;)
+        {
+            // always process full cycles, the last one is cut to the requested end frame
+            const uint32_t frames = static_cast<uint32_t>(std::min<uint64_t>(bufferSize, endFrame - frame));
+
+            {
+                const PendingRtEventsRunner prt(this, bufferSize, false);
+
+                // the transport can still be changed from other threads, which would render the wrong frames
+                if (! pData->timeInfo.playing || pData->timeInfo.frame != frame)
+                {
+                    setLastError("Transport changed while rendering");
+                    ok = false;
+                    break;
+                }
+
+                carla_zeroFloats(audioOuts[0], bufferSize * 2);
+                clearEngineEvents(pData->events.out, pData->events.outCount);
+
+                pData->graph.process(pData, audioIns, audioOuts, bufferSize);
+            }
+
+            ok = func(ptr, audioOuts, frames);
+            frame += frames;
+        }
+
+        delete[] buffers;
+
+        if (! wasPlaying)
+            transportPause();
+
+        fOffline = false;
+        offlineModeChanged(false);
+
+        // the engine might have been closed from another thread meanwhile
+        if (fRunning)
+            startThread(true);
+
+        return ok;
+    }
+
+    // -------------------------------------------------------------------
 
 protected:
     static int64_t getTimeInMicroseconds() noexcept
@@ -230,7 +373,7 @@ protected:
 
         carla_zeroFloats(audioIns[0], bufferSize);
         carla_zeroFloats(audioIns[1], bufferSize);
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in, pData->events.inCount);
 
         int64_t oldTime, newTime;
 
@@ -242,7 +385,7 @@ protected:
 
             carla_zeroFloats(audioOuts[0], bufferSize);
             carla_zeroFloats(audioOuts[1], bufferSize);
-            carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+            clearEngineEvents(pData->events.out, pData->events.outCount);
 
             pData->graph.process(pData, audioIns, audioOuts, bufferSize);
 
@@ -276,6 +419,13 @@ protected:
 
 private:
     bool fRunning;
+    bool fOffline;
+    CarlaMutex fRenderMutex;
+
+    static bool _writeToFile(void* const ptr, const float* const* const audioOut, const uint32_t frames)
+    {
+        return static_cast<CarlaAudioFileWriter*>(ptr)->write(audioOut, frames);
+    }
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineDummy)
 };
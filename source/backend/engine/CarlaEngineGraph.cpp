@@ -27,7 +27,6 @@
 using water::jmax;
 using water::jmin;
 using water::AudioProcessor;
-using water::MidiBuffer;
 using water::String;
 using water::StringArray;
 
@@ -39,6 +38,38 @@ CARLA_BACKEND_START_NAMESPACE
 static const PortNameToId kPortNameToIdFallback   = { 0, 0, { '\0' }, { '\0' } };
 static /* */ PortNameToId kPortNameToIdFallbackNC = { 0, 0, { '\0' }, { '\0' } };
 
+// -----------------------------------------------------------------------
+// Plugin auto-suspend
+
+// peak level treated as silence, about -90 dBFS
+static const float kAutoSuspendSilenceLevel = 0.00003f;
+
+// number of silent frames after which a plugin can be suspended, 0 if it must always be processed
+static inline
+uint32_t getPluginAutoSuspendFrames(const CarlaPluginPtr& plugin, const EngineOptions& options,
+                                    const double sampleRate, const bool isOffline, const bool isPlaying)
+{
+    if (options.autoSuspendTime == 0 || isOffline)
+        return 0;
+
+#ifndef BUILD_BRIDGE
+    // frozen plugins are cheap already, and their output does not depend on their input
+    if (plugin->isFrozen())
+        return 0;
+#endif
+
+    // silent audio output must mean the plugin is idle
+    if (plugin->getAudioOutCount() == 0 || plugin->getMidiOutCount() != 0 ||
+        plugin->getCVInCount() != 0 || plugin->getCVOutCount() != 0)
+        return 0;
+
+    // generators need something to wake them up, and might follow the transport on their own
+    if (plugin->getAudioInCount() == 0 && (plugin->getMidiInCount() == 0 || isPlaying))
+        return 0;
+
+    return std::max(1U, static_cast<uint32_t>(sampleRate * options.autoSuspendTime / 1000.0));
+}
+
 // -----------------------------------------------------------------------
 // External Graph stuff
 
@@ -957,7 +988,7 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
     carla_zeroFloats(outBufReal[1], frames);
 
     // initialize event outputs (zero)
-    carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
+    clearEngineEvents(data->events.out, data->events.outCount);
 
     uint32_t oldAudioInCount  = 0;
     uint32_t oldAudioOutCount = 0;
@@ -983,9 +1014,9 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
             carla_zeroFloats(outBufReal[1], frames);
 
             // if plugin has no midi out, add previous events
-            if (oldMidiOutCount == 0 && data->events.in[0].type != kEngineEventTypeNull)
+            if (oldMidiOutCount == 0 && data->events.inCount != 0)
             {
-                if (data->events.out[0].type != kEngineEventTypeNull)
+                if (data->events.outCount != 0)
                 {
                     // TODO: carefully add to input, sorted events
                     //carla_stderr("TODO midi event mixing here %s", plugin->getName());
@@ -994,11 +1025,11 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
             }
             else
             {
-                // initialize event inputs from previous outputs
-                carla_copyStructs(data->events.in, data->events.out, kMaxEngineEventInternalCount);
+                // initialize event inputs from previous outputs, only touching the used part of each buffer
+                copyEngineEvents(data->events.in, data->events.inCount, data->events.out, data->events.outCount);
 
                 // initialize event outputs (zero)
-                carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
+                clearEngineEvents(data->events.out, data->events.outCount);
             }
         }
 
@@ -1010,6 +1041,40 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
         const uint32_t numOutBufs = std::max(oldAudioOutCount, 2U);
         const uint32_t numCvBufs  = std::max(plugin->getCVInCount(), plugin->getCVOutCount());
 
+        EnginePluginData& pluginData(data->plugins[i]);
+
+        const uint32_t autoSuspendFrames = getPluginAutoSuspendFrames(plugin, data->options, data->sampleRate,
+                                                                      isOffline, data->timeInfo.playing);
+        const bool metering = pluginData.meter.isSubscribedRT(frames, data->sampleRate);
+
+        EnginePluginMeter::Values levels;
+        carla_zeroStruct(levels);
+
+        // set input levels, needed before processing for auto-suspend
+        if (oldAudioInCount > 0)
+        {
+            if (metering)
+            {
+                carla_findMaxNormalizedAndRmsFloat(inBuf0, frames, levels.peaks[0], levels.rms[0]);
+                carla_findMaxNormalizedAndRmsFloat(inBuf1, frames, levels.peaks[1], levels.rms[1]);
+            }
+            else if (autoSuspendFrames != 0)
+            {
+                levels.peaks[0] = carla_findMaxNormalizedFloat(inBuf0, frames);
+                levels.peaks[1] = carla_findMaxNormalizedFloat(inBuf1, frames);
+            }
+        }
+
+        bool suspended = false;
+
+        if (autoSuspendFrames == 0)
+            pluginData.autoSuspend.reset();
+        else
+            suspended = pluginData.autoSuspend.checkInput(levels.peaks[0] < kAutoSuspendSilenceLevel &&
+                                                          levels.peaks[1] < kAutoSuspendSilenceLevel &&
+                                                          data->events.inCount == 0 &&
+                                                          ! plugin->hasPendingExternalNotes());
+
         const float* inBuf[numInBufs];
         inBuf[0] = inBuf0;
         inBuf[1] = inBuf1;
@@ -1033,9 +1098,21 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
                 outBuf[j] = dummyBuf;
         }
 
-        // process
-        plugin->initBuffers();
-        plugin->process(inBuf, outBuf, cvBuf, cvBuf, frames);
+        // process, suspended plugins keep their outputs silent and frozen ones play back their rendered output
+        if (! suspended)
+        {
+#ifndef BUILD_BRIDGE
+            if (! plugin->processFrozen(outBuf, frames))
+#endif
+            {
+                plugin->initBuffers();
+                plugin->process(inBuf, outBuf, cvBuf, cvBuf, frames);
+#ifndef BUILD_BRIDGE
+                plugin->postProcessFrozen(outBuf, frames);
+#endif
+            }
+        }
+
         plugin->unlock();
 
         // if plugin has no audio inputs, add input buffer
@@ -1051,33 +1128,29 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
             carla_copyFloats(outBufReal[1], outBufReal[0], frames);
         }
 
-        // set peaks
+        // set output levels
+        if (oldAudioOutCount > 0)
         {
-            EnginePluginData& pluginData(data->plugins[i]);
-
-            if (oldAudioInCount > 0)
-            {
-                pluginData.peaks[0] = carla_findMaxNormalizedFloat(inBuf0, frames);
-                pluginData.peaks[1] = carla_findMaxNormalizedFloat(inBuf1, frames);
-            }
-            else
-            {
-                pluginData.peaks[0] = 0.0f;
-                pluginData.peaks[1] = 0.0f;
-            }
-
-            if (oldAudioOutCount > 0)
+            if (metering)
             {
-                pluginData.peaks[2] = carla_findMaxNormalizedFloat(outBufReal[0], frames);
-                pluginData.peaks[3] = carla_findMaxNormalizedFloat(outBufReal[1], frames);
+                carla_findMaxNormalizedAndRmsFloat(outBufReal[0], frames, levels.peaks[2], levels.rms[2]);
+                carla_findMaxNormalizedAndRmsFloat(outBufReal[1], frames, levels.peaks[3], levels.rms[3]);
             }
-            else
+            else if (autoSuspendFrames != 0)
             {
-                pluginData.peaks[2] = 0.0f;
-                pluginData.peaks[3] = 0.0f;
+                levels.peaks[2] = carla_findMaxNormalizedFloat(outBufReal[0], frames);
+                levels.peaks[3] = carla_findMaxNormalizedFloat(outBufReal[1], frames);
             }
         }
 
+        if (autoSuspendFrames != 0)
+            pluginData.autoSuspend.checkOutput(levels.peaks[2] < kAutoSuspendSilenceLevel &&
+                                               levels.peaks[3] < kAutoSuspendSilenceLevel,
+                                               frames, autoSuspendFrames);
+
+        if (metering)
+            pluginData.meter.publishRT(levels);
+
         processed = true;
     }
 }
@@ -1457,7 +1530,8 @@ class CarlaPluginInstance : public AudioProcessor
 public:
     CarlaPluginInstance(CarlaEngine* const engine, const CarlaPluginPtr plugin)
         : kEngine(engine),
-          fPlugin(plugin)
+          fPlugin(plugin),
+          fAutoSuspend()
     {
         CarlaEngineClient* const client = plugin->getEngineClient();
 
@@ -1507,26 +1581,37 @@ public:
     void processBlockWithCV(AudioSampleBuffer& audio,
                             const AudioSampleBuffer& cvIn,
                             AudioSampleBuffer& cvOut,
-                            MidiBuffer& midi) override
+                            EngineEvent* const events) override
     {
         if (fPlugin.get() == nullptr || ! fPlugin->isEnabled() || ! fPlugin->tryLock(kEngine->isOffline()))
         {
             audio.clear();
             cvOut.clear();
-            midi.clear();
+            clearEngineEvents(events);
             return;
         }
 
+        bool hasInputEvents = false;
+
         if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventInPort())
         {
             EngineEvent* const engineEvents(port->fBuffer);
             CARLA_SAFE_ASSERT_RETURN(engineEvents != nullptr,);
 
-            carla_zeroStructs(engineEvents, kMaxEngineEventInternalCount);
-            fillEngineEventsFromWaterMidiBuffer(engineEvents, midi);
+            uint32_t& eventCount(*port->fBufferCount);
+
+            copyEngineEvents(engineEvents, eventCount, events, getEngineEventCount(events));
+            hasInputEvents = eventCount != 0;
+
+            // the graph has a single event port per plugin
+            for (uint32_t i=0; i < eventCount; ++i)
+            {
+                if (engineEvents[i].type == kEngineEventTypeMidi)
+                    engineEvents[i].midi.port = 0;
+            }
         }
 
-        midi.clear();
+        clearEngineEvents(events);
 
         fPlugin->initBuffers();
 
@@ -1559,20 +1644,82 @@ public:
             for (uint32_t i=0; i<numCVInChan; ++i)
                 cvInBuffers[i] = cvIn.getReadPointer(i);
 
-            float inPeaks[2] = { 0.0f };
-            float outPeaks[2] = { 0.0f };
+            // input left/right followed by output left/right
+            float peaks[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float rms[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-            for (uint32_t i=0, count=jmin(fPlugin->getAudioInCount(), numChan2); i<count; ++i)
-                inPeaks[i] = carla_findMaxNormalizedFloat(audioBuffers[i], numSamples);
+            const uint32_t numAudioIns  = jmin(fPlugin->getAudioInCount(), numAudioChan);
+            const uint32_t numAudioOuts = jmin(fPlugin->getAudioOutCount(), numAudioChan);
 
-            fPlugin->process(const_cast<const float**>(audioBuffers), audioBuffers,
-                             cvInBuffers, cvOutBuffers,
-                             numSamples);
+            const uint32_t autoSuspendFrames = getPluginAutoSuspendFrames(fPlugin, kEngine->getOptions(),
+                                                                          kEngine->getSampleRate(),
+                                                                          kEngine->isOffline(),
+                                                                          kEngine->getTimeInfo().playing);
+            const bool metering = kEngine->isPluginMeteredRT(fPlugin->getId(), numSamples);
+
+            if (metering)
+            {
+                for (uint32_t i=0, count=jmin(numAudioIns, numChan2); i<count; ++i)
+                    carla_findMaxNormalizedAndRmsFloat(audioBuffers[i], numSamples, peaks[i], rms[i]);
+            }
+
+            bool suspended = false;
 
-            for (uint32_t i=0, count=jmin(fPlugin->getAudioOutCount(), numChan2); i<count; ++i)
-                outPeaks[i] = carla_findMaxNormalizedFloat(audioBuffers[i], numSamples);
+            if (autoSuspendFrames == 0)
+            {
+                fAutoSuspend.reset();
+            }
+            else
+            {
+                bool inputIsSilent = ! hasInputEvents && ! fPlugin->hasPendingExternalNotes();
 
-            kEngine->setPluginPeaksRT(fPlugin->getId(), inPeaks, outPeaks);
+                for (uint32_t i=0; inputIsSilent && i<numAudioIns; ++i)
+                    inputIsSilent = (metering && i < numChan2 ? peaks[i]
+                                                              : carla_findMaxNormalizedFloat(audioBuffers[i], numSamples))
+                                    < kAutoSuspendSilenceLevel;
+
+                suspended = fAutoSuspend.checkInput(inputIsSilent);
+            }
+
+            if (suspended)
+            {
+                audio.clear();
+            }
+            else
+            {
+#ifndef BUILD_BRIDGE
+                if (! fPlugin->processFrozen(audioBuffers, numSamples))
+#endif
+                {
+                    fPlugin->process(const_cast<const float**>(audioBuffers), audioBuffers,
+                                     cvInBuffers, cvOutBuffers,
+                                     numSamples);
+#ifndef BUILD_BRIDGE
+                    fPlugin->postProcessFrozen(audioBuffers, numSamples);
+#endif
+                }
+
+                if (metering)
+                {
+                    for (uint32_t i=0, count=jmin(numAudioOuts, numChan2); i<count; ++i)
+                        carla_findMaxNormalizedAndRmsFloat(audioBuffers[i], numSamples, peaks[2+i], rms[2+i]);
+                }
+
+                if (autoSuspendFrames != 0)
+                {
+                    bool outputIsSilent = true;
+
+                    for (uint32_t i=0; outputIsSilent && i<numAudioOuts; ++i)
+                        outputIsSilent = (metering && i < numChan2 ? peaks[2+i]
+                                                                   : carla_findMaxNormalizedFloat(audioBuffers[i], numSamples))
+                                         < kAutoSuspendSilenceLevel;
+
+                    fAutoSuspend.checkOutput(outputIsSilent, numSamples, autoSuspendFrames);
+                }
+            }
+
+            if (metering)
+                kEngine->setPluginPeaksRT(fPlugin->getId(), peaks, rms);
         }
         else
         {
@@ -1590,15 +1737,20 @@ public:
                              numSamples);
         }
 
-        midi.clear();
-
         if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventOutPort())
         {
-            /*const*/ EngineEvent* const engineEvents(port->fBuffer);
+            EngineEvent* const engineEvents(port->fBuffer);
             CARLA_SAFE_ASSERT_RETURN(engineEvents != nullptr,);
 
-            fillWaterMidiBufferFromEngineEvents(midi, engineEvents);
-            carla_zeroStructs(engineEvents, kMaxEngineEventInternalCount);
+            uint32_t& eventCount(*port->fBufferCount);
+
+            if (eventCount != 0)
+            {
+                // graph buffers must be sorted by time, plugin output nearly always is already
+                sortEngineEvents(engineEvents, eventCount);
+                carla_copyStructs(events, engineEvents, eventCount);
+                clearEngineEvents(engineEvents, eventCount);
+            }
         }
 
         fPlugin->unlock();
@@ -1647,6 +1799,7 @@ public:
 private:
     CarlaEngine* const kEngine;
     CarlaPluginPtr fPlugin;
+    EnginePluginAutoSuspend fAutoSuspend;
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginInstance)
 };
@@ -1700,7 +1853,6 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine,
       audioBuffer(),
       cvInBuffer(),
       cvOutBuffer(),
-      midiBuffer(),
       numAudioIns(carla_fixedValue(0U, 64U, audioIns)),
       numAudioOuts(carla_fixedValue(0U, 64U, audioOuts)),
       numCVIns(carla_fixedValue(0U, 8U, cvIns)),
@@ -1709,8 +1861,13 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine,
       usingExternalHost(false),
       usingExternalOSC(false),
       extGraph(engine),
+      batchDepth(0),
+      reorderPosted(0),
+      reorderSem(),
       kEngine(engine)
 {
+    carla_sem_create2(reorderSem, false);
+
     const uint32_t bufferSize(engine->getBufferSize());
     const double   sampleRate(engine->getSampleRate());
 
@@ -1718,15 +1875,13 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine,
                                numCVIns, numCVOuts,
                                1, 1,
                                sampleRate, static_cast<int>(bufferSize));
+    graph.setNumParallelRenderingThreads(engine->getOptions().patchbayThreads);
     graph.prepareToPlay(sampleRate, static_cast<int>(bufferSize));
 
     audioBuffer.setSize(jmax(numAudioIns, numAudioOuts), bufferSize);
     cvInBuffer.setSize(numCVIns, bufferSize);
     cvOutBuffer.setSize(numCVOuts, bufferSize);
 
-    midiBuffer.ensureSize(kMaxEngineEventInternalCount*2);
-    midiBuffer.clear();
-
     StringArray channelNames;
 
     switch (numAudioIns)
@@ -1831,7 +1986,10 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine,
 
 PatchbayGraph::~PatchbayGraph()
 {
+    signalThreadShouldExit();
+    wakeReorderThread();
     stopThread(-1);
+    carla_sem_destroy2(reorderSem);
 
     connections.clear();
     extGraph.clear();
@@ -1885,6 +2043,8 @@ void PatchbayGraph::addPlugin(const CarlaPluginPtr plugin)
     node->properties.set("pluginId", static_cast<int>(plugin->getId()));
 
     addNodeToPatchbay(sendHost, sendOSC, kEngine, node, static_cast<int>(plugin->getId()), instance);
+
+    triggerReorder();
 }
 
 void PatchbayGraph::replacePlugin(const CarlaPluginPtr oldPlugin, const CarlaPluginPtr newPlugin)
@@ -1917,6 +2077,8 @@ void PatchbayGraph::replacePlugin(const CarlaPluginPtr oldPlugin, const CarlaPlu
     node->properties.set("pluginId", static_cast<int>(newPlugin->getId()));
 
     addNodeToPatchbay(sendHost, sendOSC, kEngine, node, static_cast<int>(newPlugin->getId()), instance);
+
+    triggerReorder();
 }
 
 void PatchbayGraph::renamePlugin(const CarlaPluginPtr plugin, const char* const newName)
@@ -2038,6 +2200,8 @@ void PatchbayGraph::removePlugin(const CarlaPluginPtr plugin)
     }
 
     CARLA_SAFE_ASSERT_RETURN(graph.removeNode(node->nodeId),);
+
+    triggerReorder();
 }
 
 void PatchbayGraph::removeAllPlugins()
@@ -2062,6 +2226,8 @@ void PatchbayGraph::removeAllPlugins()
 
         graph.removeNode(node->nodeId);
     }
+
+    triggerReorder();
 }
 
 bool PatchbayGraph::connect(const bool external,
@@ -2099,6 +2265,7 @@ bool PatchbayGraph::connect(const bool external,
                       strBuf);
 
     connections.list.append(connectionToId);
+    triggerReorder();
     return true;
 }
 
@@ -2138,6 +2305,7 @@ bool PatchbayGraph::disconnect(const bool external, const uint connectionId)
                           nullptr);
 
         connections.list.remove(it);
+        triggerReorder();
         return true;
     }
 
@@ -2181,6 +2349,32 @@ void PatchbayGraph::disconnectInternalGroup(const uint groupId) noexcept
     }
 }
 
+void PatchbayGraph::beginBatch() noexcept
+{
+    __sync_fetch_and_add(&batchDepth, 1);
+}
+
+void PatchbayGraph::commitBatch() noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(batchDepth > 0,);
+
+    if (__sync_sub_and_fetch(&batchDepth, 1) == 0)
+        wakeReorderThread();
+}
+
+void PatchbayGraph::triggerReorder() noexcept
+{
+    if (__sync_fetch_and_add(&batchDepth, 0) == 0)
+        wakeReorderThread();
+}
+
+void PatchbayGraph::wakeReorderThread() noexcept
+{
+    // the semaphore is binary on some systems, only post it if the thread has not been woken up yet
+    if (__sync_bool_compare_and_swap(&reorderPosted, 0, 1))
+        carla_sem_post(reorderSem);
+}
+
 void PatchbayGraph::setGroupPos(const bool sendHost, const bool sendOSC, const bool external,
                                 uint groupId, int x1, int y1, int x2, int y2)
 {
@@ -2209,7 +2403,9 @@ void PatchbayGraph::refresh(const bool sendHost, const bool sendOSC, const bool
     CARLA_SAFE_ASSERT_RETURN(deviceName != nullptr,);
 
     connections.clear();
-    graph.removeIllegalConnections();
+
+    if (graph.removeIllegalConnections())
+        triggerReorder();
 
     for (int i=0, count=graph.getNumNodes(); i<count; ++i)
     {
@@ -2510,6 +2706,69 @@ bool PatchbayGraph::getGroupAndPortIdFromFullName(const bool external, const cha
     return false;
 }
 
+void PatchbayGraph::getExclusiveUpstreamPlugins(CarlaEngine::ProtectedData* const data,
+                                                const uint id, bool* const upstream) const
+{
+    const uint count = data->curPluginCount;
+
+    uint* nodeIds;
+
+    try {
+        nodeIds = new uint[count];
+    } CARLA_SAFE_EXCEPTION_RETURN("PatchbayGraph::getExclusiveUpstreamPlugins",);
+
+    for (uint i=0; i < count; ++i)
+    {
+        const CarlaPluginPtr plugin = data->plugins[i].plugin;
+        nodeIds[i] = plugin.get() != nullptr ? plugin->getPatchbayNodeId() : 0;
+    }
+
+    static const ConnectionToId fallback = { 0, 0, 0, 0, 0 };
+
+    // grow the set backwards from the target plugin until no more plugins feed only into it
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+
+        for (uint i=0; i < count; ++i)
+        {
+            if (i == id || upstream[i] || nodeIds[i] == 0)
+                continue;
+
+            bool hasOutputs = false;
+            bool exclusive  = true;
+
+            for (LinkedList<ConnectionToId>::Itenerator it=connections.list.begin2(); exclusive && it.valid(); it.next())
+            {
+                const ConnectionToId& connectionToId(it.getValue(fallback));
+
+                if (connectionToId.groupA != nodeIds[i])
+                    continue;
+
+                hasOutputs = true;
+                exclusive  = false;
+
+                for (uint j=0; j < count; ++j)
+                {
+                    if (nodeIds[j] != connectionToId.groupB)
+                        continue;
+
+                    exclusive = j == id || upstream[j];
+                    break;
+                }
+            }
+
+            if (hasOutputs && exclusive)
+            {
+                upstream[i] = true;
+                changed = true;
+            }
+        }
+    }
+
+    delete[] nodeIds;
+}
+
 void PatchbayGraph::process(CarlaEngine::ProtectedData* const data,
                             const float* const* const inBuf,
                             float* const* const outBuf,
@@ -2520,12 +2779,6 @@ void PatchbayGraph::process(CarlaEngine::ProtectedData* const data,
     CARLA_SAFE_ASSERT_RETURN(data->events.out != nullptr,);
     CARLA_SAFE_ASSERT_RETURN(frames > 0,);
 
-    // put events in water buffer
-    {
-        midiBuffer.clear();
-        fillWaterMidiBufferFromEngineEvents(midiBuffer, data->events.in);
-    }
-
     // set audio and cv buffer size, needed for water internals
     if (! audioBuffer.setSizeRT(frames))
         return;
@@ -2556,8 +2809,9 @@ void PatchbayGraph::process(CarlaEngine::ProtectedData* const data,
             cvOutBuffer.clear(j, 0, frames);
     }
 
-    // ready to go!
-    graph.processBlockWithCV(audioBuffer, cvInBuffer, cvOutBuffer, midiBuffer);
+    // ready to go! events go in and out of the graph as they are
+    graph.processBlockWithCV(audioBuffer, cvInBuffer, cvOutBuffer, data->events.in, data->events.out);
+    data->events.outCount = getEngineEventCount(data->events.out);
 
     // put water audio and cv in carla buffer
     {
@@ -2569,21 +2823,21 @@ void PatchbayGraph::process(CarlaEngine::ProtectedData* const data,
         for (uint32_t j=0; j < numCVOuts; ++j, ++i)
             carla_copyFloats(outBuf[i], cvOutBuffer.getReadPointer(j), frames);
     }
-
-    // put water events in carla buffer
-    {
-        carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
-        fillEngineEventsFromWaterMidiBuffer(data->events.out, midiBuffer);
-        midiBuffer.clear();
-    }
 }
 
 void PatchbayGraph::run()
 {
     while (! shouldThreadExit())
     {
-        carla_msleep(100);
-        graph.reorderNowIfNeeded();
+        // changes wake us up right away, the timeout only catches the ones made behind our back
+        if (carla_sem_timedwait(reorderSem, 1000))
+            __sync_lock_release(&reorderPosted);
+
+        if (shouldThreadExit())
+            break;
+
+        if (__sync_fetch_and_add(&batchDepth, 0) == 0)
+            graph.reorderNowIfNeeded();
     }
 }
 
@@ -2902,6 +3156,24 @@ bool CarlaEngine::patchbayRefresh(const bool sendHost, const bool sendOSC, const
     return false;
 }
 
+void CarlaEngine::patchbayBeginBatch() noexcept
+{
+    if (pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+        return;
+
+    if (PatchbayGraph* const graph = pData->graph.getPatchbayGraphOrNull())
+        graph->beginBatch();
+}
+
+void CarlaEngine::patchbayCommitBatch() noexcept
+{
+    if (pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+        return;
+
+    if (PatchbayGraph* const graph = pData->graph.getPatchbayGraphOrNull())
+        graph->commitBatch();
+}
+
 // -----------------------------------------------------------------------
 // Patchbay stuff
 
@@ -3015,6 +3287,47 @@ bool CarlaEngine::restorePatchbayGroupPosition(const bool external, PatchbayPosi
     return false;
 }
 
+void CarlaEngine::getExclusiveUpstreamPlugins(const uint id, bool* const upstream) const
+{
+    CARLA_SAFE_ASSERT_RETURN(upstream != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(id < pData->curPluginCount,);
+    CARLA_SAFE_ASSERT_RETURN(pData->graph.isReady(),);
+
+    carla_zeroStructs(upstream, pData->curPluginCount);
+
+    if (pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK)
+    {
+        const CarlaPluginPtr plugin = pData->plugins[id].plugin;
+        CARLA_SAFE_ASSERT_RETURN(plugin.get() != nullptr,);
+
+        // plugins without audio inputs get the previous output mixed into theirs
+        if (plugin->getAudioInCount() == 0)
+            return;
+
+        // events of the previous plugins go past it if it has no MIDI output of its own
+        if (plugin->getMidiOutCount() == 0)
+        {
+            for (uint i=0; i < id; ++i)
+            {
+                const CarlaPluginPtr plugin2 = pData->plugins[i].plugin;
+
+                if (plugin2.get() != nullptr && plugin2->getMidiOutCount() != 0)
+                    return;
+            }
+        }
+
+        for (uint i=0; i < id; ++i)
+            upstream[i] = true;
+    }
+    else
+    {
+        PatchbayGraph* const graph = pData->graph.getPatchbayGraph();
+        CARLA_SAFE_ASSERT_RETURN(graph != nullptr,);
+
+        graph->getExclusiveUpstreamPlugins(pData, id, upstream);
+    }
+}
+
 // -----------------------------------------------------------------------
 
 bool CarlaEngine::connectExternalGraphPort(const uint connectionType, const uint portId, const char* const portName)
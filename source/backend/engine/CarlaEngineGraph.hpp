@@ -21,6 +21,7 @@
 #include "CarlaEngine.hpp"
 #include "CarlaMutex.hpp"
 #include "CarlaPatchbayUtils.hpp"
+#include "CarlaSemUtils.hpp"
 #include "CarlaStringList.hpp"
 #include "CarlaThread.hpp"
 
@@ -29,7 +30,6 @@
 
 using water::AudioProcessorGraph;
 using water::AudioSampleBuffer;
-using water::MidiBuffer;
 
 CARLA_BACKEND_START_NAMESPACE
 
@@ -170,7 +170,6 @@ public:
     AudioSampleBuffer audioBuffer;
     AudioSampleBuffer cvInBuffer;
     AudioSampleBuffer cvOutBuffer;
-    MidiBuffer midiBuffer;
     const uint32_t numAudioIns;
     const uint32_t numAudioOuts;
     const uint32_t numCVIns;
@@ -202,6 +201,11 @@ public:
     bool connect(bool external, uint groupA, uint portA, uint groupB, uint portB);
     bool disconnect(bool external, uint connectionId);
     void disconnectInternalGroup(uint groupId) noexcept;
+
+    // changes made between these are rendered together, once the outermost batch is committed
+    void beginBatch() noexcept;
+    void commitBatch() noexcept;
+
     void setGroupPos(bool sendHost, bool sendOsc, bool external, uint groupId, int x1, int y1, int x2, int y2);
     void refresh(bool sendHost, bool sendOsc, bool external, const char* deviceName);
 
@@ -209,6 +213,7 @@ public:
     const CarlaEngine::PatchbayPosition* getPositions(bool external, uint& count) const;
     bool getGroupFromName(bool external, const char* groupName, uint& groupId) const;
     bool getGroupAndPortIdFromFullName(bool external, const char* fullPortName, uint& groupId, uint& portId) const;
+    void getExclusiveUpstreamPlugins(CarlaEngine::ProtectedData* data, uint id, bool* upstream) const;
 
     void process(CarlaEngine::ProtectedData* data,
                  const float* const* inBuf,
@@ -217,6 +222,12 @@ public:
 
 private:
     void run() override;
+    void triggerReorder() noexcept;
+    void wakeReorderThread() noexcept;
+
+    int batchDepth;
+    int reorderPosted;
+    carla_sem_t reorderSem;
 
     CarlaEngine* const kEngine;
     CARLA_DECLARE_NON_COPY_CLASS(PatchbayGraph)
@@ -17,7 +17,9 @@
 
 #include "CarlaEngineInternal.hpp"
 #include "CarlaPlugin.hpp"
+#include "CarlaProcessUtils.hpp"
 #include "CarlaSemUtils.hpp"
+#include "CarlaStateUtils.hpp"
 
 #include "jackbridge/JackBridge.hpp"
 
@@ -37,7 +39,9 @@ CARLA_BACKEND_START_NAMESPACE
 
 EngineInternalEvents::EngineInternalEvents() noexcept
     : in(nullptr),
-      out(nullptr) {}
+      out(nullptr),
+      inCount(0),
+      outCount(0) {}
 
 EngineInternalEvents::~EngineInternalEvents() noexcept
 {
@@ -58,6 +62,8 @@ void EngineInternalEvents::clear() noexcept
         delete[] out;
         out = nullptr;
     }
+
+    inCount = outCount = 0;
 }
 
 // -----------------------------------------------------------------------
@@ -373,6 +379,11 @@ EngineEvent* CarlaEngine::getInternalEventBuffer(const bool isInput) const noexc
     return isInput ? pData->events.in : pData->events.out;
 }
 
+uint32_t* CarlaEngine::getInternalEventCount(const bool isInput) const noexcept
+{
+    return isInput ? &pData->events.inCount : &pData->events.outCount;
+}
+
 // -----------------------------------------------------------------------
 // CarlaEngine::ProtectedData
 
@@ -391,6 +402,7 @@ CarlaEngine::ProtectedData::ProtectedData(CarlaEngine* const engine)
       ignoreClientPrefix(false),
       currentProjectFilename(),
       currentProjectFolder(),
+      projectLoader(nullptr),
 #endif
       bufferSize(0),
       sampleRate(0.0),
@@ -419,7 +431,7 @@ CarlaEngine::ProtectedData::ProtectedData(CarlaEngine* const engine)
 {
 #ifdef BUILD_BRIDGE_ALTERNATIVE_ARCH
     plugins[0].plugin = nullptr;
-    carla_zeroStructs(plugins[0].peaks, 1);
+    plugins[0].meter.reset();
 #endif
 }
 
@@ -608,14 +620,16 @@ void CarlaEngine::ProtectedData::doPluginRemove(const uint pluginId) noexcept
         plugin->setId(i);
 
         plugins[i].plugin = plugin;
-        carla_zeroStruct(plugins[i].peaks);
+        plugins[i].autoSuspend.reset();
+        plugins[i].meter.reset();
     }
 
     const uint id = curPluginCount;
 
     // reset last plugin (now removed)
     plugins[id].plugin.reset();
-    carla_zeroFloats(plugins[id].peaks, 4);
+    plugins[id].autoSuspend.reset();
+    plugins[id].meter.reset();
 }
 
 void CarlaEngine::ProtectedData::doPluginsSwitch(const uint idA, const uint idB) noexcept
@@ -633,9 +647,13 @@ void CarlaEngine::ProtectedData::doPluginsSwitch(const uint idA, const uint idB)
 
     pluginA->setId(idB);
     plugins[idA].plugin = pluginB;
+    plugins[idA].autoSuspend.reset();
+    plugins[idA].meter.reset();
 
     pluginB->setId(idA);
     plugins[idB].plugin = pluginA;
+    plugins[idB].autoSuspend.reset();
+    plugins[idB].meter.reset();
 }
 #endif
 
@@ -853,6 +871,360 @@ ScopedThreadStopper::~ScopedThreadStopper() noexcept
         pData->thread.startThread();
 }
 
+// -----------------------------------------------------------------------
+// ScopedPatchbayBatch
+
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+ScopedPatchbayBatch::ScopedPatchbayBatch(CarlaEngine* const e) noexcept
+    : engine(e)
+{
+    engine->patchbayBeginBatch();
+}
+
+ScopedPatchbayBatch::~ScopedPatchbayBatch() noexcept
+{
+    engine->patchbayCommitBatch();
+}
+
+// -----------------------------------------------------------------------
+// EngineProjectLoader
+
+struct EngineProjectLoader::Job {
+    CarlaStateSave* const stateSave;
+    const BinaryType btype;
+    const PluginType ptype;
+    const void* const extra;
+    const uint id;
+    const bool onMainThread;
+    bool pending;
+
+    CarlaPluginPtr plugin;
+    CarlaString error;
+
+    Job(CarlaStateSave* const s, const BinaryType b, const PluginType p, const void* const e,
+        const uint i, const bool m) noexcept
+        : stateSave(s),
+          btype(b),
+          ptype(p),
+          extra(e),
+          id(i),
+          onMainThread(m),
+          pending(true),
+          plugin(),
+          error() {}
+
+    ~Job()
+    {
+        delete stateSave;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(Job)
+};
+
+class EngineProjectLoader::LoaderThread : public CarlaThread
+{
+public:
+    LoaderThread(EngineProjectLoader& l) noexcept
+        : CarlaThread("CarlaProjectLoader"),
+          lastError(),
+          loader(l),
+          threadId(),
+          hasThreadId(false) {}
+
+    bool isCurrentThread() const noexcept
+    {
+        return hasThreadId && pthread_equal(threadId, pthread_self()) != 0;
+    }
+
+    CarlaString lastError;
+
+protected:
+    void run() override
+    {
+        threadId = pthread_self();
+        hasThreadId = true;
+
+        while (Job* const job = loader.takeNextJob(false))
+        {
+            lastError.clear();
+
+            if (! loader.loadJob(job))
+                job->error = lastError;
+        }
+
+        hasThreadId = false;
+    }
+
+private:
+    EngineProjectLoader& loader;
+    pthread_t threadId;
+    volatile bool hasThreadId;
+
+    CARLA_DECLARE_NON_COPY_CLASS(LoaderThread)
+};
+
+EngineProjectLoader::EngineProjectLoader(CarlaEngine* const engine, const uint numThreads)
+    : kEngine(engine),
+      pData(engine->pData),
+      fMutex(),
+      fJobs(),
+      fThreads(),
+      fNextThreadJob(0),
+      fNextMainJob(0)
+{
+    for (uint i=0; i < numThreads; ++i)
+        fThreads.push_back(new LoaderThread(*this));
+}
+
+EngineProjectLoader::~EngineProjectLoader()
+{
+    CARLA_SAFE_ASSERT(pData->projectLoader != this);
+
+    for (std::size_t i=0; i < fThreads.size(); ++i)
+    {
+        fThreads[i]->stopThread(-1);
+        delete fThreads[i];
+    }
+
+    for (std::size_t i=0; i < fJobs.size(); ++i)
+        delete fJobs[i];
+}
+
+void EngineProjectLoader::addPlugin(CarlaStateSave* const stateSave,
+                                    const BinaryType btype, const PluginType ptype, const void* const extra)
+{
+    CARLA_SAFE_ASSERT_RETURN(stateSave != nullptr,);
+
+    // bridged plugins live in their own process, everything else must be known to be fine outside the main thread
+    bool onMainThread = btype == BINARY_NATIVE;
+
+    switch (ptype)
+    {
+    case PLUGIN_LADSPA:
+    case PLUGIN_LV2:
+    case PLUGIN_INTERNAL:
+    case PLUGIN_SFZ:
+        onMainThread = false;
+        break;
+    default:
+        break;
+    }
+
+    // ids are reserved in project order, and fixed on commit if a previous plugin fails to load
+    const uint id = pData->curPluginCount + static_cast<uint>(fJobs.size());
+
+    Job* const job = new Job(stateSave, btype, ptype, extra, id, onMainThread);
+
+    if (id >= pData->maxPluginNumber)
+    {
+        job->pending = false;
+        job->error = "Maximum number of plugins reached";
+    }
+
+    fJobs.push_back(job);
+}
+
+bool EngineProjectLoader::loadAndCommit()
+{
+    if (fJobs.size() == 0)
+        return true;
+
+    std::size_t numThreadJobs = 0;
+
+    for (std::size_t i=0; i < fJobs.size(); ++i)
+    {
+        if (fJobs[i]->pending && ! fJobs[i]->onMainThread)
+            ++numThreadJobs;
+    }
+
+    {
+        // some plugins mess up with global signals, and threads would restore each other's handlers
+        const CarlaSignalRestorer csr;
+
+        pData->projectLoader = this;
+
+        for (std::size_t i=0; i < fThreads.size() && i < numThreadJobs; ++i)
+            fThreads[i]->startThread();
+
+        // plugins that need the main thread are loaded meanwhile
+        while (Job* const job = takeNextJob(true))
+        {
+            if (! loadJob(job))
+                job->error = kEngine->getLastError();
+
+            kEngine->callback(true, true, ENGINE_CALLBACK_IDLE, 0, 0, 0, 0, 0.0f, nullptr);
+        }
+
+        const bool needsEngineIdle = kEngine->getType() != kEngineTypePlugin;
+
+        for (;;)
+        {
+            bool threadsRunning = false;
+
+            for (std::size_t i=0; i < fThreads.size(); ++i)
+            {
+                if (fThreads[i]->isThreadRunning())
+                {
+                    threadsRunning = true;
+                    break;
+                }
+            }
+
+            if (! threadsRunning)
+                break;
+
+            kEngine->callback(true, true, ENGINE_CALLBACK_IDLE, 0, 0, 0, 0, 0.0f, nullptr);
+
+            if (needsEngineIdle)
+                kEngine->idle();
+
+            carla_msleep(5);
+        }
+
+        pData->projectLoader = nullptr;
+    }
+
+    const bool stoppedEarly = pData->aboutToClose || pData->actionCanceled;
+
+    commit(stoppedEarly);
+
+    if (! stoppedEarly)
+        return true;
+
+    if (! pData->aboutToClose)
+        kEngine->setLastError("Project load canceled");
+
+    return false;
+}
+
+bool EngineProjectLoader::isLoaderThread() const noexcept
+{
+    for (std::size_t i=0; i < fThreads.size(); ++i)
+    {
+        if (fThreads[i]->isCurrentThread())
+            return true;
+    }
+
+    return false;
+}
+
+bool EngineProjectLoader::setLastErrorForLoaderThread(const char* const error) noexcept
+{
+    for (std::size_t i=0; i < fThreads.size(); ++i)
+    {
+        if (fThreads[i]->isCurrentThread())
+        {
+            fThreads[i]->lastError = error;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+EngineProjectLoader::Job* EngineProjectLoader::takeNextJob(const bool onMainThread)
+{
+    if (pData->aboutToClose || pData->actionCanceled)
+        return nullptr;
+
+    const CarlaMutexLocker cml(fMutex);
+
+    std::size_t& next(onMainThread ? fNextMainJob : fNextThreadJob);
+
+    for (; next < fJobs.size(); ++next)
+    {
+        Job* const job = fJobs[next];
+
+        if (job->pending && job->onMainThread == onMainThread)
+        {
+            job->pending = false;
+            ++next;
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+bool EngineProjectLoader::loadJob(Job* const job)
+{
+    const CarlaStateSave& stateSave(*job->stateSave);
+
+    const CarlaPluginPtr plugin = kEngine->createPlugin(job->id, job->btype, job->ptype,
+                                                        stateSave.binary, stateSave.name, stateSave.label,
+                                                        stateSave.uniqueId, job->extra, stateSave.options);
+
+    if (plugin.get() == nullptr)
+        return false;
+
+    // deactivate bridge client-side ping check, since some plugins block during load
+    if ((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0)
+        plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
+
+    plugin->loadStateSave(stateSave);
+
+    job->plugin = plugin;
+    return true;
+}
+
+void EngineProjectLoader::commit(const bool stoppedEarly)
+{
+    const bool isPatchbay = pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY;
+
+    for (std::size_t i=0; i < fJobs.size(); ++i)
+    {
+        Job* const job = fJobs[i];
+
+        // a serial load would have stopped here, plugins loaded by other threads past this point are dropped
+        if (stoppedEarly && job->pending)
+            break;
+
+        const CarlaPluginPtr plugin = job->plugin;
+
+        if (plugin.get() == nullptr)
+        {
+            if (job->error.isNotEmpty())
+                carla_stderr2("Failed to load a plugin '%s', error was:\n%s", job->stateSave->name, job->error.buffer());
+            continue;
+        }
+
+        const uint id = pData->curPluginCount;
+        CARLA_SAFE_ASSERT_CONTINUE(pData->plugins[id].plugin.get() == nullptr);
+
+        if (plugin->getId() != id)
+            plugin->setId(id);
+
+        // names were only made unique against the plugins loaded before this project
+        if (const char* const uniqueName = kEngine->getUniquePluginName(plugin->getName()))
+        {
+            if (std::strcmp(uniqueName, plugin->getName()) != 0)
+                plugin->setName(uniqueName);
+
+            delete[] uniqueName;
+        }
+
+        EnginePluginData& pluginData(pData->plugins[id]);
+        pluginData.plugin = plugin;
+        pluginData.autoSuspend.reset();
+        pluginData.meter.reset();
+
+        plugin->setEnabled(true);
+
+        ++pData->curPluginCount;
+        kEngine->callback(true, true, ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0, 0.0f, plugin->getName());
+
+        if (isPatchbay)
+            pData->graph.addPlugin(plugin);
+    }
+
+    for (std::size_t i=0; i < fJobs.size(); ++i)
+        delete fJobs[i];
+
+    fJobs.clear();
+    fNextThreadJob = fNextMainJob = 0;
+}
+#endif
+
 // -----------------------------------------------------------------------
 // ScopedEngineEnvironmentLocker
 
@@ -59,6 +59,8 @@ CARLA_BACKEND_START_NAMESPACE
 struct EngineInternalEvents {
     EngineEvent* in;
     EngineEvent* out;
+    uint32_t inCount;  // number of events in `in`, shared with the event ports using it
+    uint32_t outCount; // number of events in `out`, same as above
 
     EngineInternalEvents() noexcept;
     ~EngineInternalEvents() noexcept;
@@ -71,8 +73,10 @@ struct EngineInternalEvents {
 // -----------------------------------------------------------------------
 // InternalGraph
 
+struct CarlaStateSave;
 struct RackGraph;
 class PatchbayGraph;
+class EngineProjectLoader;
 
 class EngineInternalGraph
 {
@@ -221,23 +225,171 @@ struct EngineNextAction {
     CARLA_DECLARE_NON_COPY_STRUCT(EngineNextAction)
 };
 
+// -----------------------------------------------------------------------
+// EnginePluginAutoSuspend
+
+// Silence tracking of a single plugin, only used by the thread processing it.
+// @see ENGINE_OPTION_AUTO_SUSPEND_TIME
+struct EnginePluginAutoSuspend {
+    uint32_t silentFrames;
+    bool suspended;
+
+    EnginePluginAutoSuspend() noexcept
+        : silentFrames(0),
+          suspended(false) {}
+
+    void reset() noexcept
+    {
+        silentFrames = 0;
+        suspended = false;
+    }
+
+    // to call before processing, returns true if the plugin can be skipped
+    bool checkInput(const bool inputIsSilent) noexcept
+    {
+        if (! inputIsSilent)
+        {
+            reset();
+            return false;
+        }
+
+        return suspended;
+    }
+
+    // to call after processing
+    void checkOutput(const bool outputIsSilent, const uint32_t frames, const uint32_t tailFrames) noexcept
+    {
+        if (! outputIsSilent)
+        {
+            silentFrames = 0;
+            return;
+        }
+
+        if (silentFrames < tailFrames)
+            silentFrames += frames;
+
+        if (silentFrames >= tailFrames)
+            suspended = true;
+    }
+};
+
+// -----------------------------------------------------------------------
+// EnginePluginMeter
+
+// Peak and RMS values of a single plugin, only computed while someone is reading them.
+// Reading subscribes to the values for kSubscriptionTime, after that the audio thread stops metering the plugin.
+// The audio thread publishes with a sequence counter, so readers get a consistent snapshot without locking.
+struct EnginePluginMeter {
+    static const uint kSubscriptionTime = 1000; // ms
+
+    // input left, input right, output left, output right
+    struct Values {
+        float peaks[4];
+        float rms[4];
+    };
+
+    volatile bool requested;    // set by readers, taken by the audio thread
+    volatile uint32_t sequence; // odd while values are being written
+    uint32_t subscribedFrames;  // audio thread only
+    Values values;              // written by the audio thread
+    Values snapshot;            // last values read, returned to readers
+
+    EnginePluginMeter() noexcept
+        : requested(false),
+          sequence(0),
+          subscribedFrames(0)
+    {
+        carla_zeroStruct(values);
+        carla_zeroStruct(snapshot);
+    }
+
+    // the plugin must not be processing
+    void reset() noexcept
+    {
+        requested = false;
+        subscribedFrames = 0;
+        carla_zeroStruct(values);
+        carla_zeroStruct(snapshot);
+    }
+
+    // to call once per audio cycle, returns true if the plugin needs to be metered in this cycle
+    bool isSubscribedRT(const uint32_t frames, const double sampleRate) noexcept
+    {
+        if (requested)
+        {
+            requested = false;
+            subscribedFrames = static_cast<uint32_t>(sampleRate * kSubscriptionTime / 1000.0);
+        }
+
+        if (subscribedFrames == 0)
+            return false;
+
+        if (subscribedFrames > frames)
+        {
+            subscribedFrames -= frames;
+            return true;
+        }
+
+        // nobody is reading anymore, do not leave stale values behind for the next reader
+        subscribedFrames = 0;
+
+        Values silence;
+        carla_zeroStruct(silence);
+        publishRT(silence);
+        return false;
+    }
+
+    void publishRT(const Values& newValues) noexcept
+    {
+        sequence = sequence + 1;
+        __sync_synchronize();
+        values = newValues;
+        __sync_synchronize();
+        sequence = sequence + 1;
+    }
+
+    // renews the subscription and updates the snapshot
+    const Values& read() noexcept
+    {
+        requested = true;
+
+        // give up after a few tries, it is not worth spinning for meters
+        for (int i=0; i < 4; ++i)
+        {
+            const uint32_t seq = sequence;
+
+            if (seq & 1)
+                continue;
+
+            __sync_synchronize();
+            Values tmp(values);
+            __sync_synchronize();
+
+            if (sequence == seq)
+            {
+                snapshot = tmp;
+                break;
+            }
+        }
+
+        return snapshot;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EnginePluginMeter)
+};
+
 // -----------------------------------------------------------------------
 // EnginePluginData
 
 struct EnginePluginData {
     CarlaPluginPtr plugin;
-    float peaks[4];
+    EnginePluginMeter meter;
+    EnginePluginAutoSuspend autoSuspend;
 
     EnginePluginData()
         : plugin(nullptr),
-#ifdef CARLA_PROPER_CPP11_SUPPORT
-          peaks{0.0f, 0.0f, 0.0f, 0.0f} {}
-#else
-          peaks()
-    {
-        carla_zeroStruct(peaks);
-    }
-#endif
+          meter(),
+          autoSuspend() {}
 };
 
 // -----------------------------------------------------------------------
@@ -263,6 +415,7 @@ struct CarlaEngine::ProtectedData {
     bool ignoreClientPrefix; // backwards compat only
     CarlaString currentProjectFilename;
     CarlaString currentProjectFolder;
+    EngineProjectLoader* projectLoader; // only valid while loading plugins in parallel
 #endif
 
     uint32_t bufferSize;
@@ -288,6 +441,7 @@ struct CarlaEngine::ProtectedData {
     float dspLoad;
 #endif
     float peaks[4];
+    float rms[4];
     std::vector<CarlaPluginPtr> pluginsToDelete;
 
     EngineInternalEvents events;
@@ -378,6 +532,79 @@ private:
 
 // -----------------------------------------------------------------------
 
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+class ScopedPatchbayBatch
+{
+public:
+    ScopedPatchbayBatch(CarlaEngine* engine) noexcept;
+    ~ScopedPatchbayBatch() noexcept;
+
+private:
+    CarlaEngine* const engine;
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(ScopedPatchbayBatch)
+};
+
+// -----------------------------------------------------------------------
+// EngineProjectLoader
+
+/*!
+ * Loads the plugins of a project using a pool of threads.
+ * LV2, LADSPA, internal, SFZ and bridged plugins are instantiated and restored by the pool,
+ * other formats are handled by the calling thread meanwhile.
+ * Plugins are only added to the engine once all of them are loaded, in project order.
+ */
+class EngineProjectLoader
+{
+public:
+    EngineProjectLoader(CarlaEngine* engine, uint numThreads);
+    ~EngineProjectLoader();
+
+    /*!
+     * Queue a plugin, taking ownership of @a stateSave.
+     */
+    void addPlugin(CarlaStateSave* stateSave, BinaryType btype, PluginType ptype, const void* extra);
+
+    /*!
+     * Load all queued plugins and add them to the engine.
+     * Stops early if the engine is closing or the action was canceled, in which case only the plugins queued
+     * before the first one that was not loaded are added, same as when loading a project without threads.
+     * Returns false when stopped early, with the engine last error set if the action was canceled.
+     */
+    bool loadAndCommit();
+
+    bool isLoaderThread() const noexcept;
+
+    /*!
+     * Keep @a error for the plugin being loaded by the calling thread.
+     * Returns false if the caller is not one of the loader threads.
+     */
+    bool setLastErrorForLoaderThread(const char* error) noexcept;
+
+private:
+    struct Job;
+    class LoaderThread;
+
+    CarlaEngine* const kEngine;
+    CarlaEngine::ProtectedData* const pData;
+
+    CarlaMutex fMutex;
+    std::vector<Job*> fJobs;
+    std::vector<LoaderThread*> fThreads;
+    std::size_t fNextThreadJob;
+    std::size_t fNextMainJob;
+
+    Job* takeNextJob(bool onMainThread);
+    bool loadJob(Job* job);
+    void commit(bool stoppedEarly);
+
+    CARLA_DECLARE_NON_COPY_CLASS(EngineProjectLoader)
+};
+#endif
+
+// -----------------------------------------------------------------------
+
 CARLA_BACKEND_END_NAMESPACE
 
 #endif // CARLA_ENGINE_INTERNAL_HPP_INCLUDED
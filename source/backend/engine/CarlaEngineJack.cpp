@@ -3023,8 +3023,8 @@ protected:
             /**/  float* outBuf[2] = { audioOut1, audioOut2 };
 
             // initialize events
-            carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-            carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+            clearEngineEvents(pData->events.in, pData->events.inCount);
+            clearEngineEvents(pData->events.out, pData->events.outCount);
 
             if (eventIn != nullptr)
             {
@@ -3048,6 +3048,8 @@ protected:
                     if (engineEventIndex >= kMaxEngineEventInternalCount)
                         break;
                 }
+
+                pData->events.inCount = engineEventIndex;
             }
 
             if (pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK)
@@ -3070,13 +3072,13 @@ protected:
                 uint8_t  mdataTmp[EngineMidiEvent::kDataSize];
                 const uint8_t* mdataPtr;
 
-                for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+                for (uint32_t i=0; i < pData->events.outCount; ++i)
                 {
                     const EngineEvent& engineEvent(pData->events.out[i]);
 
                     /**/ if (engineEvent.type == kEngineEventTypeNull)
                     {
-                        break;
+                        continue;
                     }
                     else if (engineEvent.type == kEngineEventTypeControl)
                     {
@@ -4095,34 +4097,27 @@ private:
                 cvOut[i] = nullptr;
         }
 
-        float inPeaks[2] = { 0.0f };
-        float outPeaks[2] = { 0.0f };
+        // input left/right followed by output left/right
+        float peaks[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float rms[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-        for (uint32_t i=0; i < audioInCount && i < 2; ++i)
-        {
-            for (uint32_t j=0; j < nframes; ++j)
-            {
-                const float absV(std::abs(audioIn[i][j]));
+        const bool metering = isPluginMeteredRT(plugin->getId(), nframes);
 
-                if (absV > inPeaks[i])
-                    inPeaks[i] = absV;
-            }
+        if (metering)
+        {
+            for (uint32_t i=0; i < audioInCount && i < 2; ++i)
+                carla_findMaxNormalizedAndRmsFloat(audioIn[i], nframes, peaks[i], rms[i]);
         }
 
         plugin->process(audioIn, audioOut, cvIn, cvOut, nframes);
 
-        for (uint32_t i=0; i < audioOutCount && i < 2; ++i)
+        if (metering)
         {
-            for (uint32_t j=0; j < nframes; ++j)
-            {
-                const float absV(std::abs(audioOut[i][j]));
+            for (uint32_t i=0; i < audioOutCount && i < 2; ++i)
+                carla_findMaxNormalizedAndRmsFloat(audioOut[i], nframes, peaks[2+i], rms[2+i]);
 
-                if (absV > outPeaks[i])
-                    outPeaks[i] = absV;
-            }
+            setPluginPeaksRT(plugin->getId(), peaks, rms);
         }
-
-        setPluginPeaksRT(plugin->getId(), inPeaks, outPeaks);
     }
 
 #ifndef BUILD_BRIDGE
@@ -598,8 +598,8 @@ protected:
             carla_zeroFloats(outputChannelData[i], nframes);
 
         // initialize events
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in, pData->events.inCount);
+        clearEngineEvents(pData->events.out, pData->events.outCount);
 
         if (fMidiInEvents.mutex.tryLock())
         {
@@ -631,6 +631,8 @@ protected:
                     break;
             }
 
+            pData->events.inCount = engineEventIndex;
+
             fMidiInEvents.data.clear();
             fMidiInEvents.mutex.unlock();
         }
@@ -645,12 +647,12 @@ protected:
             uint8_t        data[3] = { 0, 0, 0 };
             const uint8_t* dataPtr = data;
 
-            for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+            for (uint32_t i=0; i < pData->events.outCount; ++i)
             {
                 const EngineEvent& engineEvent(pData->events.out[i]);
 
                 if (engineEvent.type == kEngineEventTypeNull)
-                    break;
+                    continue;
 
                 else if (engineEvent.type == kEngineEventTypeControl)
                 {
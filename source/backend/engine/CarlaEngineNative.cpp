@@ -54,6 +54,7 @@
 #endif
 
 #include "water/files/File.h"
+#include "water/misc/Time.h"
 #include "water/streams/MemoryOutputStream.h"
 #include "water/xml/XmlDocument.h"
 #include "water/xml/XmlElement.h"
@@ -61,6 +62,7 @@
 using water::File;
 using water::MemoryOutputStream;
 using water::String;
+using water::Time;
 using water::XmlDocument;
 using water::XmlElement;
 
@@ -169,6 +171,7 @@ public:
         carla_debug("CarlaEngineNative::CarlaEngineNative()");
 
         carla_zeroFloats(fParameters, kNumInParams+kNumOutParams);
+        carla_zeroStructs(fUiPeaksSubscriptions, MAX_PATCHBAY_PLUGINS);
 
 #ifdef USE_REFCOUNTER_JUCE_MESSAGE_MANAGER
         if (kNeedsJuceEvents)
@@ -424,9 +427,18 @@ public:
         }
     }
 
+    // the UI asks for the peaks of each plugin it shows, and keeps asking while it does
+    void subscribePeaksFromUI(const uint32_t pluginId) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(pluginId < MAX_PATCHBAY_PLUGINS,);
+
+        fUiPeaksSubscriptions[pluginId] = Time::getMillisecondCounter() + EnginePluginMeter::kSubscriptionTime;
+    }
+
     void reloadFromUI()
     {
         carla_zeroFloats(fParameters, kNumInParams+kNumOutParams);
+        carla_zeroStructs(fUiPeaksSubscriptions, MAX_PATCHBAY_PLUGINS);
         pHost->dispatcher(pHost->handle, NATIVE_HOST_OPCODE_RELOAD_PARAMETERS, 0, 0, nullptr, 0.0f);
     }
 
@@ -1171,8 +1183,8 @@ protected:
         // ---------------------------------------------------------------
         // initialize events
 
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in, pData->events.inCount);
+        clearEngineEvents(pData->events.out, pData->events.outCount);
 
         // ---------------------------------------------------------------
         // events input (before processing)
@@ -1191,6 +1203,8 @@ protected:
                 if (engineEventIndex >= kMaxEngineEventInternalCount)
                     break;
             }
+
+            pData->events.inCount = engineEventIndex;
         }
 
         if (kIsPatchbay)
@@ -1217,18 +1231,18 @@ protected:
         // ---------------------------------------------------------------
         // events output (after processing)
 
-        carla_zeroStructs(pData->events.in, kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in, pData->events.inCount);
 
         if (kHasMidiOut)
         {
             NativeMidiEvent midiEvent;
 
-            for (uint32_t i=0; i < kMaxEngineEventInternalCount; ++i)
+            for (uint32_t i=0; i < pData->events.outCount; ++i)
             {
                 const EngineEvent& engineEvent(pData->events.out[i]);
 
                 if (engineEvent.type == kEngineEventTypeNull)
-                    break;
+                    continue;
 
                 carla_zeroStruct(midiEvent);
                 midiEvent.time = engineEvent.time;
@@ -1435,6 +1449,9 @@ protected:
         const CarlaScopedLocale csl;
         const EngineTimeInfo& timeInfo(pData->timeInfo);
 
+        // everything below goes out as a single write
+        const CarlaScopedPipeFrame cspf(fUiServer);
+
         // ------------------------------------------------------------------------------------------------------------
         // send engine info
 
@@ -1442,8 +1459,6 @@ protected:
         CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage("runtime-info\n"),);
         CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
 
-        fUiServer.flushMessages();
-
         if (const char* const projFolder = getCurrentProjectFolder())
         {
             if (fLastProjectFolder != projFolder)
@@ -1452,7 +1467,6 @@ protected:
                 fLastProjectFolder = projFolder;
                 CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage("project-folder\n"),);
                 CARLA_SAFE_ASSERT_RETURN(fUiServer.writeAndFixMessage(projFolder),);
-                fUiServer.flushMessages();
             }
         }
 
@@ -1460,7 +1474,7 @@ protected:
         // send transport
 
         CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage("transport\n"),);
-        CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(timeInfo.playing ? "true\n" : "false\n"),);
+        CARLA_SAFE_ASSERT_RETURN(fUiServer.writeBoolValue(timeInfo.playing),);
 
         if (timeInfo.bbt.valid)
         {
@@ -1469,48 +1483,48 @@ protected:
                                                                    timeInfo.bbt.beat,
                                                                    static_cast<int>(timeInfo.bbt.tick + 0.5));
             CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
-            std::snprintf(tmpBuf, STR_MAX, "%.12g\n", timeInfo.bbt.beatsPerMinute);
-            CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
+            CARLA_SAFE_ASSERT_RETURN(fUiServer.writeDoubleValue(timeInfo.bbt.beatsPerMinute),);
         }
         else
         {
             std::snprintf(tmpBuf, STR_MAX, P_UINT64 ":0:0:0\n", timeInfo.frame);
             CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
-            CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage("0.0\n"),);
+            CARLA_SAFE_ASSERT_RETURN(fUiServer.writeDoubleValue(0.0),);
         }
 
-        fUiServer.flushMessages();
-
         // ------------------------------------------------------------------------------------------------------------
-        // send peaks and param outputs for all plugins
+        // send peaks of the plugins the UI subscribed to, and param outputs for all plugins
+
+        const uint32_t now = Time::getMillisecondCounter();
 
         for (uint i=0; i < pData->curPluginCount; ++i)
         {
-            const EnginePluginData& plugData(pData->plugins[i]);
             const CarlaPluginPtr plugin = pData->plugins[i].plugin;
 
-            std::snprintf(tmpBuf, STR_MAX, "PEAKS_%i\n", i);
-            CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
-            std::snprintf(tmpBuf, STR_MAX, "%.12g:%.12g:%.12g:%.12g\n",
-                          static_cast<double>(plugData.peaks[0]),
-                          static_cast<double>(plugData.peaks[1]),
-                          static_cast<double>(plugData.peaks[2]),
-                          static_cast<double>(plugData.peaks[3]));
-            CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
+            // reading peaks keeps the plugin metered, so only do it while the UI shows them
+            if (i < MAX_PATCHBAY_PLUGINS && now < fUiPeaksSubscriptions[i])
+            {
+                const float* const peaks = getPeaks(i);
 
-            fUiServer.flushMessages();
+                std::snprintf(tmpBuf, STR_MAX, "PEAKS_%i\n", i);
+                CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
+
+                for (uint j=0; j < 4; ++j)
+                    CARLA_SAFE_ASSERT_RETURN(fUiServer.writeFloatValue(peaks[j]),);
+            }
 
-            for (uint32_t j=0, count=plugin->getParameterCount(); j < count; ++j)
+            for (uint32_t w=0, wcount=(plugin->getParameterCount()+31)/32; w < wcount; ++w)
             {
-                if (! plugin->isParameterOutput(j))
-                    continue;
+                uint32_t changes = plugin->takeParameterOutputChanges(kParameterOutputConsumerNativeUI, w);
 
-                std::snprintf(tmpBuf, STR_MAX, "PARAMVAL_%u:%u\n", i, j);
-                CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
-                std::snprintf(tmpBuf, STR_MAX, "%.12g\n", static_cast<double>(plugin->getParameterValue(j)));
-                CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
+                for (; changes != 0; changes &= changes - 1)
+                {
+                    const uint32_t j = w * 32 + static_cast<uint32_t>(__builtin_ctz(changes));
 
-                fUiServer.flushMessages();
+                    std::snprintf(tmpBuf, STR_MAX, "PARAMVAL_%u:%u\n", i, j);
+                    CARLA_SAFE_ASSERT_RETURN(fUiServer.writeMessage(tmpBuf),);
+                    CARLA_SAFE_ASSERT_RETURN(fUiServer.writeFloatValue(plugin->getParameterValue(j)),);
+                }
             }
         }
     }
@@ -1776,6 +1790,9 @@ private:
 
     bool fOptionsForced;
 
+    // time until which the UI wants the peaks of each plugin, see subscribePeaksFromUI()
+    uint32_t fUiPeaksSubscriptions[MAX_PATCHBAY_PLUGINS];
+
     CarlaPluginPtr _getPluginForParameterIndex(uint32_t& index) const noexcept
     {
         if (pData->curPluginCount == 0 || pData->plugins == nullptr)
@@ -1948,6 +1965,14 @@ bool CarlaEngineNativeUI::msgReceived(const char* const msg) noexcept
             ok = fEngine->patchbayRefresh(true, false, external);
         } CARLA_SAFE_EXCEPTION("patchbayRefresh");
     }
+    else if (std::strcmp(msg, "patchbay_begin_batch") == 0)
+    {
+        fEngine->patchbayBeginBatch();
+    }
+    else if (std::strcmp(msg, "patchbay_commit_batch") == 0)
+    {
+        fEngine->patchbayCommitBatch();
+    }
     else if (std::strcmp(msg, "transport_play") == 0)
     {
         fEngine->transportPlay();
@@ -2356,6 +2381,14 @@ bool CarlaEngineNativeUI::msgReceived(const char* const msg) noexcept
         if (const CarlaPluginPtr plugin = fEngine->getPlugin(pluginId))
             plugin->sendMidiSingleNote(static_cast<uint8_t>(channel), static_cast<uint8_t>(note), static_cast<uint8_t>(velocity), true, true, false);
     }
+    else if (std::strcmp(msg, "subscribe_peaks") == 0)
+    {
+        uint32_t pluginId;
+
+        CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(pluginId), true);
+
+        fEngine->subscribePeaksFromUI(pluginId);
+    }
     else if (std::strcmp(msg, "show_custom_ui") == 0)
     {
         uint32_t pluginId;
@@ -2365,7 +2398,12 @@ bool CarlaEngineNativeUI::msgReceived(const char* const msg) noexcept
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsBool(yesNo), true);
 
         if (const CarlaPluginPtr plugin = fEngine->getPlugin(pluginId))
+        {
+            if (yesNo)
+                plugin->markParameterOutputsChanged(kParameterOutputConsumerEngineThread);
+
             plugin->showCustomUI(yesNo);
+        }
     }
     else
     {
@@ -121,7 +121,9 @@ void CarlaEngineCVPort::setRange(const float min, const float max) noexcept
 CarlaEngineEventPort::CarlaEngineEventPort(const CarlaEngineClient& client, const bool isInputPort, const uint32_t indexOffset) noexcept
     : CarlaEnginePort(client, isInputPort, indexOffset),
       kProcessMode(client.getEngine().getProccessMode()),
-      fBuffer(nullptr)
+      fBuffer(nullptr),
+      fBufferCount(&fOwnBufferCount),
+      fOwnBufferCount(0)
 {
     carla_debug("CarlaEngineEventPort::CarlaEngineEventPort(%s)", bool2str(isInputPort));
 
@@ -148,9 +150,15 @@ CarlaEngineEventPort::~CarlaEngineEventPort() noexcept
 void CarlaEngineEventPort::initBuffer() noexcept
 {
     if (kProcessMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK || kProcessMode == ENGINE_PROCESS_MODE_BRIDGE)
-        fBuffer = kClient.getEngine().getInternalEventBuffer(kIsInput);
+    {
+        // the buffer is shared with the engine and other ports, and so is its count
+        fBuffer      = kClient.getEngine().getInternalEventBuffer(kIsInput);
+        fBufferCount = kClient.getEngine().getInternalEventCount(kIsInput);
+    }
     else if (kProcessMode == ENGINE_PROCESS_MODE_PATCHBAY && ! kIsInput)
-        carla_zeroStructs(fBuffer, kMaxEngineEventInternalCount);
+    {
+        clearEngineEvents(fBuffer, *fBufferCount);
+    }
 }
 
 uint32_t CarlaEngineEventPort::getEventCount() const noexcept
@@ -159,15 +167,7 @@ uint32_t CarlaEngineEventPort::getEventCount() const noexcept
     CARLA_SAFE_ASSERT_RETURN(fBuffer != nullptr, 0);
     CARLA_SAFE_ASSERT_RETURN(kProcessMode != ENGINE_PROCESS_MODE_SINGLE_CLIENT && kProcessMode != ENGINE_PROCESS_MODE_MULTIPLE_CLIENTS, 0);
 
-    uint32_t i=0;
-
-    for (; i < kMaxEngineEventInternalCount; ++i)
-    {
-        if (fBuffer[i].type == kEngineEventTypeNull)
-            break;
-    }
-
-    return i;
+    return *fBufferCount;
 }
 
 EngineEvent& CarlaEngineEventPort::getEvent(const uint32_t index) const noexcept
@@ -207,12 +207,11 @@ bool CarlaEngineEventPort::writeControlEvent(const uint32_t time, const uint8_t
         CARLA_SAFE_ASSERT(! MIDI_IS_CONTROL_BANK_SELECT(param));
     }
 
-    for (uint32_t i=0; i < kMaxEngineEventInternalCount; ++i)
-    {
-        EngineEvent& event(fBuffer[i]);
+    uint32_t& count(*fBufferCount);
 
-        if (event.type != kEngineEventTypeNull)
-            continue;
+    if (count < kMaxEngineEventInternalCount)
+    {
+        EngineEvent& event(fBuffer[count++]);
 
         event.type    = kEngineEventTypeControl;
         event.time    = time;
@@ -250,12 +249,11 @@ bool CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t cha
     CARLA_SAFE_ASSERT_RETURN(size > 0 && size <= EngineMidiEvent::kDataSize, false);
     CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
 
-    for (uint32_t i=0; i < kMaxEngineEventInternalCount; ++i)
-    {
-        EngineEvent& event(fBuffer[i]);
+    uint32_t& count(*fBufferCount);
 
-        if (event.type != kEngineEventTypeNull)
-            continue;
+    if (count < kMaxEngineEventInternalCount)
+    {
+        EngineEvent& event(fBuffer[count++]);
 
         event.time    = time;
         event.channel = channel;
@@ -429,15 +427,9 @@ void CarlaEngineCVSourcePorts::initPortBuffers(const float* const* const buffers
     EngineEvent* const buffer = eventPort->fBuffer;
     CARLA_SAFE_ASSERT_RETURN(buffer != nullptr,);
 
-    uint32_t eventCount = 0;
+    uint32_t& eventCount(*eventPort->fBufferCount);
     float v, min, max;
 
-    for (; eventCount < kMaxEngineEventInternalCount; ++eventCount)
-    {
-        if (buffer[eventCount].type == kEngineEventTypeNull)
-            break;
-    }
-
     if (eventCount == kMaxEngineEventInternalCount)
         return;
 
@@ -20,10 +20,9 @@
 #include "CarlaEngineInternal.hpp"
 #include "CarlaBackendUtils.hpp"
 #include "CarlaMathUtils.hpp"
+#include "CarlaRingBuffer.hpp"
 #include "CarlaStringList.hpp"
 
-#include "RtLinkedList.hpp"
-
 #include "jackbridge/JackBridge.hpp"
 
 #if defined(__clang__)
@@ -48,6 +47,10 @@
 # pragma GCC diagnostic pop
 #endif
 
+#ifdef CARLA_OS_MAC
+# include <mach/mach_time.h>
+#endif
+
 CARLA_BACKEND_START_NAMESPACE
 
 // -------------------------------------------------------------------------------------------------------------------
@@ -185,18 +188,19 @@ public:
           fAudioInterleaved(false),
           fAudioInCount(0),
           fAudioOutCount(0),
-          fLastEventTime(0),
           fDeviceName(),
           fAudioIntBufIn(nullptr),
           fAudioIntBufOut(nullptr),
-          fMidiIns(),
-          fMidiInEvents(),
+          fCallbackTime(),
+          fMidiInCount(0),
           fMidiOuts(),
           fMidiOutMutex(),
           fMidiOutVector(EngineMidiEvent::kDataSize)
     {
         carla_debug("CarlaEngineRtAudio::CarlaEngineRtAudio(%i)", api);
 
+        carla_zeroPointers(fMidiIns, kMaxMidiIns);
+
         // just to make sure
         pData->options.transportMode = ENGINE_TRANSPORT_MODE_INTERNAL;
     }
@@ -205,7 +209,7 @@ public:
     {
         CARLA_SAFE_ASSERT(fAudioInCount == 0);
         CARLA_SAFE_ASSERT(fAudioOutCount == 0);
-        CARLA_SAFE_ASSERT(fLastEventTime == 0);
+        CARLA_SAFE_ASSERT(fMidiInCount == 0);
         carla_debug("CarlaEngineRtAudio::~CarlaEngineRtAudio()");
     }
 
@@ -215,7 +219,7 @@ public:
     {
         CARLA_SAFE_ASSERT_RETURN(fAudioInCount == 0, false);
         CARLA_SAFE_ASSERT_RETURN(fAudioOutCount == 0, false);
-        CARLA_SAFE_ASSERT_RETURN(fLastEventTime == 0, false);
+        CARLA_SAFE_ASSERT_RETURN(fMidiInCount == 0, false);
         CARLA_SAFE_ASSERT_RETURN(clientName != nullptr && clientName[0] != '\0', false);
         carla_debug("CarlaEngineRtAudio::init(\"%s\")", clientName);
 
@@ -327,7 +331,7 @@ public:
 
         fAudioInCount  = iParams.nChannels;
         fAudioOutCount = oParams.nChannels;
-        fLastEventTime = 0;
+        fCallbackTime.reset = true;
 
         if (fAudioInCount > 0)
             fAudioIntBufIn = new float[fAudioInCount*bufferFrames];
@@ -387,20 +391,24 @@ public:
 
         pData->graph.destroy();
 
-        for (LinkedList<MidiInPort>::Itenerator it = fMidiIns.begin2(); it.valid(); it.next())
+        // the audio stream is stopped at this point, so the MIDI input slots can go away
+        for (uint i=0; i < fMidiInCount; ++i)
         {
-            static MidiInPort fallback = { nullptr, { '\0' } };
+            MidiInPort* const inPort(fMidiIns[i]);
+            CARLA_SAFE_ASSERT_CONTINUE(inPort != nullptr);
 
-            MidiInPort& inPort(it.getValue(fallback));
-            CARLA_SAFE_ASSERT_CONTINUE(inPort.port != nullptr);
+            if (inPort->port != nullptr)
+            {
+                inPort->port->cancelCallback();
+                inPort->port->closePort();
+                delete inPort->port;
+            }
 
-            inPort.port->cancelCallback();
-            inPort.port->closePort();
-            delete inPort.port;
+            delete inPort;
+            fMidiIns[i] = nullptr;
         }
 
-        fMidiIns.clear();
-        fMidiInEvents.clear();
+        fMidiInCount = 0;
 
         fMidiOutMutex.lock();
 
@@ -420,7 +428,6 @@ public:
 
         fAudioInCount  = 0;
         fAudioOutCount = 0;
-        fLastEventTime = 0;
         fDeviceName.clear();
 
         if (fAudioIntBufIn != nullptr)
@@ -542,14 +549,15 @@ public:
         // ---------------------------------------------------------------
         // add midi connections
 
-        for (LinkedList<MidiInPort>::Itenerator it=fMidiIns.begin2(); it.valid(); it.next())
+        for (uint i=0; i < fMidiInCount; ++i)
         {
-            static const MidiInPort fallback = { nullptr, { '\0' } };
+            const MidiInPort* const inPort(fMidiIns[i]);
+            CARLA_SAFE_ASSERT_CONTINUE(inPort != nullptr);
 
-            const MidiInPort& inPort(it.getValue(fallback));
-            CARLA_SAFE_ASSERT_CONTINUE(inPort.port != nullptr);
+            if (inPort->port == nullptr)
+                continue;
 
-            const uint portId(extGraph.midiPorts.getPortId(true, inPort.name));
+            const uint portId(extGraph.midiPorts.getPortId(true, inPort->name));
             CARLA_SAFE_ASSERT_CONTINUE(portId < extGraph.midiPorts.ins.count());
 
             ConnectionToId connectionToId;
@@ -618,15 +626,74 @@ public:
     // -------------------------------------------------------------------
 
 protected:
+    // monotonic, so wall clock adjustments do not disturb MIDI timestamps
+    static int64_t getTimeInMicroseconds() noexcept
+    {
+    #if defined(CARLA_OS_MAC)
+        static const mach_timebase_info_data_t timebase = getMachTimebase();
+
+        // numer/denom converts ticks to nanoseconds
+        return static_cast<int64_t>(mach_absolute_time() * timebase.numer / timebase.denom / 1000);
+    #elif defined(CARLA_OS_WIN)
+        static const int64_t frequency = getPerformanceFrequency();
+
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+
+        // split to avoid overflowing with high counter frequencies
+        return (counter.QuadPart / frequency) * 1000000 + (counter.QuadPart % frequency) * 1000000 / frequency;
+    #else
+        struct timespec ts;
+    # ifdef CLOCK_MONOTONIC_RAW
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    # else
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+    # endif
+
+        return (ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+    #endif
+    }
+
+#if defined(CARLA_OS_MAC)
+    static mach_timebase_info_data_t getMachTimebase() noexcept
+    {
+        mach_timebase_info_data_t timebase;
+
+        if (mach_timebase_info(&timebase) != KERN_SUCCESS || timebase.denom == 0)
+            timebase.numer = timebase.denom = 1;
+
+        return timebase;
+    }
+#elif defined(CARLA_OS_WIN)
+    static int64_t getPerformanceFrequency() noexcept
+    {
+        LARGE_INTEGER frequency;
+
+        // cannot fail on Windows XP and later
+        if (! QueryPerformanceFrequency(&frequency) || frequency.QuadPart <= 0)
+            return 1;
+
+        return frequency.QuadPart;
+    }
+#endif
+
     void handleAudioProcessCallback(void* outputBuffer, void* inputBuffer,
                                     uint nframes, double streamTime, RtAudioStreamStatus status)
     {
         const PendingRtEventsRunner prt(this, nframes, true);
 
-        if (status & RTAUDIO_INPUT_OVERFLOW)
-            ++pData->xruns;
-        if (status & RTAUDIO_OUTPUT_UNDERFLOW)
-            ++pData->xruns;
+        if (status & (RTAUDIO_INPUT_OVERFLOW|RTAUDIO_OUTPUT_UNDERFLOW))
+        {
+            if (status & RTAUDIO_INPUT_OVERFLOW)
+                ++pData->xruns;
+            if (status & RTAUDIO_OUTPUT_UNDERFLOW)
+                ++pData->xruns;
+
+            // callback times jumped, start filtering them again
+            fCallbackTime.reset = true;
+        }
+
+        fCallbackTime.update(getTimeInMicroseconds(), 1000000.0 * nframes / pData->sampleRate);
 
         // get buffers from RtAudio
         const float* const insPtr  = (const float*)inputBuffer;
@@ -672,45 +739,42 @@ protected:
         }
 
         // initialize events
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+        clearEngineEvents(pData->events.in, pData->events.inCount);
+        clearEngineEvents(pData->events.out, pData->events.outCount);
+
+        uint32_t engineEventIndex = 0;
 
-        if (fMidiInEvents.mutex.tryLock())
+        for (uint i=0, count=fMidiInCount; i < count; ++i)
         {
-            uint32_t engineEventIndex = 0;
-            fMidiInEvents.splice();
+            MidiInPort* const inPort(fMidiIns[i]);
+            CARLA_SAFE_ASSERT_CONTINUE(inPort != nullptr);
 
-            for (LinkedList<RtMidiEvent>::Itenerator it = fMidiInEvents.data.begin2(); it.valid(); it.next())
-            {
-                static const RtMidiEvent fallback = { 0, 0, { 0 } };
+            CarlaHeapRingBuffer& ring(inPort->events);
+            RtMidiEvent midiEvent;
 
-                const RtMidiEvent& midiEvent(it.getValue(fallback));
+            while (engineEventIndex < kMaxEngineEventInternalCount && ring.isDataAvailableForReading())
+            {
+                // pairs with the barrier before commitWrite() in handleMidiCallback
+                __sync_synchronize();
+                ring.readCustomType(midiEvent);
                 CARLA_SAFE_ASSERT_CONTINUE(midiEvent.size > 0);
 
-                EngineEvent& engineEvent(pData->events.in[engineEventIndex++]);
+                const uint32_t time = fCallbackTime.getFrameOffset(midiEvent.time, nframes);
 
-                if (midiEvent.time < pData->timeInfo.frame)
-                {
-                    engineEvent.time = 0;
-                }
-                else if (midiEvent.time >= pData->timeInfo.frame + nframes)
-                {
-                    carla_stderr("MIDI Event in the future!, %i vs %i", engineEvent.time, pData->timeInfo.frame);
-                    engineEvent.time = static_cast<uint32_t>(pData->timeInfo.frame) + nframes - 1;
-                }
-                else
-                    engineEvent.time = static_cast<uint32_t>(midiEvent.time - pData->timeInfo.frame);
+                // events of each port are in order, keep them sorted when mixing several ports
+                uint32_t j = engineEventIndex++;
 
-                engineEvent.fillFromMidiData(midiEvent.size, midiEvent.data, 0);
+                for (; j > 0 && pData->events.in[j-1].time > time; --j)
+                    pData->events.in[j] = pData->events.in[j-1];
 
-                if (engineEventIndex >= kMaxEngineEventInternalCount)
-                    break;
+                EngineEvent& engineEvent(pData->events.in[j]);
+                engineEvent.time = time;
+                engineEvent.fillFromMidiData(midiEvent.size, midiEvent.data, 0);
             }
-
-            fMidiInEvents.data.clear();
-            fMidiInEvents.mutex.unlock();
         }
 
+        pData->events.inCount = engineEventIndex;
+
         pData->graph.process(pData, inBuf, outBuf, nframes);
 
         fMidiOutMutex.lock();
@@ -722,13 +786,13 @@ protected:
             uint8_t mdataTmp[EngineMidiEvent::kDataSize];
             const uint8_t* mdataPtr;
 
-            for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+            for (uint32_t i=0; i < pData->events.outCount; ++i)
             {
                 const EngineEvent& engineEvent(pData->events.out[i]);
 
                 /**/ if (engineEvent.type == kEngineEventTypeNull)
                 {
-                    break;
+                    continue;
                 }
                 else if (engineEvent.type == kEngineEventTypeControl)
                 {
@@ -818,28 +882,17 @@ protected:
         bufferSizeChanged(newBufferSize);
     }
 
-    void handleMidiCallback(double timeStamp, std::vector<uchar>* const message)
+    // called from the RtMidi thread of a MIDI input, the only writer of its ring buffer
+    void handleMidiCallback(CarlaHeapRingBuffer& events, std::vector<uchar>* const message)
     {
         const size_t messageSize(message->size());
 
         if (messageSize == 0 || messageSize > EngineMidiEvent::kDataSize)
             return;
 
-        timeStamp /= 2;
-
-        if (timeStamp > 0.95)
-            timeStamp = 0.95;
-        else if (timeStamp < 0.0)
-            timeStamp = 0.0;
-
+        // RtMidi timestamps are deltas between messages, take our own on the same clock as the audio callback
         RtMidiEvent midiEvent;
-        midiEvent.time = pData->timeInfo.frame + uint64_t(timeStamp * (double)pData->bufferSize);
-
-        if (midiEvent.time < fLastEventTime)
-            midiEvent.time = fLastEventTime;
-        else
-            fLastEventTime = midiEvent.time;
-
+        midiEvent.time = getTimeInMicroseconds();
         midiEvent.size = static_cast<uint8_t>(messageSize);
 
         size_t i=0;
@@ -848,7 +901,11 @@ protected:
         for (; i < EngineMidiEvent::kDataSize; ++i)
             midiEvent.data[i] = 0;
 
-        fMidiInEvents.append(midiEvent);
+        events.writeCustomType(midiEvent);
+
+        // make the event data visible before the new write position
+        __sync_synchronize();
+        events.commitWrite();
     }
 
     // -------------------------------------------------------------------
@@ -872,14 +929,45 @@ protected:
             newRtMidiPortName += ":";
             newRtMidiPortName += portName;
 
+            // reuse a free slot, slots are only released when closing the engine
+            MidiInPort* inPort = nullptr;
+            uint slot = 0;
+
+            for (; slot < fMidiInCount; ++slot)
+            {
+                if (fMidiIns[slot] != nullptr && fMidiIns[slot]->port == nullptr)
+                {
+                    inPort = fMidiIns[slot];
+                    break;
+                }
+            }
+
+            if (inPort == nullptr)
+            {
+                CARLA_SAFE_ASSERT_RETURN(fMidiInCount < kMaxMidiIns, false);
+
+                try {
+                    inPort = new MidiInPort();
+                } CARLA_SAFE_EXCEPTION_RETURN("new MidiInPort", false);
+
+                inPort->engine = this;
+                inPort->port = nullptr;
+                inPort->events.createBuffer(kMidiInRingSize * sizeof(RtMidiEvent));
+            }
+
             RtMidiIn* rtMidiIn;
 
             try {
                 rtMidiIn = new RtMidiIn(getMatchedAudioMidiAPI(fAudio.getCurrentApi()), newRtMidiPortName.buffer(), 512);
-            } CARLA_SAFE_EXCEPTION_RETURN("new RtMidiIn", false);
+            } catch(...) {
+                carla_safe_exception("new RtMidiIn", __FILE__, __LINE__);
+                if (slot == fMidiInCount)
+                    delete inPort;
+                return false;
+            }
 
             rtMidiIn->ignoreTypes();
-            rtMidiIn->setCallback(carla_rtmidi_callback, this);
+            rtMidiIn->setCallback(carla_rtmidi_callback, inPort);
 
             bool found = false;
             uint rtMidiPortIndex;
@@ -894,27 +982,37 @@ protected:
                 }
             }
 
+            if (found)
+            {
+                try {
+                    rtMidiIn->openPort(rtMidiPortIndex, portName);
+                }
+                catch(...) {
+                    found = false;
+                };
+            }
+
             if (! found)
             {
                 delete rtMidiIn;
+                if (slot == fMidiInCount)
+                    delete inPort;
                 return false;
             }
 
-            try {
-                rtMidiIn->openPort(rtMidiPortIndex, portName);
-            }
-            catch(...) {
-                delete rtMidiIn;
-                return false;
-            };
+            inPort->port = rtMidiIn;
 
-            MidiInPort midiPort;
-            midiPort.port = rtMidiIn;
+            std::strncpy(inPort->name, portName, STR_MAX);
+            inPort->name[STR_MAX] = '\0';
 
-            std::strncpy(midiPort.name, portName, STR_MAX);
-            midiPort.name[STR_MAX] = '\0';
+            // publish new slots only once they are complete
+            if (slot == fMidiInCount)
+            {
+                fMidiIns[slot] = inPort;
+                __sync_synchronize();
+                ++fMidiInCount;
+            }
 
-            fMidiIns.append(midiPort);
             return true;
         }   break;
 
@@ -987,21 +1085,20 @@ protected:
             return CarlaEngine::disconnectExternalGraphPort(connectionType, portId, portName);
 
         case kExternalGraphConnectionMidiInput:
-            for (LinkedList<MidiInPort>::Itenerator it=fMidiIns.begin2(); it.valid(); it.next())
+            for (uint i=0; i < fMidiInCount; ++i)
             {
-                static MidiInPort fallback = { nullptr, { '\0' } };
-
-                MidiInPort& inPort(it.getValue(fallback));
-                CARLA_SAFE_ASSERT_CONTINUE(inPort.port != nullptr);
+                MidiInPort* const inPort(fMidiIns[i]);
+                CARLA_SAFE_ASSERT_CONTINUE(inPort != nullptr);
 
-                if (std::strncmp(inPort.name, portName, STR_MAX) != 0)
+                if (inPort->port == nullptr || std::strncmp(inPort->name, portName, STR_MAX) != 0)
                     continue;
 
-                inPort.port->cancelCallback();
-                inPort.port->closePort();
-                delete inPort.port;
+                inPort->port->cancelCallback();
+                inPort->port->closePort();
+                delete inPort->port;
 
-                fMidiIns.remove(it);
+                // the audio thread might still be reading the ring buffer, keep the slot around for reuse
+                inPort->port = nullptr;
                 return true;
             }
             break;
@@ -1040,7 +1137,6 @@ private:
     bool fAudioInterleaved;
     uint fAudioInCount;
     uint fAudioOutCount;
-    uint64_t fLastEventTime;
 
     // current device name
     CarlaString fDeviceName;
@@ -1049,63 +1145,101 @@ private:
     float* fAudioIntBufIn;
     float* fAudioIntBufOut;
 
-    struct MidiInPort {
-        RtMidiIn* port;
-        char name[STR_MAX+1];
-    };
-
     struct MidiOutPort {
         RtMidiOut* port;
         char name[STR_MAX+1];
     };
 
     struct RtMidiEvent {
-        uint64_t time; // needs to compare to internal time
-        uint8_t  size;
-        uint8_t  data[EngineMidiEvent::kDataSize];
+        int64_t time; // arrival time, in microseconds
+        uint8_t size;
+        uint8_t data[EngineMidiEvent::kDataSize];
     };
 
-    struct RtMidiEvents {
-        CarlaMutex mutex;
-        RtLinkedList<RtMidiEvent>::Pool dataPool;
-        RtLinkedList<RtMidiEvent> data;
-        RtLinkedList<RtMidiEvent> dataPending;
-
-        RtMidiEvents()
-            : mutex(),
-              dataPool("RtMidiEvents", 512, 512),
-              data(dataPool),
-              dataPending(dataPool) {}
+    // each RtMidi input writes into its own ring buffer, the audio callback is the only reader
+    struct MidiInPort {
+        CarlaEngineRtAudio* engine;
+        RtMidiIn* port; // null while the slot is unused
+        char name[STR_MAX+1];
+        CarlaHeapRingBuffer events;
+    };
 
-        ~RtMidiEvents()
+    // Delay-locked loop filtering the audio callback times, see "Using a DLL to filter time" by Fons Adriaensen.
+    // MIDI events that arrived during the previous cycle are placed at the same relative position of the current one,
+    // which trades jitter for a constant latency of one cycle.
+    struct CallbackTimeFilter {
+        bool reset;
+        double period; // nominal period, in microseconds
+        double prev;   // filtered time of the previous callback
+        double t0;     // filtered time of the current callback
+        double t1;     // predicted time of the next callback
+        double e2;     // filtered period
+        double b, c;   // loop coefficients
+
+        CallbackTimeFilter() noexcept
+            : reset(true),
+              period(0.0),
+              prev(0.0),
+              t0(0.0),
+              t1(0.0),
+              e2(0.0),
+              b(0.0),
+              c(0.0) {}
+
+        void update(const int64_t now, const double newPeriod) noexcept
         {
-            clear();
-        }
+            const double time = static_cast<double>(now);
 
-        void append(const RtMidiEvent& event)
-        {
-            mutex.lock();
-            dataPending.append(event);
-            mutex.unlock();
-        }
+            // start over after buffer size changes or stalls
+            if (carla_isNotEqual(newPeriod, period) || std::abs(time - t1) > newPeriod)
+                reset = true;
 
-        void clear()
-        {
-            mutex.lock();
-            data.clear();
-            dataPending.clear();
-            mutex.unlock();
+            if (reset)
+            {
+                reset  = false;
+                period = newPeriod;
+
+                // 1 Hz bandwidth
+                const double omega = 2.0 * 3.14159265358979323846 * period / 1000000.0;
+                b = std::sqrt(2.0) * omega;
+                c = omega * omega;
+
+                e2   = period;
+                prev = time - period;
+                t0   = time;
+                t1   = time + period;
+                return;
+            }
+
+            const double e = time - t1;
+
+            prev = t0;
+            t0   = t1;
+            t1  += b * e + e2;
+            e2  += c * e;
         }
 
-        void splice()
+        uint32_t getFrameOffset(const int64_t eventTime, const uint32_t frames) const noexcept
         {
-            if (dataPending.count() > 0)
-                dataPending.moveTo(data, true /* append */);
+            const double offset = (static_cast<double>(eventTime) - prev) / (t0 - prev) * frames;
+
+            if (offset <= 0.0)
+                return 0;
+            if (offset >= static_cast<double>(frames - 1))
+                return frames - 1;
+
+            return static_cast<uint32_t>(offset);
         }
     };
 
-    LinkedList<MidiInPort> fMidiIns;
-    RtMidiEvents           fMidiInEvents;
+    CallbackTimeFilter fCallbackTime;
+
+    static const uint kMaxMidiIns = 64;
+    static const uint kMidiInRingSize = 512;
+
+    // slots are only added or reused while running, the audio callback reads up to fMidiInCount
+    MidiInPort* fMidiIns[kMaxMidiIns];
+    volatile uint fMidiInCount;
 
     LinkedList<MidiOutPort> fMidiOuts;
     CarlaMutex              fMidiOutMutex;
@@ -1125,9 +1259,10 @@ private:
         return true;
     }
 
-    static void carla_rtmidi_callback(double timeStamp, std::vector<uchar>* message, void* userData)
+    static void carla_rtmidi_callback(double, std::vector<uchar>* message, void* userData)
     {
-        handlePtr->handleMidiCallback(timeStamp, message);
+        MidiInPort* const inPort((MidiInPort*)userData);
+        inPort->engine->handleMidiCallback(inPort->events, message);
     }
 
     #undef handlePtr
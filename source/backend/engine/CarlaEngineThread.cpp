@@ -96,21 +96,25 @@ void CarlaEngineThread::run() noexcept
                 // -------------------------------------------------------
                 // Update parameter outputs
 
-                for (uint32_t j=0, pcount=plugin->getParameterCount(); j < pcount; ++j)
+                for (uint32_t w=0, wcount=(plugin->getParameterCount()+31)/32; w < wcount; ++w)
                 {
-                    if (! plugin->isParameterOutput(j))
-                        continue;
+                    uint32_t changes = plugin->takeParameterOutputChanges(kParameterOutputConsumerEngineThread, w);
 
-                    value = plugin->getParameterValue(j);
+                    for (; changes != 0; changes &= changes - 1)
+                    {
+                        const uint32_t j = w * 32 + static_cast<uint32_t>(__builtin_ctz(changes));
+
+                        value = plugin->getParameterValue(j);
 
 #if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
-                    // Update OSC engine client
-                    if (oscRegistedForUDP)
-                        engineOsc.sendParameterValue(i, j, value);
+                        // Update OSC engine client
+                        if (oscRegistedForUDP)
+                            engineOsc.sendParameterValue(i, j, value);
 #endif
-                    // Update UI
-                    if (updateUI)
-                        plugin->uiParameterChange(j, value);
+                        // Update UI
+                        if (updateUI)
+                            plugin->uiParameterChange(j, value);
+                    }
                 }
 
                 if (updateUI)
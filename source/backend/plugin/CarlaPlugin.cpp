@@ -260,6 +260,16 @@ bool CarlaPlugin::isParameterOutput(const uint32_t parameterId) const noexcept
     return (pData->param.data[parameterId].type == PARAMETER_OUTPUT);
 }
 
+uint32_t CarlaPlugin::takeParameterOutputChanges(const ParameterOutputConsumer consumer, const uint32_t word) const noexcept
+{
+    return pData->param.takeOutputChanges(consumer, word);
+}
+
+void CarlaPlugin::markParameterOutputsChanged(const ParameterOutputConsumer consumer) const noexcept
+{
+    pData->param.markOutputsChanged(consumer);
+}
+
 const MidiProgramData& CarlaPlugin::getMidiProgramData(const uint32_t index) const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(index < pData->midiprog.count, kMidiProgramDataNull);
@@ -513,7 +523,15 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
     if (callPrepareForSave)
     {
         pData->stateSave.temporary = true;
+
+#ifndef BUILD_BRIDGE
+        // plugins store their state as custom data here, that must not unfreeze them
+        pData->freeze.savingState = true;
+#endif
         prepareForSave(true);
+#ifndef BUILD_BRIDGE
+        pData->freeze.savingState = false;
+#endif
     }
 
     const PluginType pluginType(getType());
@@ -551,6 +569,16 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
     pData->stateSave.ctrlChannel  = pData->ctrlChannel;
 #endif
 
+#ifndef BUILD_BRIDGE
+    if (const char* const frozenFile = getFrozenFilename())
+    {
+        pData->stateSave.frozenFile       = carla_strdup(frozenFile);
+        pData->stateSave.frozenStartFrame = pData->freeze.startFrame;
+        pData->stateSave.frozenEndFrame   = pData->freeze.endFrame;
+        pData->stateSave.frozenChain      = pData->freeze.chain;
+    }
+#endif
+
     if (pData->hints & PLUGIN_IS_BRIDGE)
         waitForBridgeSaveSignal();
 
@@ -954,6 +982,15 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
     setCtrlChannel(stateSave.ctrlChannel, true, true);
     setActive(stateSave.active, true, true);
 
+#ifndef BUILD_BRIDGE
+    // restored last, as setting anything else unfreezes the plugin
+    if (stateSave.frozenFile != nullptr && ! loadFrozenFile(stateSave.frozenFile,
+                                                            stateSave.frozenStartFrame,
+                                                            stateSave.frozenEndFrame,
+                                                            stateSave.frozenChain))
+        carla_stderr("Failed to load frozen file \"%s\", the plugin will be processed instead", stateSave.frozenFile);
+#endif
+
     if (! pData->engine->isLoadingProject())
         pData->engine->callback(true, true, ENGINE_CALLBACK_UPDATE, pData->id, 0, 0, 0, 0.0f, nullptr);
 #endif
@@ -1438,6 +1475,7 @@ void CarlaPlugin::setDryWet(const float value, const bool sendOsc, const bool se
         return;
 
     pData->postProc.dryWet = fixedValue;
+    pData->invalidateFreeze();
 
     pData->engine->callback(sendCallback, sendOsc,
                             ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED,
@@ -1463,6 +1501,7 @@ void CarlaPlugin::setVolume(const float value, const bool sendOsc, const bool se
         return;
 
     pData->postProc.volume = fixedValue;
+    pData->invalidateFreeze();
 
     pData->engine->callback(sendCallback, sendOsc,
                             ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED,
@@ -1488,6 +1527,7 @@ void CarlaPlugin::setBalanceLeft(const float value, const bool sendOsc, const bo
         return;
 
     pData->postProc.balanceLeft = fixedValue;
+    pData->invalidateFreeze();
 
     pData->engine->callback(sendCallback, sendOsc,
                             ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED,
@@ -1513,6 +1553,7 @@ void CarlaPlugin::setBalanceRight(const float value, const bool sendOsc, const b
         return;
 
     pData->postProc.balanceRight = fixedValue;
+    pData->invalidateFreeze();
 
     pData->engine->callback(sendCallback, sendOsc,
                             ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED,
@@ -1538,6 +1579,7 @@ void CarlaPlugin::setPanning(const float value, const bool sendOsc, const bool s
         return;
 
     pData->postProc.panning = fixedValue;
+    pData->invalidateFreeze();
 
     pData->engine->callback(sendCallback, sendOsc,
                             ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED,
@@ -1655,6 +1697,8 @@ void CarlaPlugin::setParameterValue(const uint32_t parameterId, const float valu
     }
     CARLA_SAFE_ASSERT_RETURN(parameterId < pData->param.count,);
 
+    pData->invalidateFreeze();
+
     if (sendGui && (pData->hints & PLUGIN_HAS_CUSTOM_UI) != 0)
         uiParameterChange(parameterId, value);
 
@@ -1722,6 +1766,8 @@ void CarlaPlugin::setParameterMidiChannel(const uint32_t parameterId, const uint
         return;
 
     pData->param.data[parameterId].midiChannel = channel;
+    pData->param.controlOutValues[parameterId] = -1.0f; // resend output value on the new channel
+    pData->midiControlMap.invalidate();
 
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
     pData->engine->callback(sendCallback, sendOsc,
@@ -1774,6 +1820,7 @@ void CarlaPlugin::setParameterMappedControlIndex(const uint32_t parameterId, con
         CARLA_SAFE_ASSERT_RETURN(oldParameterId < static_cast<int32_t>(pData->param.count),);
 
         pData->param.data[oldParameterId].mappedControlIndex = CONTROL_INDEX_NONE;
+        pData->midiControlMap.invalidate();
         pData->engine->callback(true, true,
                                 ENGINE_CALLBACK_PARAMETER_MAPPED_CONTROL_INDEX_CHANGED,
                                 pData->id,
@@ -1815,6 +1862,8 @@ void CarlaPlugin::setParameterMappedControlIndex(const uint32_t parameterId, con
 #endif
 
     paramData.mappedControlIndex = index;
+    pData->param.controlOutValues[parameterId] = -1.0f; // resend output value on the new control
+    pData->midiControlMap.invalidate();
 
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
     if (index == CONTROL_INDEX_MIDI_LEARN)
@@ -1897,6 +1946,8 @@ void CarlaPlugin::setCustomData(const char* const type, const char* const key, c
             return;
     }
 
+    pData->invalidateFreeze();
+
     // Check if we already have this key
     for (LinkedList<CustomData>::Itenerator it = pData->custom.begin2(); it.valid(); it.next())
     {
@@ -1934,6 +1985,7 @@ void CarlaPlugin::setProgram(const int32_t index,
     CARLA_SAFE_ASSERT_RETURN(index >= -1 && index < static_cast<int32_t>(pData->prog.count),);
 
     pData->prog.current = index;
+    pData->invalidateFreeze();
 
     pData->engine->callback(sendCallback, sendOsc,
                             ENGINE_CALLBACK_PROGRAM_CHANGED,
@@ -1966,6 +2018,7 @@ void CarlaPlugin::setMidiProgram(const int32_t index,
     CARLA_SAFE_ASSERT_RETURN(index >= -1 && index < static_cast<int32_t>(pData->midiprog.count),);
 
     pData->midiprog.current = index;
+    pData->invalidateFreeze();
 
     pData->engine->callback(sendCallback, sendOsc,
                             ENGINE_CALLBACK_MIDI_PROGRAM_CHANGED,
@@ -2085,6 +2138,25 @@ void CarlaPlugin::idle()
     if (! pData->enabled)
         return;
 
+    pData->midiControlMap.rebuildIfNeeded(pData->param);
+
+#ifndef BUILD_BRIDGE
+    if (pData->freeze.needsUnfreeze)
+    {
+        // frozen playback was stopped by a state change, see ProtectedData::invalidateFreeze()
+        unfreeze();
+
+        pData->engine->callback(true, true,
+                                ENGINE_CALLBACK_UPDATE,
+                                pData->id,
+                                0, 0, 0, 0.0f, nullptr);
+    }
+    else if (pData->freeze.active || pData->freeze.render != nullptr)
+    {
+        pData->freeze.idle(this);
+    }
+#endif
+
     const bool hasUI(pData->hints & PLUGIN_HAS_CUSTOM_UI);
     const bool needsUiMainThread(pData->hints & PLUGIN_NEEDS_UI_MAIN_THREAD);
     const uint32_t latency(getLatencyInFrames());
@@ -2324,6 +2396,18 @@ void CarlaPlugin::unlock() noexcept
     pData->masterMutex.unlock();
 }
 
+bool CarlaPlugin::hasPendingExternalNotes() const noexcept
+{
+    // someone is adding a note right now
+    if (! pData->extNotes.mutex.tryLock())
+        return true;
+
+    const bool hasNotes = pData->extNotes.data.isNotEmpty();
+    pData->extNotes.mutex.unlock();
+
+    return hasNotes;
+}
+
 // -------------------------------------------------------------------
 // Plugin buffers
 
@@ -2595,6 +2679,7 @@ void CarlaPlugin::checkForMidiLearn(EngineEvent& event) noexcept
     event.ctrl.handled = true;
     paramData.mappedControlIndex = static_cast<int16_t>(event.ctrl.param);
     paramData.midiChannel = event.channel;
+    pData->midiControlMap.invalidate();
 
     pData->postponeMidiLearnRtEvent(true, parameterId, static_cast<uint8_t>(event.ctrl.param), event.channel);
     pData->midiLearnParameterIndex = -1;
@@ -2644,6 +2729,17 @@ void CarlaPlugin::prepareForDeletion() noexcept
 {
     carla_debug("CarlaPlugin::prepareForDeletion");
 
+#ifndef BUILD_BRIDGE
+    // the render thread runs the engine with this plugin in it, and other plugins might be skipped for us
+    pData->freeze.cancelRender();
+
+    if (pData->freeze.chain)
+    {
+        pData->freeze.chain = false;
+        pData->freeze.releaseChain(this);
+    }
+#endif
+
     const CarlaMutexLocker cml(pData->masterMutex);
 
     pData->client->deactivate(true);
@@ -2665,6 +2761,11 @@ CarlaPlugin::ScopedDisabler::ScopedDisabler(CarlaPlugin* const plugin) noexcept
     CARLA_SAFE_ASSERT_RETURN(plugin->pData->client != nullptr,);
     carla_debug("CarlaPlugin::ScopedDisabler(%p)", plugin);
 
+#ifndef BUILD_BRIDGE
+    // do not wait for a whole render, the plugin is about to change anyway
+    plugin->pData->freeze.cancelRender();
+#endif
+
     plugin->pData->masterMutex.lock();
 
     if (plugin->pData->enabled)
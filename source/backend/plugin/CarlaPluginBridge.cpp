@@ -413,11 +413,14 @@ public:
           fSaved(true),
           fTimedOut(false),
           fTimedError(false),
+          fPipelinedProcessPending(false),
           fBufferSize(engine->getBufferSize()),
           fProcWaitTime(0),
           fBridgeBinary(),
           fBridgeThread(engine, this),
           fShmAudioPool(),
+          fShmChunkPool(),
+          fChunkPoolInUse(false),
           fShmRtClientControl(),
           fShmNonRtClientControl(),
           fShmNonRtServerControl(),
@@ -432,6 +435,8 @@ public:
     {
         carla_debug("CarlaPluginBridge::CarlaPluginBridge(%p, %i, %s, %s)", engine, id, BinaryType2Str(btype), PluginType2Str(ptype));
 
+        pData->param.outputTracked = true;
+
         pData->hints |= PLUGIN_IS_BRIDGE;
     }
 
@@ -475,6 +480,7 @@ public:
         fShmNonRtClientControl.clear();
         fShmRtClientControl.clear();
         fShmAudioPool.clear();
+        fShmChunkPool.clear();
 
         clearBuffers();
 
@@ -506,6 +512,10 @@ public:
 
     uint32_t getLatencyInFrames() const noexcept override
     {
+        // pipelined processing delays the output by one extra block
+        if (pData->options & PLUGIN_OPTION_PIPELINED_PROCESSING)
+            return fLatency + fBufferSize;
+
         return fLatency;
     }
 
@@ -547,7 +557,7 @@ public:
 
     uint getOptionsAvailable() const noexcept override
     {
-        return fInfo.optionsAvailable;
+        return fInfo.optionsAvailable | PLUGIN_OPTION_PIPELINED_PROCESSING;
     }
 
     float getParameterValue(const uint32_t parameterId) const noexcept override
@@ -701,11 +711,40 @@ public:
             return carla_stderr("CarlaPluginBridge::waitForSaved() - Timeout while requesting save state");
     }
 
+    bool waitForChunkPoolReleased()
+    {
+        if (! fChunkPoolInUse)
+            return true;
+
+        const uint32_t timeoutEnd = Time::getMillisecondCounter() + 5*1000; // 5 secs
+        const bool needsEngineIdle = pData->engine->getType() != kEngineTypePlugin;
+
+        for (; Time::getMillisecondCounter() < timeoutEnd && fBridgeThread.isThreadRunning();)
+        {
+            pData->engine->callback(true, true, ENGINE_CALLBACK_IDLE, 0, 0, 0, 0, 0.0f, nullptr);
+
+            if (needsEngineIdle)
+                pData->engine->idle();
+
+            if (! fChunkPoolInUse)
+                return true;
+
+            carla_msleep(5);
+        }
+
+        carla_stderr("CarlaPluginBridge::waitForChunkPoolReleased() - Timeout while waiting for bridge");
+        return false;
+    }
+
     // -------------------------------------------------------------------
     // Set data (internal stuff)
 
     void setOption(const uint option, const bool yesNo, const bool sendCallback) override
     {
+        // handled on our side, the bridge does not know about it
+        if (option == PLUGIN_OPTION_PIPELINED_PROCESSING)
+            return CarlaPlugin::setOption(option, yesNo, sendCallback);
+
         {
             const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
 
@@ -956,25 +995,7 @@ public:
         CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
         CARLA_SAFE_ASSERT_RETURN(dataSize > 0,);
 
-        CarlaString dataBase64(CarlaString::asBase64(data, dataSize));
-        CARLA_SAFE_ASSERT_RETURN(dataBase64.length() > 0,);
-
-        String filePath(File::getSpecialLocation(File::tempDirectory).getFullPathName());
-
-        filePath += CARLA_OS_SEP_STR ".CarlaChunk_";
-        filePath += fShmAudioPool.getFilenameSuffix();
-
-        if (File(filePath).replaceWithText(dataBase64.buffer()))
-        {
-            const uint32_t ulength(static_cast<uint32_t>(filePath.length()));
-
-            const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
-
-            fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkDataFile);
-            fShmNonRtClientControl.writeUInt(ulength);
-            fShmNonRtClientControl.writeCustomData(filePath.toRawUTF8(), ulength);
-            fShmNonRtClientControl.commitWrite();
-        }
+        _sendChunkData(data, dataSize);
 
         // save data internally as well
         fInfo.chunk.resize(dataSize);
@@ -1275,6 +1296,8 @@ public:
         if (fInfo.mOuts > 0)
             pData->extraHints |= PLUGIN_EXTRA_HINT_HAS_MIDI_OUT;
 
+        pData->midiControlMap.invalidate();
+
         bufferSizeChanged(pData->engine->getBufferSize());
         reloadPrograms(true);
 
@@ -1309,6 +1332,10 @@ public:
     {
         CARLA_SAFE_ASSERT_RETURN(! fTimedError,);
 
+        // called with the single process lock held, see CarlaPlugin::setActive()
+        bool unused;
+        waitForPipelinedProcess(unused);
+
         {
             const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
 
@@ -1342,6 +1369,49 @@ public:
             return;
         }
 
+        // --------------------------------------------------------------------------------------------------------
+        // Try lock, silence otherwise
+
+#ifndef STOAT_TEST_BUILD
+        if (pData->engine->isOffline())
+        {
+            pData->singleMutex.lock();
+        }
+        else
+#endif
+        if (! pData->singleMutex.tryLock())
+        {
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                carla_zeroFloats(audioOut[i], frames);
+            for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                carla_zeroFloats(cvOut[i], frames);
+            return;
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Collect previous block (pipelined mode)
+
+        // the bridge might still be processing the previous block, it must be done before we send anything new
+        bool hasPipelinedOutput = false;
+
+        if (! waitForPipelinedProcess(hasPipelinedOutput))
+        {
+            pData->singleMutex.unlock();
+
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                carla_zeroFloats(audioOut[i], frames);
+            for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                carla_zeroFloats(cvOut[i], frames);
+            return;
+        }
+
+        const bool pipelined = (pData->options & PLUGIN_OPTION_PIPELINED_PROCESSING) != 0 && frames == fBufferSize;
+
+        // events from the previous block must be read now, the bridge overwrites them while processing the next.
+        // this does not depend on the current option, pipelining might have just been turned off.
+        if (hasPipelinedOutput)
+            processOutputEvents(frames);
+
         // --------------------------------------------------------------------------------------------------------
         // Check if needs reset
 
@@ -1478,16 +1548,9 @@ public:
                         }
 #endif
                         // Control plugin parameters
-                        for (uint32_t k=0; k < pData->param.count; ++k)
+                        for (ProtectedData::MidiControlIterator it(pData, event.channel, ctrlEvent.param); it.valid(); it.next())
                         {
-                            if (pData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (pData->param.data[k].mappedControlIndex != ctrlEvent.param)
-                                continue;
-                            if (pData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((pData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                            const uint32_t k = it.getParameterId();
 
                             ctrlEvent.handled = true;
                             value = pData->param.getFinalUnnormalizedValue(k, ctrlEvent.normalizedValue);
@@ -1639,31 +1702,27 @@ public:
 
         } // End of Event Input
 
-        if (! processSingle(audioIn, audioOut, cvIn, cvOut, frames))
-            return;
+        const bool processed = processSingle(audioIn, audioOut, cvIn, cvOut, frames, pipelined, hasPipelinedOutput);
+
+        pData->singleMutex.unlock();
+
+        if (processed && ! pipelined)
+            processOutputEvents(frames);
+    }
 
+    void processOutputEvents(const uint32_t frames)
+    {
         // --------------------------------------------------------------------------------------------------------
         // Control and MIDI Output
 
         if (pData->event.portOut != nullptr)
         {
-            float value;
-
             for (uint32_t k=0; k < pData->param.count; ++k)
             {
                 if (pData->param.data[k].type != PARAMETER_OUTPUT)
                     continue;
 
-                if (pData->param.data[k].mappedControlIndex > 0)
-                {
-                    value = pData->param.ranges[k].getNormalizedValue(fParams[k].value);
-                    pData->event.portOut->writeControlEvent(0,
-                                                            pData->param.data[k].midiChannel,
-                                                            kEngineControlEventTypeParameter,
-                                                            static_cast<uint16_t>(pData->param.data[k].mappedControlIndex),
-                                                            -1,
-                                                            value);
-                }
+                pData->writeControlOutputRT(k, fParams[k].value, frames);
             }
 
             uint32_t time;
@@ -1701,7 +1760,8 @@ public:
     }
 
     bool processSingle(const float* const* const audioIn, float** const audioOut,
-                       const float* const* const cvIn, float** const cvOut, const uint32_t frames)
+                       const float* const* const cvIn, float** const cvOut, const uint32_t frames,
+                       const bool pipelined, const bool hasPipelinedOutput)
     {
         CARLA_SAFE_ASSERT_RETURN(! fTimedError, false);
         CARLA_SAFE_ASSERT_RETURN(frames > 0, false);
@@ -1724,25 +1784,6 @@ public:
             CARLA_SAFE_ASSERT_RETURN(cvOut != nullptr, false);
         }
 
-        // --------------------------------------------------------------------------------------------------------
-        // Try lock, silence otherwise
-
-#ifndef STOAT_TEST_BUILD
-        if (pData->engine->isOffline())
-        {
-            pData->singleMutex.lock();
-        }
-        else
-#endif
-        if (! pData->singleMutex.tryLock())
-        {
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-                carla_zeroFloats(audioOut[i], frames);
-            for (uint32_t i=0; i < pData->cvOut.count; ++i)
-                carla_zeroFloats(cvOut[i], frames);
-            return false;
-        }
-
         // --------------------------------------------------------------------------------------------------------
         // Reset audio buffers
 
@@ -1785,18 +1826,42 @@ public:
             fShmRtClientControl.commitWrite();
         }
 
-        waitForClient("process", fProcWaitTime);
-
-        if (fTimedOut)
+        if (pipelined)
         {
-            pData->singleMutex.unlock();
-            return false;
+            // the output side of the audio pool still has the previous block, which the bridge only
+            // overwrites after being woken up, so take it now and let the bridge run in the background.
+            if (hasPipelinedOutput)
+            {
+                for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                    carla_copyFloats(audioOut[i], fShmAudioPool.data + ((pData->audioIn.count + i) * fBufferSize), frames);
+                for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                    carla_copyFloats(cvOut[i], fShmAudioPool.data + ((pData->audioIn.count + pData->audioOut.count + pData->cvIn.count + i) * fBufferSize), frames);
+            }
+            else
+            {
+                for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                    carla_zeroFloats(audioOut[i], frames);
+                for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                    carla_zeroFloats(cvOut[i], frames);
+            }
+
+            fShmRtClientControl.wakeUpClient();
+            // the previous block was collected above, under the same lock
+            const bool wasIdle = __sync_bool_compare_and_swap(&fPipelinedProcessPending, false, true);
+            CARLA_SAFE_ASSERT(wasIdle);
         }
+        else
+        {
+            waitForClient("process", fProcWaitTime);
 
-        for (uint32_t i=0; i < pData->audioOut.count; ++i)
-            carla_copyFloats(audioOut[i], fShmAudioPool.data + ((pData->audioIn.count + i) * fBufferSize), frames);
-        for (uint32_t i=0; i < pData->cvOut.count; ++i)
-            carla_copyFloats(cvOut[i], fShmAudioPool.data + ((pData->audioIn.count + pData->audioOut.count + pData->cvIn.count + i) * fBufferSize), frames);
+            if (fTimedOut)
+                return false;
+
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                carla_copyFloats(audioOut[i], fShmAudioPool.data + ((pData->audioIn.count + i) * fBufferSize), frames);
+            for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                carla_copyFloats(cvOut[i], fShmAudioPool.data + ((pData->audioIn.count + pData->audioOut.count + pData->cvIn.count + i) * fBufferSize), frames);
+        }
 
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
         // --------------------------------------------------------------------------------------------------------
@@ -1908,12 +1973,16 @@ public:
 
         // --------------------------------------------------------------------------------------------------------
 
-        pData->singleMutex.unlock();
         return true;
     }
 
     void bufferSizeChanged(const uint32_t newBufferSize) override
     {
+        // keep the audio thread out while talking to the bridge, a pending block must be collected first
+        const ScopedSingleProcessLocker sspl(this, true);
+        bool unused;
+        waitForPipelinedProcess(unused);
+
         fBufferSize = newBufferSize;
         resizeAudioPool(newBufferSize);
 
@@ -1931,6 +2000,11 @@ public:
 
     void sampleRateChanged(const double newSampleRate) override
     {
+        // keep the audio thread out while talking to the bridge, a pending block must be collected first
+        const ScopedSingleProcessLocker sspl(this, true);
+        bool unused;
+        waitForPipelinedProcess(unused);
+
         {
             fShmRtClientControl.writeOpcode(kPluginBridgeRtClientSetSampleRate);
             fShmRtClientControl.writeDouble(newSampleRate);
@@ -1945,6 +2019,11 @@ public:
 
     void offlineModeChanged(const bool isOffline) override
     {
+        // keep the audio thread out while talking to the bridge, a pending block must be collected first
+        const ScopedSingleProcessLocker sspl(this, true);
+        bool unused;
+        waitForPipelinedProcess(unused);
+
         {
             fShmRtClientControl.writeOpcode(kPluginBridgeRtClientSetOnline);
             fShmRtClientControl.writeBool(isOffline);
@@ -2255,6 +2334,7 @@ public:
                     pData->param.data[index].rindex = rindex;
                     pData->param.data[index].hints  = hints;
                     pData->param.data[index].mappedControlIndex = ctrl;
+                    pData->midiControlMap.invalidate();
                 }
             }   break;
 
@@ -2329,6 +2409,9 @@ public:
                     {
                         fParams[index].value = fixedValue;
                         CarlaPlugin::setParameterValue(index, fixedValue, false, true, true);
+
+                        if (pData->param.data[index].type == PARAMETER_OUTPUT)
+                            pData->param.setOutputValueRT(index, fixedValue);
                     }
                 }
             }   break;
@@ -2342,6 +2425,9 @@ public:
                 {
                     const float fixedValue(pData->param.getFixedValue(index, value));
                     fParams[index].value = fixedValue;
+
+                    if (pData->param.data[index].type == PARAMETER_OUTPUT)
+                        pData->param.setOutputValueRT(index, fixedValue);
                 }
             }   break;
 
@@ -2487,12 +2573,50 @@ public:
                 chunkFile.deleteFile();
             }   break;
 
+            case kPluginBridgeNonRtServerSetChunkDataShm: {
+                // ulong/size
+                const uint64_t dataSize = fShmNonRtServerControl.readULong();
+                CARLA_SAFE_ASSERT_BREAK(fShmChunkPool.data != nullptr);
+                CARLA_SAFE_ASSERT_BREAK(dataSize > 0 && dataSize <= fShmChunkPool.dataSize);
+
+                fInfo.chunk.resize(static_cast<std::size_t>(dataSize));
+#ifdef CARLA_PROPER_CPP11_SUPPORT
+                std::memcpy(fInfo.chunk.data(), fShmChunkPool.data, static_cast<std::size_t>(dataSize));
+#else
+                std::memcpy(&fInfo.chunk.front(), fShmChunkPool.data, static_cast<std::size_t>(dataSize));
+#endif
+            }   break;
+
+            case kPluginBridgeNonRtServerResizeChunkPool: {
+                // ulong/size
+                const uint64_t size = fShmNonRtServerControl.readULong();
+                CARLA_SAFE_ASSERT_BREAK(size > 0);
+
+                // bridge falls back to file if pool is still too small
+                const bool resized = _resizeChunkPool(static_cast<std::size_t>(size));
+
+                const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+
+                if (resized)
+                {
+                    fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkPool);
+                    fShmNonRtClientControl.writeULong(static_cast<uint64_t>(fShmChunkPool.dataSize));
+                }
+
+                fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientPrepareForSave);
+                fShmNonRtClientControl.commitWrite();
+            }   break;
+
+            case kPluginBridgeNonRtServerChunkPoolReleased:
+                fChunkPoolInUse = false;
+                break;
+
             case kPluginBridgeNonRtServerSetLatency:
                 // uint
                 fLatency = fShmNonRtServerControl.readUInt();
 #ifndef BUILD_BRIDGE
                 if (! fInitiated)
-                    pData->latency.recreateBuffers(std::max(fInfo.aIns, fInfo.aOuts), fLatency);
+                    pData->latency.recreateBuffers(std::max(fInfo.aIns, fInfo.aOuts), getLatencyInFrames());
 #endif
                 break;
 
@@ -2751,6 +2875,9 @@ public:
             if (isPluginOptionInverseEnabled(options, PLUGIN_OPTION_SKIP_SENDING_NOTES))
                 pData->options |= PLUGIN_OPTION_SKIP_SENDING_NOTES;
 
+        if (isPluginOptionInverseEnabled(options, PLUGIN_OPTION_PIPELINED_PROCESSING))
+            pData->options |= PLUGIN_OPTION_PIPELINED_PROCESSING;
+
         if (fInfo.optionsAvailable & PLUGIN_OPTION_SEND_PROGRAM_CHANGES)
         {
             if (isPluginOptionEnabled(options, PLUGIN_OPTION_SEND_PROGRAM_CHANGES))
@@ -2785,6 +2912,7 @@ private:
     bool fSaved;
     bool fTimedOut;
     bool fTimedError;
+    volatile bool fPipelinedProcessPending;
     uint fBufferSize;
     uint fProcWaitTime;
 
@@ -2792,6 +2920,8 @@ private:
     CarlaPluginBridgeThread fBridgeThread;
 
     BridgeAudioPool          fShmAudioPool;
+    BridgeChunkPool          fShmChunkPool;
+    bool                     fChunkPoolInUse;
     BridgeRtClientControl    fShmRtClientControl;
     BridgeNonRtClientControl fShmNonRtClientControl;
     BridgeNonRtServerControl fShmNonRtServerControl;
@@ -2995,6 +3125,26 @@ private:
         waitForClient("resize-pool", 5000);
     }
 
+    // wait for the block launched by pipelined processing, must be called with the single process lock held.
+    // only one caller can take the pending block, which is reported in wasPending.
+    bool waitForPipelinedProcess(bool& wasPending) noexcept
+    {
+        wasPending = __sync_bool_compare_and_swap(&fPipelinedProcessPending, true, false);
+
+        if (! wasPending)
+            return true;
+
+        CARLA_SAFE_ASSERT_RETURN(! fTimedOut, false);
+        CARLA_SAFE_ASSERT_RETURN(! fTimedError, false);
+
+        if (fShmRtClientControl.waitForClientReply(fProcWaitTime))
+            return true;
+
+        fTimedOut = true;
+        carla_stderr2("waitForClient(process) timed out");
+        return false;
+    }
+
     void waitForClient(const char* const action, const uint msecs)
     {
         CARLA_SAFE_ASSERT_RETURN(! fTimedOut,);
@@ -3013,6 +3163,10 @@ private:
         fInitError  = false;
         fTimedError = false;
 
+        // the new bridge process needs to map the chunk pool again, recreate it when needed
+        fShmChunkPool.clear();
+        fChunkPoolInUse = false;
+
         // reset memory
         fShmRtClientControl.data->procFlags = 0;
         carla_zeroStruct(fShmRtClientControl.data->timeInfo);
@@ -3050,8 +3204,12 @@ private:
 
         fBridgeThread.startThread();
 
-        const bool needsEngineIdle = pData->engine->getType() != kEngineTypePlugin;
+        bool needsEngineIdle = pData->engine->getType() != kEngineTypePlugin;
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+        // when loading a project in parallel, the engine is idled by the thread loading it
+        if (pData->engine->isProjectLoaderThread())
+            needsEngineIdle = false;
+
         const bool needsCancelableAction = ! pData->engine->isLoadingProject();
 
         if (needsCancelableAction)
@@ -3113,30 +3271,88 @@ private:
 #else
             void* data = &fInfo.chunk.front();
 #endif
-            CarlaString dataBase64(CarlaString::asBase64(data, dataSize));
-            CARLA_SAFE_ASSERT_RETURN(dataBase64.length() > 0, true);
+            _sendChunkData(data, dataSize);
+        }
 
-            String filePath(File::getSpecialLocation(File::tempDirectory).getFullPathName());
+        return true;
+    }
 
-            filePath += CARLA_OS_SEP_STR ".CarlaChunk_";
-            filePath += fShmAudioPool.getFilenameSuffix();
+    void _sendChunkData(const void* const data, const std::size_t dataSize)
+    {
+        if (_sendChunkDataUsingPool(data, dataSize))
+            return;
 
-            if (File(filePath).replaceWithText(dataBase64.buffer()))
-            {
-                const uint32_t ulength(static_cast<uint32_t>(filePath.length()));
+        // fallback for old bridges, or if shared memory failed
+        CarlaString dataBase64(CarlaString::asBase64(data, dataSize));
+        CARLA_SAFE_ASSERT_RETURN(dataBase64.length() > 0,);
 
-                const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+        String filePath(File::getSpecialLocation(File::tempDirectory).getFullPathName());
 
-                fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkDataFile);
-                fShmNonRtClientControl.writeUInt(ulength);
-                fShmNonRtClientControl.writeCustomData(filePath.toRawUTF8(), ulength);
-                fShmNonRtClientControl.commitWrite();
-            }
+        filePath += CARLA_OS_SEP_STR ".CarlaChunk_";
+        filePath += fShmAudioPool.getFilenameSuffix();
+
+        if (File(filePath).replaceWithText(dataBase64.buffer()))
+        {
+            const uint32_t ulength(static_cast<uint32_t>(filePath.length()));
+
+            const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+
+            fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkDataFile);
+            fShmNonRtClientControl.writeUInt(ulength);
+            fShmNonRtClientControl.writeCustomData(filePath.toRawUTF8(), ulength);
+            fShmNonRtClientControl.commitWrite();
+        }
+    }
+
+    bool _sendChunkDataUsingPool(const void* const data, const std::size_t dataSize)
+    {
+        // kPluginBridgeNonRtClientSetChunkDataShm was added in API 9
+        if (fBridgeVersion < 9)
+            return false;
+
+        // the bridge might still be reading the previous chunk
+        if (fChunkPoolInUse && ! waitForChunkPoolReleased())
+            return false;
+
+        const std::size_t oldPoolSize = fShmChunkPool.dataSize;
+
+        if (! _resizeChunkPool(dataSize))
+            return false;
+
+        std::memcpy(fShmChunkPool.data, data, dataSize);
+        fChunkPoolInUse = true;
+
+        const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+
+        if (fShmChunkPool.dataSize != oldPoolSize)
+        {
+            fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkPool);
+            fShmNonRtClientControl.writeULong(static_cast<uint64_t>(fShmChunkPool.dataSize));
         }
 
+        fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkDataShm);
+        fShmNonRtClientControl.writeULong(static_cast<uint64_t>(dataSize));
+        fShmNonRtClientControl.commitWrite();
         return true;
     }
 
+    bool _resizeChunkPool(const std::size_t size)
+    {
+        if (! jackbridge_shm_is_valid(fShmChunkPool.shm))
+        {
+            const char* const suffix = fShmAudioPool.getFilenameSuffix();
+            CARLA_SAFE_ASSERT_RETURN(suffix != nullptr, false);
+
+            if (! fShmChunkPool.initializeServer(suffix))
+            {
+                carla_stderr2("CarlaPluginBridge::_resizeChunkPool() - failed to create shared memory");
+                return false;
+            }
+        }
+
+        return fShmChunkPool.resize(size);
+    }
+
     void _setUiTitleFromName()
     {
         CarlaString uiName(pData->name);
@@ -55,6 +55,8 @@ public:
     {
         carla_debug("CarlaPluginFluidSynth::CarlaPluginFluidSynth(%p, %i, %s)", engine, id,  bool2str(use16Outs));
 
+        pData->param.outputTracked = true;
+
         carla_zeroFloats(fParamBuffers, FluidSynthParametersMax);
         carla_fill<int32_t>(fCurMidiProgs, 0, MAX_MIDI_CHANNELS);
 
@@ -970,6 +972,8 @@ public:
         pData->extraHints  = 0x0;
         pData->extraHints |= PLUGIN_EXTRA_HINT_HAS_MIDI_IN;
 
+        pData->midiControlMap.invalidate();
+
         bufferSizeChanged(pData->engine->getBufferSize());
         reloadPrograms(true);
 
@@ -1287,16 +1291,9 @@ public:
                         }
 #endif
                         // Control plugin parameters
-                        for (uint32_t k=0; k < pData->param.count; ++k)
+                        for (ProtectedData::MidiControlIterator it(pData, event.channel, ctrlEvent.param); it.valid(); it.next())
                         {
-                            if (pData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (pData->param.data[k].mappedControlIndex != ctrlEvent.param)
-                                continue;
-                            if (pData->param.data[k].hints != PARAMETER_INPUT)
-                                continue;
-                            if ((pData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                            const uint32_t k = it.getParameterId();
 
                             value = pData->param.getFinalUnnormalizedValue(k, ctrlEvent.normalizedValue);
                             setParameterValueRT(k, value, true);
@@ -1462,7 +1459,6 @@ public:
 
         } // End of Event Input and Processing
 
-#ifndef BUILD_BRIDGE
         // --------------------------------------------------------------------------------------------------------
         // Control Output
 
@@ -1470,20 +1466,12 @@ public:
             uint32_t k = FluidSynthVoiceCount;
             fParamBuffers[k] = float(fluid_synth_get_active_voice_count(fSynth));
             pData->param.ranges[k].fixValue(fParamBuffers[k]);
+            pData->param.setOutputValueRT(k, fParamBuffers[k]);
 
-            if (pData->param.data[k].mappedControlIndex > 0)
-            {
-                float value(pData->param.ranges[k].getNormalizedValue(fParamBuffers[k]));
-                pData->event.portOut->writeControlEvent(0,
-                                                        pData->param.data[k].midiChannel,
-                                                        kEngineControlEventTypeParameter,
-                                                        static_cast<uint16_t>(pData->param.data[k].mappedControlIndex),
-                                                        -1,
-                                                        value);
-            }
-
-        } // End of Control Output
+#ifndef BUILD_BRIDGE
+            pData->writeControlOutputRT(k, fParamBuffers[k], frames);
 #endif
+        } // End of Control Output
     }
 
     bool processSingle(float** const outBuffer, const uint32_t frames, const uint32_t timeOffset)
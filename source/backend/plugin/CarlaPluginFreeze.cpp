@@ -0,0 +1,793 @@
+/*
+ * Carla Plugin Freeze
+ * Copyright (C) 2011-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaPluginInternal.hpp"
+#include "CarlaEngineUtils.hpp"
+
+#include "CarlaAudioFileWriter.hpp"
+#include "CarlaThread.hpp"
+
+#include "native-plugins/audio-base.hpp"
+
+CARLA_BACKEND_START_NAMESPACE
+
+// -----------------------------------------------------------------------
+// Frozen plugins render their output into a file once, and then play that file back in place of processing.
+// Small files are loaded entirely (and shared through the sample cache), bigger ones are streamed from disk.
+
+struct CarlaPlugin::ProtectedData::Freeze::Playback {
+    CarlaString filename;
+    AudioFileReader reader;
+    AudioFilePool pool;
+    uint32_t maxFrame;
+    bool entireFileLoaded;
+    volatile bool needsRead;
+
+    // serializes non-realtime access to the reader, the audio thread only takes pool.mutex
+    CarlaMutex mutex;
+
+    Playback()
+        : filename(),
+          reader(),
+          pool(),
+          maxFrame(0),
+          entireFileLoaded(false),
+          needsRead(false),
+          mutex() {}
+
+    // writes @a frames frames of the file, starting at @a fileFrame, must be called with pool.mutex locked
+    void read(CarlaEngine* const engine, float* const out1, float* const out2,
+              const uint64_t fileFrame, const uint32_t frames) noexcept
+    {
+        if (fileFrame >= maxFrame)
+        {
+            carla_zeroFloats(out1, frames);
+            carla_zeroFloats(out2, frames);
+            return;
+        }
+
+        if (entireFileLoaded)
+        {
+            const uint32_t startFrame = static_cast<uint32_t>(fileFrame);
+            const uint32_t framesToCopy = std::min(frames, maxFrame - startFrame);
+
+            carla_copyFloats(out1, pool.buffer[0] + startFrame, framesToCopy);
+            carla_copyFloats(out2, pool.buffer[1] + startFrame, framesToCopy);
+
+            if (framesToCopy != frames)
+            {
+                carla_zeroFloats(out1 + framesToCopy, frames - framesToCopy);
+                carla_zeroFloats(out2 + framesToCopy, frames - framesToCopy);
+            }
+            return;
+        }
+
+        const bool isOffline = engine->isOffline();
+        bool needsIdleRequest = false;
+        bool ok = false;
+
+        try {
+            ok = reader.tryPutData(pool, out1, out2, fileFrame, frames, false, isOffline, needsIdleRequest);
+
+            // nobody is going to wait for us when rendering, read now
+            if (needsIdleRequest && isOffline)
+            {
+                needsIdleRequest = false;
+                reader.readPoll();
+
+                ok = reader.tryPutData(pool, out1, out2, fileFrame, frames, false, isOffline, needsIdleRequest);
+            }
+        } CARLA_SAFE_EXCEPTION("Freeze::Playback::read");
+
+        if (! ok)
+        {
+            carla_zeroFloats(out1, frames);
+            carla_zeroFloats(out2, frames);
+        }
+
+        if (needsIdleRequest)
+            needsRead = true;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(Playback)
+};
+
+// Renders the plugin output into a file on its own thread, see CarlaPlugin::freeze().
+// The whole engine is processed offline over the frozen range, so the plugin gets its real input,
+// and its output is picked up by capture() as the graph processes it.
+
+class CarlaPlugin::ProtectedData::Freeze::Render : public CarlaThread
+{
+public:
+    Render(CarlaPlugin* const plugin, const char* const filename,
+           const uint64_t startFrame, const uint64_t endFrame, const bool chain) noexcept
+        : CarlaThread("CarlaPluginFreeze"),
+          kPlugin(plugin),
+          kStartFrame(startFrame),
+          kEndFrame(endFrame),
+          kChain(chain),
+          kChannels(plugin->pData->audioOut.count),
+          fFilename(filename),
+          fWriter(),
+          fError(),
+          fCapture(nullptr),
+          fCaptureSize(0),
+          fFramesDone(0),
+          fLastReportedPercent(0),
+          fDone(false) {}
+
+    ~Render() noexcept override
+    {
+        delete[] fCapture;
+    }
+
+    bool open()
+    {
+        CarlaEngine* const engine = kPlugin->pData->engine;
+
+        fCaptureSize = engine->getBufferSize();
+
+        try {
+            fCapture = new float[fCaptureSize * kChannels];
+        } CARLA_SAFE_EXCEPTION_RETURN("Freeze::Render::open", false);
+
+        carla_zeroFloats(fCapture, fCaptureSize * kChannels);
+
+        if (! fWriter.open(fFilename, kChannels, engine->getSampleRate()))
+        {
+            engine->setLastError(fWriter.getLastError());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool isDone() const noexcept
+    {
+        return fDone;
+    }
+
+    bool wasCanceled() const noexcept
+    {
+        return kPlugin->pData->engine->wasActionCanceled();
+    }
+
+    // sends the progress to the host, if it changed since the last time
+    void reportProgress() noexcept
+    {
+        const uint percent = static_cast<uint>(fFramesDone * 100 / (kEndFrame - kStartFrame));
+
+        if (percent == fLastReportedPercent)
+            return;
+
+        fLastReportedPercent = percent;
+
+        char strBuf[STR_MAX+1];
+        std::snprintf(strBuf, STR_MAX, "Freezing plugin (%u%%)", percent);
+        strBuf[STR_MAX] = '\0';
+
+        kPlugin->pData->engine->callback(true, true,
+                                         ENGINE_CALLBACK_CANCELABLE_ACTION,
+                                         kPlugin->pData->id,
+                                         1, 0, 0, 0.0f, strBuf);
+    }
+
+    // keeps the plugin output of the current cycle, called by the engine graph right after processing it
+    void capture(const float* const* const audioOut, const uint32_t frames) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(frames <= fCaptureSize,);
+
+        for (uint32_t i=0; i < kChannels; ++i)
+            carla_copyFloats(fCapture + fCaptureSize * i, audioOut[i], frames);
+    }
+
+    // called on the main thread after the thread has stopped
+    void finish(const bool canceled)
+    {
+        CarlaEngine* const engine = kPlugin->pData->engine;
+        const uint id = kPlugin->pData->id;
+
+        engine->callback(true, true, ENGINE_CALLBACK_CANCELABLE_ACTION, id, 0, 0, 0, 0.0f, "Freezing plugin");
+
+        if (canceled || fError.isNotEmpty())
+        {
+            // incomplete, nobody can use it
+            std::remove(fFilename);
+
+            if (fError.isNotEmpty())
+            {
+                engine->setLastError(fError);
+                engine->callback(true, true, ENGINE_CALLBACK_ERROR, id, 0, 0, 0, 0.0f, fError);
+            }
+            return;
+        }
+
+        if (kPlugin->loadFrozenFile(fFilename, kStartFrame, kEndFrame, kChain))
+            engine->callback(true, true, ENGINE_CALLBACK_UPDATE, id, 0, 0, 0, 0.0f, nullptr);
+        else
+            engine->callback(true, true, ENGINE_CALLBACK_ERROR, id, 0, 0, 0, 0.0f, engine->getLastError());
+    }
+
+protected:
+    void run() override
+    {
+        CarlaEngine* const engine = kPlugin->pData->engine;
+
+        if (! engine->renderOffline(kStartFrame, kEndFrame, _writeCycle, this) &&
+            fError.isEmpty() && ! shouldThreadExit())
+        {
+            fError = engine->getLastError();
+        }
+
+        fWriter.close();
+
+        fDone = true;
+    }
+
+private:
+    CarlaPlugin* const kPlugin;
+    const uint64_t kStartFrame;
+    const uint64_t kEndFrame;
+    const bool kChain;
+    const uint32_t kChannels;
+
+    CarlaString fFilename;
+    CarlaAudioFileWriter fWriter;
+    CarlaString fError;
+
+    float* fCapture;
+    uint32_t fCaptureSize;
+
+    volatile uint64_t fFramesDone;
+    uint fLastReportedPercent;
+    volatile bool fDone;
+
+    // writes what was captured during the last engine cycle, returning false stops rendering
+    bool writeCycle(const uint32_t frames)
+    {
+        if (shouldThreadExit())
+            return false;
+
+        ProtectedData* const pData = kPlugin->pData;
+
+        if (pData->freeze.renderInvalidated)
+        {
+            fError = "Plugin changed while being frozen";
+            return false;
+        }
+
+        if (! pData->active)
+        {
+            fError = "Plugin was deactivated while being frozen";
+            return false;
+        }
+
+        const float* audioOut[2];
+
+        for (uint32_t i=0; i < kChannels; ++i)
+            audioOut[i] = fCapture + fCaptureSize * i;
+
+        if (! fWriter.write(audioOut, frames))
+        {
+            fError = fWriter.getLastError();
+            return false;
+        }
+
+        // cycles where the plugin did not run must not repeat old output
+        carla_zeroFloats(fCapture, fCaptureSize * kChannels);
+
+        fFramesDone = fFramesDone + frames;
+        return true;
+    }
+
+    static bool _writeCycle(void* const ptr, const float* const* const, const uint32_t frames)
+    {
+        return static_cast<Render*>(ptr)->writeCycle(frames);
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Render)
+};
+
+// -----------------------------------------------------------------------
+
+// checks if the engine is playing a cycle that lies completely within a frozen range
+static bool isCycleWithin(const EngineTimeInfo& timeInfo, const uint32_t frames,
+                          const uint64_t startFrame, const uint64_t endFrame) noexcept
+{
+    return timeInfo.playing && timeInfo.frame >= startFrame && timeInfo.frame + frames <= endFrame;
+}
+
+// -----------------------------------------------------------------------
+
+CarlaPlugin::ProtectedData::Freeze::Freeze() noexcept
+    : playback(nullptr),
+      active(false),
+      needsUnfreeze(false),
+      startFrame(0),
+      endFrame(0),
+      chain(false),
+      render(nullptr),
+      renderInvalidated(false),
+      savingState(false),
+      chainOwner(nullptr),
+      inChain(false),
+      chainStartFrame(0),
+      chainEndFrame(0),
+      skipped(false) {}
+
+CarlaPlugin::ProtectedData::Freeze::~Freeze() noexcept
+{
+    CARLA_SAFE_ASSERT(! active);
+    CARLA_SAFE_ASSERT(render == nullptr);
+
+    if (render != nullptr)
+    {
+        // the plugin destructor waited for the render to finish, nothing left to do but join the thread
+        render->stopThread(-1);
+        delete render;
+        render = nullptr;
+    }
+
+    if (playback != nullptr)
+    {
+        try {
+            delete playback;
+        } CARLA_SAFE_EXCEPTION("Freeze::~Freeze");
+
+        playback = nullptr;
+    }
+}
+
+void CarlaPlugin::ProtectedData::Freeze::idle(CarlaPlugin* const plugin) noexcept
+{
+    // plugins can be added, removed or reconnected at any time
+    if (chain)
+        updateChain(plugin);
+
+    if (render != nullptr)
+    {
+        if (render->isDone())
+        {
+            Render* const oldRender = render;
+            render = nullptr;
+
+            oldRender->stopThread(-1);
+
+            try {
+                oldRender->finish(false);
+            } CARLA_SAFE_EXCEPTION("Freeze::idle");
+
+            delete oldRender;
+        }
+        else if (render->wasCanceled())
+        {
+            cancelRender();
+        }
+        else
+        {
+            render->reportProgress();
+        }
+        return;
+    }
+
+    if (playback == nullptr || ! playback->needsRead)
+        return;
+
+    const CarlaMutexLocker cml(playback->mutex);
+
+    playback->needsRead = false;
+
+    try {
+        playback->reader.readPoll();
+    } CARLA_SAFE_EXCEPTION("Freeze::idle");
+}
+
+void CarlaPlugin::ProtectedData::Freeze::cancelRender() noexcept
+{
+    if (render == nullptr)
+        return;
+
+    carla_debug("Freeze::cancelRender()");
+
+    Render* const oldRender = render;
+    render = nullptr;
+
+    oldRender->stopThread(-1);
+
+    try {
+        oldRender->finish(true);
+    } CARLA_SAFE_EXCEPTION("Freeze::cancelRender");
+
+    delete oldRender;
+}
+
+void CarlaPlugin::ProtectedData::Freeze::updateChain(CarlaPlugin* const owner) noexcept
+{
+    CarlaEngine* const engine = owner->pData->engine;
+    const uint count = engine->getCurrentPluginCount();
+
+    bool* upstream;
+
+    try {
+        upstream = new bool[count];
+    } CARLA_SAFE_EXCEPTION_RETURN("Freeze::updateChain",);
+
+    engine->getExclusiveUpstreamPlugins(owner->getId(), upstream);
+
+    for (uint i=0; i < count; ++i)
+    {
+        const CarlaPluginPtr plugin = engine->getPlugin(i);
+
+        if (plugin.get() == nullptr || plugin.get() == owner)
+            continue;
+
+        Freeze& other(plugin->pData->freeze);
+
+        if (upstream[i])
+        {
+            // already ours, or part of another frozen chain
+            if (other.chainOwner != nullptr)
+                continue;
+
+            other.chainStartFrame = startFrame;
+            other.chainEndFrame = endFrame;
+            other.chainOwner = owner;
+            other.inChain = true;
+        }
+        else if (other.chainOwner == owner)
+        {
+            other.inChain = false;
+            other.chainOwner = nullptr;
+        }
+    }
+
+    delete[] upstream;
+}
+
+void CarlaPlugin::ProtectedData::Freeze::releaseChain(CarlaPlugin* const owner) noexcept
+{
+    CarlaEngine* const engine = owner->pData->engine;
+
+    for (uint i=0, count=engine->getCurrentPluginCount(); i < count; ++i)
+    {
+        const CarlaPluginPtr plugin = engine->getPlugin(i);
+
+        if (plugin.get() == nullptr)
+            continue;
+
+        Freeze& other(plugin->pData->freeze);
+
+        if (other.chainOwner != owner)
+            continue;
+
+        other.inChain = false;
+        other.chainOwner = nullptr;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool CarlaPlugin::freeze(const char* const filename, const uint64_t startFrame, const uint64_t endFrame,
+                         const bool withChain)
+{
+    CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+    CARLA_SAFE_ASSERT_RETURN(pData->client != nullptr, false);
+    carla_debug("CarlaPlugin::freeze(\"%s\", " P_UINT64 ", " P_UINT64 ", %s)",
+                filename, startFrame, endFrame, bool2str(withChain));
+
+    CarlaEngine* const engine = pData->engine;
+
+    if (endFrame <= startFrame)
+    {
+        engine->setLastError("Invalid freeze range");
+        return false;
+    }
+
+    if (! engine->supportsOfflineRendering())
+    {
+        engine->setLastError("Freezing needs an engine driver that can render offline");
+        return false;
+    }
+
+    const EngineProcessMode processMode = engine->getProccessMode();
+
+    if (processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK && processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+    {
+        engine->setLastError("Plugins can only be frozen in rack or patchbay processing modes");
+        return false;
+    }
+
+    if (! pData->active)
+    {
+        engine->setLastError("Plugin must be active to be frozen");
+        return false;
+    }
+
+    const uint32_t channels = pData->audioOut.count;
+
+    if (channels != 1 && channels != 2)
+    {
+        engine->setLastError("Only plugins with 1 or 2 audio outputs can be frozen");
+        return false;
+    }
+
+    if (pData->client->getPortCount(kEnginePortTypeCV, true)     != 0 ||
+        pData->client->getPortCount(kEnginePortTypeCV, false)    != 0 ||
+        pData->client->getPortCount(kEnginePortTypeEvent, true)   > 1 ||
+        pData->client->getPortCount(kEnginePortTypeEvent, false)  > 1)
+    {
+        engine->setLastError("Plugins with CV or multiple event ports cannot be frozen");
+        return false;
+    }
+
+    // the file we are about to write might be the one being played back
+    unfreeze();
+
+    ProtectedData::Freeze& freeze(pData->freeze);
+    ProtectedData::Freeze::Render* render;
+
+    try {
+        render = new ProtectedData::Freeze::Render(this, filename, startFrame, endFrame, withChain);
+    } CARLA_SAFE_EXCEPTION_RETURN("CarlaPlugin::freeze", false);
+
+    if (! render->open())
+    {
+        delete render;
+        return false;
+    }
+
+    freeze.renderInvalidated = false;
+    freeze.render = render;
+
+    // changes to the chain while rendering must cancel the render too
+    if (withChain)
+    {
+        freeze.chain = true;
+        freeze.updateChain(this);
+    }
+
+    engine->setActionCanceled(false);
+    engine->callback(true, true, ENGINE_CALLBACK_CANCELABLE_ACTION, pData->id, 1, 0, 0, 0.0f, "Freezing plugin (0%)");
+
+    if (! render->startThread())
+    {
+        freeze.render = nullptr;
+        engine->callback(true, true, ENGINE_CALLBACK_CANCELABLE_ACTION, pData->id, 0, 0, 0, 0.0f, "Freezing plugin");
+        engine->setLastError("Failed to start the freeze thread");
+        delete render;
+        unfreeze();
+        return false;
+    }
+
+    return true;
+}
+
+bool CarlaPlugin::loadFrozenFile(const char* const filename, const uint64_t startFrame, uint64_t endFrame,
+                                 const bool withChain)
+{
+    CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+    carla_debug("CarlaPlugin::loadFrozenFile(\"%s\", " P_UINT64 ", " P_UINT64 ", %s)",
+                filename, startFrame, endFrame, bool2str(withChain));
+
+    unfreeze();
+
+    ProtectedData::Freeze& freeze(pData->freeze);
+
+    if (freeze.playback == nullptr)
+    {
+        try {
+            freeze.playback = new ProtectedData::Freeze::Playback;
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaPlugin::loadFrozenFile", false);
+    }
+
+    ProtectedData::Freeze::Playback& playback(*freeze.playback);
+    const CarlaMutexLocker cml(playback.mutex);
+
+    // the reader wants a preview, which we have no use for
+    float previewData[1];
+
+    if (! playback.reader.loadFilename(filename, static_cast<uint32_t>(pData->engine->getSampleRate()),
+                                       1, previewData))
+    {
+        pData->engine->setLastError("Failed to load frozen audio file");
+        return false;
+    }
+
+    playback.entireFileLoaded = playback.reader.isEntireFileLoaded();
+    playback.maxFrame = playback.reader.getMaxFrame();
+
+    if (playback.entireFileLoaded)
+    {
+        playback.reader.putAndSwapAllData(playback.pool);
+        playback.maxFrame = std::min(playback.maxFrame, playback.pool.numFrames);
+    }
+    else
+    {
+        playback.reader.createSwapablePool(playback.pool);
+        playback.reader.readPoll();
+    }
+
+    // never play past the end of the file, the rest of the range is processed as usual
+    if (endFrame <= startFrame || endFrame - startFrame > playback.maxFrame)
+        endFrame = startFrame + playback.maxFrame;
+
+    playback.filename = filename;
+    playback.needsRead = false;
+    freeze.startFrame = startFrame;
+    freeze.endFrame = endFrame;
+    freeze.chain = withChain;
+    freeze.needsUnfreeze = false;
+    freeze.active = true;
+
+    if (withChain)
+        freeze.updateChain(this);
+
+    return true;
+}
+
+void CarlaPlugin::unfreeze()
+{
+    ProtectedData::Freeze& freeze(pData->freeze);
+
+    freeze.cancelRender();
+    freeze.needsUnfreeze = false;
+
+    if (freeze.chain)
+    {
+        freeze.chain = false;
+        freeze.releaseChain(this);
+    }
+
+    if (freeze.playback == nullptr)
+        return;
+
+    carla_debug("CarlaPlugin::unfreeze()");
+
+    ProtectedData::Freeze::Playback& playback(*freeze.playback);
+    const CarlaMutexLocker cml(playback.mutex);
+
+    {
+        const water::GenericScopedLock<water::SpinLock> gsl(playback.pool.mutex);
+        freeze.active = false;
+    }
+
+    playback.pool.destroy();
+    playback.reader.destroy();
+    playback.filename.clear();
+    playback.maxFrame = 0;
+    playback.entireFileLoaded = false;
+    playback.needsRead = false;
+    freeze.startFrame = 0;
+    freeze.endFrame = 0;
+}
+
+bool CarlaPlugin::isFrozen() const noexcept
+{
+    return pData->freeze.active;
+}
+
+const char* CarlaPlugin::getFrozenFilename() const noexcept
+{
+    const ProtectedData::Freeze& freeze(pData->freeze);
+
+    if (! freeze.active || freeze.playback == nullptr || freeze.playback->filename.isEmpty())
+        return nullptr;
+
+    return freeze.playback->filename.buffer();
+}
+
+bool CarlaPlugin::processFrozen(float* const* const audioOut, const uint32_t frames) noexcept
+{
+    ProtectedData::Freeze& freeze(pData->freeze);
+
+    if (freeze.active || freeze.inChain)
+    {
+        const EngineTimeInfo timeInfo(pData->engine->getTimeInfo());
+
+        // feeding a frozen plugin which does not need us for this cycle, unless we are being rendered ourselves
+        if (freeze.inChain && freeze.render == nullptr &&
+            isCycleWithin(timeInfo, frames, freeze.chainStartFrame, freeze.chainEndFrame))
+        {
+            const CarlaPlugin* const owner = freeze.chainOwner;
+
+            if (owner != nullptr && owner->pData->enabled && owner->pData->active && owner->pData->freeze.active)
+            {
+                for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                    carla_zeroFloats(audioOut[i], frames);
+
+                freeze.skipped = true;
+                return true;
+            }
+        }
+
+        // cycles crossing the range edges are processed, and get their frozen part in postProcessFrozen()
+        if (freeze.active && freeze.playback != nullptr &&
+            isCycleWithin(timeInfo, frames, freeze.startFrame, freeze.endFrame))
+        {
+            ProtectedData::Freeze::Playback& playback(*freeze.playback);
+            const water::GenericScopedLock<water::SpinLock> gsl(playback.pool.mutex);
+
+            // checked again, unfreeze() changes it with the pool locked
+            if (freeze.active && pData->active)
+            {
+                const uint32_t channels = pData->audioOut.count;
+                CARLA_SAFE_ASSERT_RETURN(channels == 1 || channels == 2, false);
+
+                // mono files have both pool buffers pointing to the same data, so writing twice into the 1st output is fine
+                playback.read(pData->engine, audioOut[0], audioOut[channels - 1],
+                              timeInfo.frame - freeze.startFrame, frames);
+
+                freeze.skipped = true;
+                return true;
+            }
+        }
+    }
+
+    // the plugin did not follow the transport while skipped, start again fresh
+    if (freeze.skipped)
+    {
+        freeze.skipped = false;
+        pData->needsReset = true;
+    }
+
+    return false;
+}
+
+void CarlaPlugin::postProcessFrozen(float* const* const audioOut, const uint32_t frames) noexcept
+{
+    ProtectedData::Freeze& freeze(pData->freeze);
+
+    // renders only happen with the engine offline, and only the render thread processes it meanwhile
+    if (freeze.render != nullptr && pData->engine->isOffline())
+    {
+        if (ProtectedData::Freeze::Render* const render = freeze.render)
+            render->capture(audioOut, frames);
+        return;
+    }
+
+    if (! freeze.active || freeze.playback == nullptr)
+        return;
+
+    const EngineTimeInfo timeInfo(pData->engine->getTimeInfo());
+
+    if (! timeInfo.playing)
+        return;
+
+    const uint64_t startFrame = std::max(timeInfo.frame, freeze.startFrame);
+    const uint64_t endFrame = std::min(timeInfo.frame + frames, freeze.endFrame);
+
+    if (startFrame >= endFrame)
+        return;
+
+    ProtectedData::Freeze::Playback& playback(*freeze.playback);
+    const water::GenericScopedLock<water::SpinLock> gsl(playback.pool.mutex);
+
+    if (! freeze.active)
+        return;
+
+    const uint32_t channels = pData->audioOut.count;
+    CARLA_SAFE_ASSERT_RETURN(channels == 1 || channels == 2,);
+
+    const uint32_t offset = static_cast<uint32_t>(startFrame - timeInfo.frame);
+
+    playback.read(pData->engine, audioOut[0] + offset, audioOut[channels - 1] + offset,
+                  startFrame - freeze.startFrame, static_cast<uint32_t>(endFrame - startFrame));
+}
+
+// -----------------------------------------------------------------------
+
+CARLA_BACKEND_END_NAMESPACE
@@ -198,7 +198,14 @@ PluginParameterData::PluginParameterData() noexcept
     : count(0),
       data(nullptr),
       ranges(nullptr),
-      special(nullptr) {}
+      special(nullptr),
+      outputTracked(false),
+      outputValues(nullptr),
+      controlOutValues(nullptr),
+      controlOutHolds(nullptr)
+{
+    carla_zeroPointers(outputChanges, kParameterOutputConsumerCount);
+}
 
 PluginParameterData::~PluginParameterData() noexcept
 {
@@ -206,6 +213,9 @@ PluginParameterData::~PluginParameterData() noexcept
     CARLA_SAFE_ASSERT(data == nullptr);
     CARLA_SAFE_ASSERT(ranges == nullptr);
     CARLA_SAFE_ASSERT(special == nullptr);
+    CARLA_SAFE_ASSERT(outputValues == nullptr);
+    CARLA_SAFE_ASSERT(controlOutValues == nullptr);
+    CARLA_SAFE_ASSERT(controlOutHolds == nullptr);
 }
 
 void PluginParameterData::createNew(const uint32_t newCount, const bool withSpecial)
@@ -237,6 +247,24 @@ void PluginParameterData::createNew(const uint32_t newCount, const bool withSpec
         carla_zeroStructs(special, newCount);
     }
 
+    outputValues = new float[newCount];
+    carla_zeroFloats(outputValues, newCount);
+
+    // start with everything pending, so consumers get the initial values
+    const uint32_t wordCount = (newCount + 31) / 32;
+
+    for (uint c=0; c < kParameterOutputConsumerCount; ++c)
+    {
+        outputChanges[c] = new uint32_t[wordCount];
+        carla_fill<uint32_t>(outputChanges[c], 0xffffffff, wordCount);
+    }
+
+    controlOutValues = new float[newCount];
+    carla_fill<float>(controlOutValues, -1.0f, newCount);
+
+    controlOutHolds = new uint32_t[newCount];
+    carla_zeroStructs(controlOutHolds, newCount);
+
     count = newCount;
 }
 
@@ -260,9 +288,93 @@ void PluginParameterData::clear() noexcept
         special = nullptr;
     }
 
+    if (outputValues != nullptr)
+    {
+        delete[] outputValues;
+        outputValues = nullptr;
+    }
+
+    for (uint c=0; c < kParameterOutputConsumerCount; ++c)
+    {
+        if (outputChanges[c] != nullptr)
+        {
+            delete[] outputChanges[c];
+            outputChanges[c] = nullptr;
+        }
+    }
+
+    if (controlOutValues != nullptr)
+    {
+        delete[] controlOutValues;
+        controlOutValues = nullptr;
+    }
+
+    if (controlOutHolds != nullptr)
+    {
+        delete[] controlOutHolds;
+        controlOutHolds = nullptr;
+    }
+
     count = 0;
 }
 
+void PluginParameterData::setOutputValueRT(const uint32_t parameterId, const float value) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(parameterId < count,);
+
+    if (carla_isEqual(outputValues[parameterId], value))
+        return;
+
+    outputValues[parameterId] = value;
+
+    const uint32_t word = parameterId / 32;
+    const uint32_t bit  = 1U << (parameterId % 32);
+
+    for (uint c=0; c < kParameterOutputConsumerCount; ++c)
+        __sync_fetch_and_or(&outputChanges[c][word], bit);
+}
+
+uint32_t PluginParameterData::takeOutputChanges(const ParameterOutputConsumer consumer, const uint32_t word) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(consumer < kParameterOutputConsumerCount, 0x0);
+    CARLA_SAFE_ASSERT_RETURN(word < (count + 31) / 32, 0x0);
+
+    uint32_t changes;
+
+    if (outputTracked)
+    {
+        changes = __sync_fetch_and_and(&outputChanges[consumer][word], 0x0);
+    }
+    else
+    {
+        // not tracked by the plugin, report all output parameters
+        changes = 0xffffffff;
+    }
+
+    // only report output parameters, and nothing past the end
+    for (uint32_t bits = changes, i; bits != 0; bits &= bits - 1)
+    {
+        i = word * 32 + static_cast<uint32_t>(__builtin_ctz(bits));
+
+        if (i >= count || data[i].type != PARAMETER_OUTPUT)
+            changes &= ~(1U << (i % 32));
+    }
+
+    return changes;
+}
+
+void PluginParameterData::markOutputsChanged(const ParameterOutputConsumer consumer) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(consumer < kParameterOutputConsumerCount,);
+
+    if (! outputTracked)
+        return;
+
+    // takeOutputChanges() filters out non-output parameters
+    for (uint32_t w=0, wcount=(count+31)/32; w < wcount; ++w)
+        __sync_fetch_and_or(&outputChanges[consumer][w], 0xffffffff);
+}
+
 float PluginParameterData::getFixedValue(const uint32_t parameterId, float value) const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(parameterId < count, 0.0f);
@@ -700,6 +812,241 @@ void CarlaPlugin::ProtectedData::PostUiEvents::clear() noexcept
     mutex.unlock();
 }
 
+// -----------------------------------------------------------------------
+// ProtectedData::MidiControlMap
+
+static const uint32_t kMidiControlMapSlots = MAX_MIDI_CHANNELS * MAX_MIDI_VALUE;
+
+CarlaPlugin::ProtectedData::MidiControlMap::Table::Table() noexcept
+    : serial(0),
+      paramData(nullptr),
+      paramCount(0),
+      offsets(nullptr),
+      params(nullptr),
+      next(nullptr) {}
+
+CarlaPlugin::ProtectedData::MidiControlMap::Table::~Table() noexcept
+{
+    delete[] offsets;
+    delete[] params;
+}
+
+CarlaPlugin::ProtectedData::MidiControlMap::MidiControlMap() noexcept
+    : serial(0),
+      current(nullptr),
+      pending(nullptr),
+      retired(nullptr),
+      mutex(),
+      builtData(nullptr),
+      builtCount(0),
+      builtSerial(0) {}
+
+CarlaPlugin::ProtectedData::MidiControlMap::~MidiControlMap() noexcept
+{
+    clear();
+}
+
+void CarlaPlugin::ProtectedData::MidiControlMap::invalidate() noexcept
+{
+    __sync_fetch_and_add(&serial, 1);
+}
+
+void CarlaPlugin::ProtectedData::MidiControlMap::rebuildIfNeeded(const PluginParameterData& param) noexcept
+{
+    const CarlaMutexLocker cml(mutex);
+
+    deleteRetired();
+
+    const uint32_t newSerial = __sync_fetch_and_add(&serial, 0);
+
+    if (builtSerial == newSerial && builtData == param.data && builtCount == param.count)
+        return;
+
+    Table* const table = new(std::nothrow) Table();
+    CARLA_SAFE_ASSERT_RETURN(table != nullptr,);
+
+    table->serial = newSerial;
+    table->paramData = param.data;
+    table->paramCount = param.count;
+
+    uint32_t numMapped = 0, slot;
+
+    for (uint32_t i=0; i < param.count; ++i)
+    {
+        if (getSlot(param.data[i], slot))
+            ++numMapped;
+    }
+
+    if (numMapped != 0)
+    {
+        table->offsets = new(std::nothrow) uint32_t[kMidiControlMapSlots + 1];
+        table->params  = new(std::nothrow) uint32_t[numMapped];
+
+        if (table->offsets == nullptr || table->params == nullptr)
+        {
+            carla_safe_assert("table->offsets != nullptr && table->params != nullptr", __FILE__, __LINE__);
+            delete table;
+            return;
+        }
+
+        // count per slot and turn that into each slot end, then fill backwards so every slot ends up at its start
+        carla_zeroStructs(table->offsets, kMidiControlMapSlots + 1);
+
+        for (uint32_t i=0; i < param.count; ++i)
+        {
+            if (getSlot(param.data[i], slot))
+                ++table->offsets[slot];
+        }
+
+        for (uint32_t i=1; i < kMidiControlMapSlots; ++i)
+            table->offsets[i] += table->offsets[i-1];
+
+        table->offsets[kMidiControlMapSlots] = numMapped;
+
+        for (uint32_t i=param.count; i-- != 0;)
+        {
+            if (getSlot(param.data[i], slot))
+                table->params[--table->offsets[slot]] = i;
+        }
+    }
+
+    builtSerial = newSerial;
+    builtData   = param.data;
+    builtCount  = param.count;
+
+    // never taken by the audio thread, so safe to delete right away
+    delete exchange(pending, table);
+}
+
+void CarlaPlugin::ProtectedData::MidiControlMap::clear() noexcept
+{
+    const CarlaMutexLocker cml(mutex);
+
+    delete current;
+    current = nullptr;
+
+    delete exchange(pending, nullptr);
+    deleteRetired();
+
+    builtData  = nullptr;
+    builtCount = 0;
+}
+
+const CarlaPlugin::ProtectedData::MidiControlMap::Table*
+CarlaPlugin::ProtectedData::MidiControlMap::getTableRT(const PluginParameterData& param) noexcept
+{
+    if (pending != nullptr)
+    {
+        if (Table* const table = exchange(pending, nullptr))
+        {
+            if (Table* const old = current)
+            {
+                for (;;)
+                {
+                    old->next = retired;
+
+                    if (__sync_bool_compare_and_swap(&retired, old->next, old))
+                        break;
+                }
+            }
+
+            current = table;
+        }
+    }
+
+    if (current == nullptr)
+        return nullptr;
+    if (current->serial != serial || current->paramData != param.data || current->paramCount != param.count)
+        return nullptr;
+
+    return current;
+}
+
+bool CarlaPlugin::ProtectedData::MidiControlMap::getSlot(const ParameterData& paramData, uint32_t& slot) noexcept
+{
+    if (paramData.midiChannel >= MAX_MIDI_CHANNELS)
+        return false;
+    if (paramData.mappedControlIndex < 0 || paramData.mappedControlIndex >= MAX_MIDI_VALUE)
+        return false;
+    if (! isMapped(paramData, paramData.midiChannel, static_cast<uint16_t>(paramData.mappedControlIndex)))
+        return false;
+
+    slot = paramData.midiChannel * MAX_MIDI_VALUE + static_cast<uint32_t>(paramData.mappedControlIndex);
+    return true;
+}
+
+CarlaPlugin::ProtectedData::MidiControlMap::Table*
+CarlaPlugin::ProtectedData::MidiControlMap::exchange(Table* volatile& slot, Table* const table) noexcept
+{
+    for (;;)
+    {
+        Table* const old = slot;
+
+        if (__sync_bool_compare_and_swap(&slot, old, table))
+            return old;
+    }
+}
+
+void CarlaPlugin::ProtectedData::MidiControlMap::deleteRetired() noexcept
+{
+    for (Table* table = exchange(retired, nullptr); table != nullptr;)
+    {
+        Table* const next = table->next;
+        delete table;
+        table = next;
+    }
+}
+
+// -----------------------------------------------------------------------
+// ProtectedData::MidiControlIterator
+
+CarlaPlugin::ProtectedData::MidiControlIterator::MidiControlIterator(ProtectedData* const pData,
+                                                                     const uint8_t channel,
+                                                                     const uint16_t control) noexcept
+    : fParam(pData->param),
+      fChannel(channel),
+      fControl(control),
+      fParams(nullptr),
+      fIndex(0),
+      fCount(0)
+{
+    const MidiControlMap::Table* const table = (channel < MAX_MIDI_CHANNELS && control < MAX_MIDI_VALUE)
+                                             ? pData->midiControlMap.getTableRT(fParam)
+                                             : nullptr;
+
+    if (table != nullptr)
+    {
+        if (table->offsets == nullptr)
+            return;
+
+        const uint32_t slot = channel * MAX_MIDI_VALUE + control;
+
+        fParams = table->params + table->offsets[slot];
+        fCount  = table->offsets[slot + 1] - table->offsets[slot];
+        return;
+    }
+
+    fCount = fParam.count;
+    skipUnmapped();
+}
+
+void CarlaPlugin::ProtectedData::MidiControlIterator::next() noexcept
+{
+    ++fIndex;
+
+    if (fParams == nullptr)
+        skipUnmapped();
+}
+
+void CarlaPlugin::ProtectedData::MidiControlIterator::skipUnmapped() noexcept
+{
+    for (; fIndex < fCount; ++fIndex)
+    {
+        if (MidiControlMap::isMapped(fParam.data[fIndex], fChannel, fControl))
+            break;
+    }
+}
+
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
 // -----------------------------------------------------------------------
 // ProtectedData::PostProc
@@ -754,9 +1101,13 @@ CarlaPlugin::ProtectedData::ProtectedData(CarlaEngine* const eng, const uint idx
       extNotes(),
       latency(),
       postRtEvents(),
-      postUiEvents()
+      postUiEvents(),
+      midiControlMap()
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
     , postProc()
+#endif
+#ifndef BUILD_BRIDGE
+    , freeze()
 #endif
       {}
 
@@ -942,6 +1293,131 @@ void CarlaPlugin::ProtectedData::postponeMidiLearnRtEvent(const bool sendCallbac
     postRtEvents.appendRT(rtEvent);
 }
 
+// -----------------------------------------------------------------------
+// Control output
+
+void CarlaPlugin::ProtectedData::writeControlOutputRT(const uint32_t parameterId,
+                                                      const float value,
+                                                      const uint32_t frames) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(parameterId < param.count,);
+
+    const ParameterData& paramData(param.data[parameterId]);
+
+    if (paramData.mappedControlIndex <= 0 || event.portOut == nullptr)
+        return;
+
+    uint32_t& hold(param.controlOutHolds[parameterId]);
+    hold = hold > frames ? hold - frames : 0;
+
+    const float normalizedValue = param.ranges[parameterId].getNormalizedValue(value);
+    const float lastValue = param.controlOutValues[parameterId];
+    const EngineOptions& options(engine->getOptions());
+
+    if (lastValue >= 0.0f)
+    {
+        if (carla_isEqual(normalizedValue, lastValue))
+            return;
+
+        // not sent now, but still different from the last sent value when the hold expires
+        if (hold != 0)
+            return;
+
+        // always let the range ends through, so the receiver does not get stuck near them
+        if (options.controlOutputThreshold != 0 && normalizedValue > 0.0f && normalizedValue < 1.0f
+            && std::abs(normalizedValue - lastValue) * 1000.0f < static_cast<float>(options.controlOutputThreshold))
+            return;
+    }
+
+    event.portOut->writeControlEvent(0,
+                                     paramData.midiChannel,
+                                     kEngineControlEventTypeParameter,
+                                     static_cast<uint16_t>(paramData.mappedControlIndex),
+                                     -1,
+                                     normalizedValue);
+
+    param.controlOutValues[parameterId] = normalizedValue;
+
+    if (options.controlOutputRateLimit != 0)
+        hold = static_cast<uint32_t>(engine->getSampleRate() * options.controlOutputRateLimit / 1000.0);
+}
+
+// -----------------------------------------------------------------------
+// Direct audio processing
+
+bool CarlaPlugin::ProtectedData::canProcessAudioDirectly(const float* const* const inBuffers,
+                                                         float* const* const outBuffers,
+                                                         const uint32_t timeOffset,
+                                                         const bool canProcessInPlace) const noexcept
+{
+    if (timeOffset != 0 || latency.frames != 0)
+        return false;
+
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+    // dry/wet needs the input as it was before running the plugin
+    if ((hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(postProc.dryWet, 1.0f))
+        return false;
+#endif
+
+    for (uint32_t i=0; i < audioOut.count; ++i)
+    {
+        for (uint32_t j=0; j < i; ++j)
+        {
+            if (outBuffers[i] == outBuffers[j])
+                return false;
+        }
+
+        if (canProcessInPlace)
+            continue;
+
+        for (uint32_t j=0; j < audioIn.count; ++j)
+        {
+            if (outBuffers[i] == inBuffers[j])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void CarlaPlugin::ProtectedData::postProcessAudioInPlace(float* const* const outBuffers,
+                                                         const uint32_t frames) const noexcept
+{
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+    if ((hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(postProc.balanceLeft, -1.0f) &&
+                                                carla_isEqual(postProc.balanceRight, 1.0f)))
+    {
+        const float balRangeL = (postProc.balanceLeft  + 1.0f)/2.0f;
+        const float balRangeR = (postProc.balanceRight + 1.0f)/2.0f;
+
+        for (uint32_t i=0; i+1 < audioOut.count; i += 2)
+        {
+            float* const bufLeft  = outBuffers[i];
+            float* const bufRight = outBuffers[i+1];
+
+            for (uint32_t k=0; k < frames; ++k)
+            {
+                const float left  = bufLeft[k];
+                const float right = bufRight[k];
+
+                bufLeft[k]  = left * (1.0f - balRangeL) + right * (1.0f - balRangeR);
+                bufRight[k] = right * balRangeR + left * balRangeL;
+            }
+        }
+    }
+
+    if (carla_isNotEqual(postProc.volume, 1.0f))
+    {
+        for (uint32_t i=0; i < audioOut.count; ++i)
+            carla_multiply(outBuffers[i], postProc.volume, frames);
+    }
+#else
+    // unused
+    (void)outBuffers;
+    (void)frames;
+#endif
+}
+
 // -----------------------------------------------------------------------
 // Library functions
 
@@ -19,6 +19,7 @@
 #define CARLA_PLUGIN_INTERNAL_HPP_INCLUDED
 
 #include "CarlaPlugin.hpp"
+#include "CarlaEngine.hpp"
 
 #include "CarlaJuceUtils.hpp"
 #include "CarlaLibUtils.hpp"
@@ -191,10 +192,22 @@ struct PluginParameterData {
     ParameterRanges* ranges;
     SpecialParameterType* special;
 
+    // output parameter change tracking, bits are set by the RT side and taken by idle consumers
+    bool outputTracked;
+    float* outputValues;
+    uint32_t* outputChanges[kParameterOutputConsumerCount];
+
+    // mapped output parameters, last normalized value sent as control event (negative if none) and frames until the next
+    float* controlOutValues;
+    uint32_t* controlOutHolds;
+
     PluginParameterData() noexcept;
     ~PluginParameterData() noexcept;
     void createNew(uint32_t newCount, bool withSpecial);
     void clear() noexcept;
+    void setOutputValueRT(uint32_t parameterId, float value) noexcept;
+    uint32_t takeOutputChanges(ParameterOutputConsumer consumer, uint32_t word) noexcept;
+    void markOutputsChanged(ParameterOutputConsumer consumer) noexcept;
     float getFixedValue(uint32_t parameterId, float value) const noexcept;
     float getFinalUnnormalizedValue(uint32_t parameterId, float normalizedValue) const noexcept;
     float getFinalValueWithMidiDelta(uint32_t parameterId, float value, int8_t delta) const noexcept;
@@ -385,6 +398,87 @@ struct CarlaPlugin::ProtectedData {
 
     } postUiEvents;
 
+    // (channel, MIDI control) -> automable input parameters, built off the audio thread.
+    // Writers bump the serial after changing a parameter mapping, tables built from an older serial are not used.
+    struct MidiControlMap {
+        struct Table {
+            uint32_t serial;
+            const ParameterData* paramData;
+            uint32_t paramCount;
+            uint32_t* offsets; // MAX_MIDI_CHANNELS*MAX_MIDI_VALUE+1 entries, null if nothing is mapped
+            uint32_t* params;
+            Table* next;
+
+            Table() noexcept;
+            ~Table() noexcept;
+
+            CARLA_DECLARE_NON_COPY_STRUCT(Table)
+        };
+
+        volatile uint32_t serial;
+        Table* current; // audio thread only
+        Table* volatile pending;
+        Table* volatile retired;
+        CarlaMutex mutex;
+
+        MidiControlMap() noexcept;
+        ~MidiControlMap() noexcept;
+        void invalidate() noexcept;
+        void rebuildIfNeeded(const PluginParameterData& param) noexcept;
+        void clear() noexcept;
+        const Table* getTableRT(const PluginParameterData& param) noexcept;
+
+        static inline bool isMapped(const ParameterData& paramData, const uint8_t channel, const uint16_t control) noexcept
+        {
+            return paramData.midiChannel == channel
+                && paramData.mappedControlIndex == control
+                && paramData.type == PARAMETER_INPUT
+                && (paramData.hints & PARAMETER_IS_AUTOMABLE) != 0x0;
+        }
+
+    private:
+        const ParameterData* builtData;
+        uint32_t builtCount;
+        uint32_t builtSerial;
+
+        static bool getSlot(const ParameterData& paramData, uint32_t& slot) noexcept;
+        static Table* exchange(Table* volatile& slot, Table* table) noexcept;
+        void deleteRetired() noexcept;
+
+        CARLA_DECLARE_NON_COPY_STRUCT(MidiControlMap)
+
+    } midiControlMap;
+
+    // Iterates the parameters controlled by a MIDI CC, for use in process().
+    // Uses the control map when it is up to date, otherwise scans all parameters.
+    class MidiControlIterator {
+    public:
+        MidiControlIterator(ProtectedData* pData, uint8_t channel, uint16_t control) noexcept;
+
+        inline bool valid() const noexcept
+        {
+            return fIndex < fCount;
+        }
+
+        inline uint32_t getParameterId() const noexcept
+        {
+            return fParams != nullptr ? fParams[fIndex] : fIndex;
+        }
+
+        void next() noexcept;
+
+    private:
+        const PluginParameterData& fParam;
+        const uint8_t fChannel;
+        const uint16_t fControl;
+        const uint32_t* fParams;
+        uint32_t fIndex, fCount;
+
+        void skipUnmapped() noexcept;
+
+        CARLA_DECLARE_NON_COPY_CLASS(MidiControlIterator)
+    };
+
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
     struct PostProc {
         float dryWet;
@@ -400,6 +494,57 @@ struct CarlaPlugin::ProtectedData {
     } postProc;
 #endif
 
+#ifndef BUILD_BRIDGE
+    // see CarlaPluginFreeze.cpp
+    struct Freeze {
+        struct Playback;
+        Playback* playback; // created on first use, kept until the plugin is deleted
+
+        volatile bool active;        // playback replaces processing within the frozen range
+        volatile bool needsUnfreeze; // playback was stopped, its data is released on idle
+
+        // transport range the file was rendered from, its first frame plays at startFrame
+        uint64_t startFrame;
+        uint64_t endFrame;
+
+        // plugins only feeding into this one are skipped while it plays back, see updateChain()
+        bool chain;
+
+        struct Render;
+        Render* render; // worker thread started by freeze(), finished on idle
+
+        volatile bool renderInvalidated; // the plugin state changed while rendering
+        bool savingState; // state changes are only the plugin storing its state, see getStateSave()
+
+        // set on plugins feeding a frozen chain, these skip processing while the owner plays back its range
+        CarlaPlugin* chainOwner;
+        volatile bool inChain;
+        uint64_t chainStartFrame;
+        uint64_t chainEndFrame;
+
+        bool skipped; // the last cycle was not processed, so the plugin needs a reset before processing again
+
+        Freeze() noexcept;
+        ~Freeze() noexcept;
+
+        // reports render progress and loads the file once rendered,
+        // or reads more of the file from disk if needed, called on idle while active or rendering
+        void idle(CarlaPlugin* plugin) noexcept;
+
+        // stops a render in progress and throws its file away
+        void cancelRender() noexcept;
+
+        // finds the plugins only feeding into @a owner and marks them as part of its chain
+        void updateChain(CarlaPlugin* owner) noexcept;
+
+        // stops skipping the plugins in the chain of @a owner
+        void releaseChain(CarlaPlugin* owner) noexcept;
+
+        CARLA_DECLARE_NON_COPY_STRUCT(Freeze)
+
+    } freeze;
+#endif
+
     ProtectedData(CarlaEngine* engine, uint idx) noexcept;
     ~ProtectedData() noexcept;
 
@@ -419,6 +564,48 @@ struct CarlaPlugin::ProtectedData {
     void postponeNoteOffRtEvent(bool sendCallbackLater, uint8_t channel, uint8_t note) noexcept;
     void postponeMidiLearnRtEvent(bool sendCallbackLater, uint32_t parameter, uint8_t cc, uint8_t channel) noexcept;
 
+    // -------------------------------------------------------------------
+    // Control output
+
+    void writeControlOutputRT(uint32_t parameterId, float value, uint32_t frames) noexcept;
+
+    // -------------------------------------------------------------------
+    // Freeze
+
+    // stop frozen playback after a state change, safe to call from any thread
+    void invalidateFreeze() noexcept
+    {
+#ifndef BUILD_BRIDGE
+        if (freeze.savingState)
+            return;
+
+        if (freeze.render != nullptr)
+            freeze.renderInvalidated = true;
+
+        // the owner was rendered with our current state
+        if (freeze.chainOwner != nullptr)
+            freeze.chainOwner->pData->invalidateFreeze();
+
+        if (! freeze.active)
+            return;
+
+        freeze.active = false;
+        freeze.needsUnfreeze = true;
+#endif
+    }
+
+    // -------------------------------------------------------------------
+    // Direct audio processing
+
+    // Checks if processSingle() can connect the plugin straight to the engine buffers, skipping its private ones.
+    // Needs no time offset, latency or dry/wet, and outputs that do not alias each other or, unless
+    // @a canProcessInPlace, the inputs.
+    bool canProcessAudioDirectly(const float* const* inBuffers, float* const* outBuffers,
+                                 uint32_t timeOffset, bool canProcessInPlace) const noexcept;
+
+    // Applies balance and volume to the engine buffers after a direct run.
+    void postProcessAudioInPlace(float* const* outBuffers, uint32_t frames) const noexcept;
+
     // -------------------------------------------------------------------
     // Library functions
 
@@ -1533,6 +1533,13 @@ public:
             case kPluginBridgeNonRtServerMidiProgramData:
             case kPluginBridgeNonRtServerSetCustomData:
             case kPluginBridgeNonRtServerVersion:
+            case kPluginBridgeNonRtServerChunkPoolReleased:
+                break;
+
+            case kPluginBridgeNonRtServerSetChunkDataShm:
+            case kPluginBridgeNonRtServerResizeChunkPool:
+                // ulong/size
+                fShmNonRtServerControl.readULong();
                 break;
 
             case kPluginBridgeNonRtServerSetChunkDataFile:
@@ -876,6 +876,8 @@ public:
                                         pData->engine->getSampleRate(),
                                         static_cast<int>(pData->engine->getBufferSize()));
 
+        pData->midiControlMap.invalidate();
+
         bufferSizeChanged(pData->engine->getBufferSize());
         reloadPrograms(true);
 
@@ -1129,17 +1131,9 @@ public:
                         }
 #endif
                         // Control plugin parameters
-                        uint32_t k;
-                        for (k=0; k < pData->param.count; ++k)
+                        for (ProtectedData::MidiControlIterator it(pData, event.channel, ctrlEvent.param); it.valid(); it.next())
                         {
-                            if (pData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (pData->param.data[k].mappedControlIndex != ctrlEvent.param)
-                                continue;
-                            if (pData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((pData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                            const uint32_t k = it.getParameterId();
 
                             ctrlEvent.handled = true;
                             value = pData->param.getFinalUnnormalizedValue(k, ctrlEvent.normalizedValue);
@@ -306,7 +306,8 @@ public:
           fForcedStereoIn(false),
           fForcedStereoOut(false),
           fNeedsFixedBuffers(false),
-          fUsesCustomData(false)
+          fUsesCustomData(false),
+          fAudioConnectedDirectly(false)
 #if defined(HAVE_LIBLO) && !defined(BUILD_BRIDGE)
         , fOscData(),
           fThreadUI(engine, this, fOscData),
@@ -315,6 +316,8 @@ public:
     {
         carla_debug("CarlaPluginLADSPADSSI::CarlaPluginLADSPADSSI(%p, %i)", engine, id);
 
+        pData->param.outputTracked = true;
+
         carla_zeroPointers(fExtraStereoBuffer, 2);
     }
 
@@ -1300,6 +1303,8 @@ public:
         fForcedStereoIn  = forcedStereoIn;
         fForcedStereoOut = forcedStereoOut;
 
+        pData->midiControlMap.invalidate();
+
         bufferSizeChanged(pData->engine->getBufferSize());
         reloadPrograms(true);
 
@@ -1704,16 +1709,9 @@ public:
                         }
 #endif
                         // Control plugin parameters
-                        for (uint32_t k=0; k < pData->param.count; ++k)
+                        for (ProtectedData::MidiControlIterator it(pData, event.channel, ctrlEvent.param); it.valid(); it.next())
                         {
-                            if (pData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (pData->param.data[k].mappedControlIndex != ctrlEvent.param)
-                                continue;
-                            if (pData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((pData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                            const uint32_t k = it.getParameterId();
 
                             ctrlEvent.handled = true;
                             value = pData->param.getFinalUnnormalizedValue(k, ctrlEvent.normalizedValue);
@@ -1931,27 +1929,15 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Control Output
 
-        if (pData->event.portOut != nullptr)
         {
-            uint8_t  channel;
-            uint16_t param;
-            float    value;
-
             for (uint32_t k=0; k < pData->param.count; ++k)
             {
                 if (pData->param.data[k].type != PARAMETER_OUTPUT)
                     continue;
 
                 pData->param.ranges[k].fixValue(fParamBuffers[k]);
-
-                if (pData->param.data[k].mappedControlIndex > 0)
-                {
-                    channel = pData->param.data[k].midiChannel;
-                    param   = static_cast<uint16_t>(pData->param.data[k].mappedControlIndex);
-                    value   = pData->param.ranges[k].getNormalizedValue(fParamBuffers[k]);
-                    pData->event.portOut->writeControlEvent(0, channel, kEngineControlEventTypeParameter,
-                                                            param, -1, value);
-                }
+                pData->param.setOutputValueRT(k, fParamBuffers[k]);
+                pData->writeControlOutputRT(k, fParamBuffers[k], frames);
             }
         } // End of Control Output
 
@@ -2004,14 +1990,40 @@ public:
         const bool customMonoOut   = pData->audioOut.count == 2 && fForcedStereoOut && ! fForcedStereoIn;
         const bool customStereoOut = pData->audioOut.count == 2 && fForcedStereoIn  && ! fForcedStereoOut;
 
-        if (! customMonoOut)
+        const bool processDirectly = fHandles.count() == 1 && ! (fForcedStereoIn || fForcedStereoOut) &&
+                                     pData->canProcessAudioDirectly(audioIn, audioOut, timeOffset,
+                                                                    ! LADSPA_IS_INPLACE_BROKEN(fDescriptor->Properties));
+
+        if (processDirectly)
         {
+            // single instance, connect the engine buffers instead of copying into ours
+            LADSPA_Handle const handle(fHandles.getFirst(nullptr));
+
+            for (uint32_t i=0; i < pData->audioIn.count; ++i)
+                fDescriptor->connect_port(handle, pData->audioIn.ports[i].rindex, const_cast<float*>(audioIn[i]));
+
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
-                carla_zeroFloats(fAudioOutBuffers[i], frames);
+                fDescriptor->connect_port(handle, pData->audioOut.ports[i].rindex, audioOut[i]);
+
+            fAudioConnectedDirectly = true;
         }
+        else
+        {
+            if (fAudioConnectedDirectly)
+            {
+                fAudioConnectedDirectly = false;
+                reconnectAudioPorts();
+            }
 
-        for (uint32_t i=0; i < pData->audioIn.count; ++i)
-            carla_copyFloats(fAudioInBuffers[i], audioIn[i]+timeOffset, frames);
+            if (! customMonoOut)
+            {
+                for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                    carla_zeroFloats(fAudioOutBuffers[i], frames);
+            }
+
+            for (uint32_t i=0; i < pData->audioIn.count; ++i)
+                carla_copyFloats(fAudioInBuffers[i], audioIn[i]+timeOffset, frames);
+        }
 
         // --------------------------------------------------------------------------------------------------------
         // Run plugin
@@ -2059,10 +2071,15 @@ public:
             carla_copyFloats(fAudioOutBuffers[1], fExtraStereoBuffer[1], frames);
         }
 
+        if (processDirectly)
+        {
+            pData->postProcessAudioInPlace(audioOut, frames);
+        }
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
+        else
         {
             const bool doDryWet  = (pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f);
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
@@ -2165,10 +2182,13 @@ public:
         }
 # endif
 #else // BUILD_BRIDGE_ALTERNATIVE_ARCH
-        for (uint32_t i=0; i < pData->audioOut.count; ++i)
+        else
         {
-            for (uint32_t k=0; k < frames; ++k)
-                audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k];
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+            {
+                for (uint32_t k=0; k < frames; ++k)
+                    audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k];
+            }
         }
 #endif
 
@@ -3070,6 +3090,7 @@ private:
     bool    fForcedStereoOut;
     bool    fNeedsFixedBuffers;
     bool    fUsesCustomData;
+    bool    fAudioConnectedDirectly; // audio ports use the engine buffers, see processSingle()
 
 #if defined(HAVE_LIBLO) && !defined(BUILD_BRIDGE)
     CarlaOscData      fOscData;
@@ -30,7 +30,12 @@
 #include "CarlaPipeUtils.hpp"
 #include "CarlaPluginUI.hpp"
 #include "CarlaScopeUtils.hpp"
+#include "CarlaSemUtils.hpp"
+#include "CarlaThread.hpp"
+#include "LinkedList.hpp"
 #include "Lv2AtomRingBuffer.hpp"
+#include "Lv2RdfCache.hpp"
+#include "Lv2UridMap.hpp"
 
 #include "../modules/lilv/config/lilv_config.h"
 
@@ -156,6 +161,21 @@ enum CarlaLv2URIDs {
     kUridCount
 };
 
+// Custom URIDs, shared by all LV2 plugins
+static Lv2UridMap& getCustomUridMap() noexcept
+{
+    static Lv2UridMap sUridMap(kUridCount);
+    return sUridMap;
+}
+
+// Project loading can create plugins from several threads at once, but plugin libraries
+// are not expected to handle being opened, looked up or instantiated concurrently
+static CarlaMutex& getLibLoadingMutex() noexcept
+{
+    static CarlaMutex sMutex;
+    return sMutex;
+}
+
 // LV2 Feature Ids
 enum CarlaLv2Features {
     // DSP features
@@ -614,10 +634,263 @@ static void initAtomForge(LV2_Atom_Forge& atomForge) noexcept
 #endif
 }
 
+// -------------------------------------------------------------------------------------------------------------------
+// Worker threads shared by all LV2 plugins, woken up as soon as some work is scheduled.
+// Each client runs its work in order on a single thread at a time, different clients run in parallel.
+
+class CarlaLv2WorkerPool
+{
+public:
+    class Client
+    {
+    public:
+        Client() noexcept
+            : fPending(0),
+              fBusy(false),
+              fAdded(false) {}
+
+        virtual ~Client() {}
+
+        // Called from a pool thread, never concurrently for the same client.
+        virtual void runScheduledWork() = 0;
+
+    private:
+        int fPending;
+        bool fBusy;
+        bool fAdded;
+
+        friend class CarlaLv2WorkerPool;
+        CARLA_DECLARE_NON_COPY_CLASS(Client)
+    };
+
+    static CarlaLv2WorkerPool& getInstance() noexcept
+    {
+        static CarlaLv2WorkerPool pool;
+        return pool;
+    }
+
+    void addClient(Client* const client) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(client != nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(! client->fAdded,);
+
+        {
+            const CarlaMutexLocker cml(fMutex);
+            fClients.append(client);
+            client->fAdded = true;
+        }
+
+        const CarlaMutexLocker cml(fThreadsMutex);
+
+        if (fThreads[0] == nullptr)
+            startThreads();
+    }
+
+    // Waits for the work of @a client currently running, if any.
+    void removeClient(Client* const client) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(client != nullptr,);
+
+        if (! client->fAdded)
+            return;
+
+        bool wasLast;
+
+        for (;;)
+        {
+            {
+                const CarlaMutexLocker cml(fMutex);
+
+                if (! client->fBusy)
+                {
+                    fClients.removeOne(client);
+                    client->fAdded = false;
+                    wasLast = fClients.isEmpty();
+                    break;
+                }
+            }
+
+            carla_msleep(1);
+        }
+
+        if (! wasLast)
+            return;
+
+        const CarlaMutexLocker cml(fThreadsMutex);
+
+        {
+            // a client might have been added in the mean time
+            const CarlaMutexLocker cml2(fMutex);
+
+            if (fClients.isNotEmpty())
+                return;
+        }
+
+        stopThreads();
+    }
+
+    // Realtime safe.
+    void schedule(Client* const client) noexcept
+    {
+        __sync_lock_test_and_set(&client->fPending, 1);
+        wake();
+    }
+
+private:
+    static const uint kNumThreads = 4;
+
+    class WorkerThread : public CarlaThread
+    {
+    public:
+        WorkerThread(CarlaLv2WorkerPool& pool) noexcept
+            : CarlaThread("CarlaLv2Worker"),
+              kPool(pool) {}
+
+    protected:
+        void run() override
+        {
+            while (! shouldThreadExit())
+            {
+                if (carla_sem_timedwait(kPool.fSem, 1000))
+                    __sync_lock_release(&kPool.fPosted);
+
+                if (shouldThreadExit())
+                {
+                    // pass it on, so all threads exit
+                    kPool.wake();
+                    break;
+                }
+
+                kPool.runPendingWork();
+            }
+        }
+
+    private:
+        CarlaLv2WorkerPool& kPool;
+
+        CARLA_DECLARE_NON_COPY_CLASS(WorkerThread)
+    };
+
+    CarlaMutex fMutex;
+    CarlaMutex fThreadsMutex;
+    LinkedList<Client*> fClients;
+    WorkerThread* fThreads[kNumThreads];
+    carla_sem_t fSem;
+    int fPosted;
+
+    CarlaLv2WorkerPool() noexcept
+        : fMutex(),
+          fThreadsMutex(),
+          fClients(),
+          fSem(),
+          fPosted(0)
+    {
+        carla_zeroPointers(fThreads, kNumThreads);
+        carla_sem_create2(fSem, false);
+    }
+
+    ~CarlaLv2WorkerPool() noexcept
+    {
+        CARLA_SAFE_ASSERT(fClients.isEmpty());
+
+        stopThreads();
+        carla_sem_destroy2(fSem);
+    }
+
+    void wake() noexcept
+    {
+        // the semaphore is binary on some systems, only post it if no thread has been woken up yet
+        if (__sync_bool_compare_and_swap(&fPosted, 0, 1))
+            carla_sem_post(fSem);
+    }
+
+    void startThreads() noexcept
+    {
+        for (uint i=0; i < kNumThreads; ++i)
+        {
+            fThreads[i] = new WorkerThread(*this);
+            fThreads[i]->startThread();
+        }
+    }
+
+    void stopThreads() noexcept
+    {
+        if (fThreads[0] == nullptr)
+            return;
+
+        for (uint i=0; i < kNumThreads; ++i)
+            fThreads[i]->signalThreadShouldExit();
+
+        wake();
+
+        for (uint i=0; i < kNumThreads; ++i)
+        {
+            fThreads[i]->stopThread(-1);
+            delete fThreads[i];
+            fThreads[i] = nullptr;
+        }
+
+        // the last thread to exit leaves the semaphore posted
+        if (carla_sem_timedwait(fSem, 1))
+            __sync_lock_release(&fPosted);
+    }
+
+    void runPendingWork()
+    {
+        for (;;)
+        {
+            Client* client = nullptr;
+            bool hasMore = false;
+
+            {
+                const CarlaMutexLocker cml(fMutex);
+
+                for (LinkedList<Client*>::Itenerator it = fClients.begin2(); it.valid(); it.next())
+                {
+                    Client* const c(it.getValue(nullptr));
+                    CARLA_SAFE_ASSERT_CONTINUE(c != nullptr);
+
+                    if (c->fBusy || __sync_fetch_and_add(&c->fPending, 0) == 0)
+                        continue;
+
+                    if (client != nullptr)
+                    {
+                        hasMore = true;
+                        break;
+                    }
+
+                    client = c;
+                }
+
+                if (client == nullptr)
+                    return;
+
+                // cleared before running, so work scheduled meanwhile is picked up again after
+                client->fBusy = true;
+                __sync_lock_release(&client->fPending);
+            }
+
+            // let another thread take care of the other clients
+            if (hasMore)
+                wake();
+
+            try {
+                client->runScheduledWork();
+            } CARLA_SAFE_EXCEPTION("CarlaLv2WorkerPool runScheduledWork");
+
+            const CarlaMutexLocker cml(fMutex);
+            client->fBusy = false;
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaLv2WorkerPool)
+};
+
 // -------------------------------------------------------------------------------------------------------------------
 
 class CarlaPluginLV2 : public CarlaPlugin,
-                       private CarlaPluginUI::Callback
+                       private CarlaPluginUI::Callback,
+                       private CarlaLv2WorkerPool::Client
 {
 public:
     CarlaPluginLV2(CarlaEngine* const engine, const uint id)
@@ -631,9 +904,11 @@ public:
           fCvInBuffers(nullptr),
           fCvOutBuffers(nullptr),
           fParamBuffers(nullptr),
+          fAudioConnectedDirectly(false),
           fHasLoadDefaultState(false),
           fHasThreadSafeRestore(false),
           fNeedsFixedBuffers(false),
+          fCanProcessInPlace(true),
           fNeedsUiClose(false),
           fInlineDisplayNeedsRedraw(false),
           fInlineDisplayLastRedrawTime(0),
@@ -649,7 +924,7 @@ public:
           fEventsOut(),
           fLv2Options(),
           fPipeServer(engine, this),
-          fCustomURIDs(kUridCount, std::string("urn:null")),
+          fUridsSentToBridge(kUridCount),
           fFirstActive(true),
           fLastStateChunk(nullptr),
           fLastTimeInfo(),
@@ -658,7 +933,8 @@ public:
           fUI()
     {
         carla_debug("CarlaPluginLV2::CarlaPluginLV2(%p, %i)", engine, id);
-        CARLA_SAFE_ASSERT(fCustomURIDs.size() == kUridCount);
+
+        pData->param.outputTracked = true;
 
         carla_zeroPointers(fFeatures, kFeatureCountAll+1);
         carla_zeroPointers(fStateFeatures, kStateFeatureCountAll+1);
@@ -714,6 +990,8 @@ public:
             fUI.rdfDescriptor = nullptr;
         }
 
+        CarlaLv2WorkerPool::getInstance().removeClient(this);
+
         pData->singleMutex.lock();
         pData->masterMutex.lock();
 
@@ -1764,27 +2042,10 @@ public:
                     const CarlaScopedLocale csl;
 
                     // write URI mappings
-                    uint32_t u = 0;
-                    for (std::vector<std::string>::iterator it=fCustomURIDs.begin(), end=fCustomURIDs.end(); it != end; ++it, ++u)
-                    {
-                        if (u < kUridCount)
-                            continue;
-                        const std::string& uri(*it);
-
-                        if (! fPipeServer.writeMessage("urid\n", 5))
-                            return;
-
-                        std::snprintf(tmpBuf, 0xfe, "%u\n", u);
-                        if (! fPipeServer.writeMessage(tmpBuf))
-                            return;
+                    fUridsSentToBridge = kUridCount;
 
-                        std::snprintf(tmpBuf, 0xfe, "%lu\n", static_cast<long unsigned>(uri.length()));
-                        if (! fPipeServer.writeMessage(tmpBuf))
-                            return;
-
-                        if (! fPipeServer.writeAndFixMessage(uri.c_str()))
-                            return;
-                    }
+                    if (! writeNewURIDMessages())
+                        return;
 
                     // write UI options
                     if (! fPipeServer.writeMessage("uiOptions\n", 10))
@@ -2055,22 +2316,6 @@ public:
 
     void idle() override
     {
-        if (fAtomBufferWorkerIn.isDataAvailableForReading())
-        {
-            Lv2AtomRingBuffer tmpRingBuffer(fAtomBufferWorkerIn, fAtomBufferWorkerInTmpData);
-            CARLA_SAFE_ASSERT_RETURN(tmpRingBuffer.isDataAvailableForReading(),);
-            CARLA_SAFE_ASSERT_RETURN(fExt.worker != nullptr && fExt.worker->work != nullptr,);
-
-            uint32_t portIndex;
-            const LV2_Atom* atom;
-
-            for (; tmpRingBuffer.get(atom, portIndex);)
-            {
-                CARLA_SAFE_ASSERT_CONTINUE(atom->type == kUridCarlaAtomWorkerIn);
-                fExt.worker->work(fHandle, carla_lv2_worker_respond, this, atom->size, LV2_ATOM_BODY_CONST(atom));
-            }
-        }
-
         if (fInlineDisplayNeedsRedraw)
         {
             // TESTING
@@ -2125,6 +2370,10 @@ public:
             return;
         }
 
+        // atoms from the plugin might use URIDs the bridge does not know yet
+        if (fUI.type == UI::TYPE_BRIDGE)
+            writeNewURIDsToBridge();
+
         if (fAtomBufferUiOut.isDataAvailableForReading())
         {
             Lv2AtomRingBuffer tmpRingBuffer(fAtomBufferUiOut, fAtomBufferUiOutTmpData);
@@ -2322,6 +2571,8 @@ public:
         {
             if (fHandle2 == nullptr)
             {
+                const CarlaMutexLocker cml(getLibLoadingMutex());
+
                 try {
                     fHandle2 = fDescriptor->instantiate(fDescriptor, sampleRate, fRdfDescriptor->Bundle, fFeatures);
                 } catch(...) {}
@@ -3148,6 +3399,7 @@ public:
             fAtomBufferWorkerIn.createBuffer(eventBufferSize);
             fAtomBufferWorkerResp.createBuffer(eventBufferSize);
             fAtomBufferWorkerInTmpData = new uint8_t[fAtomBufferWorkerIn.getSize()];
+            CarlaLv2WorkerPool::getInstance().addClient(this);
         }
 
         if (fRdfDescriptor->ParameterCount > 0 ||
@@ -3233,6 +3485,8 @@ public:
         // check initial latency
         findInitialLatencyValue(aIns, cvIns, aOuts, cvOuts);
 
+        pData->midiControlMap.invalidate();
+
         bufferSizeChanged(pData->engine->getBufferSize());
         reloadPrograms(true);
 
@@ -4018,17 +4272,9 @@ public:
                         }
 #endif
                         // Control plugin parameters
-                        uint32_t k;
-                        for (k=0; k < pData->param.count; ++k)
+                        for (ProtectedData::MidiControlIterator it(pData, event.channel, ctrlEvent.param); it.valid(); it.next())
                         {
-                            if (pData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (pData->param.data[k].mappedControlIndex != ctrlEvent.param)
-                                continue;
-                            if (pData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((pData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                            const uint32_t k = it.getParameterId();
 
                             ctrlEvent.handled = true;
 
@@ -4382,36 +4628,28 @@ public:
             }
         }
 
-#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
         // --------------------------------------------------------------------------------------------------------
         // Control Output
 
-        if (pData->event.portOut != nullptr)
         {
-            uint8_t  channel;
-            uint16_t param;
-            float    value;
-
             for (uint32_t k=0; k < pData->param.count; ++k)
             {
                 if (pData->param.data[k].type != PARAMETER_OUTPUT)
                     continue;
 
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
                 if (fStrictBounds >= 0 && (pData->param.data[k].hints & PARAMETER_IS_STRICT_BOUNDS) != 0)
                     // plugin is responsible to ensure correct bounds
                     pData->param.ranges[k].fixValue(fParamBuffers[k]);
+#endif
 
-                if (pData->param.data[k].mappedControlIndex > 0)
-                {
-                    channel = pData->param.data[k].midiChannel;
-                    param   = static_cast<uint16_t>(pData->param.data[k].mappedControlIndex);
-                    value   = pData->param.ranges[k].getNormalizedValue(fParamBuffers[k]);
-                    pData->event.portOut->writeControlEvent(0, channel, kEngineControlEventTypeParameter,
-                                                            param, -1, value);
-                }
+                pData->param.setOutputValueRT(k, fParamBuffers[k]);
+
+#ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
+                pData->writeControlOutputRT(k, fParamBuffers[k], frames);
+#endif
             }
         } // End of Control Output
-#endif
 
         fFirstActive = false;
 
@@ -4472,11 +4710,31 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Set audio buffers
 
-        for (uint32_t i=0; i < pData->audioIn.count; ++i)
-            carla_copyFloats(fAudioInBuffers[i], audioIn[i]+timeOffset, frames);
+        const bool processDirectly = fHandle2 == nullptr &&
+                                     pData->canProcessAudioDirectly(audioIn, audioOut, timeOffset, fCanProcessInPlace);
 
-        for (uint32_t i=0; i < pData->audioOut.count; ++i)
-            carla_zeroFloats(fAudioOutBuffers[i], frames);
+        if (processDirectly)
+        {
+            // nothing to copy, connect_port is allowed in the audio thread
+            for (uint32_t i=0; i < pData->audioIn.count; ++i)
+                fDescriptor->connect_port(fHandle, pData->audioIn.ports[i].rindex, const_cast<float*>(audioIn[i]));
+
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                fDescriptor->connect_port(fHandle, pData->audioOut.ports[i].rindex, audioOut[i]);
+
+            fAudioConnectedDirectly = true;
+        }
+        else
+        {
+            if (fAudioConnectedDirectly)
+                reconnectAudioPorts();
+
+            for (uint32_t i=0; i < pData->audioIn.count; ++i)
+                carla_copyFloats(fAudioInBuffers[i], audioIn[i]+timeOffset, frames);
+
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                carla_zeroFloats(fAudioOutBuffers[i], frames);
+        }
 
         // --------------------------------------------------------------------------------------------------------
         // Set CV buffers
@@ -4515,10 +4773,15 @@ public:
 
         pData->postRtEvents.trySplice();
 
+        if (processDirectly)
+        {
+            pData->postProcessAudioInPlace(audioOut, frames);
+        }
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
+        else
         {
             const bool doDryWet  = (pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f);
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
@@ -4620,10 +4883,13 @@ public:
         }
 # endif
 #else // BUILD_BRIDGE_ALTERNATIVE_ARCH
-        for (uint32_t i=0; i < pData->audioOut.count; ++i)
+        else
         {
-            for (uint32_t k=0; k < frames; ++k)
-                audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k];
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+            {
+                for (uint32_t k=0; k < frames; ++k)
+                    audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k];
+            }
         }
 #endif
 
@@ -4658,42 +4924,7 @@ public:
             fAudioOutBuffers[i] = new float[newBufferSize];
         }
 
-        if (fHandle2 == nullptr)
-        {
-            for (uint32_t i=0; i < pData->audioIn.count; ++i)
-            {
-                CARLA_ASSERT(fAudioInBuffers[i] != nullptr);
-                fDescriptor->connect_port(fHandle, pData->audioIn.ports[i].rindex, fAudioInBuffers[i]);
-            }
-
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-            {
-                CARLA_ASSERT(fAudioOutBuffers[i] != nullptr);
-                fDescriptor->connect_port(fHandle, pData->audioOut.ports[i].rindex, fAudioOutBuffers[i]);
-            }
-        }
-        else
-        {
-            if (pData->audioIn.count > 0)
-            {
-                CARLA_ASSERT(pData->audioIn.count == 2);
-                CARLA_ASSERT(fAudioInBuffers[0] != nullptr);
-                CARLA_ASSERT(fAudioInBuffers[1] != nullptr);
-
-                fDescriptor->connect_port(fHandle,  pData->audioIn.ports[0].rindex, fAudioInBuffers[0]);
-                fDescriptor->connect_port(fHandle2, pData->audioIn.ports[1].rindex, fAudioInBuffers[1]);
-            }
-
-            if (pData->audioOut.count > 0)
-            {
-                CARLA_ASSERT(pData->audioOut.count == 2);
-                CARLA_ASSERT(fAudioOutBuffers[0] != nullptr);
-                CARLA_ASSERT(fAudioOutBuffers[1] != nullptr);
-
-                fDescriptor->connect_port(fHandle,  pData->audioOut.ports[0].rindex, fAudioOutBuffers[0]);
-                fDescriptor->connect_port(fHandle2, pData->audioOut.ports[1].rindex, fAudioOutBuffers[1]);
-            }
-        }
+        reconnectAudioPorts();
 
         for (uint32_t i=0; i < pData->cvIn.count; ++i)
         {
@@ -4746,6 +4977,48 @@ public:
         carla_debug("CarlaPluginLV2::bufferSizeChanged(%i) - end", newBufferSize);
     }
 
+    void reconnectAudioPorts() noexcept
+    {
+        fAudioConnectedDirectly = false;
+
+        if (fHandle2 == nullptr)
+        {
+            for (uint32_t i=0; i < pData->audioIn.count; ++i)
+            {
+                CARLA_ASSERT(fAudioInBuffers[i] != nullptr);
+                fDescriptor->connect_port(fHandle, pData->audioIn.ports[i].rindex, fAudioInBuffers[i]);
+            }
+
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+            {
+                CARLA_ASSERT(fAudioOutBuffers[i] != nullptr);
+                fDescriptor->connect_port(fHandle, pData->audioOut.ports[i].rindex, fAudioOutBuffers[i]);
+            }
+        }
+        else
+        {
+            if (pData->audioIn.count > 0)
+            {
+                CARLA_ASSERT(pData->audioIn.count == 2);
+                CARLA_ASSERT(fAudioInBuffers[0] != nullptr);
+                CARLA_ASSERT(fAudioInBuffers[1] != nullptr);
+
+                fDescriptor->connect_port(fHandle,  pData->audioIn.ports[0].rindex, fAudioInBuffers[0]);
+                fDescriptor->connect_port(fHandle2, pData->audioIn.ports[1].rindex, fAudioInBuffers[1]);
+            }
+
+            if (pData->audioOut.count > 0)
+            {
+                CARLA_ASSERT(pData->audioOut.count == 2);
+                CARLA_ASSERT(fAudioOutBuffers[0] != nullptr);
+                CARLA_ASSERT(fAudioOutBuffers[1] != nullptr);
+
+                fDescriptor->connect_port(fHandle,  pData->audioOut.ports[0].rindex, fAudioOutBuffers[0]);
+                fDescriptor->connect_port(fHandle2, pData->audioOut.ports[1].rindex, fAudioOutBuffers[1]);
+            }
+        }
+    }
+
     void sampleRateChanged(const double newSampleRate) override
     {
         CARLA_ASSERT_INT(newSampleRate > 0.0, newSampleRate);
@@ -5553,7 +5826,9 @@ public:
     {
         parameterId = UINT32_MAX;
 
-        if (urid >= fCustomURIDs.size())
+        const char* const uri = getCustomUridMap().unmap(urid);
+
+        if (uri == nullptr)
             return false;
 
         for (uint32_t i=0; i < fRdfDescriptor->ParameterCount; ++i)
@@ -5572,9 +5847,7 @@ public:
                 continue;
             }
 
-            const std::string& uri(fCustomURIDs[urid]);
-
-            if (uri != rdfParam.URI)
+            if (std::strcmp(uri, rdfParam.URI) != 0)
                 continue;
 
             const int32_t rindex = static_cast<int32_t>(fRdfDescriptor->PortCount + i);
@@ -5600,35 +5873,66 @@ public:
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', kUridNull);
         carla_debug("CarlaPluginLV2::getCustomURID(\"%s\")", uri);
 
-        const std::string    s_uri(uri);
-        const std::ptrdiff_t s_pos(std::find(fCustomURIDs.begin(), fCustomURIDs.end(), s_uri) - fCustomURIDs.begin());
+        const LV2_URID urid = getCustomUridMap().map(uri);
 
-        if (s_pos <= 0 || s_pos >= INT32_MAX)
-            return kUridNull;
+        if (fUI.type == UI::TYPE_BRIDGE)
+            writeNewURIDsToBridge();
 
-        const LV2_URID urid     = static_cast<LV2_URID>(s_pos);
-        const LV2_URID uriCount = static_cast<LV2_URID>(fCustomURIDs.size());
+        return urid;
+    }
 
-        if (urid < uriCount)
-            return urid;
+    const char* getCustomURIDString(const LV2_URID urid) const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(urid != kUridNull, kUnmapFallback);
+        carla_debug("CarlaPluginLV2::getCustomURIString(%i)", urid);
 
-        CARLA_SAFE_ASSERT(urid == uriCount);
+        const char* const uri = getCustomUridMap().unmap(urid);
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr, kUnmapFallback);
 
-        fCustomURIDs.push_back(uri);
+        return uri;
+    }
 
-        if (fUI.type == UI::TYPE_BRIDGE && fPipeServer.isPipeRunning())
-            fPipeServer.writeLv2UridMessage(urid, uri);
+    // send the bridge all URIDs mapped since last time, by any plugin
+    void writeNewURIDsToBridge()
+    {
+        if (fUridsSentToBridge == getCustomUridMap().getNextURID() || ! fPipeServer.isPipeRunning())
+            return;
 
-        return urid;
+        const CarlaMutexLocker cml(fPipeServer.getPipeLock());
+
+        if (writeNewURIDMessages())
+            fPipeServer.flushMessages();
     }
 
-    const char* getCustomURIDString(const LV2_URID urid) const noexcept
+    // must be called with the pipe lock held
+    bool writeNewURIDMessages()
     {
-        CARLA_SAFE_ASSERT_RETURN(urid != kUridNull, kUnmapFallback);
-        CARLA_SAFE_ASSERT_RETURN(urid < fCustomURIDs.size(), kUnmapFallback);
-        carla_debug("CarlaPluginLV2::getCustomURIString(%i)", urid);
+        const Lv2UridMap& uridMap(getCustomUridMap());
+
+        char tmpBuf[0xff];
+        tmpBuf[0xfe] = '\0';
 
-        return fCustomURIDs[urid].c_str();
+        for (const LV2_URID nextURID = uridMap.getNextURID(); fUridsSentToBridge < nextURID; ++fUridsSentToBridge)
+        {
+            const char* const uri = uridMap.unmap(fUridsSentToBridge);
+            CARLA_SAFE_ASSERT_CONTINUE(uri != nullptr);
+
+            if (! fPipeServer.writeMessage("urid\n", 5))
+                return false;
+
+            std::snprintf(tmpBuf, 0xfe, "%u\n", fUridsSentToBridge);
+            if (! fPipeServer.writeMessage(tmpBuf))
+                return false;
+
+            std::snprintf(tmpBuf, 0xfe, "%lu\n", static_cast<long unsigned>(std::strlen(uri)));
+            if (! fPipeServer.writeMessage(tmpBuf))
+                return false;
+
+            if (! fPipeServer.writeAndFixMessage(uri))
+                return false;
+        }
+
+        return true;
     }
 
     // -------------------------------------------------------------------
@@ -5940,7 +6244,32 @@ public:
         atom.size = size;
         atom.type = kUridCarlaAtomWorkerIn;
 
-        return fAtomBufferWorkerIn.putChunk(&atom, data, fEventsOut.ctrlIndex) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+        if (! fAtomBufferWorkerIn.putChunk(&atom, data, fEventsOut.ctrlIndex))
+            return LV2_WORKER_ERR_NO_SPACE;
+
+        CarlaLv2WorkerPool::getInstance().schedule(this);
+        return LV2_WORKER_SUCCESS;
+    }
+
+    // -------------------------------------------------------------------
+
+    void runScheduledWork() override
+    {
+        if (! fAtomBufferWorkerIn.isDataAvailableForReading())
+            return;
+
+        Lv2AtomRingBuffer tmpRingBuffer(fAtomBufferWorkerIn, fAtomBufferWorkerInTmpData);
+        CARLA_SAFE_ASSERT_RETURN(tmpRingBuffer.isDataAvailableForReading(),);
+        CARLA_SAFE_ASSERT_RETURN(fExt.worker != nullptr && fExt.worker->work != nullptr,);
+
+        uint32_t portIndex;
+        const LV2_Atom* atom;
+
+        for (; tmpRingBuffer.get(atom, portIndex);)
+        {
+            CARLA_SAFE_ASSERT_CONTINUE(atom->type == kUridCarlaAtomWorkerIn);
+            fExt.worker->work(fHandle, carla_lv2_worker_respond, this, atom->size, LV2_ATOM_BODY_CONST(atom));
+        }
     }
 
     LV2_Worker_Status handleWorkerRespond(const uint32_t size, const void* const data)
@@ -6335,21 +6664,39 @@ public:
         const EngineOptions& opts(pData->engine->getOptions());
 
         // ---------------------------------------------------------------
-        // Init LV2 World if needed, sets LV2_PATH for lilv
+        // get plugin from our cache if possible, so the LV2 World only needs to load its bundle
 
         Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
+        Lv2RdfCache& rdfCache(Lv2RdfCache::getInstance());
+
+        const char* lv2Path;
 
         if (opts.pathLV2 != nullptr && opts.pathLV2[0] != '\0')
-            lv2World.initIfNeeded(opts.pathLV2);
+            lv2Path = opts.pathLV2;
         else if (const char* const LV2_PATH = std::getenv("LV2_PATH"))
-            lv2World.initIfNeeded(LV2_PATH);
+            lv2Path = LV2_PATH;
         else
-            lv2World.initIfNeeded(LILV_DEFAULT_LV2_PATH);
+            lv2Path = LILV_DEFAULT_LV2_PATH;
 
-        // ---------------------------------------------------------------
-        // get plugin from lv2_rdf (lilv)
+        if ((fRdfDescriptor = rdfCache.load(uri, lv2Path)) != nullptr)
+        {
+            lv2World.loadBundleLazily(fRdfDescriptor->Bundle, lv2Path);
+        }
+        else
+        {
+            // -----------------------------------------------------------
+            // Init LV2 World if needed, sets LV2_PATH for lilv
+
+            lv2World.initIfNeeded(lv2Path);
+
+            // -----------------------------------------------------------
+            // get plugin from lv2_rdf (lilv)
+
+            fRdfDescriptor = lv2_rdf_new(uri, true);
 
-        fRdfDescriptor = lv2_rdf_new(uri, true);
+            if (fRdfDescriptor != nullptr)
+                rdfCache.store(fRdfDescriptor, lv2Path);
+        }
 
         if (fRdfDescriptor == nullptr)
         {
@@ -6387,66 +6734,71 @@ public:
         removeFileFromQuarantine(fRdfDescriptor->Binary);
 #endif
 
-        if (! pData->libOpen(fRdfDescriptor->Binary))
+        // plugin libraries are opened and searched one at a time, see getLibLoadingMutex()
         {
-            pData->engine->setLastError(pData->libError(fRdfDescriptor->Binary));
-            return false;
-        }
-
-        // ---------------------------------------------------------------
-        // try to get DLL main entry via new mode
+            const CarlaMutexLocker cml(getLibLoadingMutex());
 
-        if (const LV2_Lib_Descriptor_Function libDescFn = pData->libSymbol<LV2_Lib_Descriptor_Function>("lv2_lib_descriptor"))
-        {
-            // -----------------------------------------------------------
-            // all ok, get lib descriptor
-
-            const LV2_Lib_Descriptor* const libDesc = libDescFn(fRdfDescriptor->Bundle, nullptr);
-
-            if (libDesc == nullptr)
+            if (! pData->libOpen(fRdfDescriptor->Binary))
             {
-                pData->engine->setLastError("Could not find the LV2 Descriptor");
+                pData->engine->setLastError(pData->libError(fRdfDescriptor->Binary));
                 return false;
             }
 
             // -----------------------------------------------------------
-            // get descriptor that matches URI (new mode)
+            // try to get DLL main entry via new mode
 
-            uint32_t i = 0;
-            while ((fDescriptor = libDesc->get_plugin(libDesc->handle, i++)))
+            if (const LV2_Lib_Descriptor_Function libDescFn = pData->libSymbol<LV2_Lib_Descriptor_Function>("lv2_lib_descriptor"))
             {
-                if (std::strcmp(fDescriptor->URI, uri) == 0)
-                    break;
-            }
-        }
-        else
-        {
-            // -----------------------------------------------------------
-            // get DLL main entry (old mode)
+                // -------------------------------------------------------
+                // all ok, get lib descriptor
 
-            const LV2_Descriptor_Function descFn = pData->libSymbol<LV2_Descriptor_Function>("lv2_descriptor");
+                const LV2_Lib_Descriptor* const libDesc = libDescFn(fRdfDescriptor->Bundle, nullptr);
 
-            if (descFn == nullptr)
-            {
-                pData->engine->setLastError("Could not find the LV2 Descriptor in the plugin library");
-                return false;
-            }
+                if (libDesc == nullptr)
+                {
+                    pData->engine->setLastError("Could not find the LV2 Descriptor");
+                    return false;
+                }
 
-            // -----------------------------------------------------------
-            // get descriptor that matches URI (old mode)
+                // -------------------------------------------------------
+                // get descriptor that matches URI (new mode)
 
-            uint32_t i = 0;
-            while ((fDescriptor = descFn(i++)))
+                uint32_t i = 0;
+                while ((fDescriptor = libDesc->get_plugin(libDesc->handle, i++)))
+                {
+                    if (std::strcmp(fDescriptor->URI, uri) == 0)
+                        break;
+                }
+            }
+            else
             {
-                if (std::strcmp(fDescriptor->URI, uri) == 0)
-                    break;
+                // -------------------------------------------------------
+                // get DLL main entry (old mode)
+
+                const LV2_Descriptor_Function descFn = pData->libSymbol<LV2_Descriptor_Function>("lv2_descriptor");
+
+                if (descFn == nullptr)
+                {
+                    pData->engine->setLastError("Could not find the LV2 Descriptor in the plugin library");
+                    return false;
+                }
+
+                // -------------------------------------------------------
+                // get descriptor that matches URI (old mode)
+
+                uint32_t i = 0;
+                while ((fDescriptor = descFn(i++)))
+                {
+                    if (std::strcmp(fDescriptor->URI, uri) == 0)
+                        break;
+                }
             }
-        }
 
-        if (fDescriptor == nullptr)
-        {
-            pData->engine->setLastError("Could not find the requested plugin URI in the plugin library");
-            return false;
+            if (fDescriptor == nullptr)
+            {
+                pData->engine->setLastError("Could not find the requested plugin URI in the plugin library");
+                return false;
+            }
         }
 
         // ---------------------------------------------------------------
@@ -6483,6 +6835,10 @@ public:
             {
                 fNeedsFixedBuffers = true;
             }
+            else if (std::strcmp(feature.URI, LV2_CORE__inPlaceBroken) == 0)
+            {
+                fCanProcessInPlace = false;
+            }
             else if (std::strcmp(feature.URI, LV2_PORT_PROPS__supportsStrictBounds) == 0)
             {
                 fStrictBounds = feature.Required ? 1 : 0;
@@ -6745,9 +7101,13 @@ public:
         // ---------------------------------------------------------------
         // initialize plugin
 
-        try {
-            fHandle = fDescriptor->instantiate(fDescriptor, pData->engine->getSampleRate(), fRdfDescriptor->Bundle, fFeatures);
-        } catch(...) {}
+        {
+            const CarlaMutexLocker cml(getLibLoadingMutex());
+
+            try {
+                fHandle = fDescriptor->instantiate(fDescriptor, pData->engine->getSampleRate(), fRdfDescriptor->Bundle, fFeatures);
+            } catch(...) {}
+        }
 
         if (fHandle == nullptr)
         {
@@ -7300,24 +7660,17 @@ public:
     {
         CARLA_SAFE_ASSERT_RETURN(urid != kUridNull,);
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0',);
-        carla_debug("CarlaPluginLV2::handleUridMap(%i v " P_SIZE ", \"%s\")", urid, fCustomURIDs.size()-1, uri);
+        carla_debug("CarlaPluginLV2::handleUridMap(%i, \"%s\")", urid, uri);
 
-        const std::size_t uriCount(fCustomURIDs.size());
+        if (urid >= kUridCount && getCustomUridMap().add(urid, uri))
+            return;
 
-        if (urid < uriCount)
-        {
-            const char* const ourURI(carla_lv2_urid_unmap(this, urid));
-            CARLA_SAFE_ASSERT_RETURN(ourURI != nullptr && ourURI != kUnmapFallback,);
+        const char* const ourURI(carla_lv2_urid_unmap(this, urid));
+        CARLA_SAFE_ASSERT_RETURN(ourURI != nullptr,);
 
-            if (std::strcmp(ourURI, uri) != 0)
-            {
-                carla_stderr2("PLUGIN :: wrong URI '%s' vs '%s'", ourURI,  uri);
-            }
-        }
-        else
+        if (std::strcmp(ourURI, uri) != 0)
         {
-            CARLA_SAFE_ASSERT_RETURN(urid == uriCount,);
-            fCustomURIDs.push_back(uri);
+            carla_stderr2("PLUGIN :: wrong URI '%s' vs '%s'", ourURI,  uri);
         }
     }
 
@@ -7365,10 +7718,12 @@ private:
     float** fCvInBuffers;
     float** fCvOutBuffers;
     float*  fParamBuffers;
+    bool    fAudioConnectedDirectly; // audio ports use the engine buffers, see processSingle()
 
     bool    fHasLoadDefaultState : 1;
     bool    fHasThreadSafeRestore : 1;
     bool    fNeedsFixedBuffers : 1;
+    bool    fCanProcessInPlace : 1;
     bool    fNeedsUiClose  : 1;
     bool    fInlineDisplayNeedsRedraw : 1;
     int64_t fInlineDisplayLastRedrawTime;
@@ -7387,7 +7742,7 @@ private:
     CarlaPluginLV2Options   fLv2Options;
     CarlaPipeServerLV2      fPipeServer;
 
-    std::vector<std::string> fCustomURIDs;
+    LV2_URID fUridsSentToBridge;
 
     bool fFirstActive; // first process() call after activate()
     void* fLastStateChunk;
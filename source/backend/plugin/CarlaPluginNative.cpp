@@ -51,7 +51,8 @@ class NativePluginInitializer
 {
 public:
     NativePluginInitializer() noexcept
-        : fNeedsInit(true) {}
+        : fMutex(),
+          fNeedsInit(true) {}
 
     ~NativePluginInitializer() noexcept
     {
@@ -60,6 +61,9 @@ public:
 
     void initIfNeeded() noexcept
     {
+        // plugins can be loaded from more than one thread
+        const CarlaMutexLocker cml(fMutex);
+
         if (! fNeedsInit)
             return;
 
@@ -71,6 +75,7 @@ public:
     }
 
 private:
+    CarlaMutex fMutex;
     bool fNeedsInit;
 
 } sPluginInitializer;
@@ -272,6 +277,8 @@ public:
     {
         carla_debug("CarlaPluginNative::CarlaPluginNative(%p, %i)", engine, id);
 
+        pData->param.outputTracked = true;
+
         carla_fill(fCurMidiProgs, 0, MAX_MIDI_CHANNELS);
         carla_zeroStructs(fMidiInEvents, kPluginMaxMidiEvents);
         carla_zeroStructs(fMidiOutEvents, kPluginMaxMidiEvents);
@@ -1434,6 +1441,8 @@ public:
         // extra plugin hints
         pData->extraHints = 0x0;
 
+        pData->midiControlMap.invalidate();
+
         bufferSizeChanged(pData->engine->getBufferSize());
         reloadPrograms(true);
 
@@ -2030,16 +2039,9 @@ public:
                         }
 #endif
                         // Control plugin parameters
-                        for (uint32_t k=0; k < pData->param.count; ++k)
+                        for (ProtectedData::MidiControlIterator it(pData, event.channel, ctrlEvent.param); it.valid(); it.next())
                         {
-                            if (pData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (pData->param.data[k].mappedControlIndex != ctrlEvent.param)
-                                continue;
-                            if (pData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((pData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                            const uint32_t k = it.getParameterId();
 
                             ctrlEvent.handled = true;
                             value = pData->param.getFinalUnnormalizedValue(k, ctrlEvent.normalizedValue);
@@ -2247,13 +2249,11 @@ public:
 
         } // End of Plugin processing (no events)
 
-#ifndef BUILD_BRIDGE
         // --------------------------------------------------------------------------------------------------------
         // Control Output
 
-        if (pData->event.portOut != nullptr)
         {
-            float value, curValue;
+            float curValue;
 
             for (uint32_t k=0; k < pData->param.count; ++k)
             {
@@ -2262,20 +2262,13 @@ public:
 
                 curValue = fDescriptor->get_parameter_value(fHandle, k);
                 pData->param.ranges[k].fixValue(curValue);
+                pData->param.setOutputValueRT(k, curValue);
 
-                if (pData->param.data[k].mappedControlIndex > 0)
-                {
-                    value = pData->param.ranges[k].getNormalizedValue(curValue);
-                    pData->event.portOut->writeControlEvent(0,
-                                                            pData->param.data[k].midiChannel,
-                                                            kEngineControlEventTypeParameter,
-                                                            static_cast<uint16_t>(pData->param.data[k].mappedControlIndex),
-                                                            -1,
-                                                            value);
-                }
+#ifndef BUILD_BRIDGE
+                pData->writeControlOutputRT(k, curValue, frames);
+#endif
             }
         } // End of Control Output
-#endif
     }
 
     bool processSingle(const float* const* const audioIn, float** const audioOut,
@@ -2323,14 +2316,43 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Set audio buffers
 
+        // native plugins have no way to tell if they support in-place processing, so only go direct
+        // when the engine gives us separate input and output buffers
+        const bool processDirectly = fHandle2 == nullptr &&
+                                     pData->canProcessAudioDirectly(audioIn, audioOut, timeOffset, false);
+
+        const uint32_t acIns  = pData->audioIn.count  + pData->cvIn.count;
+        const uint32_t acOuts = pData->audioOut.count + pData->cvOut.count;
+
+        float* directInBuffers[acIns > 0 ? acIns : 1];
+        float* directOutBuffers[acOuts > 0 ? acOuts : 1];
+
+        if (processDirectly)
+        {
+            // audio goes straight from and to the engine, CV still uses our own buffers
+            for (uint32_t i=0; i < pData->audioIn.count; ++i)
+                directInBuffers[i] = const_cast<float*>(audioIn[i]);
+            for (uint32_t i=pData->audioIn.count; i < acIns; ++i)
+                directInBuffers[i] = fAudioAndCvInBuffers[i];
+
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                directOutBuffers[i] = audioOut[i];
+            for (uint32_t i=pData->audioOut.count; i < acOuts; ++i)
+                directOutBuffers[i] = fAudioAndCvOutBuffers[i];
+        }
+        else
         {
             for (uint32_t i=0; i < pData->audioIn.count; ++i)
                 carla_copyFloats(fAudioAndCvInBuffers[i], audioIn[i]+timeOffset, frames);
-            for (uint32_t i=0; i < pData->cvIn.count; ++i)
-                carla_copyFloats(fAudioAndCvInBuffers[pData->audioIn.count+i], cvIn[i]+timeOffset, frames);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
                 carla_zeroFloats(fAudioAndCvOutBuffers[i], frames);
+        }
+
+        {
+            for (uint32_t i=0; i < pData->cvIn.count; ++i)
+                carla_copyFloats(fAudioAndCvInBuffers[pData->audioIn.count+i], cvIn[i]+timeOffset, frames);
+
             for (uint32_t i=0; i < pData->cvOut.count; ++i)
                 carla_zeroFloats(fAudioAndCvOutBuffers[pData->audioOut.count+i], frames);
         }
@@ -2340,7 +2362,13 @@ public:
 
         fIsProcessing = true;
 
-        if (fHandle2 == nullptr)
+        if (processDirectly)
+        {
+            fDescriptor->process(fHandle,
+                                 directInBuffers, directOutBuffers, frames,
+                                 fMidiInEvents, fMidiEventInCount);
+        }
+        else if (fHandle2 == nullptr)
         {
             fDescriptor->process(fHandle,
                                  fAudioAndCvInBuffers, fAudioAndCvOutBuffers, frames,
@@ -2365,10 +2393,17 @@ public:
             fTimeInfo.frame += frames;
 
         uint32_t i=0;
+
+        if (processDirectly)
+        {
+            pData->postProcessAudioInPlace(audioOut, frames);
+            i = pData->audioOut.count;
+        }
 #ifndef BUILD_BRIDGE_ALTERNATIVE_ARCH
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
+        else
         {
             const bool doDryWet  = (pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f);
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
@@ -2428,10 +2463,13 @@ public:
 
         } // End of Post-processing
 #else
-        for (; i < pData->audioOut.count; ++i)
+        else
         {
-            for (uint32_t k=0; k < frames; ++k)
-                audioOut[i][k+timeOffset] = fAudioAndCvOutBuffers[i][k];
+            for (; i < pData->audioOut.count; ++i)
+            {
+                for (uint32_t k=0; k < frames; ++k)
+                    audioOut[i][k+timeOffset] = fAudioAndCvOutBuffers[i][k];
+            }
         }
 #endif
         // CV stuff too
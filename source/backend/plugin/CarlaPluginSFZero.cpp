@@ -39,6 +39,9 @@ CARLA_BACKEND_START_NAMESPACE
 
 static const ExternalMidiNote kExternalMidiNoteFallback = { -1, 0, 0 };
 
+// Samples longer than this (plus their region offsets and loops) are streamed from disk
+static const double kSampleStreamingPreloadSeconds = 0.25;
+
 
 static void loadingIdleCallbackFunction(void* ptr)
 {
@@ -299,6 +302,8 @@ public:
         pData->extraHints  = 0x0;
         pData->extraHints |= PLUGIN_EXTRA_HINT_HAS_MIDI_IN;
 
+        pData->midiControlMap.invalidate();
+
         bufferSizeChanged(pData->engine->getBufferSize());
         reloadPrograms(true);
 
@@ -454,16 +459,9 @@ public:
                         }
 #endif
                         // Control plugin parameters
-                        for (uint32_t k=0; k < pData->param.count; ++k)
+                        for (ProtectedData::MidiControlIterator it(pData, event.channel, ctrlEvent.param); it.valid(); it.next())
                         {
-                            if (pData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (pData->param.data[k].mappedControlIndex != ctrlEvent.param)
-                                continue;
-                            if (pData->param.data[k].hints != PARAMETER_INPUT)
-                                continue;
-                            if ((pData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                            const uint32_t k = it.getParameterId();
 
                             value = pData->param.getFinalUnnormalizedValue(k, ctrlEvent.normalizedValue);
                             setParameterValueRT(k, value, true);
@@ -693,7 +691,7 @@ public:
         };
 
         sound->loadRegions();
-        sound->loadSamples(cb);
+        sound->loadSamples(cb, kSampleStreamingPreloadSeconds);
 
         if (fSynth.addSound(sound) == nullptr)
         {
@@ -701,6 +699,9 @@ public:
             return false;
         }
 
+        if (sound->hasStreamingSamples())
+            fSynth.startStreaming();
+
         sound->dumpToConsole();
 
         // ---------------------------------------------------------------
@@ -53,6 +53,10 @@ public:
 
     bool readlineblock_bool(const uint timeout) noexcept
     {
+        bool value;
+        if (CarlaPipeClient::_readFrameValue(kFrameItemBool, &value))
+            return value;
+
         if (const char* const line = CarlaPipeClient::_readlineblock(false, 0, timeout))
             return std::strcmp(line, "true") == 0;
 
@@ -69,6 +73,14 @@ public:
 
     double readlineblock_float(const uint timeout) noexcept
     {
+        float valuef;
+        if (CarlaPipeClient::_readFrameValue(kFrameItemFloat, &valuef))
+            return static_cast<double>(valuef);
+
+        double value;
+        if (CarlaPipeClient::_readFrameValue(kFrameItemDouble, &value))
+            return value;
+
         if (const char* const line = CarlaPipeClient::_readlineblock(false, 0, timeout))
             return std::atof(line);
 
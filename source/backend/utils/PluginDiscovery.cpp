@@ -0,0 +1,1089 @@
+/*
+ * Carla Plugin Host
+ * Copyright (C) 2011-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaUtils.h"
+
+#include "CarlaBackendUtils.hpp"
+#include "CarlaMutex.hpp"
+#include "CarlaString.hpp"
+#include "CarlaThread.hpp"
+
+#include "water/files/File.h"
+#include "water/misc/Time.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#ifdef CARLA_OS_WIN
+# include <process.h>
+#else
+# include <cerrno>
+# include <fcntl.h>
+# include <poll.h>
+# include <signal.h>
+# include <spawn.h>
+# include <unistd.h>
+# include <sys/wait.h>
+#endif
+
+namespace CB = CarlaBackend;
+
+// -------------------------------------------------------------------------------------------------------------------
+
+static const char* const gDiscoveryNullCharPtr = "";
+
+// bump this whenever the carla-discovery output or the stored data changes
+static const uint32_t kDatabaseVersion = 1;
+
+struct DiscoveredPlugin {
+    CB::BinaryType btype;
+    CB::PluginCategory category;
+    uint hints;
+    uint32_t audioIns, audioOuts;
+    uint32_t cvIns, cvOuts;
+    uint32_t midiIns, midiOuts;
+    uint32_t parameterIns, parameterOuts;
+    int64_t uniqueId;
+    CarlaString filename;
+    CarlaString name;
+    CarlaString label;
+    CarlaString maker;
+
+    DiscoveredPlugin() noexcept
+        : btype(CB::BINARY_NONE),
+          category(CB::PLUGIN_CATEGORY_NONE),
+          hints(0x0),
+          audioIns(0),
+          audioOuts(0),
+          cvIns(0),
+          cvOuts(0),
+          midiIns(0),
+          midiOuts(0),
+          parameterIns(0),
+          parameterOuts(0),
+          uniqueId(0),
+          filename(),
+          name(),
+          label(),
+          maker() {}
+};
+
+// result of checking a single file
+struct CheckedFile {
+    uint64_t size;
+    int64_t mtime;
+    std::vector<DiscoveredPlugin> plugins;
+
+    CheckedFile() noexcept
+        : size(0),
+          mtime(0),
+          plugins() {}
+};
+
+typedef std::map<std::string, CheckedFile> CheckedFileMap;
+
+// -------------------------------------------------------------------------------------------------------------------
+
+static bool getFileStamp(const char* const filename, uint64_t& size, int64_t& mtime) noexcept
+{
+    struct stat st;
+
+    if (::stat(filename, &st) != 0)
+        return false;
+
+    size  = static_cast<uint64_t>(st.st_size);
+    mtime = static_cast<int64_t>(st.st_mtime);
+    return true;
+}
+
+static CB::PluginCategory getPluginCategoryFromString(const char* const category) noexcept
+{
+    for (int i = CB::PLUGIN_CATEGORY_NONE; i <= CB::PLUGIN_CATEGORY_OTHER; ++i)
+    {
+        const CB::PluginCategory value = static_cast<CB::PluginCategory>(i);
+
+        if (std::strcmp(category, CB::getPluginCategoryAsString(value)) == 0)
+            return value;
+    }
+
+    return CB::PLUGIN_CATEGORY_NONE;
+}
+
+static uint32_t getUIntFromString(const char* const value) noexcept
+{
+    return static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+}
+
+static uint getCpuCount() noexcept
+{
+#ifdef CARLA_OS_WIN
+    SYSTEM_INFO info;
+    ::GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? static_cast<uint>(info.dwNumberOfProcessors) : 1;
+#else
+    const long count = ::sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<uint>(count) : 1;
+#endif
+}
+
+static water::File getDefaultDatabaseDir()
+{
+    using water::File;
+
+    if (const char* const xdgCacheHome = std::getenv("XDG_CACHE_HOME"))
+        if (xdgCacheHome[0] != '\0')
+            return File(xdgCacheHome).getChildFile("carla/discovery");
+
+#if defined(CARLA_OS_WIN)
+    if (const char* const localAppData = std::getenv("LOCALAPPDATA"))
+        if (localAppData[0] != '\0')
+            return File(localAppData).getChildFile("carla/discovery");
+
+    return File::getSpecialLocation(File::tempDirectory).getChildFile("carla/discovery");
+#elif defined(CARLA_OS_MAC)
+    return File::getSpecialLocation(File::userHomeDirectory).getChildFile("Library/Caches/carla/discovery");
+#else
+    return File::getSpecialLocation(File::userHomeDirectory).getChildFile(".cache/carla/discovery");
+#endif
+}
+
+// one database per tool and plugin type, tools for different architectures find different things
+static CarlaString getDefaultDatabaseFile(const char* tool, const CB::PluginType ptype)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (; *tool != '\0'; ++tool)
+    {
+        hash ^= static_cast<uint8_t>(*tool);
+        hash *= 1099511628211ULL;
+    }
+
+    char name[64];
+    std::snprintf(name, 63, "%s-%016llx.bin",
+                  CB::getPluginTypeAsString(ptype), static_cast<unsigned long long>(hash));
+    name[63] = '\0';
+
+    return CarlaString(getDefaultDatabaseDir().getChildFile(name).getFullPathName().toRawUTF8());
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// carla-discovery output parsing, matching runCarlaDiscovery() from the frontend
+
+class DiscoveryOutputParser
+{
+public:
+    DiscoveryOutputParser(const char* const filename, std::vector<DiscoveredPlugin>& plugins) noexcept
+        : fFilename(filename),
+          fPlugins(plugins),
+          fPlugin(),
+          fInPlugin(false),
+          fLine() {}
+
+    void feed(const char* const data, const size_t size)
+    {
+        for (size_t i=0; i < size; ++i)
+        {
+            if (data[i] != '\n')
+            {
+                fLine.push_back(data[i]);
+                continue;
+            }
+
+            parseLine();
+            fLine.clear();
+        }
+    }
+
+    // an unfinished plugin is dropped, as runCarlaDiscovery() does
+    void finish()
+    {
+        if (! fLine.empty())
+        {
+            parseLine();
+            fLine.clear();
+        }
+    }
+
+private:
+    const char* const fFilename;
+    std::vector<DiscoveredPlugin>& fPlugins;
+    DiscoveredPlugin fPlugin;
+    bool fInPlugin;
+    std::string fLine;
+
+    void parseLine()
+    {
+        while (! fLine.empty() && (fLine[fLine.size()-1] == '\r' || fLine[fLine.size()-1] == ' '))
+            fLine.erase(fLine.size()-1);
+
+        static const char* const kPrefix = "carla-discovery::";
+        static const size_t kPrefixLen = std::strlen(kPrefix);
+
+        if (fLine.compare(0, kPrefixLen, kPrefix) != 0)
+            return;
+
+        const std::string::size_type sep = fLine.find("::", kPrefixLen);
+
+        if (sep == std::string::npos)
+            return;
+
+        const std::string prop(fLine.substr(kPrefixLen, sep - kPrefixLen));
+        const char* const value = fLine.c_str() + sep + 2;
+
+        if (prop == "init")
+        {
+            fPlugin = DiscoveredPlugin();
+            fPlugin.filename = fFilename;
+            fInPlugin = true;
+            return;
+        }
+        if (prop == "end")
+        {
+            if (fInPlugin)
+                fPlugins.push_back(fPlugin);
+            fInPlugin = false;
+            return;
+        }
+        if (prop == "info" || prop == "warning" || prop == "error")
+        {
+            carla_stdout("carla-discovery::%s::%s - %s", prop.c_str(), value, fFilename);
+            return;
+        }
+
+        if (! fInPlugin)
+            return;
+
+        /**/ if (prop == "build")
+            fPlugin.btype = static_cast<CB::BinaryType>(getUIntFromString(value));
+        else if (prop == "name")
+            fPlugin.name = value;
+        else if (prop == "label")
+            fPlugin.label = value;
+        else if (prop == "filename")
+            fPlugin.filename = value;
+        else if (prop == "maker")
+            fPlugin.maker = value;
+        else if (prop == "category")
+            fPlugin.category = getPluginCategoryFromString(value);
+        else if (prop == "uniqueId")
+            fPlugin.uniqueId = static_cast<int64_t>(std::strtoll(value, nullptr, 10));
+        else if (prop == "hints")
+            fPlugin.hints = getUIntFromString(value);
+        else if (prop == "audio.ins")
+            fPlugin.audioIns = getUIntFromString(value);
+        else if (prop == "audio.outs")
+            fPlugin.audioOuts = getUIntFromString(value);
+        else if (prop == "cv.ins")
+            fPlugin.cvIns = getUIntFromString(value);
+        else if (prop == "cv.outs")
+            fPlugin.cvOuts = getUIntFromString(value);
+        else if (prop == "midi.ins")
+            fPlugin.midiIns = getUIntFromString(value);
+        else if (prop == "midi.outs")
+            fPlugin.midiOuts = getUIntFromString(value);
+        else if (prop == "parameters.ins")
+            fPlugin.parameterIns = getUIntFromString(value);
+        else if (prop == "parameters.outs")
+            fPlugin.parameterOuts = getUIntFromString(value);
+        else if (prop == "uri")
+        {
+            // cannot use empty URIs
+            if (value[0] != '\0')
+                fPlugin.label = value;
+            else
+                fInPlugin = false;
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(DiscoveryOutputParser)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+// running a single carla-discovery process
+
+enum DiscoveryProcessResult {
+    kDiscoveryProcessOk,
+    kDiscoveryProcessFailed,   // could not be started, stays unchecked
+    kDiscoveryProcessCrashed,  // crashed, stays failed until the file changes
+    kDiscoveryProcessTimedOut, // took too long, checked again on the next scan
+    kDiscoveryProcessCancelled
+};
+
+static DiscoveryProcessResult runDiscoveryProcess(const char* const tool, const char* const stype,
+                                                  const char* const filename, const uint timeoutMs,
+                                                  DiscoveryOutputParser& parser, const volatile bool& cancelled)
+{
+    char buffer[4096];
+    const uint32_t startTime = water::Time::getMillisecondCounter();
+
+#ifdef CARLA_OS_WIN
+    SECURITY_ATTRIBUTES sa;
+    carla_zeroStruct(sa);
+    sa.nLength = sizeof(sa);
+    sa.bInheritHandle = TRUE;
+
+    HANDLE pipeRead, pipeWrite;
+    if (::CreatePipe(&pipeRead, &pipeWrite, &sa, 0) == FALSE)
+        return kDiscoveryProcessFailed;
+
+    ::SetHandleInformation(pipeRead, HANDLE_FLAG_INHERIT, 0);
+
+    water::String command;
+    command << "\"" << tool << "\" " << stype << " \"" << filename << "\"";
+
+    STARTUPINFOA si;
+    carla_zeroStruct(si);
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = ::GetStdHandle(STD_INPUT_HANDLE);
+    si.hStdOutput = pipeWrite;
+    si.hStdError = ::GetStdHandle(STD_ERROR_HANDLE);
+
+    PROCESS_INFORMATION pi;
+    carla_zeroStruct(pi);
+
+    const BOOL started = ::CreateProcessA(nullptr, const_cast<LPSTR>(command.toRawUTF8()),
+                                          nullptr, nullptr, TRUE, CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi);
+    ::CloseHandle(pipeWrite);
+
+    if (started == FALSE)
+    {
+        ::CloseHandle(pipeRead);
+        return kDiscoveryProcessFailed;
+    }
+
+    DiscoveryProcessResult result = kDiscoveryProcessOk;
+
+    for (;;)
+    {
+        DWORD available = 0;
+
+        if (::PeekNamedPipe(pipeRead, nullptr, 0, nullptr, &available, nullptr) == FALSE)
+            break; // process closed its end
+
+        if (available != 0)
+        {
+            DWORD numRead = 0;
+            if (::ReadFile(pipeRead, buffer, sizeof(buffer), &numRead, nullptr) == FALSE || numRead == 0)
+                break;
+            parser.feed(buffer, numRead);
+            continue;
+        }
+
+        if (cancelled)
+        {
+            result = kDiscoveryProcessCancelled;
+            break;
+        }
+
+        if (water::Time::getMillisecondCounter() - startTime >= timeoutMs)
+        {
+            result = kDiscoveryProcessTimedOut;
+            break;
+        }
+
+        ::WaitForSingleObject(pi.hProcess, 20);
+    }
+
+    ::CloseHandle(pipeRead);
+
+    if (result != kDiscoveryProcessOk)
+    {
+        ::TerminateProcess(pi.hProcess, 1);
+        ::WaitForSingleObject(pi.hProcess, INFINITE);
+    }
+    else
+    {
+        ::WaitForSingleObject(pi.hProcess, INFINITE);
+
+        DWORD exitCode = 0;
+        // unhandled exceptions end the process with their NTSTATUS code
+        if (::GetExitCodeProcess(pi.hProcess, &exitCode) != FALSE && exitCode >= 0xC0000000)
+            result = kDiscoveryProcessCrashed;
+    }
+
+    ::CloseHandle(pi.hThread);
+    ::CloseHandle(pi.hProcess);
+#else
+    int fds[2];
+    if (::pipe(fds) != 0)
+        return kDiscoveryProcessFailed;
+
+    // do not leak our end into processes started by other workers
+    ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+
+    // same environment as runCarlaDiscovery() from the frontend
+    const char* const argv[] = { "env", "LANG=C", "LD_PRELOAD=", tool, stype, filename, nullptr };
+
+    extern char** environ;
+    pid_t pid = -1;
+    const int spawnErr = ::posix_spawnp(&pid, "env", &actions, nullptr, const_cast<char* const*>(argv), environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fds[1]);
+
+    if (spawnErr != 0)
+    {
+        ::close(fds[0]);
+        return kDiscoveryProcessFailed;
+    }
+
+    DiscoveryProcessResult result = kDiscoveryProcessOk;
+
+    for (;;)
+    {
+        if (cancelled)
+        {
+            result = kDiscoveryProcessCancelled;
+            break;
+        }
+
+        const uint32_t elapsed = water::Time::getMillisecondCounter() - startTime;
+
+        if (elapsed >= timeoutMs)
+        {
+            result = kDiscoveryProcessTimedOut;
+            break;
+        }
+
+        // wake up regularly to check for cancellation
+        struct pollfd pfd = { fds[0], POLLIN, 0 };
+        const int ret = ::poll(&pfd, 1, static_cast<int>(std::min<uint32_t>(timeoutMs - elapsed, 50)));
+
+        if (ret < 0 && errno != EINTR)
+            break;
+        if (ret <= 0)
+            continue;
+
+        const ssize_t numRead = ::read(fds[0], buffer, sizeof(buffer));
+
+        if (numRead > 0)
+            parser.feed(buffer, static_cast<size_t>(numRead));
+        else if (numRead == 0 || errno != EINTR)
+            break;
+    }
+
+    ::close(fds[0]);
+
+    if (result != kDiscoveryProcessOk)
+        ::kill(pid, SIGKILL);
+
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+    if (result == kDiscoveryProcessOk && WIFSIGNALED(status))
+        result = kDiscoveryProcessCrashed;
+#endif
+
+    if (result == kDiscoveryProcessOk)
+        parser.finish();
+
+    return result;
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+
+class PluginDiscovery
+{
+public:
+    PluginDiscovery(const char* const tool, const CB::PluginType ptype, const char* const* const filenames,
+                    const uint timeoutMs, const char* const databaseFile)
+        : fTool(tool),
+          fToolSize(0),
+          fToolTime(0),
+          fType(ptype),
+          fTimeoutMs(timeoutMs),
+          fDatabaseFile(databaseFile != nullptr && databaseFile[0] != '\0'
+                        ? CarlaString(databaseFile)
+                        : getDefaultDatabaseFile(tool, ptype)),
+          fFilenames(),
+          fResults(),
+          fDatabase(),
+          fNextFile(0),
+          fCheckedCount(0),
+          fRunningWorkers(0),
+          fCancelled(false),
+          fFinished(false),
+          fPlugins(),
+          fRetInfo(),
+          fWorkers(),
+          fMutex()
+    {
+        for (const char* const* it = filenames; *it != nullptr; ++it)
+            fFilenames.push_back(*it);
+
+        fResults.resize(fFilenames.size());
+
+        getFileStamp(tool, fToolSize, fToolTime);
+        loadDatabase();
+    }
+
+    ~PluginDiscovery()
+    {
+        fCancelled = true;
+
+        for (std::vector<Worker*>::iterator it = fWorkers.begin(); it != fWorkers.end(); ++it)
+        {
+            (*it)->stopThread(-1);
+            delete *it;
+        }
+
+        // keep what was checked so far, so an aborted scan continues where it stopped
+        if (! fFinished)
+            saveDatabase();
+    }
+
+    void start(uint workerCount)
+    {
+        if (workerCount == 0)
+            workerCount = getCpuCount();
+        if (workerCount > fFilenames.size())
+            workerCount = static_cast<uint>(fFilenames.size());
+
+        if (workerCount == 0)
+        {
+            finish();
+            return;
+        }
+
+        fRunningWorkers = workerCount;
+
+        for (uint i=0; i < workerCount; ++i)
+            fWorkers.push_back(new Worker(this));
+
+        for (std::vector<Worker*>::iterator it = fWorkers.begin(); it != fWorkers.end(); ++it)
+            (*it)->startThread();
+    }
+
+    uint getCheckedCount() const noexcept
+    {
+        return fCheckedCount;
+    }
+
+    bool isFinished() const noexcept
+    {
+        return fFinished;
+    }
+
+    uint getPluginCount() const noexcept
+    {
+        return fFinished ? static_cast<uint>(fPlugins.size()) : 0;
+    }
+
+    const CarlaDiscoveredPluginInfo* getPluginInfo(const uint index) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(fFinished, nullptr);
+        CARLA_SAFE_ASSERT_RETURN(index < fPlugins.size(), nullptr);
+
+        const DiscoveredPlugin& plugin(fPlugins[index]);
+
+        fRetInfo.btype         = plugin.btype;
+        fRetInfo.category      = plugin.category;
+        fRetInfo.hints         = plugin.hints;
+        fRetInfo.audioIns      = plugin.audioIns;
+        fRetInfo.audioOuts     = plugin.audioOuts;
+        fRetInfo.cvIns         = plugin.cvIns;
+        fRetInfo.cvOuts        = plugin.cvOuts;
+        fRetInfo.midiIns       = plugin.midiIns;
+        fRetInfo.midiOuts      = plugin.midiOuts;
+        fRetInfo.parameterIns  = plugin.parameterIns;
+        fRetInfo.parameterOuts = plugin.parameterOuts;
+        fRetInfo.uniqueId      = plugin.uniqueId;
+        fRetInfo.filename      = plugin.filename.isNotEmpty() ? plugin.filename.buffer() : gDiscoveryNullCharPtr;
+        fRetInfo.name          = plugin.name.isNotEmpty()     ? plugin.name.buffer()     : gDiscoveryNullCharPtr;
+        fRetInfo.label         = plugin.label.isNotEmpty()    ? plugin.label.buffer()    : gDiscoveryNullCharPtr;
+        fRetInfo.maker         = plugin.maker.isNotEmpty()    ? plugin.maker.buffer()    : gDiscoveryNullCharPtr;
+
+        return &fRetInfo;
+    }
+
+private:
+    class Worker : public CarlaThread
+    {
+    public:
+        Worker(PluginDiscovery* const discovery) noexcept
+            : CarlaThread("PluginDiscoveryWorker"),
+              kDiscovery(discovery) {}
+
+    protected:
+        void run() override
+        {
+            kDiscovery->runWorker();
+        }
+
+    private:
+        PluginDiscovery* const kDiscovery;
+
+        CARLA_DECLARE_NON_COPY_CLASS(Worker)
+    };
+
+    enum ResultState {
+        kResultNone,   // not checked or not a file, nothing to store
+        kResultChecked // checked now or taken from the database, store as-is
+    };
+
+    struct Result {
+        ResultState state;
+        CheckedFile file;
+
+        Result() noexcept
+            : state(kResultNone),
+              file() {}
+    };
+
+    const CarlaString fTool;
+    uint64_t fToolSize;
+    int64_t fToolTime;
+    const CB::PluginType fType;
+    const uint fTimeoutMs;
+    const CarlaString fDatabaseFile;
+
+    std::vector<std::string> fFilenames;
+    std::vector<Result> fResults;
+
+    // read-only while workers are running
+    CheckedFileMap fDatabase;
+
+    volatile uint fNextFile;
+    volatile uint fCheckedCount;
+    volatile uint fRunningWorkers;
+    volatile bool fCancelled;
+    volatile bool fFinished;
+
+    std::vector<DiscoveredPlugin> fPlugins;
+    CarlaDiscoveredPluginInfo fRetInfo;
+
+    std::vector<Worker*> fWorkers;
+    CarlaMutex fMutex;
+
+    // ---------------------------------------------------------------------------------------------------------------
+
+    void runWorker()
+    {
+        const char* const stype = CB::getPluginTypeAsString(fType);
+
+        for (;;)
+        {
+            if (fCancelled)
+                break;
+
+            const uint index = __sync_fetch_and_add(&fNextFile, 1);
+
+            if (index >= fFilenames.size())
+                break;
+
+            const char* const filename = fFilenames[index].c_str();
+            Result& result(fResults[index]);
+
+            uint64_t size = 0;
+            int64_t mtime = 0;
+
+            // special paths like ":all" are not files and can not be cached
+            const bool hasStamp = getFileStamp(filename, size, mtime);
+
+            if (hasStamp)
+            {
+                const CheckedFileMap::const_iterator it = fDatabase.find(fFilenames[index]);
+
+                if (it != fDatabase.end() && it->second.size == size && it->second.mtime == mtime)
+                {
+                    result.file  = it->second;
+                    result.state = kResultChecked;
+                    __sync_fetch_and_add(&fCheckedCount, 1);
+                    continue;
+                }
+            }
+
+            result.file.size  = size;
+            result.file.mtime = mtime;
+
+            DiscoveryOutputParser parser(filename, result.file.plugins);
+            DiscoveryProcessResult ret = kDiscoveryProcessFailed;
+
+            try {
+                ret = runDiscoveryProcess(fTool, stype, filename, fTimeoutMs, parser, fCancelled);
+            } CARLA_SAFE_EXCEPTION("PluginDiscovery::runDiscoveryProcess");
+
+            switch (ret)
+            {
+            case kDiscoveryProcessOk:
+                if (hasStamp)
+                    result.state = kResultChecked;
+                break;
+            case kDiscoveryProcessFailed:
+                carla_stderr2("carla-discovery::error::failed to start %s - %s", fTool.buffer(), filename);
+                result.file.plugins.clear();
+                break;
+            case kDiscoveryProcessCrashed:
+                carla_stderr2("carla-discovery::crash::%s crashed during discovery", filename);
+                result.file.plugins.clear();
+                if (hasStamp)
+                    result.state = kResultChecked;
+                break;
+            case kDiscoveryProcessTimedOut:
+                carla_stderr2("carla-discovery::timeout::%s took longer than %u ms", filename, fTimeoutMs);
+                result.file.plugins.clear();
+                break;
+            case kDiscoveryProcessCancelled:
+                result.file.plugins.clear();
+                break;
+            }
+
+            if (ret == kDiscoveryProcessCancelled)
+                break;
+
+            __sync_fetch_and_add(&fCheckedCount, 1);
+        }
+
+        if (__sync_sub_and_fetch(&fRunningWorkers, 1) == 0 && ! fCancelled)
+            finish();
+    }
+
+    void finish()
+    {
+        for (size_t i=0, count=fResults.size(); i < count; ++i)
+        {
+            const std::vector<DiscoveredPlugin>& plugins(fResults[i].file.plugins);
+            fPlugins.insert(fPlugins.end(), plugins.begin(), plugins.end());
+        }
+
+        saveDatabase();
+        fFinished = true;
+    }
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // database, a binary file with all checked files and their plugins
+
+    struct Reader {
+        const uint8_t* data;
+        size_t size;
+        size_t pos;
+        bool ok;
+
+        Reader(const uint8_t* const d, const size_t s) noexcept
+            : data(d), size(s), pos(0), ok(true) {}
+
+        bool read(void* const dst, const size_t len) noexcept
+        {
+            if (! ok || len > size - pos)
+                return (ok = false);
+
+            std::memcpy(dst, data + pos, len);
+            pos += len;
+            return true;
+        }
+
+        uint32_t u32() noexcept
+        {
+            uint32_t value = 0;
+            read(&value, sizeof(value));
+            return value;
+        }
+
+        uint64_t u64() noexcept
+        {
+            uint64_t value = 0;
+            read(&value, sizeof(value));
+            return value;
+        }
+
+        // number of elements, each of them takes at least 1 byte in the file
+        uint32_t count() noexcept
+        {
+            const uint32_t value = u32();
+
+            if (ok && value > size - pos)
+                ok = false;
+
+            return ok ? value : 0;
+        }
+
+        std::string str()
+        {
+            const uint32_t len = u32();
+
+            if (! ok || len > size - pos)
+            {
+                ok = false;
+                return std::string();
+            }
+
+            const std::string value(reinterpret_cast<const char*>(data + pos), len);
+            pos += len;
+            return value;
+        }
+    };
+
+    struct Writer {
+        std::FILE* const file;
+        bool ok;
+
+        Writer(std::FILE* const f) noexcept
+            : file(f), ok(true) {}
+
+        void write(const void* const src, const size_t len) noexcept
+        {
+            if (ok && len != 0 && std::fwrite(src, len, 1, file) != 1)
+                ok = false;
+        }
+
+        void u32(const uint32_t value) noexcept { write(&value, sizeof(value)); }
+        void u64(const uint64_t value) noexcept { write(&value, sizeof(value)); }
+
+        void str(const char* const value) noexcept
+        {
+            const size_t len = std::strlen(value);
+            u32(static_cast<uint32_t>(len));
+            write(value, len);
+        }
+    };
+
+    void loadDatabase()
+    {
+        std::FILE* const file = std::fopen(fDatabaseFile, "rb");
+
+        if (file == nullptr)
+            return;
+
+        std::vector<uint8_t> data;
+        long size = 0;
+
+        if (std::fseek(file, 0, SEEK_END) == 0 && (size = std::ftell(file)) > 0 && std::fseek(file, 0, SEEK_SET) == 0)
+        {
+            data.resize(static_cast<size_t>(size));
+
+            if (std::fread(&data[0], data.size(), 1, file) != 1)
+                data.clear();
+        }
+
+        std::fclose(file);
+
+        if (data.empty())
+            return;
+
+        Reader r(&data[0], data.size());
+
+        char magic[4];
+        r.read(magic, 4);
+
+        if (! r.ok || std::memcmp(magic, "CDSC", 4) != 0 || r.u32() != kDatabaseVersion)
+            return;
+
+        // a different or updated tool might find different things
+        if (r.str() != fTool.buffer() || r.u64() != fToolSize || static_cast<int64_t>(r.u64()) != fToolTime)
+            return;
+        if (r.u32() != static_cast<uint32_t>(fType))
+            return;
+
+        CheckedFileMap database;
+
+        for (uint32_t i=0, count=r.count(); i < count && r.ok; ++i)
+        {
+            const std::string filename(r.str());
+
+            CheckedFile checked;
+            checked.size  = r.u64();
+            checked.mtime = static_cast<int64_t>(r.u64());
+
+            for (uint32_t j=0, pcount=r.count(); j < pcount && r.ok; ++j)
+            {
+                DiscoveredPlugin plugin;
+                plugin.btype         = static_cast<CB::BinaryType>(r.u32());
+                plugin.category      = static_cast<CB::PluginCategory>(r.u32());
+                plugin.hints         = r.u32();
+                plugin.audioIns      = r.u32();
+                plugin.audioOuts     = r.u32();
+                plugin.cvIns         = r.u32();
+                plugin.cvOuts        = r.u32();
+                plugin.midiIns       = r.u32();
+                plugin.midiOuts      = r.u32();
+                plugin.parameterIns  = r.u32();
+                plugin.parameterOuts = r.u32();
+                plugin.uniqueId      = static_cast<int64_t>(r.u64());
+                plugin.filename      = r.str().c_str();
+                plugin.name          = r.str().c_str();
+                plugin.label         = r.str().c_str();
+                plugin.maker         = r.str().c_str();
+                checked.plugins.push_back(plugin);
+            }
+
+            database[filename] = checked;
+        }
+
+        if (r.ok)
+            fDatabase.swap(database);
+    }
+
+    // merges this scan's results into the database, files not part of this scan are kept
+    void saveDatabase()
+    {
+        const CarlaMutexLocker cml(fMutex);
+
+        for (size_t i=0, count=fResults.size(); i < count; ++i)
+        {
+            if (fResults[i].state == kResultChecked)
+                fDatabase[fFilenames[i]] = fResults[i].file;
+        }
+
+        try {
+            const water::File dir(water::File(fDatabaseFile.buffer()).getParentDirectory());
+
+            if (! dir.isDirectory())
+                dir.createDirectory();
+        } CARLA_SAFE_EXCEPTION_RETURN("PluginDiscovery::saveDatabase",);
+
+        char tmpSuffix[32];
+#ifdef CARLA_OS_WIN
+        std::snprintf(tmpSuffix, 31, ".%i.tmp", _getpid());
+#else
+        std::snprintf(tmpSuffix, 31, ".%i.tmp", getpid());
+#endif
+        tmpSuffix[31] = '\0';
+
+        const CarlaString tmpFilename(fDatabaseFile + tmpSuffix);
+
+        std::FILE* const file = std::fopen(tmpFilename, "wb");
+        CARLA_SAFE_ASSERT_RETURN(file != nullptr,);
+
+        Writer w(file);
+        w.write("CDSC", 4);
+        w.u32(kDatabaseVersion);
+        w.str(fTool);
+        w.u64(fToolSize);
+        w.u64(static_cast<uint64_t>(fToolTime));
+        w.u32(static_cast<uint32_t>(fType));
+        w.u32(static_cast<uint32_t>(fDatabase.size()));
+
+        for (CheckedFileMap::const_iterator it = fDatabase.begin(); it != fDatabase.end(); ++it)
+        {
+            const CheckedFile& checked(it->second);
+
+            w.str(it->first.c_str());
+            w.u64(checked.size);
+            w.u64(static_cast<uint64_t>(checked.mtime));
+            w.u32(static_cast<uint32_t>(checked.plugins.size()));
+
+            for (std::vector<DiscoveredPlugin>::const_iterator pit = checked.plugins.begin();
+                 pit != checked.plugins.end(); ++pit)
+            {
+                w.u32(static_cast<uint32_t>(pit->btype));
+                w.u32(static_cast<uint32_t>(pit->category));
+                w.u32(pit->hints);
+                w.u32(pit->audioIns);
+                w.u32(pit->audioOuts);
+                w.u32(pit->cvIns);
+                w.u32(pit->cvOuts);
+                w.u32(pit->midiIns);
+                w.u32(pit->midiOuts);
+                w.u32(pit->parameterIns);
+                w.u32(pit->parameterOuts);
+                w.u64(static_cast<uint64_t>(pit->uniqueId));
+                w.str(pit->filename);
+                w.str(pit->name);
+                w.str(pit->label);
+                w.str(pit->maker);
+            }
+        }
+
+        const bool ok = std::fclose(file) == 0 && w.ok;
+
+#ifdef CARLA_OS_WIN
+        if (ok)
+            std::remove(fDatabaseFile);
+#endif
+        if (! ok || std::rename(tmpFilename, fDatabaseFile) != 0)
+            std::remove(tmpFilename);
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(PluginDiscovery)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+
+CarlaPluginDiscoveryHandle carla_plugin_discovery_start(const char* const discoveryTool, const PluginType ptype,
+                                                        const char* const* const filenames,
+                                                        const uint workerCount, const uint timeoutMs,
+                                                        const char* const databaseFile)
+{
+    CARLA_SAFE_ASSERT_RETURN(discoveryTool != nullptr && discoveryTool[0] != '\0', nullptr);
+    CARLA_SAFE_ASSERT_RETURN(filenames != nullptr, nullptr);
+    CARLA_SAFE_ASSERT_RETURN(timeoutMs != 0, nullptr);
+    carla_debug("carla_plugin_discovery_start(\"%s\", %i:%s, %p, %u, %u, \"%s\")",
+                discoveryTool, ptype, CB::PluginType2Str(ptype), filenames, workerCount, timeoutMs, databaseFile);
+
+    PluginDiscovery* discovery = nullptr;
+
+    try {
+        discovery = new PluginDiscovery(discoveryTool, ptype, filenames, timeoutMs, databaseFile);
+        discovery->start(workerCount);
+    } catch(...) {
+        carla_safe_exception("carla_plugin_discovery_start", __FILE__, __LINE__);
+        delete discovery;
+        return nullptr;
+    }
+
+    return discovery;
+}
+
+uint carla_plugin_discovery_get_checked_count(CarlaPluginDiscoveryHandle handle)
+{
+    CARLA_SAFE_ASSERT_RETURN(handle != nullptr, 0);
+
+    return ((PluginDiscovery*)handle)->getCheckedCount();
+}
+
+bool carla_plugin_discovery_is_finished(CarlaPluginDiscoveryHandle handle)
+{
+    CARLA_SAFE_ASSERT_RETURN(handle != nullptr, true);
+
+    return ((PluginDiscovery*)handle)->isFinished();
+}
+
+uint carla_plugin_discovery_get_plugin_count(CarlaPluginDiscoveryHandle handle)
+{
+    CARLA_SAFE_ASSERT_RETURN(handle != nullptr, 0);
+
+    return ((PluginDiscovery*)handle)->getPluginCount();
+}
+
+const CarlaDiscoveredPluginInfo* carla_plugin_discovery_get_plugin_info(CarlaPluginDiscoveryHandle handle,
+                                                                        const uint index)
+{
+    CARLA_SAFE_ASSERT_RETURN(handle != nullptr, nullptr);
+
+    return ((PluginDiscovery*)handle)->getPluginInfo(index);
+}
+
+void carla_plugin_discovery_stop(CarlaPluginDiscoveryHandle handle)
+{
+    CARLA_SAFE_ASSERT_RETURN(handle != nullptr,);
+    carla_debug("carla_plugin_discovery_stop(%p)", handle);
+
+    delete (PluginDiscovery*)handle;
+}
+
+// -------------------------------------------------------------------------------------------------------------------
@@ -187,7 +187,7 @@ public:
         if (fPorts.numMidiIns > 0)
         {
             uint32_t engineEventIndex = 0;
-            carla_zeroStructs(pData->events.in, kMaxEngineEventInternalCount);
+            clearEngineEvents(pData->events.in, pData->events.inCount);
 
             for (uint32_t i=0; i < fPorts.numMidiIns; ++i)
             {
@@ -213,11 +213,13 @@ public:
                         break;
                 }
             }
+
+            pData->events.inCount = engineEventIndex;
         }
 
         if (fPorts.numMidiOuts > 0)
         {
-            carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+            clearEngineEvents(pData->events.out, pData->events.outCount);
         }
 
         if (fPlugin->tryLock(fIsOffline))
@@ -238,13 +240,13 @@ public:
                 uint8_t mdataTmp[EngineMidiEvent::kDataSize];
                 const uint8_t* mdataPtr;
 
-                for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+                for (uint32_t i=0; i < pData->events.outCount; ++i)
                 {
                     const EngineEvent& engineEvent(pData->events.out[i]);
 
                     /**/ if (engineEvent.type == kEngineEventTypeNull)
                     {
-                        break;
+                        continue;
                     }
                     else if (engineEvent.type == kEngineEventTypeControl)
                     {
@@ -467,6 +469,7 @@ protected:
 
     void handleUiShow() override
     {
+        fPlugin->markParameterOutputsChanged(kParameterOutputConsumerEngineThread);
         fPlugin->showCustomUI(true);
         fUI.isVisible = true;
     }
@@ -22,6 +22,8 @@
 #include "CarlaLv2Utils.hpp"
 #include "CarlaMIDI.h"
 #include "LinkedList.hpp"
+#include "Lv2RdfCache.hpp"
+#include "Lv2UridMap.hpp"
 
 #include "water/files/File.h"
 
@@ -29,9 +31,6 @@
 # include "CarlaMacUtils.hpp"
 #endif
 
-#include <string>
-#include <vector>
-
 #define URI_CARLA_ATOM_WORKER_IN   "http://kxstudio.sf.net/ns/carla/atomWorkerIn"
 #define URI_CARLA_ATOM_WORKER_RESP "http://kxstudio.sf.net/ns/carla/atomWorkerResp"
 #define URI_CARLA_PARAMETER_CHANGE "http://kxstudio.sf.net/ns/carla/parameterChange"
@@ -114,6 +113,13 @@ enum CarlaLv2URIDs {
     kUridCount
 };
 
+// Custom URIDs, kept in sync with the host
+static Lv2UridMap& getCustomUridMap() noexcept
+{
+    static Lv2UridMap sUridMap(kUridCount);
+    return sUridMap;
+}
+
 // LV2 Feature Ids
 enum CarlaLv2Features {
     // DSP features
@@ -280,11 +286,8 @@ public:
           fControlDesignatedPort(0),
           fLv2Options(),
           fUiOptions(),
-          fCustomURIDs(kUridCount, std::string("urn:null")),
           fExt()
     {
-        CARLA_SAFE_ASSERT(fCustomURIDs.size() == kUridCount);
-
         carla_zeroPointers(fFeatures, kFeatureCount+1);
 
         // ------------------------------------------------------------------------------------------------------------
@@ -453,7 +456,17 @@ public:
         // load plugin
 
         Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
-        lv2World.initIfNeeded(std::getenv("LV2_PATH"));
+
+        const char* lv2Path = std::getenv("LV2_PATH");
+
+        if (lv2Path == nullptr || lv2Path[0] == '\0')
+            lv2Path = LILV_DEFAULT_LV2_PATH;
+
+        // the host usually has this plugin cached already, no need to scan anything then
+        fRdfDescriptor = Lv2RdfCache::getInstance().load(pluginURI, lv2Path);
+
+        if (fRdfDescriptor == nullptr)
+            lv2World.initIfNeeded(lv2Path);
 
 #if 0
         Lilv::Node bundleNode(lv2World.new_file_uri(nullptr, uiBundle));
@@ -470,7 +483,9 @@ public:
         // ------------------------------------------------------------------------------------------------------------
         // get plugin from lv2_rdf (lilv)
 
-        fRdfDescriptor = lv2_rdf_new(pluginURI, false);
+        if (fRdfDescriptor == nullptr)
+            fRdfDescriptor = lv2_rdf_new(pluginURI, false);
+
         CARLA_SAFE_ASSERT_RETURN(fRdfDescriptor != nullptr, false);
 
         // ------------------------------------------------------------------------------------------------------------
@@ -763,10 +778,14 @@ public:
 
     void dspURIDReceived(const LV2_URID urid, const char* const uri) override
     {
-        CARLA_SAFE_ASSERT_RETURN(urid == fCustomURIDs.size(),);
+        CARLA_SAFE_ASSERT_RETURN(urid >= kUridCount,);
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0',);
 
-        fCustomURIDs.push_back(uri);
+        if (! getCustomUridMap().add(urid, uri))
+        {
+            const char* const ourURI(getCustomUridMap().unmap(urid));
+            carla_stderr2("UI :: wrong URI '%s' vs '%s'", ourURI != nullptr ? ourURI : kUnmapFallback, uri);
+        }
     }
 
     void uiOptionsChanged(const BridgeFormatOptions& opts) override
@@ -849,23 +868,12 @@ public:
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', kUridNull);
         carla_debug("CarlaLv2Client::getCustomURID(\"%s\")", uri);
 
-        const std::string    s_uri(uri);
-        const std::ptrdiff_t s_pos(std::find(fCustomURIDs.begin(), fCustomURIDs.end(), s_uri) - fCustomURIDs.begin());
-
-        if (s_pos <= 0 || s_pos >= INT32_MAX)
-            return kUridNull;
-
-        const LV2_URID urid     = static_cast<LV2_URID>(s_pos);
-        const LV2_URID uriCount = static_cast<LV2_URID>(fCustomURIDs.size());
+        Lv2UridMap& uridMap(getCustomUridMap());
 
-        if (urid < uriCount)
-            return urid;
+        const LV2_URID nextURID = uridMap.getNextURID();
+        const LV2_URID urid = uridMap.map(uri);
 
-        CARLA_SAFE_ASSERT(urid == uriCount);
-
-        fCustomURIDs.push_back(uri);
-
-        if (isPipeRunning())
+        if (urid >= nextURID && isPipeRunning())
             writeLv2UridMessage(urid, uri);
 
         return urid;
@@ -874,10 +882,12 @@ public:
     const char* getCustomURIDString(const LV2_URID urid) const noexcept
     {
         CARLA_SAFE_ASSERT_RETURN(urid != kUridNull, kUnmapFallback);
-        CARLA_SAFE_ASSERT_RETURN(urid < fCustomURIDs.size(), kUnmapFallback);
         carla_debug("CarlaLv2Client::getCustomURIDString(%i)", urid);
 
-        return fCustomURIDs[urid].c_str();
+        const char* const uri = getCustomUridMap().unmap(urid);
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr, kUnmapFallback);
+
+        return uri;
     }
 
     // ----------------------------------------------------------------------------------------------------------------
@@ -1057,7 +1067,6 @@ private:
     Lv2PluginOptions          fLv2Options;
 
     Options fUiOptions;
-    std::vector<std::string> fCustomURIDs;
 
     struct Extensions {
         const LV2_Options_Interface* options;
@@ -23,6 +23,7 @@ from abc import abstractmethod
 from platform import architecture
 from struct import pack
 from sys import platform, maxsize
+from time import monotonic
 
 # ---------------------------------------------------------------------------------------------------------------------
 # Imports (ctypes)
@@ -278,6 +279,11 @@ PLUGIN_OPTION_SEND_PROGRAM_CHANGES = 0x200
 # We always want notes enabled by default, not the contrary.
 PLUGIN_OPTION_SKIP_SENDING_NOTES = 0x400
 
+# Process bridged plugins one block ahead, without waiting for the bridge in the audio thread.
+# The extra block is reported as plugin latency.
+# This is off-by-default and only available for bridged plugins.
+PLUGIN_OPTION_PIPELINED_PROCESSING = 0x800
+
 # Special flag to indicate that plugin options are not yet set.
 # This flag exists because 0x0 as an option value is a valid one, so we need something else to indicate "null-ness".
 PLUGIN_OPTIONS_NULL = 0x10000
@@ -794,7 +800,7 @@ ENGINE_CALLBACK_SAMPLE_RATE_CHANGED = 34
 # A cancelable action has been started or stopped.
 # @a pluginId Plugin Id the action relates to, -1 for none
 # @a value1   1 for action started, 0 for stopped
-# @a valueStr Action name
+# @a valueStr Action name, started may be sent again with a new name to show progress
 ENGINE_CALLBACK_CANCELABLE_ACTION = 35
 
 # Project has finished loading.
@@ -1048,6 +1054,31 @@ ENGINE_OPTION_CLIENT_NAME_PREFIX = 34
 # Treat loaded plugins as standalone (that is, there is no host UI to manage them)
 ENGINE_OPTION_PLUGINS_ARE_STANDALONE = 35
 
+# Number of extra threads used to process independent plugins in parallel in patchbay mode.
+# Default is 0, meaning all plugins are processed serially in the audio thread.
+# @note Only applied when the engine starts
+ENGINE_OPTION_PATCHBAY_THREADS = 36
+
+# Number of threads used to instantiate plugins in parallel when loading a project.
+# Only LV2, LADSPA, internal, SFZ and bridged plugins are loaded this way, other formats stay on the main thread.
+# Default is 0, meaning all plugins are loaded one after the other.
+ENGINE_OPTION_LOADER_THREADS = 37
+
+# Minimum change of an output parameter, in thousandths of its range, before it is sent again as a control event.
+# Only applies to output parameters mapped to a MIDI CC.
+# Default is 0, meaning any change is sent.
+ENGINE_OPTION_CONTROL_OUTPUT_THRESHOLD = 38
+
+# Minimum time in milliseconds between two control events of the same output parameter.
+# Only applies to output parameters mapped to a MIDI CC, the latest value is sent once the time has passed.
+# Default is 0, meaning no limit.
+ENGINE_OPTION_CONTROL_OUTPUT_RATE_LIMIT = 39
+
+# Time in milliseconds a plugin's output must stay silent, while its input is silent, before it stops being processed.
+# Auto-suspended plugins are woken up as soon as they receive non-silent audio or any event.
+# Default is 0, meaning plugins are always processed.
+ENGINE_OPTION_AUTO_SUSPEND_TIME = 40
+
 # ---------------------------------------------------------------------------------------------------------------------
 # Engine Process Mode
 # Engine process mode.
@@ -1752,6 +1783,20 @@ class CarlaHostMeta():
     def patchbay_refresh(self, external):
         raise NotImplementedError
 
+    # Start a batch of internal patchbay changes.
+    # Connections, disconnections and added or removed plugins are applied together when the batch is committed,
+    # so that the internal graph is rebuilt only once for all of them.
+    # Batches can be nested, each call must be matched by patchbay_commit_batch().
+    # Only valid in patchbay engine mode, other modes will ignore this.
+    @abstractmethod
+    def patchbay_begin_batch(self):
+        raise NotImplementedError
+
+    # Commit a batch of internal patchbay changes started with patchbay_begin_batch().
+    @abstractmethod
+    def patchbay_commit_batch(self):
+        raise NotImplementedError
+
     # Start playback of the engine transport.
     @abstractmethod
     def transport_play(self):
@@ -1782,6 +1827,16 @@ class CarlaHostMeta():
     def get_transport_info(self):
         raise NotImplementedError
 
+    # Render the engine output offline into an audio file, as fast as possible.
+    # Covers the transport frames from startFrame up to, but not including, endFrame.
+    # The file format is taken from the filename extension, either ".wav" or ".flac".
+    # Only supported by the Dummy driver.
+    # Returns how many times faster than realtime the render went, or 0.0 on failure.
+    # @see get_last_error()
+    @abstractmethod
+    def render_to_file(self, filename, startFrame, endFrame):
+        raise NotImplementedError
+
     # Current number of plugins loaded.
     @abstractmethod
     def get_current_plugin_count(self):
@@ -1869,6 +1924,30 @@ class CarlaHostMeta():
     def export_plugin_lv2(self, pluginId, lv2path):
         raise NotImplementedError
 
+    # Freeze a plugin, rendering its output over a transport range into an audio file,
+    # which is then played back instead of processing it while the transport plays within that range.
+    # The engine is rendered offline in the background, with progress and cancelation through
+    # ENGINE_CALLBACK_CANCELABLE_ACTION, ENGINE_CALLBACK_UPDATE is sent once the plugin is frozen.
+    # Only supported by engine drivers that can render offline, currently the Dummy one.
+    # Changing parameters, programs or custom data of the plugin, or of its chain, unfreezes it.
+    # @param pluginId   Plugin
+    # @param filename   Path to the audio file to render into
+    # @param startFrame First transport frame to render
+    # @param endFrame   Transport frame to stop rendering at, not included
+    # @param chain      Also skip the plugins that only feed into this one while it plays back
+    # @see carla_unfreeze_plugin()
+    @abstractmethod
+    def freeze_plugin(self, pluginId, filename, startFrame, endFrame, chain):
+        raise NotImplementedError
+
+    # Unfreeze a plugin, going back to processing it.
+    # The audio file used for freezing is kept.
+    # @param pluginId Plugin
+    # @see carla_freeze_plugin()
+    @abstractmethod
+    def unfreeze_plugin(self, pluginId):
+        raise NotImplementedError
+
     # Get information from a plugin.
     # @param pluginId Plugin
     @abstractmethod
@@ -2379,6 +2458,12 @@ class CarlaHostNull(CarlaHostMeta):
     def patchbay_refresh(self, external):
         return False
 
+    def patchbay_begin_batch(self):
+        return
+
+    def patchbay_commit_batch(self):
+        return
+
     def transport_play(self):
         return
 
@@ -2397,6 +2482,9 @@ class CarlaHostNull(CarlaHostMeta):
     def get_transport_info(self):
         return PyCarlaTransportInfo
 
+    def render_to_file(self, filename, startFrame, endFrame):
+        return 0.0
+
     def get_current_plugin_count(self):
         return 0
 
@@ -2433,6 +2521,12 @@ class CarlaHostNull(CarlaHostMeta):
     def export_plugin_lv2(self, pluginId, lv2path):
         return False
 
+    def freeze_plugin(self, pluginId, filename, startFrame, endFrame, chain):
+        return False
+
+    def unfreeze_plugin(self, pluginId):
+        return False
+
     def get_plugin_info(self, pluginId):
         return PyCarlaPluginInfo
 
@@ -2700,6 +2794,12 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_patchbay_refresh.argtypes = (c_void_p, c_bool)
         self.lib.carla_patchbay_refresh.restype = c_bool
 
+        self.lib.carla_patchbay_begin_batch.argtypes = (c_void_p,)
+        self.lib.carla_patchbay_begin_batch.restype = None
+
+        self.lib.carla_patchbay_commit_batch.argtypes = (c_void_p,)
+        self.lib.carla_patchbay_commit_batch.restype = None
+
         self.lib.carla_transport_play.argtypes = (c_void_p,)
         self.lib.carla_transport_play.restype = None
 
@@ -2718,6 +2818,9 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_get_transport_info.argtypes = (c_void_p,)
         self.lib.carla_get_transport_info.restype = POINTER(CarlaTransportInfo)
 
+        self.lib.carla_render_to_file.argtypes = (c_void_p, c_char_p, c_uint64, c_uint64)
+        self.lib.carla_render_to_file.restype = c_double
+
         self.lib.carla_get_current_plugin_count.argtypes = (c_void_p,)
         self.lib.carla_get_current_plugin_count.restype = c_uint32
 
@@ -2755,6 +2858,12 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_export_plugin_lv2.argtypes = (c_void_p, c_uint, c_char_p)
         self.lib.carla_export_plugin_lv2.restype = c_bool
 
+        self.lib.carla_freeze_plugin.argtypes = (c_void_p, c_uint, c_char_p, c_uint64, c_uint64, c_bool)
+        self.lib.carla_freeze_plugin.restype = c_bool
+
+        self.lib.carla_unfreeze_plugin.argtypes = (c_void_p, c_uint)
+        self.lib.carla_unfreeze_plugin.restype = c_bool
+
         self.lib.carla_get_plugin_info.argtypes = (c_void_p, c_uint)
         self.lib.carla_get_plugin_info.restype = POINTER(CarlaPluginInfo)
 
@@ -3016,6 +3125,12 @@ class CarlaHostDLL(CarlaHostMeta):
     def patchbay_refresh(self, external):
         return bool(self.lib.carla_patchbay_refresh(self.handle, external))
 
+    def patchbay_begin_batch(self):
+        self.lib.carla_patchbay_begin_batch(self.handle)
+
+    def patchbay_commit_batch(self):
+        self.lib.carla_patchbay_commit_batch(self.handle)
+
     def transport_play(self):
         self.lib.carla_transport_play(self.handle)
 
@@ -3034,6 +3149,9 @@ class CarlaHostDLL(CarlaHostMeta):
     def get_transport_info(self):
         return structToDict(self.lib.carla_get_transport_info(self.handle).contents)
 
+    def render_to_file(self, filename, startFrame, endFrame):
+        return float(self.lib.carla_render_to_file(self.handle, filename.encode("utf-8"), startFrame, endFrame))
+
     def get_current_plugin_count(self):
         return int(self.lib.carla_get_current_plugin_count(self.handle))
 
@@ -3078,6 +3196,13 @@ class CarlaHostDLL(CarlaHostMeta):
     def export_plugin_lv2(self, pluginId, lv2path):
         return bool(self.lib.carla_export_plugin_lv2(self.handle, pluginId, lv2path.encode("utf-8")))
 
+    def freeze_plugin(self, pluginId, filename, startFrame, endFrame, chain):
+        return bool(self.lib.carla_freeze_plugin(self.handle, pluginId, filename.encode("utf-8"),
+                                                 startFrame, endFrame, chain))
+
+    def unfreeze_plugin(self, pluginId):
+        return bool(self.lib.carla_unfreeze_plugin(self.handle, pluginId))
+
     def get_plugin_info(self, pluginId):
         return structToDict(self.lib.carla_get_plugin_info(self.handle, pluginId).contents)
 
@@ -3299,6 +3424,7 @@ class PluginStoreInfo():
         self.customDataCount = 0
         self.customData      = []
         self.peaks = [0.0, 0.0, 0.0, 0.0]
+        self.peaksSubscribed = None
 
 # ---------------------------------------------------------------------------------------------------------------------
 # Carla Host object for plugins (using pipes)
@@ -3424,6 +3550,12 @@ class CarlaHostPlugin(CarlaHostMeta):
     def patchbay_refresh(self, external):
         return self.sendMsgAndSetError(["patchbay_refresh", external])
 
+    def patchbay_begin_batch(self):
+        self.sendMsg(["patchbay_begin_batch"])
+
+    def patchbay_commit_batch(self):
+        self.sendMsg(["patchbay_commit_batch"])
+
     def transport_play(self):
         self.sendMsg(["transport_play"])
 
@@ -3442,6 +3574,9 @@ class CarlaHostPlugin(CarlaHostMeta):
     def get_transport_info(self):
         return self.fTransportInfo
 
+    def render_to_file(self, filename, startFrame, endFrame):
+        return 0.0
+
     def get_current_plugin_count(self):
         return len(self.fPluginsInfo)
 
@@ -3486,6 +3621,14 @@ class CarlaHostPlugin(CarlaHostMeta):
         self.fLastError = "Operation unavailable in plugin version"
         return False
 
+    def freeze_plugin(self, pluginId, filename, startFrame, endFrame, chain):
+        self.fLastError = "Operation unavailable in plugin version"
+        return False
+
+    def unfreeze_plugin(self, pluginId):
+        self.fLastError = "Operation unavailable in plugin version"
+        return False
+
     def get_plugin_info(self, pluginId):
         return self.fPluginsInfo.get(pluginId, self.fFallbackPluginInfo).pluginInfo
 
@@ -3573,10 +3716,10 @@ class CarlaHostPlugin(CarlaHostMeta):
         return self.fPluginsInfo[pluginId].parameterValues[parameterId]
 
     def get_input_peak_value(self, pluginId, isLeft):
-        return self.fPluginsInfo[pluginId].peaks[0 if isLeft else 1]
+        return self._get_peaks(pluginId)[0 if isLeft else 1]
 
     def get_output_peak_value(self, pluginId, isLeft):
-        return self.fPluginsInfo[pluginId].peaks[2 if isLeft else 3]
+        return self._get_peaks(pluginId)[2 if isLeft else 3]
 
     def render_inline_display(self, pluginId, width, height):
         return None
@@ -3958,6 +4101,20 @@ class CarlaHostPlugin(CarlaHostMeta):
         if pluginInfo is not None:
             pluginInfo.peaks = [in1, in2, out1, out2]
 
+    # the engine only sends peaks for plugins we subscribe to, a subscription lasts about a second
+    def _get_peaks(self, pluginId):
+        pluginInfo = self.fPluginsInfo[pluginId]
+        now = monotonic()
+
+        if pluginInfo.peaksSubscribed is None or now - pluginInfo.peaksSubscribed >= 0.5:
+            # values from before a lapsed subscription are stale
+            if pluginInfo.peaksSubscribed is None or now - pluginInfo.peaksSubscribed >= 1.0:
+                pluginInfo.peaks = [0.0, 0.0, 0.0, 0.0]
+            pluginInfo.peaksSubscribed = now
+            self.sendMsg(["subscribe_peaks", pluginId])
+
+        return pluginInfo.peaks
+
     def _removePlugin(self, pluginId):
         pluginCountM1 = len(self.fPluginsInfo)-1
 
@@ -144,7 +144,8 @@ class CarlaHostOSC(CarlaHostQtPlugin):
 
         method = lines.pop(0)
 
-        if method == "set_engine_option":
+        # peaks are always sent over OSC
+        if method in ("set_engine_option", "subscribe_peaks"):
             return True
 
         if self.lo_target_tcp is None:
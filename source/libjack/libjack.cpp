@@ -1211,6 +1211,11 @@ bool CarlaJackAppClient::handleNonRtData()
             fShmNonRtClientControl.readUInt();
             break;
 
+        case kPluginBridgeNonRtClientSetChunkPool:
+        case kPluginBridgeNonRtClientSetChunkDataShm:
+            fShmNonRtClientControl.readULong();
+            break;
+
         case kPluginBridgeNonRtClientSetCtrlChannel:
             fShmNonRtClientControl.readShort();
             break;
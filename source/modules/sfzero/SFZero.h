@@ -21,6 +21,7 @@ END_JUCE_MODULE_DECLARATION
 #include "sfzero/SFZRegion.h"
 #include "sfzero/SFZSample.h"
 #include "sfzero/SFZSound.h"
+#include "sfzero/SFZStream.h"
 #include "sfzero/SFZSynth.h"
 #include "sfzero/SFZVoice.h"
 
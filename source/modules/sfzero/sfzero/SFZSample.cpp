@@ -21,7 +21,7 @@ extern "C" {
 namespace sfzero
 {
 
-bool Sample::load()
+bool Sample::load(double streamingPreloadSeconds)
 {
 #if 0
     static water::AudioFormatManager afm;
@@ -70,12 +70,54 @@ bool Sample::load()
         return false;
     }
 
+    // Fix for misinformation using libsndfile
+    if (info.frames % info.channels)
+        --info.frames;
+
     sampleRate_ = info.sample_rate;
-    sampleLength_ = info.frames/info.channels;
+    sampleLength_ = info.frames;
+    headLength_ = sampleLength_;
+    streaming_ = false;
     // TODO loopStart_, loopEnd_
 
+    // Keep only the head in memory if the rest of the file is long enough to be worth streaming.
+    // We read 4 frames past the head so interpolation never needs the stream for the first frame.
+    if (streamingPreloadSeconds > 0.0 && info.can_seek != 0)
+    {
+        const water::uint64 headLength = minimumHeadLength_ + static_cast<water::uint64>(streamingPreloadSeconds * sampleRate_);
+
+        if (headLength + 4 < sampleLength_)
+        {
+            headLength_ = headLength;
+            streaming_ = true;
+        }
+    }
+
+    if (! streaming_)
+    {
+        ad_close(handle);
+
+        // Fully loaded samples are shared with every other sound using the same file.
+        // The cache pads them with zeros, so interpolation can be done without checking for the edge all the time.
+        cached_ = CarlaSampleCache::getInstance().acquire(filename.toRawUTF8(), 0);
+
+        if (cached_ == nullptr)
+        {
+            carla_stderr2("sfzero::Sample::load() - failed to read complete file");
+            return false;
+        }
+
+        sampleRate_ = cached_->sampleRate;
+        sampleLength_ = headLength_ = cached_->frames;
+        buffer_ = new water::AudioSampleBuffer(cached_->buffers, cached_->channels,
+                                               static_cast<uint32_t>(cached_->frames + CarlaCachedSample::kPaddingFrames));
+        return true;
+    }
+
+    const int64_t numSamplesToRead = static_cast<int64_t>(headLength_ + 4) * info.channels;
+
     // read interleaved buffer
-    float* const rbuffer = (float*)std::calloc(1, sizeof(float)*info.frames);
+    float* const rbuffer = (float*)std::calloc(1, sizeof(float)*numSamplesToRead);
 
     if (rbuffer == nullptr)
     {
@@ -84,23 +126,17 @@ bool Sample::load()
         return false;
     }
 
-    // Fix for misinformation using libsndfile
-    if (info.frames % info.channels)
-        --info.frames;
-
-    const ssize_t r = ad_read(handle, rbuffer, info.frames);
-    if (r != info.frames)
+    const ssize_t r = ad_read(handle, rbuffer, numSamplesToRead);
+    if (r != numSamplesToRead)
     {
         if (r != 0)
-            carla_stderr2("sfzero::Sample::load() - failed to read complete file: " P_SSIZE " vs " P_INT64, r, info.frames);
+            carla_stderr2("sfzero::Sample::load() - failed to read complete file: " P_SSIZE " vs " P_INT64, r, numSamplesToRead);
+        std::free(rbuffer);
         ad_close(handle);
         return false;
     }
 
-    // NOTE: We add some extra samples, which will be filled with zeros,
-    // so interpolation can be done without having to check for the edge all the time.
-
-    buffer_ = new water::AudioSampleBuffer(info.channels, sampleLength_ + 4, true);
+    buffer_ = new water::AudioSampleBuffer(info.channels, headLength_ + 4, true);
 
     for (int i=info.channels; --i >= 0;)
         buffer_->copyFromInterleavedSource(i, rbuffer, r);
@@ -112,18 +148,54 @@ bool Sample::load()
     return true;
 }
 
-Sample::~Sample() { }
+Sample::~Sample()
+{
+  buffer_ = nullptr;
+  releaseCached();
+}
+
+void Sample::releaseCached()
+{
+  if (cached_ != nullptr)
+  {
+    CarlaSampleCache::getInstance().release(cached_);
+    cached_ = nullptr;
+  }
+}
+
+void Sample::setMinimumHeadLength(water::uint64 frames)
+{
+  if (frames > minimumHeadLength_)
+  {
+    minimumHeadLength_ = frames;
+  }
+}
 
 water::String Sample::getShortName() { return (file_.getFileName()); }
 
 void Sample::setBuffer(water::AudioSampleBuffer *newBuffer)
 {
   buffer_ = newBuffer;
-  sampleLength_ = buffer_->getNumSamples();
+  releaseCached();
+  sampleLength_ = headLength_ = buffer_->getNumSamples();
+  streaming_ = false;
 }
 
 water::AudioSampleBuffer *Sample::detachBuffer()
 {
+  if (cached_ != nullptr && buffer_ != nullptr)
+  {
+    // the caller owns the result, so it cannot keep pointing to shared data
+    water::AudioSampleBuffer *copy = new water::AudioSampleBuffer(buffer_->getNumChannels(), buffer_->getNumSamples(), false);
+    for (uint32_t i = 0; i < buffer_->getNumChannels(); ++i)
+    {
+      copy->copyFrom(i, 0, *buffer_, i, 0, buffer_->getNumSamples());
+    }
+    buffer_ = nullptr;
+    releaseCached();
+    return copy;
+  }
+
   return buffer_.release();
 }
 
@@ -12,6 +12,7 @@
 #include "water/buffers/AudioSampleBuffer.h"
 #include "water/files/File.h"
 
+#include "CarlaSampleCache.hpp"
 #include "CarlaScopeUtils.hpp"
 
 namespace sfzero
@@ -20,10 +21,13 @@ namespace sfzero
 class Sample
 {
 public:
-  explicit Sample(const water::File &fileIn) : file_(fileIn), buffer_(nullptr), sampleRate_(0), sampleLength_(0), loopStart_(0), loopEnd_(0) {}
+  explicit Sample(const water::File &fileIn) : file_(fileIn), buffer_(nullptr), sampleRate_(0), sampleLength_(0), loopStart_(0), loopEnd_(0),
+    minimumHeadLength_(0), headLength_(0), streaming_(false), cached_(nullptr) {}
   virtual ~Sample();
 
-  bool load();
+  // With a non-zero preload time, only the head of long samples is kept in memory and the
+  // rest is streamed from disk by the voices.
+  bool load(double streamingPreloadSeconds = 0.0);
 
   water::File getFile() { return (file_); }
   water::AudioSampleBuffer *getBuffer() { return (buffer_); }
@@ -36,6 +40,12 @@ public:
   water::uint64 getLoopStart() const { return loopStart_; }
   water::uint64 getLoopEnd() const { return loopEnd_; }
 
+  // Frames that must always be in memory (region offsets and loops), set before load().
+  void setMinimumHeadLength(water::uint64 frames);
+  // Frames available in the buffer, the stream starts from here.
+  water::uint64 getHeadLength() const { return headLength_; }
+  bool isStreaming() const { return streaming_; }
+
 #ifdef DEBUG
   void checkIfZeroed(const char *where);
 #endif
@@ -45,6 +55,11 @@ private:
   CarlaScopedPointer<water::AudioSampleBuffer> buffer_;
   double sampleRate_;
   water::uint64 sampleLength_, loopStart_, loopEnd_;
+  water::uint64 minimumHeadLength_, headLength_;
+  bool streaming_;
+  const CarlaCachedSample *cached_;
+
+  void releaseCached();
 
   CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Sample)
 };
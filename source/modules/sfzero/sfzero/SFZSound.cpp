@@ -82,13 +82,36 @@ void Sound::loadRegions()
   reader.read(file_);
 }
 
-void Sound::loadSamples(const LoadingIdleCallback& cb)
+void Sound::loadSamples(const LoadingIdleCallback& cb, double streamingPreloadSeconds)
 {
+    if (streamingPreloadSeconds > 0.0)
+    {
+        // Voices only read the stream going forward, so region offsets and loops must be in memory.
+        for (int i = regions_.size(); --i >= 0;)
+        {
+            Region* const region = regions_.getUnchecked(i);
+
+            if (region->sample == nullptr)
+                continue;
+
+            water::int64 headLength = region->offset;
+
+            if (region->loop_mode != Region::no_loop && region->loop_mode != Region::one_shot &&
+                region->loop_start < region->loop_end)
+            {
+                headLength = std::max(headLength, region->loop_end + 1);
+            }
+
+            if (headLength > 0)
+                region->sample->setMinimumHeadLength(static_cast<water::uint64>(headLength));
+        }
+    }
+
     for (water::HashMap<water::String, Sample *>::Iterator i(samples_); i.next();)
     {
         Sample* const sample = i.getValue();
 
-        if (sample->load())
+        if (sample->load(streamingPreloadSeconds))
         {
             carla_debug("Loaded sample '%s'", sample->getShortName().toRawUTF8());
             cb.callback(cb.callbackPtr);
@@ -100,6 +123,17 @@ void Sound::loadSamples(const LoadingIdleCallback& cb)
     }
 }
 
+bool Sound::hasStreamingSamples()
+{
+    for (water::HashMap<water::String, Sample *>::Iterator i(samples_); i.next();)
+    {
+        if (i.getValue()->isStreaming())
+            return true;
+    }
+
+    return false;
+}
+
 Region *Sound::getRegionFor(int note, int velocity, Region::Trigger trigger)
 {
   int numRegions = regions_.size();
@@ -42,7 +42,9 @@ public:
   void addUnsupportedOpcode(const water::String &opcode);
 
   virtual void loadRegions();
-  virtual void loadSamples(const LoadingIdleCallback& cb);
+  // A non-zero preload time enables disk streaming for samples longer than it.
+  virtual void loadSamples(const LoadingIdleCallback& cb, double streamingPreloadSeconds = 0.0);
+  bool hasStreamingSamples();
 
   Region *getRegionFor(int note, int velocity, Region::Trigger trigger = Region::attack);
   int getNumRegions();
@@ -0,0 +1,237 @@
+/*************************************************************************************
+ * Original code copyright (C) 2012 Steve Folta
+ * Converted to Juce module (C) 2016 Leo Olivers
+ * Forked from https://github.com/stevefolta/SFZero
+ * For license info please see the LICENSE file distributed with this source code
+ *************************************************************************************/
+
+#include "SFZStream.h"
+#include "SFZSample.h"
+
+extern "C" {
+#include "audio_decoder/ad.h"
+}
+
+namespace sfzero
+{
+
+static const int kFillFrameBits = 48;
+static const water::uint64 kFillFrameMask = (static_cast<water::uint64>(1) << kFillFrameBits) - 1;
+
+static inline water::uint64 packFillState(water::uint64 generation, water::uint64 frame)
+{
+  return (generation << kFillFrameBits) | (frame & kFillFrameMask);
+}
+
+SampleStream::SampleStream()
+    : ringL_(nullptr), ringR_(nullptr), sample_(nullptr), readPos_(0), generation_(0), fillState_(0),
+      fileHandle_(nullptr), fileSample_(nullptr), fileChannels_(0), fileFrame_(0), readBuffer_(nullptr)
+{
+}
+
+SampleStream::~SampleStream()
+{
+  closeFile();
+
+  delete[] ringL_;
+  delete[] ringR_;
+}
+
+void SampleStream::allocate()
+{
+  if (ringL_ != nullptr)
+  {
+    return;
+  }
+
+  ringL_ = new float[kRingSize];
+  ringR_ = new float[kRingSize];
+  carla_zeroFloats(ringL_, kRingSize);
+  carla_zeroFloats(ringR_, kRingSize);
+}
+
+void SampleStream::start(Sample *sample, water::uint64 startFrame)
+{
+  sample_ = sample;
+  readPos_ = startFrame;
+  fillState_ = packFillState(++generation_, startFrame);
+}
+
+void SampleStream::stop()
+{
+  sample_ = nullptr;
+  fillState_ = packFillState(++generation_, 0);
+}
+
+void SampleStream::setReadPosition(water::uint64 frame)
+{
+  // only the audio thread moves the read position, the reader just follows it
+  if (frame > readPos_.get())
+  {
+    readPos_ = frame;
+  }
+}
+
+water::uint64 SampleStream::getAvailableEnd() const
+{
+  // the reader only publishes for the current generation, so the frame part is always ours
+  return fillState_.get() & kFillFrameMask;
+}
+
+bool SampleStream::service()
+{
+  // the fill state is stored last on start(), reading it first gets a sample and read position at least as new
+  const water::uint64 fillState = fillState_.get();
+  Sample *const sample = sample_;
+  const water::uint64 readPos = readPos_.get();
+  const water::uint64 fillEnd = fillState & kFillFrameMask;
+
+  if (sample == nullptr)
+  {
+    return false;
+  }
+
+  if (sample != fileSample_)
+  {
+    closeFile();
+
+    struct adinfo info;
+    carla_zeroStruct(info);
+
+    fileSample_ = sample;
+    fileHandle_ = ad_open(sample->getFile().getFullPathName().toRawUTF8(), &info);
+
+    if (fileHandle_ == nullptr)
+    {
+      carla_stderr2("sfzero::SampleStream::service() - failed to open '%s'", sample->getShortName().toRawUTF8());
+      return false;
+    }
+
+    fileChannels_ = info.channels;
+    fileFrame_ = 0;
+    readBuffer_ = new float[kChunkSize * info.channels];
+  }
+
+  if (fileHandle_ == nullptr)
+  {
+    return false;
+  }
+
+  // never overwrite the ring slots the voice has not consumed yet
+  const water::uint64 fillFrom = std::max(fillEnd, readPos);
+  const water::uint64 fillLimit = std::min(readPos + kRingSize, sample->getSampleLength());
+
+  if (fillFrom >= fillLimit)
+  {
+    return false;
+  }
+
+  const water::uint64 frames = std::min(fillLimit - fillFrom, static_cast<water::uint64>(kChunkSize));
+
+  if (fileFrame_ != fillFrom)
+  {
+    if (ad_seek(fileHandle_, static_cast<int64_t>(fillFrom)) < 0)
+    {
+      return false;
+    }
+    fileFrame_ = fillFrom;
+  }
+
+  const ssize_t r = ad_read(fileHandle_, readBuffer_, frames * fileChannels_);
+
+  if (r <= 0)
+  {
+    return false;
+  }
+
+  const water::uint64 framesRead = static_cast<water::uint64>(r) / fileChannels_;
+  const int rightOffset = fileChannels_ > 1 ? 1 : 0;
+
+  for (water::uint64 i = 0; i < framesRead; ++i)
+  {
+    const water::uint64 slot = (fillFrom + i) & kRingMask;
+    ringL_[slot] = readBuffer_[i * fileChannels_];
+    ringR_[slot] = readBuffer_[i * fileChannels_ + rightOffset];
+  }
+
+  fileFrame_ += framesRead;
+
+  // fails if the voice restarted or stopped while reading, which drops this chunk
+  fillState_.compareAndSetBool(packFillState(fillState >> kFillFrameBits, fillFrom + framesRead), fillState);
+
+  return true;
+}
+
+void SampleStream::closeFile()
+{
+  if (fileHandle_ != nullptr)
+  {
+    ad_close(fileHandle_);
+    fileHandle_ = nullptr;
+  }
+
+  if (readBuffer_ != nullptr)
+  {
+    delete[] readBuffer_;
+    readBuffer_ = nullptr;
+  }
+
+  fileSample_ = nullptr;
+  fileChannels_ = 0;
+  fileFrame_ = 0;
+}
+
+StreamReader::StreamReader() : CarlaThread("SFZeroStreamReader"), streams_() {}
+
+StreamReader::~StreamReader()
+{
+  stopThread(-1);
+}
+
+void StreamReader::addStream(SampleStream *stream)
+{
+  CARLA_SAFE_ASSERT_RETURN(!isThreadRunning(),);
+
+  stream->allocate();
+  streams_.add(stream);
+}
+
+void StreamReader::clearStreams()
+{
+  CARLA_SAFE_ASSERT_RETURN(!isThreadRunning(),);
+
+  for (int i = streams_.size(); --i >= 0;)
+  {
+    streams_.getUnchecked(i)->closeFile();
+  }
+
+  streams_.clear();
+}
+
+void StreamReader::run()
+{
+  while (!shouldThreadExit())
+  {
+    bool didRead = false;
+
+    // round-robin, one chunk per stream, so a single busy voice does not starve the others
+    for (int i = streams_.size(); --i >= 0;)
+    {
+      if (streams_.getUnchecked(i)->service())
+      {
+        didRead = true;
+      }
+    }
+
+    if (!didRead)
+    {
+      carla_msleep(2);
+    }
+  }
+
+  for (int i = streams_.size(); --i >= 0;)
+  {
+    streams_.getUnchecked(i)->closeFile();
+  }
+}
+}
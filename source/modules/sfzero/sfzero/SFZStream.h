@@ -0,0 +1,98 @@
+/*************************************************************************************
+ * Original code copyright (C) 2012 Steve Folta
+ * Converted to Juce module (C) 2016 Leo Olivers
+ * Forked from https://github.com/stevefolta/SFZero
+ * For license info please see the LICENSE file distributed with this source code
+ *************************************************************************************/
+#ifndef SFZSTREAM_H_INCLUDED
+#define SFZSTREAM_H_INCLUDED
+
+#include "SFZCommon.h"
+
+#include "water/containers/Array.h"
+#include "water/memory/Atomic.h"
+
+#include "CarlaThread.hpp"
+
+namespace sfzero
+{
+
+class Sample;
+
+// Streams the part of a sample that comes after its preloaded head, for a single voice.
+// The ring buffer is indexed by absolute sample frame, the voice reads it from the audio
+// thread while StreamReader fills it from disk.
+// Nothing here locks, the fill end is published together with the voice generation so
+// the reader can drop chunks meant for a voice that was restarted or stopped meanwhile.
+class SampleStream
+{
+public:
+  enum
+  {
+    kRingSize = 32768,
+    kRingMask = kRingSize - 1,
+    kChunkSize = 4096
+  };
+
+  SampleStream();
+  ~SampleStream();
+
+  void allocate();
+  bool isAllocated() const { return ringL_ != nullptr; }
+
+  // Audio thread side.
+  void start(Sample *sample, water::uint64 startFrame);
+  void stop();
+  void setReadPosition(water::uint64 frame);
+  // Frames below the returned one (and not behind the read position) can be read.
+  water::uint64 getAvailableEnd() const;
+  const float *getRingL() const { return ringL_; }
+  const float *getRingR() const { return ringR_; }
+
+  // Reader thread side, returns true if some data was read.
+  bool service();
+  void closeFile();
+
+private:
+  float *ringL_, *ringR_;
+
+  // written by the audio thread
+  Sample *volatile sample_;
+  water::Atomic<water::uint64> readPos_;
+  water::uint64 generation_;
+
+  // generation in the upper bits and fill end frame in the lower ones,
+  // set by the audio thread on start/stop and advanced by the reader thread
+  water::Atomic<water::uint64> fillState_;
+
+  // reader thread only
+  void *fileHandle_;
+  Sample *fileSample_;
+  int fileChannels_;
+  water::uint64 fileFrame_;
+  float *readBuffer_;
+
+  CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleStream)
+};
+
+// Background disk thread feeding the streams of all voices in a synth.
+class StreamReader : public CarlaThread
+{
+public:
+  StreamReader();
+  ~StreamReader() override;
+
+  void addStream(SampleStream *stream);
+  void clearStreams();
+
+protected:
+  void run() override;
+
+private:
+  water::Array<SampleStream *> streams_;
+
+  CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StreamReader)
+};
+}
+
+#endif // SFZSTREAM_H_INCLUDED
@@ -12,11 +12,17 @@
 namespace sfzero
 {
 
-Synth::Synth() : Synthesiser()
+Synth::Synth() : Synthesiser(), streamReader_()
 {
     carla_zeroStructs(noteVelocities_, 128);
 }
 
+Synth::~Synth()
+{
+    // the reader thread uses our voices and samples, stop it before they go away
+    stopStreaming();
+}
+
 void Synth::noteOn(int midiChannel, int midiNoteNumber, float velocity)
 {
   int i;
@@ -172,4 +178,30 @@ water::String Synth::voiceInfoString()
   return lines.joinIntoString("\n");
 }
 
+void Synth::startStreaming()
+{
+  if (streamReader_.isThreadRunning())
+  {
+    return;
+  }
+
+  streamReader_.clearStreams();
+
+  for (int i = voices.size(); --i >= 0;)
+  {
+    if (Voice *voice = dynamic_cast<Voice *>(voices.getUnchecked(i)))
+    {
+      streamReader_.addStream(&voice->getStream());
+    }
+  }
+
+  streamReader_.startThread();
+}
+
+void Synth::stopStreaming()
+{
+  streamReader_.stopThread(-1);
+  streamReader_.clearStreams();
+}
+
 }
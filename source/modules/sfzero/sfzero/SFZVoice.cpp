@@ -15,14 +15,133 @@
 
 #include <cmath>
 
+#if defined(__AVX__) || defined(__SSE2__)
+# include <immintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
 namespace sfzero
 {
 
 static const float globalGain = -1.0;
 
+// Longest stretch of frames rendered by a single kernel call.
+static const int kMaxSpanFrames = 128;
+
+// Linear interpolation and gain for a span of gathered frames, mixed into the output.
+static void renderSpanKernel(float *outL, float *outR, const float *curL, const float *nextL, const float *curR,
+                             const float *nextR, const float *alpha, const float *gains, float noteGainLeft,
+                             float noteGainRight, int frames)
+{
+  int i = 0;
+
+#if defined(__AVX__)
+  const __m256 one8 = _mm256_set1_ps(1.0f);
+  const __m256 half8 = _mm256_set1_ps(0.5f);
+  const __m256 noteGainLeft8 = _mm256_set1_ps(noteGainLeft);
+  const __m256 noteGainRight8 = _mm256_set1_ps(noteGainRight);
+
+  for (; i + 8 <= frames; i += 8)
+  {
+    const __m256 a = _mm256_loadu_ps(alpha + i);
+    const __m256 invA = _mm256_sub_ps(one8, a);
+    const __m256 g = _mm256_loadu_ps(gains + i);
+    __m256 l = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(curL + i), invA), _mm256_mul_ps(_mm256_loadu_ps(nextL + i), a));
+    __m256 r = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(curR + i), invA), _mm256_mul_ps(_mm256_loadu_ps(nextR + i), a));
+    l = _mm256_mul_ps(l, _mm256_mul_ps(noteGainLeft8, g));
+    r = _mm256_mul_ps(r, _mm256_mul_ps(noteGainRight8, g));
+
+    if (outR)
+    {
+      _mm256_storeu_ps(outL + i, _mm256_add_ps(_mm256_loadu_ps(outL + i), l));
+      _mm256_storeu_ps(outR + i, _mm256_add_ps(_mm256_loadu_ps(outR + i), r));
+    }
+    else
+    {
+      _mm256_storeu_ps(outL + i, _mm256_add_ps(_mm256_loadu_ps(outL + i), _mm256_mul_ps(_mm256_add_ps(l, r), half8)));
+    }
+  }
+#endif
+
+#if defined(__SSE2__)
+  const __m128 one4 = _mm_set1_ps(1.0f);
+  const __m128 half4 = _mm_set1_ps(0.5f);
+  const __m128 noteGainLeft4 = _mm_set1_ps(noteGainLeft);
+  const __m128 noteGainRight4 = _mm_set1_ps(noteGainRight);
+
+  for (; i + 4 <= frames; i += 4)
+  {
+    const __m128 a = _mm_loadu_ps(alpha + i);
+    const __m128 invA = _mm_sub_ps(one4, a);
+    const __m128 g = _mm_loadu_ps(gains + i);
+    __m128 l = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(curL + i), invA), _mm_mul_ps(_mm_loadu_ps(nextL + i), a));
+    __m128 r = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(curR + i), invA), _mm_mul_ps(_mm_loadu_ps(nextR + i), a));
+    l = _mm_mul_ps(l, _mm_mul_ps(noteGainLeft4, g));
+    r = _mm_mul_ps(r, _mm_mul_ps(noteGainRight4, g));
+
+    if (outR)
+    {
+      _mm_storeu_ps(outL + i, _mm_add_ps(_mm_loadu_ps(outL + i), l));
+      _mm_storeu_ps(outR + i, _mm_add_ps(_mm_loadu_ps(outR + i), r));
+    }
+    else
+    {
+      _mm_storeu_ps(outL + i, _mm_add_ps(_mm_loadu_ps(outL + i), _mm_mul_ps(_mm_add_ps(l, r), half4)));
+    }
+  }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+  const float32x4_t one4 = vdupq_n_f32(1.0f);
+  const float32x4_t half4 = vdupq_n_f32(0.5f);
+  const float32x4_t noteGainLeft4 = vdupq_n_f32(noteGainLeft);
+  const float32x4_t noteGainRight4 = vdupq_n_f32(noteGainRight);
+
+  for (; i + 4 <= frames; i += 4)
+  {
+    const float32x4_t a = vld1q_f32(alpha + i);
+    const float32x4_t invA = vsubq_f32(one4, a);
+    const float32x4_t g = vld1q_f32(gains + i);
+    float32x4_t l = vaddq_f32(vmulq_f32(vld1q_f32(curL + i), invA), vmulq_f32(vld1q_f32(nextL + i), a));
+    float32x4_t r = vaddq_f32(vmulq_f32(vld1q_f32(curR + i), invA), vmulq_f32(vld1q_f32(nextR + i), a));
+    l = vmulq_f32(l, vmulq_f32(noteGainLeft4, g));
+    r = vmulq_f32(r, vmulq_f32(noteGainRight4, g));
+
+    if (outR)
+    {
+      vst1q_f32(outL + i, vaddq_f32(vld1q_f32(outL + i), l));
+      vst1q_f32(outR + i, vaddq_f32(vld1q_f32(outR + i), r));
+    }
+    else
+    {
+      vst1q_f32(outL + i, vaddq_f32(vld1q_f32(outL + i), vmulq_f32(vaddq_f32(l, r), half4)));
+    }
+  }
+#endif
+
+  for (; i < frames; ++i)
+  {
+    const float invA = 1.0f - alpha[i];
+    float l = curL[i] * invA + nextL[i] * alpha[i];
+    float r = curR[i] * invA + nextR[i] * alpha[i];
+    l *= noteGainLeft * gains[i];
+    r *= noteGainRight * gains[i];
+
+    if (outR)
+    {
+      outL[i] += l;
+      outR[i] += r;
+    }
+    else
+    {
+      outL[i] += (l + r) * 0.5f;
+    }
+  }
+}
+
 Voice::Voice()
     : region_(nullptr), curMidiNote_(0), curPitchWheel_(0), pitchRatio_(0), noteGainLeft_(0), noteGainRight_(0),
-      sourceSamplePosition_(0), sampleEnd_(0), loopStart_(0), loopEnd_(0), numLoops_(0), curVelocity_(0)
+      sourceSamplePosition_(0), sampleEnd_(0), loopStart_(0), loopEnd_(0), stream_(), streaming_(false), numLoops_(0),
+      curVelocity_(0)
 {
   ampeg_.setExponentialDecay(true);
 }
@@ -117,6 +236,26 @@ void Voice::startNote(int midiNoteNumber, float floatVelocity, water::Synthesise
     }
   }
   numLoops_ = 0;
+
+  // Stream.
+  const bool streaming = region_->sample->isStreaming() && stream_.isAllocated();
+  if (streaming)
+  {
+    stream_.start(region_->sample, region_->sample->getHeadLength());
+  }
+  else
+  {
+    if (streaming_)
+    {
+      stream_.stop();
+    }
+    if (region_->sample->isStreaming() && sampleEnd_ > static_cast<water::int64>(region_->sample->getHeadLength()))
+    {
+      // nobody is feeding our stream, only play what is in memory
+      sampleEnd_ = static_cast<water::int64>(region_->sample->getHeadLength());
+    }
+  }
+  streaming_ = streaming;
 }
 
 void Voice::stopNote(float /*velocity*/, bool allowTailOff)
@@ -164,6 +303,173 @@ void Voice::pitchWheelMoved(int newValue)
 
 void Voice::controllerMoved(int /*controllerNumber*/, int /*newValue*/) { /***/}
 void Voice::renderNextBlock(water::AudioSampleBuffer &outputBuffer, int startSample, int numSamples)
+{
+  while (numSamples > 0 && region_ != nullptr)
+  {
+    int done = renderSpan(outputBuffer, startSample, numSamples);
+
+    // loop points, buffer edges and underruns are left to the reference renderer
+    if (done == 0)
+    {
+      renderNextBlockReference(outputBuffer, startSample, 1);
+      done = 1;
+    }
+
+    startSample += done;
+    numSamples -= done;
+  }
+}
+
+// Render as many frames as possible that need no per-frame checks: all read from the same contiguous
+// source, none crosses the loop end or the sample end, and the EG stays on its segment until the last one.
+int Voice::renderSpan(water::AudioSampleBuffer &outputBuffer, int startSample, int numSamples)
+{
+  water::AudioSampleBuffer *buffer = region_->sample->getBuffer();
+  const int bufferNumSamples = buffer->getNumSamples();
+
+  double sourceSamplePosition = this->sourceSamplePosition_;
+  const int firstPos = static_cast<int>(sourceSamplePosition);
+
+  const float *inL, *inR;
+  int mask;
+  double dataLimit;
+
+  if (firstPos >= 0 && firstPos + 1 < bufferNumSamples)
+  {
+    inL = buffer->getReadPointer(0, 0);
+    inR = buffer->getNumChannels() > 1 ? buffer->getReadPointer(1, 0) : nullptr;
+    mask = -1;
+    dataLimit = bufferNumSamples - 1;
+  }
+  else if (streaming_)
+  {
+    const water::int64 streamAvailable = static_cast<water::int64>(stream_.getAvailableEnd());
+    if (firstPos + 1 >= streamAvailable)
+    {
+      return 0;
+    }
+    inL = stream_.getRingL();
+    inR = buffer->getNumChannels() > 1 ? stream_.getRingR() : nullptr;
+    mask = SampleStream::kRingMask;
+    dataLimit = static_cast<double>(streamAvailable - 1);
+  }
+  else
+  {
+    return 0;
+  }
+
+  const float loopStart = static_cast<float>(this->loopStart_);
+  const float loopEnd = static_cast<float>(this->loopEnd_);
+  const float sampleEnd = static_cast<float>(this->sampleEnd_);
+  const bool looping = loopStart < loopEnd;
+
+  double limit = std::min(dataLimit, static_cast<double>(sampleEnd));
+  if (looping)
+  {
+    limit = std::min(limit, static_cast<double>(loopEnd));
+  }
+
+  int samplesUntilNextAmpSegment = ampeg_.getSamplesUntilNextSegment();
+  int maxFrames = std::min(numSamples, kMaxSpanFrames);
+  if (samplesUntilNextAmpSegment < maxFrames)
+  {
+    // sustain uses INT_MAX here, so never add to it
+    maxFrames = samplesUntilNextAmpSegment + 1;
+  }
+
+  // Positions and EG levels are accumulated exactly like the reference renderer does.
+  int positions[kMaxSpanFrames];
+  float alpha[kMaxSpanFrames], gains[kMaxSpanFrames];
+  float ampegGain = ampeg_.getLevel();
+  const float ampegSlope = ampeg_.getSlope();
+  int frames = 0;
+
+  if (ampeg_.getSegmentIsExponential())
+  {
+    for (; frames < maxFrames && sourceSamplePosition < limit; ++frames)
+    {
+      const int pos = static_cast<int>(sourceSamplePosition);
+      positions[frames] = pos;
+      alpha[frames] = static_cast<float>(sourceSamplePosition - pos);
+      gains[frames] = ampegGain;
+      ampegGain *= ampegSlope;
+      sourceSamplePosition += pitchRatio_;
+    }
+  }
+  else
+  {
+    for (; frames < maxFrames && sourceSamplePosition < limit; ++frames)
+    {
+      const int pos = static_cast<int>(sourceSamplePosition);
+      positions[frames] = pos;
+      alpha[frames] = static_cast<float>(sourceSamplePosition - pos);
+      gains[frames] = ampegGain;
+      ampegGain += ampegSlope;
+      sourceSamplePosition += pitchRatio_;
+    }
+  }
+
+  if (frames == 0)
+  {
+    return 0;
+  }
+
+  float curL[kMaxSpanFrames], nextL[kMaxSpanFrames], curR[kMaxSpanFrames], nextR[kMaxSpanFrames];
+
+  for (int i = 0; i < frames; ++i)
+  {
+    curL[i] = inL[positions[i] & mask];
+    nextL[i] = inL[(positions[i] + 1) & mask];
+  }
+
+  if (inR)
+  {
+    for (int i = 0; i < frames; ++i)
+    {
+      curR[i] = inR[positions[i] & mask];
+      nextR[i] = inR[(positions[i] + 1) & mask];
+    }
+  }
+
+  float *outL = outputBuffer.getWritePointer(0, startSample);
+  float *outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
+
+  renderSpanKernel(outL, outR, curL, nextL, inR ? curR : curL, inR ? nextR : nextL, alpha, gains, noteGainLeft_,
+                   noteGainRight_, frames);
+
+  // Only the last frame can wrap around the loop, end the sample or the EG segment.
+  if (looping && (sourceSamplePosition > loopEnd))
+  {
+    sourceSamplePosition = loopStart;
+    numLoops_ += 1;
+  }
+
+  samplesUntilNextAmpSegment -= frames;
+  if (samplesUntilNextAmpSegment < 0)
+  {
+    ampeg_.setLevel(ampegGain);
+    ampeg_.nextSegment();
+    ampegGain = ampeg_.getLevel();
+    samplesUntilNextAmpSegment = ampeg_.getSamplesUntilNextSegment();
+  }
+
+  this->sourceSamplePosition_ = sourceSamplePosition;
+  ampeg_.setLevel(ampegGain);
+  ampeg_.setSamplesUntilNextSegment(samplesUntilNextAmpSegment);
+
+  if ((sourceSamplePosition >= sampleEnd) || ampeg_.isDone())
+  {
+    killNote();
+  }
+  else if (streaming_)
+  {
+    stream_.setReadPosition(static_cast<water::uint64>(sourceSamplePosition));
+  }
+
+  return frames;
+}
+
+void Voice::renderNextBlockReference(water::AudioSampleBuffer &outputBuffer, int startSample, int numSamples)
 {
   if (region_ == nullptr)
   {
@@ -190,10 +496,17 @@ void Voice::renderNextBlock(water::AudioSampleBuffer &outputBuffer, int startSam
   float loopEnd = static_cast<float>(this->loopEnd_);
   float sampleEnd = static_cast<float>(this->sampleEnd_);
 
+  // Frames past the head come from the stream, a snapshot of what the reader made available is enough.
+  const bool streaming = streaming_;
+  const water::int64 streamAvailable = streaming ? static_cast<water::int64>(stream_.getAvailableEnd()) : 0;
+  const water::int64 streamEnd = streaming ? static_cast<water::int64>(region_->sample->getSampleLength()) : 0;
+  const float *streamL = stream_.getRingL();
+  const float *streamR = stream_.getRingR();
+
   while (--numSamples >= 0)
   {
     const int pos = static_cast<int>(sourceSamplePosition);
-    CARLA_SAFE_ASSERT_CONTINUE(pos >= 0 && pos < bufferNumSamples); // leoo
+    CARLA_SAFE_ASSERT_CONTINUE(pos >= 0 && (pos < bufferNumSamples || streaming)); // leoo
 
     float alpha = static_cast<float>(sourceSamplePosition - pos);
     float invAlpha = 1.0f - alpha;
@@ -203,11 +516,47 @@ void Voice::renderNextBlock(water::AudioSampleBuffer &outputBuffer, int startSam
       nextPos = static_cast<int>(loopStart);
     }
 
+    float curL, curR;
+    if (pos < bufferNumSamples)
+    {
+      curL = inL[pos];
+      curR = inR ? inR[pos] : curL;
+    }
+    else if (pos < streamAvailable)
+    {
+      curL = streamL[pos & SampleStream::kRingMask];
+      curR = inR ? streamR[pos & SampleStream::kRingMask] : curL;
+    }
+    else
+    {
+      // stream underrun, play silence but keep going
+      curL = curR = 0.0f;
+    }
+
     // Simple linear interpolation with buffer overrun check
-    float nextL = nextPos < bufferNumSamples ? inL[nextPos] : inL[pos];
-    float nextR = inR ? (nextPos < bufferNumSamples ? inR[nextPos] : inR[pos]) : nextL;
-    float l = (inL[pos] * invAlpha + nextL * alpha);
-    float r = inR ? (inR[pos] * invAlpha + nextR * alpha) : l;
+    float nextL, nextR;
+    if (nextPos < bufferNumSamples)
+    {
+      nextL = inL[nextPos];
+      nextR = inR ? inR[nextPos] : nextL;
+    }
+    else if (nextPos < streamAvailable)
+    {
+      nextL = streamL[nextPos & SampleStream::kRingMask];
+      nextR = inR ? streamR[nextPos & SampleStream::kRingMask] : nextL;
+    }
+    else if (streaming && nextPos >= streamEnd)
+    {
+      // same as the zero padding of fully loaded samples
+      nextL = nextR = 0.0f;
+    }
+    else
+    {
+      nextL = curL;
+      nextR = curR;
+    }
+    float l = (curL * invAlpha + nextL * alpha);
+    float r = inR ? (curR * invAlpha + nextR * alpha) : l;
 
     //// Simple linear interpolation, old version (possible buffer overrun with non-loop??)
     // float l = (inL[pos] * invAlpha + inL[nextPos] * alpha);
@@ -264,6 +613,10 @@ void Voice::renderNextBlock(water::AudioSampleBuffer &outputBuffer, int startSam
   }
 
   this->sourceSamplePosition_ = sourceSamplePosition;
+  if (streaming && region_ != nullptr)
+  {
+    stream_.setReadPosition(static_cast<water::uint64>(sourceSamplePosition));
+  }
   ampeg_.setLevel(ampegGain);
   ampeg_.setSamplesUntilNextSegment(samplesUntilNextAmpSegment);
 }
@@ -324,6 +677,11 @@ void Voice::calcPitchRatio()
 
 void Voice::killNote()
 {
+  if (streaming_)
+  {
+    stream_.stop();
+    streaming_ = false;
+  }
   region_ = nullptr;
   clearCurrentNote();
 }
@@ -9,6 +9,7 @@
 #define SFZVOICE_H_INCLUDED
 
 #include "SFZEG.h"
+#include "SFZStream.h"
 
 #include "water/synthesisers/Synthesiser.h"
 
@@ -31,6 +32,8 @@ public:
   void pitchWheelMoved(int newValue) override;
   void controllerMoved(int controllerNumber, int newValue) override;
   void renderNextBlock(water::AudioSampleBuffer &outputBuffer, int startSample, int numSamples) override;
+  // Plain per-frame renderer, the reference for the block renderer above.
+  void renderNextBlockReference(water::AudioSampleBuffer &outputBuffer, int startSample, int numSamples);
   bool isPlayingNoteDown();
   bool isPlayingOneShot();
 
@@ -42,6 +45,8 @@ public:
 
   water::String infoString();
 
+  SampleStream &getStream() { return stream_; }
+
 private:
   Region *region_;
   int curMidiNote_, curPitchWheel_;
@@ -51,11 +56,14 @@ private:
   EG ampeg_;
   water::int64 sampleEnd_;
   water::int64 loopStart_, loopEnd_;
+  SampleStream stream_;
+  bool streaming_;
 
   // Info only.
   int numLoops_;
   int curVelocity_;
 
+  int renderSpan(water::AudioSampleBuffer &outputBuffer, int startSample, int numSamples);
   void calcPitchRatio();
   void killNote();
   double fractionalMidiNoteInHz(double note, double freqOfA = 440.0);
@@ -26,8 +26,14 @@
 
 #include "CarlaMutex.hpp"
 
+namespace CarlaBackend {
+struct EngineEvent;
+}
+
 namespace water {
 
+using CarlaBackend::EngineEvent;
+
 //==============================================================================
 /**
     Base class for audio processing filters or plugins.
@@ -136,13 +142,15 @@ public:
         Also note that some hosts will occasionally decide to pass a buffer containing
         zero samples, so make sure that your algorithm can deal with that!
 
-        If the filter is receiving a midi input, then the midiMessages array will be filled
-        with the midi messages for this block. Each message's timestamp will indicate the
-        message's time, as a number of samples from the start of the block.
+        If the filter is receiving a midi input, then the events array will be filled
+        with the engine events for this block, sorted by time, which is a number of samples
+        from the start of the block. The array holds up to kMaxEngineEventInternalCount events,
+        the used part ends at the first kEngineEventTypeNull one.
 
-        Any messages left in the midi buffer when this method has finished are assumed to
-        be the filter's midi output. This means that your filter should be careful to
-        clear any incoming messages from the array if it doesn't want them to be passed-on.
+        Any events left in the array when this method has finished are assumed to
+        be the filter's midi output, and must also be sorted by time. This means that your
+        filter should be careful to clear any incoming events from the array if it doesn't
+        want them to be passed-on.
 
         Be very careful about what you do in this callback - it's going to be called by
         the audio thread, so any kind of interaction with the UI is absolutely
@@ -157,7 +165,7 @@ public:
     virtual void processBlockWithCV (AudioSampleBuffer& audioBuffer,
                                      const AudioSampleBuffer& cvInBuffer,
                                      AudioSampleBuffer& cvOutBuffer,
-                                     MidiBuffer& midiMessages) = 0;
+                                     EngineEvent* events) = 0;
 
     //==============================================================================
     /** Returns the total number of input channels. */
@@ -20,13 +20,54 @@
 
 #include "AudioProcessorGraph.h"
 #include "../containers/SortedSet.h"
+#include "../memory/Atomic.h"
+
+#include "CarlaEngineUtils.hpp"
+#include "CarlaSemUtils.hpp"
+#include "CarlaThread.hpp"
 
 namespace water {
 
+using CarlaBackend::kMaxEngineEventInternalCount;
+
 //==============================================================================
 namespace GraphRenderingOps
 {
 
+//==============================================================================
+/** A shared MIDI buffer, engine events sorted by time until the first null one. */
+typedef HeapBlock<EngineEvent> EngineEventBuffer;
+
+//==============================================================================
+/** Lists the shared rendering buffers an op reads from and writes to.
+    Used to find which ops can safely run at the same time in parallel mode.
+*/
+struct BufferUsage
+{
+    Array<int> reads, writes;
+
+    void read (const AudioProcessor::ChannelType channelType, const int index)
+    {
+        reads.addIfNotAlreadyThere (getResourceId (channelType, index));
+    }
+
+    void write (const AudioProcessor::ChannelType channelType, const int index)
+    {
+        writes.addIfNotAlreadyThere (getResourceId (channelType, index));
+    }
+
+    // graph-level in/out buffers, accessed by the io processors
+    void writeExternal (const int ioType)
+    {
+        writes.addIfNotAlreadyThere (-1 - ioType);
+    }
+
+    static int getResourceId (const AudioProcessor::ChannelType channelType, const int index) noexcept
+    {
+        return index * 3 + static_cast<int> (channelType);
+    }
+};
+
 struct AudioGraphRenderingOpBase
 {
     AudioGraphRenderingOpBase() noexcept {}
@@ -34,8 +75,12 @@ struct AudioGraphRenderingOpBase
 
     virtual void perform (AudioSampleBuffer& sharedAudioBufferChans,
                           AudioSampleBuffer& sharedCVBufferChans,
-                          const OwnedArray<MidiBuffer>& sharedMidiBuffers,
+                          const OwnedArray<EngineEventBuffer>& sharedMidiBuffers,
                           const int numSamples) = 0;
+
+    virtual void getBufferUsage (BufferUsage& usage) const = 0;
+
+    virtual bool isProcessBufferOp() const noexcept { return false; }
 };
 
 // use CRTP
@@ -44,7 +89,7 @@ struct AudioGraphRenderingOp  : public AudioGraphRenderingOpBase
 {
     void perform (AudioSampleBuffer& sharedAudioBufferChans,
                   AudioSampleBuffer& sharedCVBufferChans,
-                  const OwnedArray<MidiBuffer>& sharedMidiBuffers,
+                  const OwnedArray<EngineEventBuffer>& sharedMidiBuffers,
                   const int numSamples) override
     {
         static_cast<Child*> (this)->perform (sharedAudioBufferChans,
@@ -62,7 +107,7 @@ struct ClearChannelOp  : public AudioGraphRenderingOp<ClearChannelOp>
 
     void perform (AudioSampleBuffer& sharedAudioBufferChans,
                   AudioSampleBuffer& sharedCVBufferChans,
-                  const OwnedArray<MidiBuffer>&,
+                  const OwnedArray<EngineEventBuffer>&,
                   const int numSamples)
     {
         if (isCV)
@@ -71,6 +116,11 @@ struct ClearChannelOp  : public AudioGraphRenderingOp<ClearChannelOp>
             sharedAudioBufferChans.clear (channelNum, 0, numSamples);
     }
 
+    void getBufferUsage (BufferUsage& usage) const override
+    {
+        usage.write (isCV ? AudioProcessor::ChannelTypeCV : AudioProcessor::ChannelTypeAudio, channelNum);
+    }
+
     const int channelNum;
     const bool isCV;
 
@@ -85,7 +135,7 @@ struct CopyChannelOp  : public AudioGraphRenderingOp<CopyChannelOp>
 
     void perform (AudioSampleBuffer& sharedAudioBufferChans,
                   AudioSampleBuffer& sharedCVBufferChans,
-                  const OwnedArray<MidiBuffer>&,
+                  const OwnedArray<EngineEventBuffer>&,
                   const int numSamples)
     {
         if (isCV)
@@ -94,6 +144,14 @@ struct CopyChannelOp  : public AudioGraphRenderingOp<CopyChannelOp>
             sharedAudioBufferChans.copyFrom (dstChannelNum, 0, sharedAudioBufferChans, srcChannelNum, 0, numSamples);
     }
 
+    void getBufferUsage (BufferUsage& usage) const override
+    {
+        const AudioProcessor::ChannelType channelType = isCV ? AudioProcessor::ChannelTypeCV
+                                                             : AudioProcessor::ChannelTypeAudio;
+        usage.read (channelType, srcChannelNum);
+        usage.write (channelType, dstChannelNum);
+    }
+
     const int srcChannelNum, dstChannelNum;
     const bool isCV;
 
@@ -108,7 +166,7 @@ struct AddChannelOp  : public AudioGraphRenderingOp<AddChannelOp>
 
     void perform (AudioSampleBuffer& sharedAudioBufferChans,
                   AudioSampleBuffer& sharedCVBufferChans,
-                  const OwnedArray<MidiBuffer>&,
+                  const OwnedArray<EngineEventBuffer>&,
                   const int numSamples)
     {
         if (isCV)
@@ -117,6 +175,14 @@ struct AddChannelOp  : public AudioGraphRenderingOp<AddChannelOp>
             sharedAudioBufferChans.addFrom (dstChannelNum, 0, sharedAudioBufferChans, srcChannelNum, 0, numSamples);
     }
 
+    void getBufferUsage (BufferUsage& usage) const override
+    {
+        const AudioProcessor::ChannelType channelType = isCV ? AudioProcessor::ChannelTypeCV
+                                                             : AudioProcessor::ChannelTypeAudio;
+        usage.read (channelType, srcChannelNum);
+        usage.write (channelType, dstChannelNum);
+    }
+
     const int srcChannelNum, dstChannelNum;
     const bool isCV;
 
@@ -129,10 +195,15 @@ struct ClearMidiBufferOp  : public AudioGraphRenderingOp<ClearMidiBufferOp>
     ClearMidiBufferOp (const int buffer) noexcept  : bufferNum (buffer)  {}
 
     void perform (AudioSampleBuffer&, AudioSampleBuffer&,
-                  const OwnedArray<MidiBuffer>& sharedMidiBuffers,
+                  const OwnedArray<EngineEventBuffer>& sharedMidiBuffers,
                   const int)
     {
-        sharedMidiBuffers.getUnchecked (bufferNum)->clear();
+        CarlaBackend::clearEngineEvents (*sharedMidiBuffers.getUnchecked (bufferNum));
+    }
+
+    void getBufferUsage (BufferUsage& usage) const override
+    {
+        usage.write (AudioProcessor::ChannelTypeMIDI, bufferNum);
     }
 
     const int bufferNum;
@@ -148,10 +219,17 @@ struct CopyMidiBufferOp  : public AudioGraphRenderingOp<CopyMidiBufferOp>
     {}
 
     void perform (AudioSampleBuffer&, AudioSampleBuffer&,
-                  const OwnedArray<MidiBuffer>& sharedMidiBuffers,
+                  const OwnedArray<EngineEventBuffer>& sharedMidiBuffers,
                   const int)
     {
-        *sharedMidiBuffers.getUnchecked (dstBufferNum) = *sharedMidiBuffers.getUnchecked (srcBufferNum);
+        CarlaBackend::copyEngineEvents (*sharedMidiBuffers.getUnchecked (dstBufferNum),
+                                        *sharedMidiBuffers.getUnchecked (srcBufferNum));
+    }
+
+    void getBufferUsage (BufferUsage& usage) const override
+    {
+        usage.read (AudioProcessor::ChannelTypeMIDI, srcBufferNum);
+        usage.write (AudioProcessor::ChannelTypeMIDI, dstBufferNum);
     }
 
     const int srcBufferNum, dstBufferNum;
@@ -167,11 +245,17 @@ struct AddMidiBufferOp  : public AudioGraphRenderingOp<AddMidiBufferOp>
     {}
 
     void perform (AudioSampleBuffer&, AudioSampleBuffer&,
-                  const OwnedArray<MidiBuffer>& sharedMidiBuffers,
-                  const int numSamples)
+                  const OwnedArray<EngineEventBuffer>& sharedMidiBuffers,
+                  const int)
     {
-        sharedMidiBuffers.getUnchecked (dstBufferNum)
-            ->addEvents (*sharedMidiBuffers.getUnchecked (srcBufferNum), 0, numSamples, 0);
+        CarlaBackend::mergeEngineEvents (*sharedMidiBuffers.getUnchecked (dstBufferNum),
+                                         *sharedMidiBuffers.getUnchecked (srcBufferNum));
+    }
+
+    void getBufferUsage (BufferUsage& usage) const override
+    {
+        usage.read (AudioProcessor::ChannelTypeMIDI, srcBufferNum);
+        usage.write (AudioProcessor::ChannelTypeMIDI, dstBufferNum);
     }
 
     const int srcBufferNum, dstBufferNum;
@@ -193,7 +277,7 @@ struct DelayChannelOp  : public AudioGraphRenderingOp<DelayChannelOp>
 
     void perform (AudioSampleBuffer& sharedAudioBufferChans,
                   AudioSampleBuffer& sharedCVBufferChans,
-                  const OwnedArray<MidiBuffer>&,
+                  const OwnedArray<EngineEventBuffer>&,
                   const int numSamples)
     {
         float* data = isCV
@@ -211,6 +295,11 @@ struct DelayChannelOp  : public AudioGraphRenderingOp<DelayChannelOp>
         }
     }
 
+    void getBufferUsage (BufferUsage& usage) const override
+    {
+        usage.write (isCV ? AudioProcessor::ChannelTypeCV : AudioProcessor::ChannelTypeAudio, channel);
+    }
+
 private:
     HeapBlock<float> buffer;
     const int channel, bufferSize;
@@ -249,7 +338,7 @@ struct ProcessBufferOp   : public AudioGraphRenderingOp<ProcessBufferOp>
 
     void perform (AudioSampleBuffer& sharedAudioBufferChans,
                   AudioSampleBuffer& sharedCVBufferChans,
-                  const OwnedArray<MidiBuffer>& sharedMidiBuffers,
+                  const OwnedArray<EngineEventBuffer>& sharedMidiBuffers,
                   const int numSamples)
     {
         HeapBlock<float*>& audioChannelsCopy = audioChannels;
@@ -282,12 +371,32 @@ struct ProcessBufferOp   : public AudioGraphRenderingOp<ProcessBufferOp>
         }
     }
 
+    void getBufferUsage (BufferUsage& usage) const override
+    {
+        for (uint i = 0; i < totalAudioChans; ++i)
+            usage.write (AudioProcessor::ChannelTypeAudio, audioChannelsToUse.getUnchecked (i));
+
+        for (uint i = 0; i < totalCVIns; ++i)
+            usage.read (AudioProcessor::ChannelTypeCV, cvInChannelsToUse.getUnchecked (i));
+
+        for (uint i = 0; i < totalCVOuts; ++i)
+            usage.write (AudioProcessor::ChannelTypeCV, cvOutChannelsToUse.getUnchecked (i));
+
+        usage.write (AudioProcessor::ChannelTypeMIDI, midiBufferToUse);
+
+        if (const AudioProcessorGraph::AudioGraphIOProcessor* const ioProc
+                = dynamic_cast<const AudioProcessorGraph::AudioGraphIOProcessor*> (processor))
+            usage.writeExternal (static_cast<int> (ioProc->getType()));
+    }
+
+    bool isProcessBufferOp() const noexcept override { return true; }
+
     void callProcess (AudioSampleBuffer& audioBuffer,
                       AudioSampleBuffer& cvInBuffer,
                       AudioSampleBuffer& cvOutBuffer,
-                      MidiBuffer& midiMessages)
+                      EngineEvent* const events)
     {
-        processor->processBlockWithCV (audioBuffer, cvInBuffer, cvOutBuffer, midiMessages);
+        processor->processBlockWithCV (audioBuffer, cvInBuffer, cvOutBuffer, events);
     }
 
     const AudioProcessorGraph::Node::Ptr node;
@@ -317,9 +426,11 @@ struct RenderingOpSequenceCalculator
 {
     RenderingOpSequenceCalculator (AudioProcessorGraph& g,
                                    const Array<AudioProcessorGraph::Node*>& nodes,
-                                   Array<void*>& renderingOps)
+                                   Array<void*>& renderingOps,
+                                   const bool reuseFreeBuffers = true)
         : graph (g),
           orderedNodes (nodes),
+          reuseBuffers (reuseFreeBuffers),
           totalLatency (0)
     {
         audioNodeIds.add ((uint32) zeroNodeID); // first buffer is read-only zeros
@@ -330,6 +441,8 @@ struct RenderingOpSequenceCalculator
 
         midiNodeIds.add ((uint32) zeroNodeID);
 
+        findConnectionReaders();
+
         for (int i = 0; i < orderedNodes.size(); ++i)
         {
             createRenderingOpsForNode (*orderedNodes.getUnchecked(i), renderingOps, i);
@@ -347,6 +460,8 @@ private:
     //==============================================================================
     AudioProcessorGraph& graph;
     const Array<AudioProcessorGraph::Node*>& orderedNodes;
+    // when false every op gets its own buffers, so independent nodes never share one
+    const bool reuseBuffers;
     Array<uint> audioChannels, cvChannels;
     Array<uint32> audioNodeIds, cvNodeIds, midiNodeIds;
 
@@ -358,6 +473,83 @@ private:
     Array<int> nodeDelays;
     int totalLatency;
 
+    // every connection, as the rendering step that reads it, sorted by source
+    struct ConnectionReader
+    {
+        int64 sourceKey;
+        int step;
+        uint destChannel;
+    };
+
+    struct ConnectionReaderSorter
+    {
+        static int compareElements (const ConnectionReader& first, const ConnectionReader& second) noexcept
+        {
+            return first.sourceKey < second.sourceKey ? -1 : (first.sourceKey > second.sourceKey ? 1 : 0);
+        }
+    };
+
+    Array<ConnectionReader> connectionReaders;
+
+    static int64 getSourceKey (const AudioProcessor::ChannelType channelType,
+                               const uint32 nodeId, const uint outputChannel) noexcept
+    {
+        return (static_cast<int64> (channelType) << 56)
+             | (static_cast<int64> (outputChannel & 0xffffff) << 32)
+             | static_cast<int64> (nodeId);
+    }
+
+    void findConnectionReaders()
+    {
+        // node ids, each with its rendering step in the low bits, sorted for lookups
+        Array<int64> steps;
+        steps.ensureStorageAllocated (orderedNodes.size());
+
+        for (int i = 0; i < orderedNodes.size(); ++i)
+            steps.add ((static_cast<int64> (orderedNodes.getUnchecked(i)->nodeId) << 32) | i);
+
+        steps.sort();
+
+        const int numConnections = static_cast<int> (graph.getNumConnections());
+        connectionReaders.ensureStorageAllocated (numConnections);
+
+        for (int i = 0; i < numConnections; ++i)
+        {
+            const AudioProcessorGraph::Connection* const c = graph.getConnection (i);
+            const int64 destKey = static_cast<int64> (c->destNodeId) << 32;
+
+            int start = 0;
+            int end = steps.size();
+
+            while (start < end)
+            {
+                const int halfway = (start + end) / 2;
+
+                if (steps.getUnchecked (halfway) < destKey)
+                    start = halfway + 1;
+                else
+                    end = halfway;
+            }
+
+            if (start == steps.size() || (steps.getUnchecked (start) >> 32) != static_cast<int64> (c->destNodeId))
+                continue;
+
+            const int step = static_cast<int> (steps.getUnchecked (start) & 0xffffffff);
+
+            if (c->destChannelIndex >= orderedNodes.getUnchecked (step)->getProcessor()->getTotalNumInputChannels (c->channelType))
+                continue;
+
+            ConnectionReader reader;
+            reader.sourceKey = getSourceKey (c->channelType, c->sourceNodeId, c->sourceChannelIndex);
+            reader.step = step;
+            reader.destChannel = c->destChannelIndex;
+            connectionReaders.add (reader);
+        }
+
+        ConnectionReaderSorter sorter;
+        connectionReaders.sort (sorter);
+    }
+
     int getNodeDelay (const uint32 nodeID) const        { return nodeDelays [nodeDelayIDs.indexOf (nodeID)]; }
 
     void setNodeDelay (const uint32 nodeID, const int latency)
@@ -802,6 +994,10 @@ private:
         if (numAudioOuts == 0)
             totalLatency = maxLatency;
 
+        // without audio the processor gets a dummy channel, don't let it be the shared read-only one
+        if (audioChannelsToUse.size() == 0 && ! reuseBuffers)
+            audioChannelsToUse.add (getFreeBuffer (AudioProcessor::ChannelTypeAudio));
+
         renderingOps.add (new ProcessBufferOp (&node,
                                                audioChannelsToUse,
                                                totalAudioChans,
@@ -816,29 +1012,29 @@ private:
         switch (channelType)
         {
         case AudioProcessor::ChannelTypeAudio:
-            for (int i = 1; i < audioNodeIds.size(); ++i)
+            for (int i = 1; reuseBuffers && i < audioNodeIds.size(); ++i)
                 if (audioNodeIds.getUnchecked(i) == freeNodeID)
                     return i;
 
-            audioNodeIds.add ((uint32) freeNodeID);
+            audioNodeIds.add ((uint32) (reuseBuffers ? freeNodeID : anonymousNodeID));
             audioChannels.add (0);
             return audioNodeIds.size() - 1;
 
         case AudioProcessor::ChannelTypeCV:
-            for (int i = 1; i < cvNodeIds.size(); ++i)
+            for (int i = 1; reuseBuffers && i < cvNodeIds.size(); ++i)
                 if (cvNodeIds.getUnchecked(i) == freeNodeID)
                     return i;
 
-            cvNodeIds.add ((uint32) freeNodeID);
+            cvNodeIds.add ((uint32) (reuseBuffers ? freeNodeID : anonymousNodeID));
             cvChannels.add (0);
             return cvNodeIds.size() - 1;
 
         case AudioProcessor::ChannelTypeMIDI:
-            for (int i = 1; i < midiNodeIds.size(); ++i)
+            for (int i = 1; reuseBuffers && i < midiNodeIds.size(); ++i)
                 if (midiNodeIds.getUnchecked(i) == freeNodeID)
                     return i;
 
-            midiNodeIds.add ((uint32) freeNodeID);
+            midiNodeIds.add ((uint32) (reuseBuffers ? freeNodeID : anonymousNodeID));
             return midiNodeIds.size() - 1;
         }
 
@@ -882,6 +1078,9 @@ private:
 
     void markAnyUnusedBuffersAsFree (const int stepIndex)
     {
+        if (! reuseBuffers)
+            return;
+
         for (int i = 0; i < audioNodeIds.size(); ++i)
         {
             if (isNodeBusy (audioNodeIds.getUnchecked(i))
@@ -914,19 +1113,34 @@ private:
                               const uint32 nodeId,
                               const uint outputChanIndex) const
     {
-        while (stepIndexToSearchFrom < orderedNodes.size())
+        const int64 sourceKey = getSourceKey (channelType, nodeId, outputChanIndex);
+
+        // find the first reader of this output
+        int start = 0;
+        int end = connectionReaders.size();
+
+        while (start < end)
+        {
+            const int halfway = (start + end) / 2;
+
+            if (connectionReaders.getReference (halfway).sourceKey < sourceKey)
+                start = halfway + 1;
+            else
+                end = halfway;
+        }
+
+        for (; start < connectionReaders.size(); ++start)
         {
-            const AudioProcessorGraph::Node* const node = (const AudioProcessorGraph::Node*) orderedNodes.getUnchecked (stepIndexToSearchFrom);
+            const ConnectionReader& reader (connectionReaders.getReference (start));
 
-            for (uint i = 0; i < node->getProcessor()->getTotalNumInputChannels(channelType); ++i)
-                if (i != inputChannelOfIndexToIgnore
-                        && graph.getConnectionBetween (channelType,
-                                                       nodeId, outputChanIndex,
-                                                       node->nodeId, i) != nullptr)
-                    return true;
+            if (reader.sourceKey != sourceKey)
+                break;
+
+            if (reader.step > stepIndexToSearchFrom)
+                return true;
 
-            inputChannelOfIndexToIgnore = (uint)-1;
-            ++stepIndexToSearchFrom;
+            if (reader.step == stepIndexToSearchFrom && reader.destChannel != inputChannelOfIndexToIgnore)
+                return true;
         }
 
         return false;
@@ -960,146 +1174,506 @@ private:
 };
 
 //==============================================================================
-// Holds a fast lookup table for checking which nodes are inputs to others.
-class ConnectionLookupTable
+struct ConnectionSorter
 {
-public:
-    explicit ConnectionLookupTable (const OwnedArray<AudioProcessorGraph::Connection>& connections)
+    static int compareElements (const AudioProcessorGraph::Connection* const first,
+                                const AudioProcessorGraph::Connection* const second) noexcept
+    {
+        if (first->sourceNodeId < second->sourceNodeId)                return -1;
+        if (first->sourceNodeId > second->sourceNodeId)                return 1;
+        if (first->destNodeId < second->destNodeId)                    return -1;
+        if (first->destNodeId > second->destNodeId)                    return 1;
+        if (first->sourceChannelIndex < second->sourceChannelIndex)    return -1;
+        if (first->sourceChannelIndex > second->sourceChannelIndex)    return 1;
+        if (first->destChannelIndex < second->destChannelIndex)        return -1;
+        if (first->destChannelIndex > second->destChannelIndex)        return 1;
+
+        return 0;
+    }
+};
+
+//==============================================================================
+static inline void relaxCpu() noexcept
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__ ("yield");
+#endif
+}
+
+//==============================================================================
+/** A fixed-size work-stealing deque of task indexes.
+
+    The owner pushes and pops at the bottom, other threads steal from the top.
+    Each task is pushed at most once per block and the deque is reset before
+    every block, so indexes never wrap around.
+*/
+struct TaskDeque
+{
+    TaskDeque (const int capacity)
+        : top (0),
+          bottom (0)
+    {
+        tasks.calloc ((size_t) jmax (1, capacity));
+    }
+
+    void reset() noexcept
+    {
+        top = 0;
+        bottom = 0;
+    }
+
+    void push (const int taskIndex) noexcept
     {
-        for (int i = 0; i < static_cast<int>(connections.size()); ++i)
+        const int32 b = bottom.get();
+        tasks[b] = taskIndex;
+        bottom = b + 1;
+    }
+
+    int pop() noexcept
+    {
+        const int32 b = bottom.get() - 1;
+        bottom = b;
+
+        const int32 t = top.get();
+
+        if (t > b)
         {
-            const AudioProcessorGraph::Connection* const c = connections.getUnchecked(i);
+            bottom = b + 1;
+            return -1;
+        }
 
-            int index;
-            Entry* entry = findEntry (c->destNodeId, index);
+        int taskIndex = tasks[b];
 
-            if (entry == nullptr)
-            {
-                entry = new Entry (c->destNodeId);
-                entries.insert (index, entry);
-            }
+        if (t == b)
+        {
+            // last task, race against thieves for it
+            if (! top.compareAndSetBool (t + 1, t))
+                taskIndex = -1;
 
-            entry->srcNodes.add (c->sourceNodeId);
+            bottom = b + 1;
         }
+
+        return taskIndex;
     }
 
-    bool isAnInputTo (const uint32 possibleInputId,
-                      const uint32 possibleDestinationId) const noexcept
+    int steal() noexcept
     {
-        return isAnInputToRecursive (possibleInputId, possibleDestinationId, entries.size());
+        const int32 t = top.get();
+        const int32 b = bottom.get();
+
+        if (t >= b)
+            return -1;
+
+        const int taskIndex = tasks[t];
+        return top.compareAndSetBool (t + 1, t) ? taskIndex : -1;
     }
 
 private:
-    //==============================================================================
-    struct Entry
+    HeapBlock<int> tasks;
+    Atomic<int32> top, bottom;
+
+    CARLA_DECLARE_NON_COPY_CLASS (TaskDeque)
+};
+
+//==============================================================================
+/** The rendering ops of a graph split into one task per node, plus the
+    dependencies between those tasks.
+
+    A task runs the ops that prepare a node's input buffers followed by the
+    node's own ProcessBufferOp. It depends on every earlier task that touches
+    one of its buffers in a conflicting way (read after write, write after read
+    or write after write), so every buffer sees exactly the same sequence of
+    operations as in serial mode and the output is bit-identical.
+*/
+struct ParallelRenderingSequence
+{
+    ParallelRenderingSequence (const Array<void*>& renderingOps, const int numThreads)
+        : ops (renderingOps),
+          numParticipants (numThreads + 1),
+          numTasksRemaining (0),
+          currentAudioBuffers (nullptr),
+          currentCVBuffers (nullptr),
+          currentMidiBuffers (nullptr),
+          currentNumSamples (0)
     {
-        explicit Entry (const uint32 destNodeId_) noexcept : destNodeId (destNodeId_) {}
+        // split ops into tasks, each ending with a node process
+        for (int i = 0, first = 0; i < ops.size(); ++i)
+        {
+            if (getOp (i)->isProcessBufferOp() || i + 1 == ops.size())
+            {
+                tasks.add (new Task (first, i + 1 - first));
+                first = i + 1;
+            }
+        }
 
-        const uint32 destNodeId;
-        SortedSet<uint32> srcNodes;
+        // find dependencies from the buffers each task uses
+        OwnedArray<BufferUsage> usages;
+        int numResources = 0;
 
-        CARLA_DECLARE_NON_COPY_CLASS (Entry)
-    };
+        for (int t = 0; t < getNumTasks(); ++t)
+        {
+            const Task* const task = tasks.getUnchecked (t);
+            BufferUsage* const usage = new BufferUsage();
+            usages.add (usage);
 
-    OwnedArray<Entry> entries;
+            for (int i = 0; i < task->numOps; ++i)
+                getOp (task->firstOp + i)->getBufferUsage (*usage);
 
-    bool isAnInputToRecursive (const uint32 possibleInputId,
-                               const uint32 possibleDestinationId,
-                               int recursionCheck) const noexcept
-    {
-        int index;
+            for (int i = 0; i < usage->reads.size(); ++i)
+                numResources = jmax (numResources, getResourceIndex (usage->reads.getUnchecked (i)) + 1);
+            for (int i = 0; i < usage->writes.size(); ++i)
+                numResources = jmax (numResources, getResourceIndex (usage->writes.getUnchecked (i)) + 1);
+        }
+
+        Array<int> lastWriter;
+        OwnedArray<Array<int> > readersSinceWrite;
 
-        if (const Entry* const entry = findEntry (possibleDestinationId, index))
+        for (int i = 0; i < numResources; ++i)
         {
-            const SortedSet<uint32>& srcNodes = entry->srcNodes;
+            lastWriter.add (-1);
+            readersSinceWrite.add (new Array<int>());
+        }
 
-            if (srcNodes.contains (possibleInputId))
-                return true;
+        for (int t = 0; t < getNumTasks(); ++t)
+        {
+            const BufferUsage& usage (*usages.getUnchecked (t));
+
+            for (int i = 0; i < usage.reads.size(); ++i)
+            {
+                const int resource = getResourceIndex (usage.reads.getUnchecked (i));
+
+                addDependency (lastWriter.getUnchecked (resource), t);
 
-            if (--recursionCheck >= 0)
+                if (! usage.writes.contains (usage.reads.getUnchecked (i)))
+                    readersSinceWrite.getUnchecked (resource)->add (t);
+            }
+
+            for (int i = 0; i < usage.writes.size(); ++i)
             {
-                for (int i = 0; i < srcNodes.size(); ++i)
-                    if (isAnInputToRecursive (possibleInputId, srcNodes.getUnchecked(i), recursionCheck))
-                        return true;
+                const int resource = getResourceIndex (usage.writes.getUnchecked (i));
+                Array<int>& readers (*readersSinceWrite.getUnchecked (resource));
+
+                addDependency (lastWriter.getUnchecked (resource), t);
+
+                for (int j = 0; j < readers.size(); ++j)
+                    addDependency (readers.getUnchecked (j), t);
+
+                lastWriter.set (resource, t);
+                readers.clearQuick();
             }
         }
 
-        return false;
+        for (int t = 0; t < getNumTasks(); ++t)
+            if (tasks.getUnchecked (t)->numDependencies == 0)
+                rootTasks.add (t);
+
+        for (int i = 0; i < numParticipants; ++i)
+            deques.add (new TaskDeque (getNumTasks()));
     }
 
-    Entry* findEntry (const uint32 destNodeId, int& insertIndex) const noexcept
+    int getNumParticipants() const noexcept     { return numParticipants; }
+    int getNumTasks() const noexcept            { return static_cast<int> (tasks.size()); }
+
+    /** Prepares the tasks for a new block, must be called before any participant runs. */
+    void prepare (AudioSampleBuffer& sharedAudioBufferChans,
+                  AudioSampleBuffer& sharedCVBufferChans,
+                  const OwnedArray<EngineEventBuffer>& sharedMidiBuffers,
+                  const int numSamples) noexcept
     {
-        Entry* result = nullptr;
+        currentAudioBuffers = &sharedAudioBufferChans;
+        currentCVBuffers    = &sharedCVBufferChans;
+        currentMidiBuffers  = &sharedMidiBuffers;
+        currentNumSamples   = numSamples;
 
-        int start = 0;
-        int end = entries.size();
+        for (int i = 0; i < getNumTasks(); ++i)
+        {
+            Task* const task = tasks.getUnchecked (i);
+            task->pendingDependencies = task->numDependencies;
+        }
 
-        for (;;)
+        for (int i = 0; i < numParticipants; ++i)
+            deques.getUnchecked (i)->reset();
+
+        // roots go to the caller's deque, workers steal them from there
+        for (int i = 0; i < rootTasks.size(); ++i)
+            deques.getUnchecked (0)->push (rootTasks.getUnchecked (i));
+
+        numTasksRemaining = getNumTasks();
+    }
+
+    /** Runs tasks until all of the current block is done.
+        Participant 0 is the audio thread, the others are pool workers.
+    */
+    void run (const int participant) noexcept
+    {
+        TaskDeque& ownDeque (*deques.getUnchecked (participant));
+
+        while (numTasksRemaining.get() > 0)
         {
-            if (start >= end)
-            {
-                break;
-            }
-            else if (destNodeId == entries.getUnchecked (start)->destNodeId)
+            int taskIndex = ownDeque.pop();
+
+            for (int i = 1; taskIndex < 0 && i < numParticipants; ++i)
+                taskIndex = deques.getUnchecked ((participant + i) % numParticipants)->steal();
+
+            if (taskIndex < 0)
             {
-                result = entries.getUnchecked (start);
-                break;
+                relaxCpu();
+                continue;
             }
-            else
-            {
-                const int halfway = (start + end) / 2;
 
-                if (halfway == start)
-                {
-                    if (destNodeId >= entries.getUnchecked (halfway)->destNodeId)
-                        ++start;
+            Task* const task = tasks.getUnchecked (taskIndex);
 
-                    break;
-                }
-                else if (destNodeId >= entries.getUnchecked (halfway)->destNodeId)
-                    start = halfway;
-                else
-                    end = halfway;
+            for (int i = 0; i < task->numOps; ++i)
+                getOp (task->firstOp + i)->perform (*currentAudioBuffers, *currentCVBuffers,
+                                                    *currentMidiBuffers, currentNumSamples);
+
+            for (int i = 0; i < task->dependants.size(); ++i)
+            {
+                const int dependant = task->dependants.getUnchecked (i);
+
+                if (--tasks.getUnchecked (dependant)->pendingDependencies == 0)
+                    ownDeque.push (dependant);
             }
+
+            --numTasksRemaining;
         }
+    }
 
-        insertIndex = start;
-        return result;
+private:
+    struct Task
+    {
+        Task (const int first, const int count) noexcept
+            : firstOp (first), numOps (count), numDependencies (0), pendingDependencies (0) {}
+
+        const int firstOp, numOps;
+        int numDependencies;
+        Array<int> dependants;
+        Atomic<int32> pendingDependencies;
+
+        CARLA_DECLARE_NON_COPY_CLASS (Task)
+    };
+
+    const Array<void*> ops;
+    const int numParticipants;
+    OwnedArray<Task> tasks;
+    Array<int> rootTasks;
+    OwnedArray<TaskDeque> deques;
+    Atomic<int32> numTasksRemaining;
+
+    AudioSampleBuffer* currentAudioBuffers;
+    AudioSampleBuffer* currentCVBuffers;
+    const OwnedArray<EngineEventBuffer>* currentMidiBuffers;
+    int currentNumSamples;
+
+    AudioGraphRenderingOpBase* getOp (const int index) const noexcept
+    {
+        return static_cast<AudioGraphRenderingOpBase*> (ops.getUnchecked (index));
     }
 
-    CARLA_DECLARE_NON_COPY_CLASS (ConnectionLookupTable)
-};
+    // external resources use negative ids, shift everything so they fit in an array
+    static int getResourceIndex (const int resourceId) noexcept
+    {
+        return resourceId + 8;
+    }
 
-//==============================================================================
-struct ConnectionSorter
-{
-    static int compareElements (const AudioProcessorGraph::Connection* const first,
-                                const AudioProcessorGraph::Connection* const second) noexcept
+    void addDependency (const int dependency, const int dependant)
     {
-        if (first->sourceNodeId < second->sourceNodeId)                return -1;
-        if (first->sourceNodeId > second->sourceNodeId)                return 1;
-        if (first->destNodeId < second->destNodeId)                    return -1;
-        if (first->destNodeId > second->destNodeId)                    return 1;
-        if (first->sourceChannelIndex < second->sourceChannelIndex)    return -1;
-        if (first->sourceChannelIndex > second->sourceChannelIndex)    return 1;
-        if (first->destChannelIndex < second->destChannelIndex)        return -1;
-        if (first->destChannelIndex > second->destChannelIndex)        return 1;
+        if (dependency < 0 || dependency == dependant)
+            return;
 
-        return 0;
+        Task* const task = tasks.getUnchecked (dependency);
+
+        if (task->dependants.addIfNotAlreadyThere (dependant))
+            ++tasks.getUnchecked (dependant)->numDependencies;
     }
+
+    CARLA_DECLARE_NON_COPY_CLASS (ParallelRenderingSequence)
 };
 
 }
 
 //==============================================================================
-AudioProcessorGraph::Connection::Connection (ChannelType ct,
-                                             const uint32 sourceID, const uint sourceChannel,
-                                             const uint32 destID, const uint destChannel) noexcept
-    : channelType (ct),
-      sourceNodeId (sourceID), sourceChannelIndex (sourceChannel),
-      destNodeId (destID), destChannelIndex (destChannel)
+/** A pool of realtime worker threads, each pinned to its own CPU core.
+    The workers sleep until the audio thread hands them a block to render.
+*/
+class AudioProcessorGraph::RenderingThreadPool
 {
-}
+public:
+    RenderingThreadPool (const uint numThreads)
+        : currentSequence (nullptr),
+          workerGate (0)
+    {
+        for (uint i = 0; i < numThreads; ++i)
+        {
+            Worker* const worker = new Worker (*this, static_cast<int> (i) + 1);
+            workers.add (worker);
+            worker->startThread (true);
+        }
+    }
+
+    ~RenderingThreadPool()
+    {
+        for (int i = workers.size(); --i >= 0;)
+            workers.getUnchecked (i)->stopThread (-1);
+    }
+
+    int getNumThreads() const noexcept
+    {
+        return static_cast<int> (workers.size());
+    }
+
+    /** Renders one block using all workers plus the calling thread.
+        Returns as soon as all tasks are done, workers that wake up late find the gate closed and go back to sleep.
+    */
+    void perform (GraphRenderingOps::ParallelRenderingSequence& sequence,
+                  AudioSampleBuffer& sharedAudioBufferChans,
+                  AudioSampleBuffer& sharedCVBufferChans,
+                  const OwnedArray<GraphRenderingOps::EngineEventBuffer>& sharedMidiBuffers,
+                  const int numSamples) noexcept
+    {
+        // workers still inside the previous block only need to see it is done,
+        // wait for them to leave before resetting the tasks
+        waitForWorkersToLeave();
+
+        sequence.prepare (sharedAudioBufferChans, sharedCVBufferChans, sharedMidiBuffers, numSamples);
+
+        const int numWorkers = jmin (static_cast<int> (workers.size()), sequence.getNumParticipants() - 1);
+
+        currentSequence = &sequence;
+        workerGate = kGateOpen;
+
+        for (int i = 0; i < numWorkers; ++i)
+            workers.getUnchecked (i)->wakeUp();
+
+        sequence.run (0);
+
+        closeGate();
+    }
+
+    /** Waits for workers that entered the last block late to leave it.
+        Must be called before the sequence they were working on is reset or deleted.
+    */
+    void waitForWorkersToLeave() const noexcept
+    {
+        while (workerGate.get() != 0)
+            GraphRenderingOps::relaxCpu();
+    }
+
+private:
+    class Worker : public CarlaThread
+    {
+    public:
+        Worker (RenderingThreadPool& p, const int index)
+            : CarlaThread ("GraphRenderWorker"),
+              pool (p),
+              participant (index),
+              woken (0)
+        {
+            carla_sem_create2 (sem, false);
+        }
+
+        ~Worker() override
+        {
+            carla_sem_destroy2 (sem);
+        }
+
+        void wakeUp() noexcept
+        {
+            // a worker that did not wake up for the previous block is still posted
+            if (woken.compareAndSetBool (1, 0))
+                carla_sem_post (sem);
+        }
+
+    protected:
+        void run() override
+        {
+#ifdef CARLA_OS_LINUX
+            const long numCPUs = sysconf (_SC_NPROCESSORS_ONLN);
+
+            if (numCPUs > 1)
+            {
+                cpu_set_t cpuSet;
+                CPU_ZERO (&cpuSet);
+                CPU_SET (static_cast<int> (participant % numCPUs), &cpuSet);
+                pthread_setaffinity_np (pthread_self(), sizeof (cpuSet), &cpuSet);
+            }
+#endif
+
+            while (! shouldThreadExit())
+            {
+                if (! carla_sem_timedwait (sem, 100))
+                    continue;
+
+                woken = 0;
+
+                if (! pool.enterGate())
+                    continue;
+
+                pool.currentSequence->run (participant);
+                pool.leaveGate();
+            }
+        }
+
+    private:
+        RenderingThreadPool& pool;
+        const int participant;
+        carla_sem_t sem;
+        Atomic<int32> woken;
+
+        CARLA_DECLARE_NON_COPY_CLASS (Worker)
+    };
+
+    // the gate is open while a block is being rendered, the lower bits count the workers inside it
+    static const int32 kGateOpen = 0x40000000;
+
+    OwnedArray<Worker> workers;
+    GraphRenderingOps::ParallelRenderingSequence* volatile currentSequence;
+    Atomic<int32> workerGate;
+
+    bool enterGate() noexcept
+    {
+        for (;;)
+        {
+            const int32 gate = workerGate.get();
+
+            if ((gate & kGateOpen) == 0)
+                return false;
+
+            if (workerGate.compareAndSetBool (gate + 1, gate))
+                return true;
+        }
+    }
+
+    void leaveGate() noexcept
+    {
+        --workerGate;
+    }
+
+    void closeGate() noexcept
+    {
+        for (;;)
+        {
+            const int32 gate = workerGate.get();
+
+            if (workerGate.compareAndSetBool (gate & ~kGateOpen, gate))
+                return;
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS (RenderingThreadPool)
+};
+
+//==============================================================================
+AudioProcessorGraph::Connection::Connection (ChannelType ct,
+                                             const uint32 sourceID, const uint sourceChannel,
+                                             const uint32 destID, const uint destChannel) noexcept
+    : channelType (ct),
+      sourceNodeId (sourceID), sourceChannelIndex (sourceChannel),
+      destNodeId (destID), destChannelIndex (destChannel)
+{
+}
 
 //==============================================================================
 AudioProcessorGraph::Node::Node (const uint32 nodeID, AudioProcessor* const p) noexcept
@@ -1144,24 +1718,12 @@ struct AudioProcessorGraph::AudioProcessorGraphBufferHelpers
         : currentAudioInputBuffer (nullptr),
           currentCVInputBuffer (nullptr) {}
 
-    void setRenderingBufferSize (int newNumAudioChannels, int newNumCVChannels, int newNumSamples) noexcept
-    {
-        renderingAudioBuffers.setSize (newNumAudioChannels, newNumSamples);
-        renderingAudioBuffers.clear();
-
-        renderingCVBuffers.setSize (newNumCVChannels, newNumSamples);
-        renderingCVBuffers.clear();
-    }
-
     void release() noexcept
     {
-        renderingAudioBuffers.setSize (1, 1);
         currentAudioInputBuffer = nullptr;
         currentCVInputBuffer = nullptr;
         currentAudioOutputBuffer.setSize (1, 1);
         currentCVOutputBuffer.setSize (1, 1);
-
-        renderingCVBuffers.setSize (1, 1);
     }
 
     void prepareInOutBuffers (int newNumAudioChannels, int newNumCVChannels, int newNumSamples) noexcept
@@ -1172,18 +1734,361 @@ struct AudioProcessorGraph::AudioProcessorGraphBufferHelpers
         currentCVOutputBuffer.setSize (newNumCVChannels, newNumSamples);
     }
 
-    AudioSampleBuffer        renderingAudioBuffers;
-    AudioSampleBuffer        renderingCVBuffers;
     AudioSampleBuffer*       currentAudioInputBuffer;
     const AudioSampleBuffer* currentCVInputBuffer;
     AudioSampleBuffer        currentAudioOutputBuffer;
     AudioSampleBuffer        currentCVOutputBuffer;
 };
 
+//==============================================================================
+/*  Everything the audio thread needs to render one version of the graph.
+    buildRenderingSequence() prepares a new one and publishes it, then the audio
+    thread swaps it in at the start of its next block without taking any lock.
+*/
+struct AudioProcessorGraph::RenderingSequence
+{
+    RenderingSequence() noexcept
+        : parallelSequence (nullptr),
+          nextRetired (nullptr) {}
+
+    ~RenderingSequence()
+    {
+        delete parallelSequence;
+
+        for (int i = ops.size(); --i >= 0;)
+            delete static_cast<GraphRenderingOps::AudioGraphRenderingOpBase*> (ops.getUnchecked(i));
+    }
+
+    Array<void*> ops;
+    GraphRenderingOps::ParallelRenderingSequence* parallelSequence;
+    AudioSampleBuffer audioBuffers;
+    AudioSampleBuffer cvBuffers;
+    OwnedArray<GraphRenderingOps::EngineEventBuffer> midiBuffers;
+
+    // sequences the audio thread is done with are linked together until they get deleted
+    RenderingSequence* nextRetired;
+
+    CARLA_DECLARE_NON_COPY_CLASS (RenderingSequence)
+};
+
+//==============================================================================
+/*  Keeps the nodes in a topological order that is updated incrementally as
+    connections come and go, following Pearce and Kelly's dynamic topological
+    sort. Adding a connection only visits the nodes placed between its two ends,
+    so rebuilding the rendering sequence never has to re-sort the whole graph.
+
+    Connections that would close a feedback loop are kept aside and do not
+    affect the order, they get another try whenever a connection is removed.
+*/
+struct AudioProcessorGraph::NodeOrdering
+{
+    NodeOrdering() noexcept {}
+
+    void clear() noexcept
+    {
+        order.clear();
+        infos.clear();
+        feedbackConnections.clear();
+    }
+
+    void addNode (Node* const node)
+    {
+        int index;
+        CARLA_SAFE_ASSERT_RETURN (findInfo (node->nodeId, index) == nullptr,);
+
+        NodeInfo* const info = new NodeInfo (node, order.size());
+        infos.insert (index, info);
+        order.add (info);
+    }
+
+    void removeNode (const uint32 nodeId)
+    {
+        int index;
+        NodeInfo* const info = findInfo (nodeId, index);
+        CARLA_SAFE_ASSERT_RETURN (info != nullptr,);
+
+        // the graph disconnects a node before removing it, this only guards against leftovers
+        for (int i = info->outputs.size(); --i >= 0;)
+            info->outputs.getUnchecked(i)->inputs.removeAllInstancesOf (info);
+
+        for (int i = info->inputs.size(); --i >= 0;)
+            info->inputs.getUnchecked(i)->outputs.removeAllInstancesOf (info);
+
+        for (int i = feedbackConnections.size(); --i >= 0;)
+        {
+            const FeedbackConnection& fc (feedbackConnections.getReference(i));
+
+            if (fc.sourceNodeId == nodeId || fc.destNodeId == nodeId)
+                feedbackConnections.remove (i);
+        }
+
+        order.remove (info->position);
+
+        for (int i = info->position; i < order.size(); ++i)
+            order.getUnchecked(i)->position = i;
+
+        infos.remove (index);
+    }
+
+    void addConnection (const uint32 sourceNodeId, const uint32 destNodeId)
+    {
+        int index;
+        NodeInfo* const source = findInfo (sourceNodeId, index);
+        NodeInfo* const dest   = findInfo (destNodeId, index);
+        CARLA_SAFE_ASSERT_RETURN (source != nullptr && dest != nullptr,);
+
+        if (! insertEdge (source, dest))
+            feedbackConnections.add (FeedbackConnection (sourceNodeId, destNodeId));
+    }
+
+    void removeConnection (const uint32 sourceNodeId, const uint32 destNodeId)
+    {
+        int index;
+        NodeInfo* const source = findInfo (sourceNodeId, index);
+        NodeInfo* const dest   = findInfo (destNodeId, index);
+        CARLA_SAFE_ASSERT_RETURN (source != nullptr && dest != nullptr,);
+
+        if (source->outputs.contains (dest))
+        {
+            source->outputs.removeFirstMatchingValue (dest);
+            dest->inputs.removeFirstMatchingValue (source);
+
+            // this might have broken a loop, so a feedback connection can fit again
+            if (feedbackConnections.size() != 0)
+                retryFeedbackConnections();
+            return;
+        }
+
+        for (int i = feedbackConnections.size(); --i >= 0;)
+        {
+            const FeedbackConnection& fc (feedbackConnections.getReference(i));
+
+            if (fc.sourceNodeId == sourceNodeId && fc.destNodeId == destNodeId)
+            {
+                feedbackConnections.remove (i);
+                return;
+            }
+        }
+    }
+
+    int getNumNodes() const noexcept
+    {
+        return order.size();
+    }
+
+    Node* getNode (const int position) const noexcept
+    {
+        return order.getUnchecked (position)->node;
+    }
+
+private:
+    //==============================================================================
+    struct NodeInfo
+    {
+        NodeInfo (Node* const n, const int pos) noexcept
+            : node (n), nodeId (n->nodeId), position (pos), visited (false) {}
+
+        Node* const node;
+        const uint32 nodeId;
+        int position;
+        bool visited;
+
+        // one entry per connection, so the same node can appear more than once
+        Array<NodeInfo*> outputs, inputs;
+
+        CARLA_DECLARE_NON_COPY_CLASS (NodeInfo)
+    };
+
+    struct FeedbackConnection
+    {
+        FeedbackConnection() noexcept
+            : sourceNodeId (0), destNodeId (0) {}
+
+        FeedbackConnection (const uint32 src, const uint32 dst) noexcept
+            : sourceNodeId (src), destNodeId (dst) {}
+
+        uint32 sourceNodeId, destNodeId;
+    };
+
+    struct PositionSorter
+    {
+        static int compareElements (const NodeInfo* const first, const NodeInfo* const second) noexcept
+        {
+            return first->position - second->position;
+        }
+    };
+
+    Array<NodeInfo*> order;
+    OwnedArray<NodeInfo> infos; // sorted by node id
+    Array<FeedbackConnection> feedbackConnections;
+
+    // scratch space, kept around to avoid allocations
+    Array<NodeInfo*> stack, forward, backward;
+    Array<int> positions;
+
+    NodeInfo* findInfo (const uint32 nodeId, int& insertIndex) const noexcept
+    {
+        int start = 0;
+        int end = infos.size();
+
+        while (start < end)
+        {
+            const int halfway = (start + end) / 2;
+            NodeInfo* const info = infos.getUnchecked (halfway);
+
+            if (info->nodeId == nodeId)
+            {
+                insertIndex = halfway;
+                return info;
+            }
+
+            if (info->nodeId < nodeId)
+                start = halfway + 1;
+            else
+                end = halfway;
+        }
+
+        insertIndex = start;
+        return nullptr;
+    }
+
+    // returns false, without changing anything, if the edge would close a loop
+    bool insertEdge (NodeInfo* const source, NodeInfo* const dest)
+    {
+        if (source == dest)
+            return false;
+
+        if (source->position > dest->position)
+        {
+            const int lowerBound = dest->position;
+            const int upperBound = source->position;
+
+            // everything reachable from dest that sits before source in the order
+            forward.clearQuick();
+            stack.clearQuick();
+            dest->visited = true;
+            forward.add (dest);
+            stack.add (dest);
+
+            while (stack.size() != 0)
+            {
+                const NodeInfo* const n = stack.removeAndReturn (stack.size() - 1);
+
+                for (int i = n->outputs.size(); --i >= 0;)
+                {
+                    NodeInfo* const o = n->outputs.getUnchecked(i);
+
+                    if (o == source)
+                    {
+                        resetVisited (forward);
+                        return false;
+                    }
+
+                    if (! o->visited && o->position < upperBound)
+                    {
+                        o->visited = true;
+                        forward.add (o);
+                        stack.add (o);
+                    }
+                }
+            }
+
+            // everything that reaches source and sits after dest in the order
+            backward.clearQuick();
+            stack.clearQuick();
+            source->visited = true;
+            backward.add (source);
+            stack.add (source);
+
+            while (stack.size() != 0)
+            {
+                const NodeInfo* const n = stack.removeAndReturn (stack.size() - 1);
+
+                for (int i = n->inputs.size(); --i >= 0;)
+                {
+                    NodeInfo* const in = n->inputs.getUnchecked(i);
+
+                    if (! in->visited && in->position > lowerBound)
+                    {
+                        in->visited = true;
+                        backward.add (in);
+                        stack.add (in);
+                    }
+                }
+            }
+
+            // reuse the same positions, with the backward set moved before the forward one
+            PositionSorter sorter;
+            forward.sort (sorter);
+            backward.sort (sorter);
+
+            positions.clearQuick();
+
+            for (int i = 0; i < backward.size(); ++i)
+                positions.add (backward.getUnchecked(i)->position);
+            for (int i = 0; i < forward.size(); ++i)
+                positions.add (forward.getUnchecked(i)->position);
+
+            positions.sort();
+
+            int k = 0;
+
+            for (int i = 0; i < backward.size(); ++i)
+                place (backward.getUnchecked(i), positions.getUnchecked(k++));
+            for (int i = 0; i < forward.size(); ++i)
+                place (forward.getUnchecked(i), positions.getUnchecked(k++));
+
+            resetVisited (forward);
+            resetVisited (backward);
+        }
+
+        source->outputs.add (dest);
+        dest->inputs.add (source);
+        return true;
+    }
+
+    void place (NodeInfo* const info, const int position) noexcept
+    {
+        info->position = position;
+        order.setUnchecked (position, info);
+    }
+
+    static void resetVisited (const Array<NodeInfo*>& infoList) noexcept
+    {
+        for (int i = infoList.size(); --i >= 0;)
+            infoList.getUnchecked(i)->visited = false;
+    }
+
+    void retryFeedbackConnections()
+    {
+        Array<FeedbackConnection> pending;
+        pending.swapWith (feedbackConnections);
+
+        for (int i = 0; i < pending.size(); ++i)
+        {
+            const FeedbackConnection& fc (pending.getReference(i));
+
+            int index;
+            NodeInfo* const source = findInfo (fc.sourceNodeId, index);
+            NodeInfo* const dest   = findInfo (fc.destNodeId, index);
+            CARLA_SAFE_ASSERT_CONTINUE (source != nullptr && dest != nullptr);
+
+            if (! insertEdge (source, dest))
+                feedbackConnections.add (fc);
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS (NodeOrdering)
+};
+
 //==============================================================================
 AudioProcessorGraph::AudioProcessorGraph()
     : lastNodeId (0), audioAndCVBuffers (new AudioProcessorGraphBufferHelpers),
-      currentMidiInputBuffer (nullptr), isPrepared (false), needsReorder (false)
+      nodeOrdering (new NodeOrdering),
+      renderingSequence (nullptr), pendingRenderingSequence (nullptr),
+      retiredRenderingSequences (nullptr), renderingThreadPool (nullptr),
+      currentMidiInputBuffer (nullptr), currentMidiOutputBuffer (nullptr),
+      isPrepared (false), needsReorder (false)
 {
 }
 
@@ -1191,6 +2096,8 @@ AudioProcessorGraph::~AudioProcessorGraph()
 {
     clearRenderingSequence();
     clear();
+
+    delete renderingThreadPool;
 }
 
 const String AudioProcessorGraph::getName() const
@@ -1203,6 +2110,7 @@ void AudioProcessorGraph::clear()
 {
     nodes.clear();
     connections.clear();
+    nodeOrdering->clear();
     needsReorder = true;
 }
 
@@ -1215,6 +2123,13 @@ AudioProcessorGraph::Node* AudioProcessorGraph::getNodeForId (const uint32 nodeI
     return nullptr;
 }
 
+AudioProcessorGraph::Node* AudioProcessorGraph::getNodeInRenderingOrder (const int position) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN (isPositiveAndBelow (position, nodeOrdering->getNumNodes()), nullptr);
+
+    return nodeOrdering->getNode (position);
+}
+
 AudioProcessorGraph::Node* AudioProcessorGraph::addNode (AudioProcessor* const newProcessor, uint32 nodeId)
 {
     CARLA_SAFE_ASSERT_RETURN (newProcessor != nullptr && newProcessor != this, nullptr);
@@ -1240,6 +2155,7 @@ AudioProcessorGraph::Node* AudioProcessorGraph::addNode (AudioProcessor* const n
 
     Node* const n = new Node (nodeId, newProcessor);
     nodes.add (n);
+    nodeOrdering->addNode (n);
 
     if (isPrepared)
         needsReorder = true;
@@ -1257,6 +2173,7 @@ bool AudioProcessorGraph::removeNode (const uint32 nodeId)
         if (nodes.getUnchecked(i)->nodeId == nodeId)
         {
             nodes.remove (i);
+            nodeOrdering->removeNode (nodeId);
 
             if (isPrepared)
                 needsReorder = true;
@@ -1345,6 +2262,7 @@ bool AudioProcessorGraph::addConnection (const ChannelType ct,
     connections.addSorted (sorter, new Connection (ct,
                                                    sourceNodeId, sourceChannelIndex,
                                                    destNodeId, destChannelIndex));
+    nodeOrdering->addConnection (sourceNodeId, destNodeId);
 
     if (isPrepared)
         needsReorder = true;
@@ -1354,6 +2272,10 @@ bool AudioProcessorGraph::addConnection (const ChannelType ct,
 
 void AudioProcessorGraph::removeConnection (const int index)
 {
+    const Connection* const c = connections [index];
+    CARLA_SAFE_ASSERT_RETURN (c != nullptr,);
+
+    nodeOrdering->removeConnection (c->sourceNodeId, c->destNodeId);
     connections.remove (index);
 
     if (isPrepared)
@@ -1434,22 +2356,70 @@ bool AudioProcessorGraph::removeIllegalConnections()
 }
 
 //==============================================================================
-static void deleteRenderOpArray (Array<void*>& ops)
+AudioProcessorGraph::RenderingSequence* AudioProcessorGraph::exchangeRenderingSequence (RenderingSequence* volatile& slot,
+                                                                                       RenderingSequence* const newSequence) noexcept
 {
-    for (int i = ops.size(); --i >= 0;)
-        delete static_cast<GraphRenderingOps::AudioGraphRenderingOpBase*> (ops.getUnchecked(i));
+    for (;;)
+    {
+        RenderingSequence* const oldSequence = slot;
+
+        if (__sync_bool_compare_and_swap (&slot, oldSequence, newSequence))
+            return oldSequence;
+    }
 }
 
 void AudioProcessorGraph::clearRenderingSequence()
 {
-    Array<void*> oldOps;
+    RenderingSequence* oldSequence = nullptr;
 
     {
         const CarlaRecursiveMutexLocker cml (getCallbackLock());
-        renderingOps.swapWith (oldOps);
+        std::swap (renderingSequence, oldSequence);
+    }
+
+    if (renderingThreadPool != nullptr)
+        renderingThreadPool->waitForWorkersToLeave();
+
+    delete oldSequence;
+    delete exchangeRenderingSequence (pendingRenderingSequence, nullptr);
+    deleteRetiredRenderingSequences();
+}
+
+void AudioProcessorGraph::swapInPendingRenderingSequence() noexcept
+{
+    RenderingSequence* const newSequence = exchangeRenderingSequence (pendingRenderingSequence, nullptr);
+
+    if (newSequence == nullptr)
+        return;
+
+    if (RenderingSequence* const oldSequence = renderingSequence)
+    {
+        // the old sequence is deleted on another thread, late workers must be out of it by then
+        if (renderingThreadPool != nullptr)
+            renderingThreadPool->waitForWorkersToLeave();
+
+        // only deleteRetiredRenderingSequences() takes items off this list, and it takes all of them
+        for (;;)
+        {
+            RenderingSequence* const head = retiredRenderingSequences;
+            oldSequence->nextRetired = head;
+
+            if (__sync_bool_compare_and_swap (&retiredRenderingSequences, head, oldSequence))
+                break;
+        }
     }
 
-    deleteRenderOpArray (oldOps);
+    renderingSequence = newSequence;
+}
+
+void AudioProcessorGraph::deleteRetiredRenderingSequences()
+{
+    for (RenderingSequence* sequence = exchangeRenderingSequence (retiredRenderingSequences, nullptr); sequence != nullptr;)
+    {
+        RenderingSequence* const next = sequence->nextRetired;
+        delete sequence;
+        sequence = next;
+    }
 }
 
 bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
@@ -1474,60 +2444,85 @@ bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
 
 void AudioProcessorGraph::buildRenderingSequence()
 {
-    Array<void*> newRenderingOps;
-    int numAudioRenderingBuffersNeeded = 2;
-    int numCVRenderingBuffersNeeded = 0;
-    int numMidiBuffersNeeded = 1;
+    RenderingSequence* const newSequence = new RenderingSequence();
 
-    {
-        const CarlaRecursiveMutexLocker cml (reorderMutex);
+    const CarlaRecursiveMutexLocker cml (reorderMutex);
 
-        Array<Node*> orderedNodes;
+    Array<Node*> orderedNodes;
+    CARLA_SAFE_ASSERT_INT2 (nodeOrdering->getNumNodes() == nodes.size(), nodeOrdering->getNumNodes(), nodes.size());
 
-        {
-            const GraphRenderingOps::ConnectionLookupTable table (connections);
+    orderedNodes.ensureStorageAllocated (nodeOrdering->getNumNodes());
 
-            for (int i = 0; i < nodes.size(); ++i)
-            {
-                Node* const node = nodes.getUnchecked(i);
+    for (int i = 0; i < nodeOrdering->getNumNodes(); ++i)
+    {
+        Node* const node = nodeOrdering->getNode (i);
 
-                node->prepare (getSampleRate(), getBlockSize(), this);
+        node->prepare (getSampleRate(), getBlockSize(), this);
+        orderedNodes.add (node);
+    }
 
-                int j = 0;
-                for (; j < orderedNodes.size(); ++j)
-                    if (table.isAnInputTo (node->nodeId, ((Node*) orderedNodes.getUnchecked(j))->nodeId))
-                      break;
+    const RenderingThreadPool* const threadPool = renderingThreadPool;
 
-                orderedNodes.insert (j, node);
-            }
-        }
+    GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, newSequence->ops,
+                                                                 threadPool == nullptr);
 
-        GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, newRenderingOps);
+    if (threadPool != nullptr)
+        newSequence->parallelSequence = new GraphRenderingOps::ParallelRenderingSequence (newSequence->ops,
+                                                                                          threadPool->getNumThreads());
 
-        numAudioRenderingBuffersNeeded = calculator.getNumAudioBuffersNeeded();
-        numCVRenderingBuffersNeeded = calculator.getNumCVBuffersNeeded();
-        numMidiBuffersNeeded = calculator.getNumMidiBuffersNeeded();
-    }
+    newSequence->audioBuffers.setSize (calculator.getNumAudioBuffersNeeded(), getBlockSize());
+    newSequence->audioBuffers.clear();
+
+    newSequence->cvBuffers.setSize (calculator.getNumCVBuffersNeeded(), getBlockSize());
+    newSequence->cvBuffers.clear();
 
+    for (int i = calculator.getNumMidiBuffersNeeded(); --i >= 0;)
     {
-        // swap over to the new rendering sequence..
-        const CarlaRecursiveMutexLocker cml (getCallbackLock());
+        GraphRenderingOps::EngineEventBuffer* const midiBuffer = new GraphRenderingOps::EngineEventBuffer();
+        midiBuffer->calloc (kMaxEngineEventInternalCount);
+        newSequence->midiBuffers.add (midiBuffer);
+    }
 
-        audioAndCVBuffers->setRenderingBufferSize (numAudioRenderingBuffersNeeded,
-                                                   numCVRenderingBuffersNeeded,
-                                                   getBlockSize());
+    // anything the audio thread has let go of since the last rebuild
+    deleteRetiredRenderingSequences();
 
-        for (int i = static_cast<int>(midiBuffers.size()); --i >= 0;)
-            midiBuffers.getUnchecked(i)->clear();
+    // the audio thread swaps to the new sequence at its next block,
+    // a previous one it did not get to in time is simply dropped
+    delete exchangeRenderingSequence (pendingRenderingSequence, newSequence);
+}
+
+void AudioProcessorGraph::setNumParallelRenderingThreads (const uint numThreads)
+{
+    const CarlaRecursiveMutexLocker cml1 (reorderMutex);
+
+    if (getNumParallelRenderingThreads() == numThreads)
+        return;
 
-        while (static_cast<int>(midiBuffers.size()) < numMidiBuffersNeeded)
-            midiBuffers.add (new MidiBuffer());
+    RenderingThreadPool* oldThreadPool = nullptr;
 
-        renderingOps.swapWith (newRenderingOps);
+    // stop using the current pool before rebuilding for the new one
+    {
+        const CarlaRecursiveMutexLocker cml2 (getCallbackLock());
+        std::swap (renderingThreadPool, oldThreadPool);
     }
 
-    // delete the old ones..
-    deleteRenderOpArray (newRenderingOps);
+    // stopping the old workers also waits for them to leave the current sequence
+    delete oldThreadPool;
+    clearRenderingSequence();
+
+    if (numThreads != 0)
+        renderingThreadPool = new RenderingThreadPool (numThreads);
+
+    if (isPrepared)
+        buildRenderingSequence();
+}
+
+uint AudioProcessorGraph::getNumParallelRenderingThreads() const noexcept
+{
+    if (const RenderingThreadPool* const threadPool = renderingThreadPool)
+        return static_cast<uint> (threadPool->getNumThreads());
+
+    return 0;
 }
 
 //==============================================================================
@@ -1540,7 +2535,10 @@ void AudioProcessorGraph::prepareToPlay (double sampleRate, int estimatedSamples
                                            estimatedSamplesPerBlock);
 
     currentMidiInputBuffer = nullptr;
-    currentMidiOutputBuffer.clear();
+    currentMidiOutputBuffer = nullptr;
+
+    if (midiOutputBuffer == nullptr)
+        midiOutputBuffer.calloc (kMaxEngineEventInternalCount);
 
     clearRenderingSequence();
     buildRenderingSequence();
@@ -1556,10 +2554,9 @@ void AudioProcessorGraph::releaseResources()
         nodes.getUnchecked(i)->unprepare();
 
     audioAndCVBuffers->release();
-    midiBuffers.clear();
 
     currentMidiInputBuffer = nullptr;
-    currentMidiOutputBuffer.clear();
+    currentMidiOutputBuffer = nullptr;
 }
 
 void AudioProcessorGraph::reset()
@@ -1621,14 +2618,19 @@ void AudioProcessorGraph::processAudio (AudioSampleBuffer& audioBuffer, MidiBuff
 void AudioProcessorGraph::processAudioAndCV (AudioSampleBuffer& audioBuffer,
                                              const AudioSampleBuffer& cvInBuffer,
                                              AudioSampleBuffer& cvOutBuffer,
-                                             MidiBuffer& midiMessages)
+                                             const EngineEvent* const eventsIn,
+                                             EngineEvent* const eventsOut)
 {
     AudioSampleBuffer*&       currentAudioInputBuffer  = audioAndCVBuffers->currentAudioInputBuffer;
     const AudioSampleBuffer*& currentCVInputBuffer     = audioAndCVBuffers->currentCVInputBuffer;
     AudioSampleBuffer&        currentAudioOutputBuffer = audioAndCVBuffers->currentAudioOutputBuffer;
     AudioSampleBuffer&        currentCVOutputBuffer    = audioAndCVBuffers->currentCVOutputBuffer;
-    AudioSampleBuffer&        renderingAudioBuffers    = audioAndCVBuffers->renderingAudioBuffers;
-    AudioSampleBuffer&        renderingCVBuffers       = audioAndCVBuffers->renderingCVBuffers;
+
+    // block boundary, pick up the latest rebuild
+    if (pendingRenderingSequence != nullptr)
+        swapInPendingRenderingSequence();
+
+    RenderingSequence* const sequence = renderingSequence;
 
     const int numSamples = audioBuffer.getNumSamples();
 
@@ -1636,24 +2638,46 @@ void AudioProcessorGraph::processAudioAndCV (AudioSampleBuffer& audioBuffer,
         return;
     if (! audioAndCVBuffers->currentCVOutputBuffer.setSizeRT(numSamples))
         return;
-    if (! audioAndCVBuffers->renderingAudioBuffers.setSizeRT(numSamples))
+    if (sequence != nullptr && ! sequence->audioBuffers.setSizeRT(numSamples))
         return;
-    if (! audioAndCVBuffers->renderingCVBuffers.setSizeRT(numSamples))
+    if (sequence != nullptr && ! sequence->cvBuffers.setSizeRT(numSamples))
         return;
 
     currentAudioInputBuffer = &audioBuffer;
     currentCVInputBuffer = &cvInBuffer;
-    currentMidiInputBuffer = &midiMessages;
+    currentMidiInputBuffer = eventsIn;
+    currentMidiOutputBuffer = eventsOut;
     currentAudioOutputBuffer.clear();
     currentCVOutputBuffer.clear();
-    currentMidiOutputBuffer.clear();
+    CarlaBackend::clearEngineEvents (eventsOut);
 
-    for (int i = 0; i < renderingOps.size(); ++i)
+    if (sequence != nullptr)
     {
-        GraphRenderingOps::AudioGraphRenderingOpBase* const op
-            = (GraphRenderingOps::AudioGraphRenderingOpBase*) renderingOps.getUnchecked(i);
+        AudioSampleBuffer&        renderingAudioBuffers    = sequence->audioBuffers;
+        AudioSampleBuffer&        renderingCVBuffers       = sequence->cvBuffers;
+        OwnedArray<GraphRenderingOps::EngineEventBuffer>& renderingMidiBuffers = sequence->midiBuffers;
 
-        op->perform (renderingAudioBuffers, renderingCVBuffers, midiBuffers, numSamples);
+        RenderingThreadPool* const threadPool = renderingThreadPool;
+
+        if (sequence->parallelSequence != nullptr && threadPool != nullptr)
+        {
+            // ops running in parallel must not race on the buffers' shared "is clear" flag
+            renderingAudioBuffers.getArrayOfWritePointers();
+            renderingCVBuffers.getArrayOfWritePointers();
+
+            threadPool->perform (*sequence->parallelSequence,
+                                 renderingAudioBuffers, renderingCVBuffers, renderingMidiBuffers, numSamples);
+        }
+        else
+        {
+            for (int i = 0; i < sequence->ops.size(); ++i)
+            {
+                GraphRenderingOps::AudioGraphRenderingOpBase* const op
+                    = (GraphRenderingOps::AudioGraphRenderingOpBase*) sequence->ops.getUnchecked(i);
+
+                op->perform (renderingAudioBuffers, renderingCVBuffers, renderingMidiBuffers, numSamples);
+            }
+        }
     }
 
     for (uint32_t i = 0; i < audioBuffer.getNumChannels(); ++i)
@@ -1662,8 +2686,8 @@ void AudioProcessorGraph::processAudioAndCV (AudioSampleBuffer& audioBuffer,
     for (uint32_t i = 0; i < cvOutBuffer.getNumChannels(); ++i)
         cvOutBuffer.copyFrom (i, 0, currentCVOutputBuffer, i, 0, numSamples);
 
-    midiMessages.clear();
-    midiMessages.addEvents (currentMidiOutputBuffer, 0, audioBuffer.getNumSamples(), 0);
+    currentMidiInputBuffer = nullptr;
+    currentMidiOutputBuffer = nullptr;
 }
 
 bool AudioProcessorGraph::acceptsMidi() const                       { return true; }
@@ -1679,9 +2703,24 @@ void AudioProcessorGraph::processBlock (AudioSampleBuffer& buffer, MidiBuffer& m
 void AudioProcessorGraph::processBlockWithCV (AudioSampleBuffer& audioBuffer,
                                               const AudioSampleBuffer& cvInBuffer,
                                               AudioSampleBuffer& cvOutBuffer,
-                                              MidiBuffer& midiMessages)
+                                              EngineEvent* const events)
+{
+    CARLA_SAFE_ASSERT_RETURN(midiOutputBuffer != nullptr,);
+
+    processAudioAndCV (audioBuffer, cvInBuffer, cvOutBuffer, events, midiOutputBuffer);
+
+    CarlaBackend::copyEngineEvents (events, midiOutputBuffer);
+}
+
+void AudioProcessorGraph::processBlockWithCV (AudioSampleBuffer& audioBuffer,
+                                              const AudioSampleBuffer& cvInBuffer,
+                                              AudioSampleBuffer& cvOutBuffer,
+                                              const EngineEvent* const eventsIn,
+                                              EngineEvent* const eventsOut)
 {
-    processAudioAndCV (audioBuffer, cvInBuffer, cvOutBuffer, midiMessages);
+    CARLA_SAFE_ASSERT_RETURN(eventsIn != eventsOut,);
+
+    processAudioAndCV (audioBuffer, cvInBuffer, cvOutBuffer, eventsIn, eventsOut);
 }
 
 void AudioProcessorGraph::reorderNowIfNeeded()
@@ -1736,7 +2775,7 @@ void AudioProcessorGraph::AudioGraphIOProcessor::releaseResources()
 void AudioProcessorGraph::AudioGraphIOProcessor::processAudioAndCV (AudioSampleBuffer& audioBuffer,
                                                                     const AudioSampleBuffer& cvInBuffer,
                                                                     AudioSampleBuffer& cvOutBuffer,
-                                                                    MidiBuffer& midiMessages)
+                                                                    EngineEvent* const events)
 {
     CARLA_SAFE_ASSERT_RETURN(graph != nullptr,);
 
@@ -1799,11 +2838,11 @@ void AudioProcessorGraph::AudioGraphIOProcessor::processAudioAndCV (AudioSampleB
         }
 
         case midiOutputNode:
-            graph->currentMidiOutputBuffer.addEvents (midiMessages, 0, audioBuffer.getNumSamples(), 0);
+            CarlaBackend::mergeEngineEvents (graph->currentMidiOutputBuffer, events);
             break;
 
         case midiInputNode:
-            midiMessages.addEvents (*graph->currentMidiInputBuffer, 0, audioBuffer.getNumSamples(), 0);
+            CarlaBackend::mergeEngineEvents (events, graph->currentMidiInputBuffer);
             break;
 
         default:
@@ -1814,9 +2853,9 @@ void AudioProcessorGraph::AudioGraphIOProcessor::processAudioAndCV (AudioSampleB
 void AudioProcessorGraph::AudioGraphIOProcessor::processBlockWithCV (AudioSampleBuffer& audioBuffer,
                                                                      const AudioSampleBuffer& cvInBuffer,
                                                                      AudioSampleBuffer& cvOutBuffer,
-                                                                     MidiBuffer& midiMessages)
+                                                                     EngineEvent* const events)
 {
-    processAudioAndCV (audioBuffer, cvInBuffer, cvOutBuffer, midiMessages);
+    processAudioAndCV (audioBuffer, cvInBuffer, cvOutBuffer, events);
 }
 
 bool AudioProcessorGraph::AudioGraphIOProcessor::acceptsMidi() const
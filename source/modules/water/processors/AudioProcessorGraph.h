@@ -25,7 +25,7 @@
 #include "../containers/NamedValueSet.h"
 #include "../containers/OwnedArray.h"
 #include "../containers/ReferenceCountedArray.h"
-#include "../midi/MidiBuffer.h"
+#include "../memory/HeapBlock.h"
 
 namespace water {
 
@@ -167,6 +167,12 @@ public:
     */
     Node* getNodeForId (const uint32 nodeId) const;
 
+    /** Returns the node at a position in the order the graph renders its nodes in.
+        Connections that close a feedback loop do not affect this order.
+        This will return nullptr if the position is out of range.
+    */
+    Node* getNodeInRenderingOrder (const int position) const noexcept;
+
     /** Adds a node to the graph.
 
         This creates a new node in the graph, for the specified processor. Once you have
@@ -323,7 +329,7 @@ public:
         void processBlockWithCV (AudioSampleBuffer& audioBuffer,
                                  const AudioSampleBuffer& cvInBuffer,
                                  AudioSampleBuffer& cvOutBuffer,
-                                 MidiBuffer& midiMessages) override;
+                                 EngineEvent* events) override;
 
         bool acceptsMidi() const override;
         bool producesMidi() const override;
@@ -340,7 +346,7 @@ public:
         void processAudioAndCV (AudioSampleBuffer& audioBuffer,
                                 const AudioSampleBuffer& cvInBuffer,
                                 AudioSampleBuffer& cvOutBuffer,
-                                MidiBuffer& midiMessages);
+                                EngineEvent* events);
 
         CARLA_DECLARE_NON_COPY_CLASS (AudioGraphIOProcessor)
     };
@@ -353,7 +359,16 @@ public:
     void processBlockWithCV (AudioSampleBuffer& audioBuffer,
                              const AudioSampleBuffer& cvInBuffer,
                              AudioSampleBuffer& cvOutBuffer,
-                             MidiBuffer& midiMessages) override;
+                             EngineEvent* events) override;
+
+    /** Same as processBlockWithCV(), but reading the graph's input events from @a eventsIn
+        and writing its output events straight into @a eventsOut, which must not be the same array.
+    */
+    void processBlockWithCV (AudioSampleBuffer& audioBuffer,
+                             const AudioSampleBuffer& cvInBuffer,
+                             AudioSampleBuffer& cvOutBuffer,
+                             const EngineEvent* eventsIn,
+                             EngineEvent* eventsOut);
 
     void reset() override;
     void setNonRealtime (bool) noexcept override;
@@ -364,31 +379,57 @@ public:
     void reorderNowIfNeeded();
     const CarlaRecursiveMutex& getReorderMutex() const;
 
+    //==============================================================================
+    /** Sets the number of worker threads used to render independent nodes in parallel.
+
+        With 0 threads (the default) all nodes are rendered in order on the calling thread.
+        Otherwise the nodes are split into a dependency graph and the workers, together with
+        the calling thread, steal ready nodes from each other. The output is bit-identical
+        to serial rendering.
+    */
+    void setNumParallelRenderingThreads (uint numThreads);
+
+    /** Returns the number of worker threads used for parallel rendering. */
+    uint getNumParallelRenderingThreads() const noexcept;
+
 private:
     //==============================================================================
     // void processAudio (AudioSampleBuffer& audioBuffer, MidiBuffer& midiMessages);
     void processAudioAndCV (AudioSampleBuffer& audioBuffer,
                             const AudioSampleBuffer& cvInBuffer,
                             AudioSampleBuffer& cvOutBuffer,
-                            MidiBuffer& midiMessages);
+                            const EngineEvent* eventsIn,
+                            EngineEvent* eventsOut);
 
     //==============================================================================
     ReferenceCountedArray<Node> nodes;
     OwnedArray<Connection> connections;
     uint32 lastNodeId;
-    OwnedArray<MidiBuffer> midiBuffers;
-    Array<void*> renderingOps;
 
     friend class AudioGraphIOProcessor;
     struct AudioProcessorGraphBufferHelpers;
     CarlaScopedPointer<AudioProcessorGraphBufferHelpers> audioAndCVBuffers;
-
-    MidiBuffer* currentMidiInputBuffer;
-    MidiBuffer currentMidiOutputBuffer;
+    struct NodeOrdering;
+    CarlaScopedPointer<NodeOrdering> nodeOrdering;
+    struct RenderingSequence;
+    RenderingSequence* renderingSequence;
+    RenderingSequence* volatile pendingRenderingSequence;
+    RenderingSequence* volatile retiredRenderingSequences;
+    class RenderingThreadPool;
+    RenderingThreadPool* renderingThreadPool;
+
+    const EngineEvent* currentMidiInputBuffer;
+    EngineEvent* currentMidiOutputBuffer;
+    HeapBlock<EngineEvent> midiOutputBuffer; // used when processing in place
 
     bool isPrepared, needsReorder;
     CarlaRecursiveMutex reorderMutex;
 
+    void swapInPendingRenderingSequence() noexcept;
+    static RenderingSequence* exchangeRenderingSequence (RenderingSequence* volatile& slot,
+                                                         RenderingSequence* newSequence) noexcept;
+    void deleteRetiredRenderingSequences();
+
 public:
     void clearRenderingSequence();
     void buildRenderingSequence();
@@ -20,6 +20,7 @@
 
 #include "CarlaThread.hpp"
 #include "CarlaMathUtils.hpp"
+#include "CarlaSampleCache.hpp"
 
 extern "C" {
 #include "audio_decoder/ad.h"
@@ -58,6 +59,8 @@ struct AudioFilePool {
     uint32_t maxFrame;
     volatile uint64_t startFrame;
     water::SpinLock mutex;
+    // when set, buffer points to this shared data instead of our own
+    const CarlaCachedSample* cached;
 
 #ifdef CARLA_PROPER_CPP11_SUPPORT
     AudioFilePool() noexcept
@@ -66,12 +69,14 @@ struct AudioFilePool {
           numFrames(0),
           maxFrame(0),
           startFrame(0),
-          mutex() {}
+          mutex(),
+          cached(nullptr) {}
 #else
     AudioFilePool() noexcept
         : numFrames(0),
           startFrame(0),
-          mutex()
+          mutex(),
+          cached(nullptr)
     {
         buffer[0] = buffer[1] = nullptr;
         tmpbuf[0] = tmpbuf[1] = nullptr;
@@ -117,6 +122,25 @@ struct AudioFilePool {
         maxFrame = fileNumFrames;
     }
 
+    // use the read-only data of a cached sample, which must have 1 or 2 channels
+    void createShared(const CarlaCachedSample* const sample, const uint32_t fileNumFrames)
+    {
+        CARLA_ASSERT(buffer[0] == nullptr);
+        CARLA_ASSERT(buffer[1] == nullptr);
+        CARLA_ASSERT(cached == nullptr);
+        CARLA_SAFE_ASSERT_RETURN(sample != nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(sample->channels == 1 || sample->channels == 2,);
+
+        const water::GenericScopedLock<water::SpinLock> gsl(mutex);
+
+        cached = sample;
+        buffer[0] = sample->buffers[0];
+        buffer[1] = sample->buffers[sample->channels - 1];
+        startFrame = 0;
+        numFrames = static_cast<uint32_t>(sample->frames);
+        maxFrame = fileNumFrames;
+    }
+
     void destroy() noexcept
     {
         {
@@ -126,6 +150,13 @@ struct AudioFilePool {
             maxFrame = 0;
         }
 
+        if (cached != nullptr)
+        {
+            CarlaSampleCache::getInstance().release(cached);
+            cached = nullptr;
+            buffer[0] = buffer[1] = nullptr;
+        }
+
         if (buffer[0] != nullptr)
         {
             delete[] buffer[0];
@@ -380,11 +411,15 @@ public:
             if (fileNumFrames <= maxPoolNumFrames || fFileNfo.can_seek == 0)
             {
                 // entire file fits in a small pool, lets read it now
-                const uint32_t poolNumFrames = needsResample
-                                             ? static_cast<uint32_t>(static_cast<double>(fileNumFrames) * fResampleRatio + 0.5)
-                                             : fileNumFrames;
-                fPool.create(poolNumFrames, maxFrame, false);
-                readEntireFileIntoPool(needsResample);
+                if (! readEntireFileIntoPool(filename, sampleRate, maxFrame))
+                {
+                    ad_clear_nfo(&fFileNfo);
+                    ad_close(fFilePtr);
+                    fFilePtr = nullptr;
+                    carla_stderr2("loadFilename error, failed to read file");
+                    return false;
+                }
+
                 ad_close(fFilePtr);
                 fFilePtr = nullptr;
 
@@ -472,16 +507,19 @@ public:
         CARLA_SAFE_ASSERT_RETURN(pool.numFrames == 0,);
         CARLA_SAFE_ASSERT_RETURN(pool.buffer[0] == nullptr,);
         CARLA_SAFE_ASSERT_RETURN(pool.tmpbuf[0] == nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(pool.cached == nullptr,);
 
         pool.startFrame = fPool.startFrame;
         pool.numFrames = fPool.numFrames;
         pool.buffer[0] = fPool.buffer[0];
         pool.buffer[1] = fPool.buffer[1];
+        pool.cached = fPool.cached;
 
         fPool.startFrame = 0;
         fPool.numFrames = 0;
         fPool.buffer[0] = nullptr;
         fPool.buffer[1] = nullptr;
+        fPool.cached = nullptr;
     }
 
     bool tryPutData(AudioFilePool& pool,
@@ -539,80 +577,22 @@ public:
         }
     }
 
-    void readEntireFileIntoPool(const bool needsResample)
+    bool readEntireFileIntoPool(const char* const filename, const uint32_t sampleRate, const uint32_t maxFrame)
     {
-        CARLA_SAFE_ASSERT_RETURN(fPool.numFrames > 0,);
-
-        const uint numChannels = fFileNfo.channels;
-        const uint fileNumFrames = static_cast<uint>(fFileNfo.frames);
-        const uint bufferSize = fileNumFrames * numChannels;
-
-        float* const buffer = (float*)std::calloc(bufferSize, sizeof(float));
-        CARLA_SAFE_ASSERT_RETURN(buffer != nullptr,);
-
-        ad_seek(fFilePtr, 0);
-        ssize_t rv = ad_read(fFilePtr, buffer, bufferSize);
-        CARLA_SAFE_ASSERT_INT2_RETURN(rv == static_cast<ssize_t>(bufferSize),
-                                      static_cast<int>(rv),
-                                      static_cast<int>(bufferSize),
-                                      std::free(buffer));
-
-        fCurrentBitRate = ad_get_bitrate(fFilePtr);
-
-        float* rbuffer;
-
-        if (needsResample)
-        {
-            const uint rbufferSize = fPool.numFrames * numChannels;
-            rbuffer = (float*)std::calloc(rbufferSize, sizeof(float));
-            CARLA_SAFE_ASSERT_RETURN(rbuffer != nullptr, std::free(buffer););
-
-            rv = static_cast<ssize_t>(rbufferSize);
-
-            fResampler.inp_count = fileNumFrames;
-            fResampler.out_count = fPool.numFrames;
-            fResampler.inp_data = buffer;
-            fResampler.out_data = rbuffer;
-            fResampler.process();
-            CARLA_SAFE_ASSERT_INT(fResampler.inp_count <= 2, fResampler.inp_count);
-        }
-        else
-        {
-            rbuffer = buffer;
-        }
+        // decoded data is shared with every other reader of the same file and sample rate
+        const CarlaCachedSample* const sample = CarlaSampleCache::getInstance().acquire(filename, sampleRate);
+        CARLA_SAFE_ASSERT_RETURN(sample != nullptr, false);
 
+        if (sample->channels != static_cast<uint>(fFileNfo.channels))
         {
-            // lock, and put data asap
-            const water::GenericScopedLock<water::SpinLock> gsl(fPool.mutex);
-
-            if (numChannels == 1)
-            {
-                for (ssize_t i=0, j=0; j < rv; ++i, ++j)
-                    fPool.buffer[0][i] = fPool.buffer[1][i] = rbuffer[j];
-            }
-            else
-            {
-                for (ssize_t i=0, j=0; j < rv; ++j)
-                {
-                    if (j % 2 == 0)
-                    {
-                        fPool.buffer[0][i] = rbuffer[j];
-                    }
-                    else
-                    {
-                        fPool.buffer[1][i] = rbuffer[j];
-                        ++i;
-                    }
-                }
-            }
+            CarlaSampleCache::getInstance().release(sample);
+            return false;
         }
 
-        if (rbuffer != buffer)
-            std::free(rbuffer);
-
-        std::free(buffer);
-
+        fCurrentBitRate = ad_get_bitrate(fFilePtr);
+        fPool.createShared(sample, maxFrame);
         fEntireFileLoaded = true;
+        return true;
     }
 
     void readPoll()
@@ -0,0 +1,192 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+// Checks that a sample streamed from disk plays back gap-free, the same as when it is fully loaded in memory.
+
+#include "sfzero/SFZero.h"
+
+#include "water/memory/MemoryBlock.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace water;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+static const int kSampleRate = 48000;
+static const int kSampleFrames = kSampleRate * 4;
+static const int kBlockSize = 128;
+static const double kPreloadSeconds = 0.25;
+
+static void appendData(MemoryBlock& block, const void* const data, const size_t size)
+{
+    block.append(data, size);
+}
+
+static void appendUInt32(MemoryBlock& block, const uint32 value)
+{
+    const uint8 bytes[4] = {
+        static_cast<uint8>(value), static_cast<uint8>(value >> 8), static_cast<uint8>(value >> 16), static_cast<uint8>(value >> 24)
+    };
+    appendData(block, bytes, 4);
+}
+
+static void appendUInt16(MemoryBlock& block, const uint16 value)
+{
+    const uint8 bytes[2] = { static_cast<uint8>(value), static_cast<uint8>(value >> 8) };
+    appendData(block, bytes, 2);
+}
+
+// stereo 32-bit float wav, with no silent stretches that could hide a gap
+static bool writeSampleFile(const File& file)
+{
+    const uint32 dataSize = static_cast<uint32>(kSampleFrames * 2 * sizeof(float));
+    MemoryBlock block;
+
+    appendData(block, "RIFF", 4);
+    appendUInt32(block, 36 + dataSize);
+    appendData(block, "WAVE", 4);
+    appendData(block, "fmt ", 4);
+    appendUInt32(block, 16);
+    appendUInt16(block, 3); // IEEE float
+    appendUInt16(block, 2);
+    appendUInt32(block, kSampleRate);
+    appendUInt32(block, kSampleRate * 2 * sizeof(float));
+    appendUInt16(block, 2 * sizeof(float));
+    appendUInt16(block, 32);
+    appendData(block, "data", 4);
+    appendUInt32(block, dataSize);
+
+    for (int i = 0; i < kSampleFrames; ++i)
+    {
+        const float frame[2] = {
+            0.5f + 0.25f * std::sin(static_cast<float>(i) * 0.01f),
+            -0.5f + 0.25f * std::sin(static_cast<float>(i) * 0.013f),
+        };
+        appendData(block, frame, sizeof(frame));
+    }
+
+    return file.replaceWithData(block.getData(), block.getSize());
+}
+
+static void loadingIdleCallback(void*)
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+static bool render(const File& sfzFile, const double preloadSeconds, std::vector<float>& output)
+{
+    sfzero::Synth synth;
+
+    for (int i = 0; i < 4; ++i)
+        synth.addVoice(new sfzero::Voice());
+
+    synth.setCurrentPlaybackSampleRate(kSampleRate);
+
+    sfzero::Sound* const sound = new sfzero::Sound(sfzFile);
+    const sfzero::Sound::LoadingIdleCallback cb = { loadingIdleCallback, nullptr };
+
+    sound->loadRegions();
+    sound->loadSamples(cb, preloadSeconds);
+    synth.addSound(sound);
+
+    if (sound->getErrors().size() != 0)
+    {
+        std::printf("FAIL: %s\n", sound->getErrors().joinIntoString(", ").toRawUTF8());
+        return false;
+    }
+
+    const bool streaming = sound->hasStreamingSamples();
+
+    if (streaming != (preloadSeconds > 0.0))
+    {
+        std::printf("FAIL: sample is %s, but it should not be\n", streaming ? "streaming" : "not streaming");
+        return false;
+    }
+
+    if (streaming)
+        synth.startStreaming();
+
+    AudioSampleBuffer buffer(2, kBlockSize);
+    output.clear();
+    output.reserve(2 * kSampleFrames);
+
+    synth.noteOn(1, 60, 1.0f);
+
+    for (int done = 0; done < kSampleFrames; done += kBlockSize)
+    {
+        buffer.clear();
+        synth.renderVoices(buffer, 0, kBlockSize);
+
+        for (uint32 c = 0; c < 2; ++c)
+            output.insert(output.end(), buffer.getReadPointer(c), buffer.getReadPointer(c) + kBlockSize);
+
+        // roughly real-time, the disk thread is expected to keep up with that
+        if (streaming)
+            carla_msleep(1);
+    }
+
+    if (streaming)
+        synth.stopStreaming();
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+int main()
+{
+    const File dir(File::getSpecialLocation(File::tempDirectory).getNonexistentChildFile("carla-sfzero-streaming", ""));
+    const File sampleFile(dir.getChildFile("sample.wav"));
+    const File sfzFile(dir.getChildFile("sample.sfz"));
+
+    if (! dir.createDirectory() ||
+        ! writeSampleFile(sampleFile) ||
+        ! sfzFile.replaceWithText("<region> sample=sample.wav pitch_keycenter=60 loop_mode=one_shot\n"))
+    {
+        std::printf("FAIL: could not write test files\n");
+        dir.deleteRecursively();
+        return 1;
+    }
+
+    std::vector<float> loaded, streamed;
+    bool ok = render(sfzFile, 0.0, loaded) && render(sfzFile, kPreloadSeconds, streamed);
+
+    dir.deleteRecursively();
+
+    if (! ok)
+        return 1;
+
+    for (std::size_t i = 0; i < loaded.size(); ++i)
+    {
+        if (std::fabs(loaded[i] - streamed[i]) > 1e-6f)
+        {
+            std::printf("FAIL: streamed playback differs at frame " P_SIZE " of channel " P_SIZE ", %f vs %f\n",
+                        (i / kBlockSize / 2) * kBlockSize + i % kBlockSize, (i / kBlockSize) % 2,
+                        static_cast<double>(streamed[i]), static_cast<double>(loaded[i]));
+            return 1;
+        }
+    }
+
+    std::printf("streamed playback is gap-free and matches in-memory playback\n");
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
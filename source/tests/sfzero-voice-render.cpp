@@ -0,0 +1,169 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+// Checks that the SFZero block renderer matches the plain per-frame reference renderer.
+
+#include "sfzero/SFZero.h"
+
+#include <cmath>
+#include <cstdio>
+
+using namespace water;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+static const double kSampleRate = 48000.0;
+static const int kSampleFrames = 24000;
+static const int kBlockSize = 256;
+static const int kNumBlocks = 200;
+static const float kTolerance = 1e-5f;
+
+struct TestCase {
+    const char* name;
+    int note;
+    sfzero::Region::LoopMode loopMode;
+    int64 offset, end, loopStart, loopEnd;
+    int noteOffBlock;
+    int pitchWheelBlock;
+};
+
+static const TestCase kTestCases[] = {
+    { "plain",               60, sfzero::Region::no_loop,         0,     0,    0,     0, 100,  -1 },
+    { "pitched up",          67, sfzero::Region::no_loop,         0,     0,    0,     0, 150,  -1 },
+    { "pitched down",        53, sfzero::Region::one_shot,        0,     0,    0,     0,  -1,  -1 },
+    { "offset and end",      72, sfzero::Region::no_loop,       300, 20000,    0,     0,  -1,  -1 },
+    { "continuous loop",     64, sfzero::Region::loop_continuous, 0,     0, 1000,  5003, 120,  -1 },
+    { "sustain loop",        58, sfzero::Region::loop_sustain,    0,     0, 2000,  2257,  60,  -1 },
+    { "pitch wheel",         61, sfzero::Region::loop_continuous, 0,     0,  500, 12000, 180,  40 },
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+static sfzero::Sound* createSound(const TestCase& tc)
+{
+    sfzero::Sound* const sound = new sfzero::Sound(File::getCurrentWorkingDirectory().getChildFile("test.sfz"));
+    sfzero::Region* const region = new sfzero::Region();
+
+    AudioSampleBuffer* const buffer = new AudioSampleBuffer(2, kSampleFrames);
+
+    float* const dataL = buffer->getWritePointer(0);
+    float* const dataR = buffer->getWritePointer(1);
+
+    for (int i = 0; i < kSampleFrames; ++i)
+    {
+        dataL[i] = 0.5f * std::sin(static_cast<float>(i) * 0.031f);
+        dataR[i] = 0.5f * std::sin(static_cast<float>(i) * 0.017f + 1.0f);
+    }
+
+    region->sample = sound->addSample("test.wav");
+    region->sample->setBuffer(buffer);
+    region->loop_mode = tc.loopMode;
+    region->offset = tc.offset;
+    region->end = tc.end;
+    region->loop_start = tc.loopStart;
+    region->loop_end = tc.loopEnd;
+    region->pan = 30.0f;
+    region->ampeg.attack = 0.01f;
+    region->ampeg.hold = 0.005f;
+    region->ampeg.decay = 0.2f;
+    region->ampeg.sustain = 60.0f;
+    region->ampeg.release = 0.05f;
+
+    sound->addRegion(region);
+    return sound;
+}
+
+static bool runTestCase(const TestCase& tc)
+{
+    const sfzero::Sound::Ptr sound(createSound(tc));
+    sfzero::Voice blockVoice, referenceVoice;
+
+    blockVoice.setCurrentPlaybackSampleRate(kSampleRate);
+    referenceVoice.setCurrentPlaybackSampleRate(kSampleRate);
+    blockVoice.startNote(tc.note, 0.8f, sound.get(), 8192);
+    referenceVoice.startNote(tc.note, 0.8f, sound.get(), 8192);
+
+    AudioSampleBuffer blockOut(2, kBlockSize), referenceOut(2, kBlockSize);
+    bool hadSound = false;
+
+    for (int block = 0; block < kNumBlocks; ++block)
+    {
+        if (block == tc.noteOffBlock)
+        {
+            blockVoice.stopNote(0.0f, true);
+            referenceVoice.stopNote(0.0f, true);
+        }
+
+        if (block == tc.pitchWheelBlock)
+        {
+            blockVoice.pitchWheelMoved(10000);
+            referenceVoice.pitchWheelMoved(10000);
+        }
+
+        blockOut.clear();
+        referenceOut.clear();
+
+        // odd split, so spans do not always line up with blocks
+        blockVoice.renderNextBlock(blockOut, 0, 100);
+        blockVoice.renderNextBlock(blockOut, 100, kBlockSize - 100);
+        referenceVoice.renderNextBlockReference(referenceOut, 0, kBlockSize);
+
+        for (uint32 c = 0; c < 2; ++c)
+        {
+            const float* const blockData = blockOut.getReadPointer(c);
+            const float* const referenceData = referenceOut.getReadPointer(c);
+
+            for (int i = 0; i < kBlockSize; ++i)
+            {
+                if (std::fabs(blockData[i] - referenceData[i]) > kTolerance)
+                {
+                    std::printf("FAIL: %s, block renderer differs at frame %i of channel %u, %f vs %f\n",
+                                tc.name, block * kBlockSize + i, c,
+                                static_cast<double>(blockData[i]), static_cast<double>(referenceData[i]));
+                    return false;
+                }
+
+                if (referenceData[i] != 0.0f)
+                    hadSound = true;
+            }
+        }
+    }
+
+    if (! hadSound)
+    {
+        std::printf("FAIL: %s, rendered silence\n", tc.name);
+        return false;
+    }
+
+    std::printf("%s: block renderer matches the reference renderer\n", tc.name);
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+int main()
+{
+    for (uint i = 0; i < sizeof(kTestCases)/sizeof(kTestCases[0]); ++i)
+    {
+        if (! runTestCase(kTestCases[i]))
+            return 1;
+    }
+
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,231 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+// Times patchbay graph edits and rendering sequence rebuilds, from 10 to 1000 nodes,
+// and checks the node order stays valid after each batch of edits.
+
+#include "water/processors/AudioProcessorGraph.h"
+#include "water/text/String.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+using namespace water;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class DummyProcessor : public AudioProcessor
+{
+public:
+    DummyProcessor()
+    {
+        setPlayConfigDetails(2, 2, 0, 0, 0, 0, 48000.0, 128);
+    }
+
+    const String getName() const override { return "Dummy"; }
+    void prepareToPlay(double, int) override {}
+    void releaseResources() override {}
+    bool acceptsMidi() const override { return false; }
+    bool producesMidi() const override { return false; }
+
+    void processBlockWithCV(AudioSampleBuffer&, const AudioSampleBuffer&, AudioSampleBuffer&, EngineEvent*) override {}
+};
+
+static double getTimeInMilliseconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) * 1000.0 + static_cast<double>(ts.tv_nsec) / 1000000.0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+static void connectStereo(AudioProcessorGraph& graph, const uint32 src, const uint32 dst)
+{
+    graph.addConnection(AudioProcessor::ChannelTypeAudio, src, 0, dst, 0);
+    graph.addConnection(AudioProcessor::ChannelTypeAudio, src, 1, dst, 1);
+}
+
+static void disconnectStereo(AudioProcessorGraph& graph, const uint32 src, const uint32 dst)
+{
+    graph.removeConnection(AudioProcessor::ChannelTypeAudio, src, 0, dst, 0);
+    graph.removeConnection(AudioProcessor::ChannelTypeAudio, src, 1, dst, 1);
+}
+
+static std::vector<uint32> getOrder(const AudioProcessorGraph& graph)
+{
+    std::vector<uint32> order;
+
+    for (int i = 0; i < graph.getNumNodes(); ++i)
+    {
+        const AudioProcessorGraph::Node* const node = graph.getNodeInRenderingOrder(i);
+        order.push_back(node != nullptr ? node->nodeId : 0);
+    }
+
+    return order;
+}
+
+// Every node must show up once, and every connection to a higher node id must go forward in the order.
+// Connections back to a lower node id are the feedback ones, which the order ignores.
+static bool checkOrder(const AudioProcessorGraph& graph, const char* const name, const int numNodes, const char* const stage)
+{
+    const std::vector<uint32> order(getOrder(graph));
+    std::vector<int> positions(static_cast<size_t>(numNodes + 1), -1);
+
+    if (order.size() != static_cast<size_t>(numNodes))
+    {
+        std::printf("FAIL: %s %d nodes, after %s: order has " P_SIZE " nodes\n", name, numNodes, stage, order.size());
+        return false;
+    }
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (order[i] == 0 || order[i] > static_cast<uint32>(numNodes) || positions[order[i]] != -1)
+        {
+            std::printf("FAIL: %s %d nodes, after %s: node %u is missing or repeated\n", name, numNodes, stage, order[i]);
+            return false;
+        }
+
+        positions[order[i]] = static_cast<int>(i);
+    }
+
+    for (size_t i = 0; i < graph.getNumConnections(); ++i)
+    {
+        const AudioProcessorGraph::Connection* const c = graph.getConnection(i);
+
+        if (c->sourceNodeId < c->destNodeId && positions[c->sourceNodeId] >= positions[c->destNodeId])
+        {
+            std::printf("FAIL: %s %d nodes, after %s: node %u is rendered after node %u it connects to\n",
+                        name, numNodes, stage, c->sourceNodeId, c->destNodeId);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool checkOrderUnchanged(const AudioProcessorGraph& graph, const std::vector<uint32>& previous,
+                                const char* const name, const int numNodes, const char* const stage)
+{
+    if (getOrder(graph) == previous)
+        return true;
+
+    std::printf("FAIL: %s %d nodes, after %s: feedback connection changed the order\n", name, numNodes, stage);
+    return false;
+}
+
+static bool runBenchmark(const char* const name, const int numNodes, const bool randomDag)
+{
+    AudioProcessorGraph graph;
+    graph.setPlayConfigDetails(2, 2, 0, 0, 0, 0, 48000.0, 128);
+    graph.prepareToPlay(48000.0, 128);
+
+    for (int i = 0; i < numNodes; ++i)
+        graph.addNode(new DummyProcessor(), static_cast<uint32>(i + 1));
+
+    const double editStart = getTimeInMilliseconds();
+
+    if (randomDag)
+    {
+        // connect in reverse order, so each new connection forces the order to change
+        for (int i = numNodes - 1; --i >= 0;)
+        {
+            for (int j = 0; j < 2; ++j)
+            {
+                const int dst = i + 1 + std::rand() % (numNodes - i - 1);
+                connectStereo(graph, static_cast<uint32>(i + 1), static_cast<uint32>(dst + 1));
+            }
+        }
+    }
+    else
+    {
+        for (int i = numNodes - 1; --i >= 0;)
+            connectStereo(graph, static_cast<uint32>(i + 1), static_cast<uint32>(i + 2));
+    }
+
+    const double editTime = getTimeInMilliseconds() - editStart;
+
+    if (! checkOrder(graph, name, numNodes, "connecting"))
+        return false;
+
+    // a feedback loop, which must not affect the order
+    const std::vector<uint32> orderBeforeFeedback(getOrder(graph));
+    connectStereo(graph, static_cast<uint32>(numNodes), 1);
+
+    if (! checkOrderUnchanged(graph, orderBeforeFeedback, name, numNodes, "adding feedback"))
+        return false;
+
+    const int numRebuilds = 10;
+    const double rebuildStart = getTimeInMilliseconds();
+
+    for (int i = 0; i < numRebuilds; ++i)
+        graph.buildRenderingSequence();
+
+    const double rebuildTime = (getTimeInMilliseconds() - rebuildStart) / numRebuilds;
+
+    std::printf("%-10s %5d nodes: connect %9.3f ms, rebuild %9.3f ms\n", name, numNodes, editTime, rebuildTime);
+
+    disconnectStereo(graph, static_cast<uint32>(numNodes), 1);
+
+    if (! checkOrderUnchanged(graph, orderBeforeFeedback, name, numNodes, "removing feedback"))
+        return false;
+
+    // take out some connections, then add new ones that need the order to change again
+    for (size_t i = graph.getNumConnections(); i > 0; i -= std::min<size_t>(i, 3))
+    {
+        const AudioProcessorGraph::Connection* const c = graph.getConnection(i - 1);
+        graph.removeConnection(c->channelType, c->sourceNodeId, c->sourceChannelIndex, c->destNodeId, c->destChannelIndex);
+    }
+
+    if (! checkOrder(graph, name, numNodes, "disconnecting"))
+        return false;
+
+    for (int i = numNodes - 1; --i >= 0;)
+    {
+        const int dst = i + 1 + std::rand() % (numNodes - i - 1);
+        connectStereo(graph, static_cast<uint32>(i + 1), static_cast<uint32>(dst + 1));
+    }
+
+    if (! checkOrder(graph, name, numNodes, "reconnecting"))
+        return false;
+
+    graph.releaseResources();
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+int main()
+{
+    static const int sizes[] = { 10, 50, 100, 250, 500, 1000 };
+
+    std::srand(1);
+
+    for (uint i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i)
+        if (! runBenchmark("chain", sizes[i], false))
+            return 1;
+
+    for (uint i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i)
+        if (! runBenchmark("random-dag", sizes[i], true))
+            return 1;
+
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
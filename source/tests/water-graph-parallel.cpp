@@ -0,0 +1,176 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+// Checks that parallel patchbay rendering is bit-identical to serial rendering.
+
+#include "water/processors/AudioProcessorGraph.h"
+#include "water/text/String.h"
+
+#include "CarlaEngineUtils.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace water;
+using CarlaBackend::kMaxEngineEventInternalCount;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// A stateful, non-linear processor, so any change in processing order or input shows up in the output.
+class ShaperProcessor : public AudioProcessor
+{
+public:
+    ShaperProcessor(const float g)
+        : gain(g)
+    {
+        setPlayConfigDetails(2, 2, 0, 0, 0, 0, 48000.0, 128);
+        state[0] = state[1] = 0.0f;
+    }
+
+    const String getName() const override { return "Shaper"; }
+    void prepareToPlay(double, int) override {}
+    void releaseResources() override {}
+    bool acceptsMidi() const override { return false; }
+    bool producesMidi() const override { return false; }
+
+    void processBlockWithCV(AudioSampleBuffer& audio, const AudioSampleBuffer&, AudioSampleBuffer&, EngineEvent*) override
+    {
+        for (uint32 c = 0; c < 2; ++c)
+        {
+            float* const data = audio.getWritePointer(c);
+
+            for (int i = 0, count = audio.getNumSamples(); i < count; ++i)
+            {
+                state[c] = std::tanh(data[i] * gain + state[c] * 0.5f);
+                data[i] = state[c];
+            }
+        }
+    }
+
+private:
+    const float gain;
+    float state[2];
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+static const int kNumBranches = 8;
+static const int kBranchLength = 4;
+static const int kBlockSize = 128;
+static const int kNumBlocks = 500;
+
+static void connectStereo(AudioProcessorGraph& graph, const uint32 src, const uint32 dst)
+{
+    graph.addConnection(AudioProcessor::ChannelTypeAudio, src, 0, dst, 0);
+    graph.addConnection(AudioProcessor::ChannelTypeAudio, src, 1, dst, 1);
+}
+
+static std::vector<float> render(const uint numThreads)
+{
+    AudioProcessorGraph graph;
+    graph.setPlayConfigDetails(2, 2, 0, 0, 0, 0, 48000.0, kBlockSize);
+    graph.prepareToPlay(48000.0, kBlockSize);
+    graph.setNumParallelRenderingThreads(numThreads);
+
+    const uint32 inputId = 1, outputId = 2;
+    graph.addNode(new AudioProcessorGraph::AudioGraphIOProcessor(AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode), inputId);
+    graph.addNode(new AudioProcessorGraph::AudioGraphIOProcessor(AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode), outputId);
+
+    // independent branches from input to output, with a few links across them
+    for (int b = 0; b < kNumBranches; ++b)
+    {
+        for (int n = 0; n < kBranchLength; ++n)
+        {
+            const uint32 nodeId = static_cast<uint32>(10 + b * kBranchLength + n);
+            graph.addNode(new ShaperProcessor(0.5f + 0.1f * static_cast<float>(b * kBranchLength + n)), nodeId);
+            connectStereo(graph, n == 0 ? inputId : nodeId - 1, nodeId);
+        }
+
+        connectStereo(graph, static_cast<uint32>(10 + b * kBranchLength + kBranchLength - 1), outputId);
+
+        if (b % 3 == 1)
+            connectStereo(graph, static_cast<uint32>(10 + (b - 1) * kBranchLength + 1), static_cast<uint32>(10 + b * kBranchLength + 2));
+    }
+
+    graph.buildRenderingSequence();
+
+    AudioSampleBuffer audio(2, kBlockSize), cvIn(0, kBlockSize), cvOut(0, kBlockSize);
+    std::vector<EngineEvent> eventsIn(kMaxEngineEventInternalCount), eventsOut(kMaxEngineEventInternalCount);
+    std::memset(&eventsIn[0], 0, sizeof(EngineEvent) * kMaxEngineEventInternalCount);
+    std::memset(&eventsOut[0], 0, sizeof(EngineEvent) * kMaxEngineEventInternalCount);
+
+    std::vector<float> output;
+    output.reserve(2 * kBlockSize * kNumBlocks);
+
+    for (int block = 0; block < kNumBlocks; ++block)
+    {
+        for (uint32 c = 0; c < 2; ++c)
+        {
+            float* const data = audio.getWritePointer(c);
+
+            for (int i = 0; i < kBlockSize; ++i)
+                data[i] = std::sin(static_cast<float>(block * kBlockSize + i) * (0.01f + 0.005f * static_cast<float>(c)));
+        }
+
+        graph.processBlockWithCV(audio, cvIn, cvOut, &eventsIn[0], &eventsOut[0]);
+
+        for (uint32 c = 0; c < 2; ++c)
+            output.insert(output.end(), audio.getReadPointer(c), audio.getReadPointer(c) + kBlockSize);
+    }
+
+    graph.releaseResources();
+    return output;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+int main()
+{
+    const std::vector<float> serial(render(0));
+
+    bool silent = true;
+    for (std::size_t i = 0; silent && i < serial.size(); ++i)
+        silent = serial[i] == 0.0f;
+
+    if (silent)
+    {
+        std::printf("FAIL: serial rendering produced silence\n");
+        return 1;
+    }
+
+    static const uint threadCounts[] = { 1, 2, 3, 7 };
+
+    for (uint t = 0; t < sizeof(threadCounts)/sizeof(threadCounts[0]); ++t)
+    {
+        const std::vector<float> parallel(render(threadCounts[t]));
+
+        if (parallel.size() != serial.size() ||
+            std::memcmp(&parallel[0], &serial[0], serial.size() * sizeof(float)) != 0)
+        {
+            std::printf("FAIL: parallel rendering with %u threads differs from serial rendering\n", threadCounts[t]);
+            return 1;
+        }
+
+        std::printf("parallel rendering with %u threads is bit-identical to serial rendering\n", threadCounts[t]);
+    }
+
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,247 @@
+/*
+ * Carla audio file writer
+ * Copyright (C) 2011-2020 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_AUDIO_FILE_WRITER_HPP_INCLUDED
+#define CARLA_AUDIO_FILE_WRITER_HPP_INCLUDED
+
+#include "CarlaString.hpp"
+
+#ifdef HAVE_SNDFILE
+# include <sndfile.h>
+#endif
+
+#include <cstdio>
+
+// -----------------------------------------------------------------------
+// CarlaAudioFileWriter class
+
+/*!
+ * Write planar float buffers into an audio file.
+ * The format is picked from the filename extension, ".wav" or ".flac".
+ * Uses libsndfile when available, otherwise only 32-bit float WAV files can be written.
+ * Not realtime safe.
+ */
+class CarlaAudioFileWriter
+{
+public:
+    CarlaAudioFileWriter() noexcept
+        : fChannels(0),
+          fFile(nullptr),
+#ifndef HAVE_SNDFILE
+          fFramesWritten(0),
+          fSampleRate(0),
+#endif
+          fBuffer(nullptr),
+          fBufferFrames(0),
+          fLastError() {}
+
+    ~CarlaAudioFileWriter() noexcept
+    {
+        close();
+    }
+
+    /*!
+     * Open @a filename for writing, replacing any existing file.
+     */
+    bool open(const char* const filename, const uint channels, const double sampleRate) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+        CARLA_SAFE_ASSERT_RETURN(channels > 0, false);
+        CARLA_SAFE_ASSERT_RETURN(sampleRate > 0.0, false);
+        CARLA_SAFE_ASSERT_RETURN(fFile == nullptr, false);
+
+        const bool isFlac = CarlaString(filename).toLower().endsWith(".flac");
+
+        fChannels = channels;
+
+#ifdef HAVE_SNDFILE
+        SF_INFO info;
+        carla_zeroStruct(info);
+        info.samplerate = static_cast<int>(sampleRate + 0.5);
+        info.channels   = static_cast<int>(channels);
+        info.format     = isFlac ? (SF_FORMAT_FLAC|SF_FORMAT_PCM_24) : (SF_FORMAT_WAV|SF_FORMAT_FLOAT);
+
+        fFile = sf_open(filename, SFM_WRITE, &info);
+
+        if (fFile == nullptr)
+        {
+            fLastError = sf_strerror(nullptr);
+            return false;
+        }
+#else
+        if (isFlac)
+        {
+            fLastError = "FLAC output requires libsndfile";
+            return false;
+        }
+
+        fFile = std::fopen(filename, "wb");
+
+        if (fFile == nullptr)
+        {
+            fLastError = "Failed to open file for writing";
+            return false;
+        }
+
+        fFramesWritten = 0;
+        fSampleRate = static_cast<uint32_t>(sampleRate + 0.5);
+
+        // sizes are filled in again on close()
+        _writeWavHeader();
+#endif
+
+        return true;
+    }
+
+    /*!
+     * Write @a frames frames from the planar @a buffers, one per channel.
+     */
+    bool write(const float* const* const buffers, const uint32_t frames) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(fFile != nullptr, false);
+        CARLA_SAFE_ASSERT_RETURN(buffers != nullptr, false);
+
+        if (frames == 0)
+            return true;
+
+        if (frames > fBufferFrames)
+        {
+            delete[] fBuffer;
+
+            try {
+                fBuffer = new float[frames * fChannels];
+            } CARLA_SAFE_EXCEPTION_RETURN("CarlaAudioFileWriter::write", false);
+
+            fBufferFrames = frames;
+        }
+
+        for (uint32_t i=0, j=0; i < frames; ++i)
+            for (uint c=0; c < fChannels; ++c)
+                fBuffer[j++] = buffers[c][i];
+
+#ifdef HAVE_SNDFILE
+        if (sf_writef_float(fFile, fBuffer, frames) != static_cast<sf_count_t>(frames))
+        {
+            fLastError = sf_strerror(fFile);
+            return false;
+        }
+#else
+        if (std::fwrite(fBuffer, sizeof(float) * fChannels, frames, fFile) != frames)
+        {
+            fLastError = "Failed to write audio data";
+            return false;
+        }
+
+        fFramesWritten += frames;
+#endif
+
+        return true;
+    }
+
+    /*!
+     * Finish writing and close the file.
+     */
+    void close() noexcept
+    {
+        if (fFile != nullptr)
+        {
+#ifdef HAVE_SNDFILE
+            sf_close(fFile);
+#else
+            _writeWavHeader();
+            std::fclose(fFile);
+#endif
+            fFile = nullptr;
+        }
+
+        if (fBuffer != nullptr)
+        {
+            delete[] fBuffer;
+            fBuffer = nullptr;
+        }
+
+        fBufferFrames = 0;
+    }
+
+    /*!
+     * Get the last error, if open() or write() failed.
+     */
+    const char* getLastError() const noexcept
+    {
+        return fLastError.buffer();
+    }
+
+private:
+    uint fChannels;
+#ifdef HAVE_SNDFILE
+    SNDFILE* fFile;
+#else
+    std::FILE* fFile;
+    uint64_t fFramesWritten;
+    uint32_t fSampleRate;
+#endif
+    float* fBuffer;
+    uint32_t fBufferFrames;
+    CarlaString fLastError;
+
+#ifndef HAVE_SNDFILE
+    void _writeUInt(const uint32_t value, const uint bytes) noexcept
+    {
+        // WAV is little endian
+        for (uint i=0; i < bytes; ++i)
+            std::fputc(static_cast<int>((value >> (i * 8)) & 0xff), fFile);
+    }
+
+    void _writeWavHeader() noexcept
+    {
+        const uint32_t dataSize = static_cast<uint32_t>(fFramesWritten * fChannels * sizeof(float));
+
+        std::fseek(fFile, 0, SEEK_SET);
+
+        std::fwrite("RIFF", 1, 4, fFile);
+        _writeUInt(50 + dataSize, 4);
+        std::fwrite("WAVE", 1, 4, fFile);
+
+        // format chunk, IEEE float
+        std::fwrite("fmt ", 1, 4, fFile);
+        _writeUInt(18, 4);
+        _writeUInt(3, 2);
+        _writeUInt(fChannels, 2);
+        _writeUInt(fSampleRate, 4);
+        _writeUInt(fSampleRate * fChannels * sizeof(float), 4);
+        _writeUInt(fChannels * sizeof(float), 2);
+        _writeUInt(32, 2);
+        _writeUInt(0, 2);
+
+        // fact chunk, required for non-PCM data
+        std::fwrite("fact", 1, 4, fFile);
+        _writeUInt(4, 4);
+        _writeUInt(static_cast<uint32_t>(fFramesWritten), 4);
+
+        std::fwrite("data", 1, 4, fFile);
+        _writeUInt(dataSize, 4);
+
+        std::fseek(fFile, 0, SEEK_END);
+    }
+#endif
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaAudioFileWriter)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // CARLA_AUDIO_FILE_WRITER_HPP_INCLUDED
@@ -408,6 +408,16 @@ const char* EngineOption2Str(const EngineOption option) noexcept
         return "ENGINE_OPTION_CLIENT_NAME_PREFIX";
     case ENGINE_OPTION_PLUGINS_ARE_STANDALONE:
         return "ENGINE_OPTION_PLUGINS_ARE_STANDALONE";
+    case ENGINE_OPTION_PATCHBAY_THREADS:
+        return "ENGINE_OPTION_PATCHBAY_THREADS";
+    case ENGINE_OPTION_LOADER_THREADS:
+        return "ENGINE_OPTION_LOADER_THREADS";
+    case ENGINE_OPTION_CONTROL_OUTPUT_THRESHOLD:
+        return "ENGINE_OPTION_CONTROL_OUTPUT_THRESHOLD";
+    case ENGINE_OPTION_CONTROL_OUTPUT_RATE_LIMIT:
+        return "ENGINE_OPTION_CONTROL_OUTPUT_RATE_LIMIT";
+    case ENGINE_OPTION_AUTO_SUSPEND_TIME:
+        return "ENGINE_OPTION_AUTO_SUSPEND_TIME";
     }
 
     carla_stderr("CarlaBackend::EngineOption2Str(%i) - invalid option", option);
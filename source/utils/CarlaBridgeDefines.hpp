@@ -24,7 +24,7 @@
 #define CARLA_PLUGIN_BRIDGE_API_VERSION_MINIMUM 6
 
 // current API version, bumped when something is added
-#define CARLA_PLUGIN_BRIDGE_API_VERSION_CURRENT 8
+#define CARLA_PLUGIN_BRIDGE_API_VERSION_CURRENT 9
 
 // -------------------------------------------------------------------------------------------------------------------
 
@@ -79,6 +79,9 @@ enum PluginBridgeNonRtClientOpcode {
     kPluginBridgeNonRtClientSetOptions,                     // uint
     // stuff added in API 8
     kPluginBridgeNonRtClientSetWindowTitle,                 // uint/size, str[]
+    // stuff added in API 9
+    kPluginBridgeNonRtClientSetChunkPool,                   // ulong/size
+    kPluginBridgeNonRtClientSetChunkDataShm,                // ulong/size (raw data in chunk pool)
 };
 
 // Client sends these to server during non-RT
@@ -114,7 +117,11 @@ enum PluginBridgeNonRtServerOpcode {
     kPluginBridgeNonRtServerUiClosed,
     kPluginBridgeNonRtServerError,              // uint/size, str[]
     // stuff added in API 7
-    kPluginBridgeNonRtServerVersion             // uint
+    kPluginBridgeNonRtServerVersion,            // uint
+    // stuff added in API 9
+    kPluginBridgeNonRtServerSetChunkDataShm,    // ulong/size (raw data in chunk pool)
+    kPluginBridgeNonRtServerResizeChunkPool,    // ulong/size (save is requested again after resize)
+    kPluginBridgeNonRtServerChunkPoolReleased
 };
 
 // used for kPluginBridgeNonRtServerPortName
@@ -23,11 +23,13 @@
 
 #if defined(CARLA_OS_WIN) && !defined(BUILDING_CARLA_FOR_WINE)
 # define PLUGIN_BRIDGE_NAMEPREFIX_AUDIO_POOL    "Local\\carla-bridge_shm_ap_"
+# define PLUGIN_BRIDGE_NAMEPREFIX_CHUNK_POOL    "Local\\carla-bridge_shm_chk_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT     "Local\\carla-bridge_shm_rtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_CLIENT "Local\\carla-bridge_shm_nonrtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_SERVER "Local\\carla-bridge_shm_nonrtS_"
 #else
 # define PLUGIN_BRIDGE_NAMEPREFIX_AUDIO_POOL    "/crlbrdg_shm_ap_"
+# define PLUGIN_BRIDGE_NAMEPREFIX_CHUNK_POOL    "/crlbrdg_shm_chk_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT     "/crlbrdg_shm_rtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_CLIENT "/crlbrdg_shm_nonrtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_SERVER "/crlbrdg_shm_nonrtS_"
@@ -147,6 +149,108 @@ const char* BridgeAudioPool::getFilenameSuffix() const noexcept
 
 // -------------------------------------------------------------------------------------------------------------------
 
+BridgeChunkPool::BridgeChunkPool() noexcept
+    : data(nullptr),
+      dataSize(0),
+      filename(),
+      isServer(false)
+{
+    carla_zeroChars(shm, 64);
+    jackbridge_shm_init(shm);
+}
+
+BridgeChunkPool::~BridgeChunkPool() noexcept
+{
+    clear();
+}
+
+bool BridgeChunkPool::initializeServer(const char* const suffix) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(suffix != nullptr && suffix[0] != '\0', false);
+
+    // must be invalid right now
+    CARLA_SAFE_ASSERT_RETURN(! jackbridge_shm_is_valid(shm), false);
+
+    filename  = PLUGIN_BRIDGE_NAMEPREFIX_CHUNK_POOL;
+    filename += suffix;
+
+    const carla_shm_t shm2 = carla_shm_create(filename);
+    CARLA_SAFE_ASSERT_RETURN(carla_is_shm_valid(shm2), false);
+
+    void* const shmptr = shm;
+    carla_shm_t& shm1  = *(carla_shm_t*)shmptr;
+    carla_copyStruct(shm1, shm2);
+
+    isServer = true;
+    return true;
+}
+
+bool BridgeChunkPool::attachClient(const char* const suffix) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(suffix != nullptr && suffix[0] != '\0', false);
+
+    // must be invalid right now
+    CARLA_SAFE_ASSERT_RETURN(! jackbridge_shm_is_valid(shm), false);
+
+    filename  = PLUGIN_BRIDGE_NAMEPREFIX_CHUNK_POOL;
+    filename += suffix;
+
+    jackbridge_shm_attach(shm, filename);
+
+    return jackbridge_shm_is_valid(shm);
+}
+
+void BridgeChunkPool::clear() noexcept
+{
+    filename.clear();
+
+    if (! jackbridge_shm_is_valid(shm))
+    {
+        CARLA_SAFE_ASSERT(data == nullptr);
+        return;
+    }
+
+    if (data != nullptr)
+    {
+        jackbridge_shm_unmap(shm, data);
+        data = nullptr;
+    }
+
+    dataSize = 0;
+    jackbridge_shm_close(shm);
+    jackbridge_shm_init(shm);
+}
+
+bool BridgeChunkPool::resize(const std::size_t size) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(jackbridge_shm_is_valid(shm), false);
+    CARLA_SAFE_ASSERT_RETURN(size > 0, false);
+
+    if (isServer && size <= dataSize)
+        return true;
+
+    if (data != nullptr)
+    {
+        jackbridge_shm_unmap(shm, data);
+        data = nullptr;
+    }
+
+    // server rounds up to 64Kb so small changes in chunk size do not need a resize each time
+    dataSize = isServer ? ((size + 0xffff) & ~static_cast<std::size_t>(0xffff)) : size;
+
+    data = (uint8_t*)jackbridge_shm_map(shm, dataSize);
+
+    if (data == nullptr)
+    {
+        dataSize = 0;
+        return false;
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+
 BridgeRtClientControl::BridgeRtClientControl() noexcept
     : data(nullptr),
       filename(),
@@ -293,6 +397,23 @@ bool BridgeRtClientControl::waitForClient(const uint msecs) noexcept
     return jackbridge_sem_timedwait(&data->sem.client, msecs, true);
 }
 
+void BridgeRtClientControl::wakeUpClient() noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(isServer,);
+
+    jackbridge_sem_post(&data->sem.server, true);
+}
+
+bool BridgeRtClientControl::waitForClientReply(const uint msecs) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(msecs > 0, false);
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
+    CARLA_SAFE_ASSERT_RETURN(isServer, false);
+
+    return jackbridge_sem_timedwait(&data->sem.client, msecs, true);
+}
+
 bool BridgeRtClientControl::writeOpcode(const PluginBridgeRtClientOpcode opcode) noexcept
 {
     return writeUInt(static_cast<uint32_t>(opcode));
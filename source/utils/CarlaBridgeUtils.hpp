@@ -127,6 +127,10 @@ const char* PluginBridgeNonRtClientOpcode2str(const PluginBridgeNonRtClientOpcod
         return "kPluginBridgeNonRtClientSetOptions";
     case kPluginBridgeNonRtClientSetWindowTitle:
         return "kPluginBridgeNonRtClientSetWindowTitle";
+    case kPluginBridgeNonRtClientSetChunkPool:
+        return "kPluginBridgeNonRtClientSetChunkPool";
+    case kPluginBridgeNonRtClientSetChunkDataShm:
+        return "kPluginBridgeNonRtClientSetChunkDataShm";
     }
 
     carla_stderr("CarlaBackend::PluginBridgeNonRtClientOpcode2str(%i) - invalid opcode", opcode);
@@ -200,6 +204,12 @@ const char* PluginBridgeNonRtServerOpcode2str(const PluginBridgeNonRtServerOpcod
         return "kPluginBridgeNonRtServerError";
     case kPluginBridgeNonRtServerVersion:
         return "kPluginBridgeNonRtServerVersion";
+    case kPluginBridgeNonRtServerSetChunkDataShm:
+        return "kPluginBridgeNonRtServerSetChunkDataShm";
+    case kPluginBridgeNonRtServerResizeChunkPool:
+        return "kPluginBridgeNonRtServerResizeChunkPool";
+    case kPluginBridgeNonRtServerChunkPoolReleased:
+        return "kPluginBridgeNonRtServerChunkPoolReleased";
     }
 
     carla_stderr("CarlaBackend::PluginBridgeNonRtServerOpcode2str%i) - invalid opcode", opcode);
@@ -255,6 +265,29 @@ struct BridgeAudioPool {
 
 // -------------------------------------------------------------------------------------------------------------------
 
+// raw plugin chunk data, shared by both directions (added in API 9)
+struct BridgeChunkPool {
+    uint8_t* data;
+    std::size_t dataSize;
+    CarlaString filename;
+    char shm[64];
+    bool isServer;
+
+    BridgeChunkPool() noexcept;
+    ~BridgeChunkPool() noexcept;
+
+    bool initializeServer(const char* const suffix) noexcept;
+    bool attachClient(const char* const suffix) noexcept;
+    void clear() noexcept;
+
+    // server grows the pool as needed, client maps the size given by the server
+    bool resize(const std::size_t size) noexcept;
+
+    CARLA_DECLARE_NON_COPY_STRUCT(BridgeChunkPool)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+
 struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
     BridgeRtClientData* data;
     CarlaString filename;
@@ -276,6 +309,10 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
     bool waitForClient(const uint msecs) noexcept;
     bool writeOpcode(const PluginBridgeRtClientOpcode opcode) noexcept;
 
+    // non-bridge, server, waitForClient() split in two for pipelined processing
+    void wakeUpClient() noexcept;
+    bool waitForClientReply(const uint msecs) noexcept;
+
     // bridge, client
     PluginBridgeRtClientOpcode readOpcode() noexcept;
 
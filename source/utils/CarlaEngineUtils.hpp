@@ -22,8 +22,6 @@
 #include "CarlaUtils.hpp"
 #include "CarlaMIDI.h"
 
-#include "water/midi/MidiBuffer.h"
-
 CARLA_BACKEND_START_NAMESPACE
 
 // -----------------------------------------------------------------------
@@ -119,96 +117,119 @@ const char* EngineControlEventType2Str(const EngineControlEventType type) noexce
 
 // -----------------------------------------------------------------------
 
+// Engine event buffers are filled from the start, with their number of events kept next to them.
+// Entries past that count are always clear, so readers can also stop at the first kEngineEventTypeNull one.
+
+// clear the used part of an engine event buffer, leaving the (already clear) rest untouched
 static inline
-void fillEngineEventsFromWaterMidiBuffer(EngineEvent engineEvents[kMaxEngineEventInternalCount], const water::MidiBuffer& midiBuffer)
+void clearEngineEvents(EngineEvent engineEvents[kMaxEngineEventInternalCount], uint32_t& count) noexcept
 {
-    const uint8_t* midiData;
-    int numBytes, sampleNumber;
-    ushort engineEventIndex = 0;
-
-    for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+    if (count != 0)
     {
-        const EngineEvent& engineEvent(engineEvents[i]);
+        carla_zeroStructs(engineEvents, count);
+        count = 0;
+    }
+}
 
-        if (engineEvent.type != kEngineEventTypeNull)
-            continue;
+// replace the used part of `dst` with the events of `src`
+static inline
+void copyEngineEvents(EngineEvent dst[kMaxEngineEventInternalCount], uint32_t& dstCount,
+                      const EngineEvent src[kMaxEngineEventInternalCount], const uint32_t srcCount) noexcept
+{
+    if (srcCount != 0)
+        carla_copyStructs(dst, src, srcCount);
 
-        engineEventIndex = i;
-        break;
-    }
+    if (dstCount > srcCount)
+        carla_zeroStructs(dst + srcCount, dstCount - srcCount);
+
+    dstCount = srcCount;
+}
 
-    for (water::MidiBuffer::Iterator midiBufferIterator(midiBuffer); midiBufferIterator.getNextEvent(midiData, numBytes, sampleNumber) && engineEventIndex < kMaxEngineEventInternalCount;)
+// sort the used part of an engine event buffer by time, keeping the order of events with equal times.
+// meant for buffers that are already (nearly) sorted, which is what plugins output.
+static inline
+void sortEngineEvents(EngineEvent engineEvents[kMaxEngineEventInternalCount], const uint32_t count) noexcept
+{
+    for (uint32_t i=1; i < count; ++i)
     {
-        CARLA_SAFE_ASSERT_CONTINUE(numBytes > 0);
-        CARLA_SAFE_ASSERT_CONTINUE(sampleNumber >= 0);
-        CARLA_SAFE_ASSERT_CONTINUE(numBytes < 0xFF /* uint8_t max */);
+        if (engineEvents[i-1].time <= engineEvents[i].time)
+            continue;
+
+        const EngineEvent event(engineEvents[i]);
+        uint32_t j = i;
 
-        EngineEvent& engineEvent(engineEvents[engineEventIndex++]);
+        for (; j > 0 && engineEvents[j-1].time > event.time; --j)
+            engineEvents[j] = engineEvents[j-1];
 
-        engineEvent.time = static_cast<uint32_t>(sampleNumber);
-        engineEvent.fillFromMidiData(static_cast<uint8_t>(numBytes), midiData, 0);
+        engineEvents[j] = event;
     }
 }
 
 // -----------------------------------------------------------------------
+// The patchbay graph passes events between its nodes in buffers that have no count,
+// the used part of those ends at the first kEngineEventTypeNull entry.
 
 static inline
-void fillWaterMidiBufferFromEngineEvents(water::MidiBuffer& midiBuffer, const EngineEvent engineEvents[kMaxEngineEventInternalCount])
+uint32_t getEngineEventCount(const EngineEvent engineEvents[kMaxEngineEventInternalCount]) noexcept
 {
-    uint8_t size     = 0;
-    uint8_t mdata[3] = { 0, 0, 0 };
-    uint8_t mdataTmp[EngineMidiEvent::kDataSize];
-    const uint8_t* mdataPtr;
+    uint32_t i=0;
 
-    for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+    for (; i < kMaxEngineEventInternalCount; ++i)
     {
-        const EngineEvent& engineEvent(engineEvents[i]);
-
-        /**/ if (engineEvent.type == kEngineEventTypeNull)
-        {
+        if (engineEvents[i].type == kEngineEventTypeNull)
             break;
-        }
-        else if (engineEvent.type == kEngineEventTypeControl)
-        {
-            const EngineControlEvent& ctrlEvent(engineEvent.ctrl);
-
-            size = ctrlEvent.convertToMidiData(engineEvent.channel, mdata);
-            mdataPtr = mdata;
-        }
-        else if (engineEvent.type == kEngineEventTypeMidi)
-        {
-            const EngineMidiEvent& midiEvent(engineEvent.midi);
-
-            size = midiEvent.size;
-            CARLA_SAFE_ASSERT_CONTINUE(size > 0);
-
-            if (size > EngineMidiEvent::kDataSize)
-            {
-                CARLA_SAFE_ASSERT_CONTINUE(midiEvent.dataExt != nullptr);
-                mdataPtr = midiEvent.dataExt;
-            }
-            else
-            {
-                // set first byte
-                mdataTmp[0] = static_cast<uint8_t>(midiEvent.data[0] | (engineEvent.channel & MIDI_CHANNEL_BIT));
-
-                if (size > 1)
-                {
-                    // copy rest
-                    carla_copy<uint8_t>(mdataTmp+1, midiEvent.data+1, size-1U);
-                }
-
-                // done
-                mdataPtr = mdataTmp;
-            }
-        }
-        else
-        {
-            continue;
-        }
+    }
+
+    return i;
+}
+
+// clear the used part of a graph event buffer
+static inline
+void clearEngineEvents(EngineEvent engineEvents[kMaxEngineEventInternalCount]) noexcept
+{
+    uint32_t count = getEngineEventCount(engineEvents);
+    clearEngineEvents(engineEvents, count);
+}
+
+// replace the used part of graph event buffer `dst` with the events of `src`
+static inline
+void copyEngineEvents(EngineEvent dst[kMaxEngineEventInternalCount], const EngineEvent src[kMaxEngineEventInternalCount]) noexcept
+{
+    uint32_t dstCount = getEngineEventCount(dst);
+    copyEngineEvents(dst, dstCount, src, getEngineEventCount(src));
+}
+
+// merge the time-sorted events of graph event buffer `src` into the time-sorted `dst`.
+// on equal times `dst` events come first, when the buffer gets full the latest events are dropped.
+static inline
+void mergeEngineEvents(EngineEvent dst[kMaxEngineEventInternalCount], const EngineEvent src[kMaxEngineEventInternalCount]) noexcept
+{
+    const uint32_t srcCount = getEngineEventCount(src);
+
+    if (srcCount == 0)
+        return;
+
+    uint32_t dstCount = getEngineEventCount(dst);
+
+    // nothing to interleave, just append
+    if (dstCount == 0 || dst[dstCount-1].time <= src[0].time)
+    {
+        if (const uint32_t count = std::min<uint32_t>(srcCount, kMaxEngineEventInternalCount - dstCount))
+            carla_copyStructs(dst + dstCount, src, count);
+        return;
+    }
+
+    // merge from the back, so that `dst` events are moved before being overwritten
+    const uint32_t total = std::min<uint32_t>(dstCount + srcCount, kMaxEngineEventInternalCount);
+
+    for (uint32_t srcIndex = srcCount, writeIndex = dstCount + srcCount; srcIndex != 0;)
+    {
+        const EngineEvent& event(dstCount != 0 && dst[dstCount-1].time > src[srcIndex-1].time
+                                 ? dst[--dstCount]
+                                 : src[--srcIndex]);
 
-        if (size > 0)
-            midiBuffer.addEvent(mdataPtr, static_cast<int>(size), static_cast<int>(engineEvent.time));
+        if (--writeIndex < total)
+            dst[writeIndex] = event;
     }
 }
 
@@ -19,6 +19,8 @@
 #define CARLA_LV2_UTILS_HPP_INCLUDED
 
 #include "CarlaMathUtils.hpp"
+#include "CarlaMutex.hpp"
+#include "CarlaString.hpp"
 #include "CarlaStringList.hpp"
 #include "CarlaMIDI.h"
 
@@ -293,6 +295,13 @@ public:
     const LilvPlugin** cachedPlugins;
     uint pluginCount;
 
+    // set while only some bundles are loaded, see loadBundleLazily()
+    CarlaString lazyPath;
+    CarlaStringList lazyBundles;
+
+    // lilv is not thread-safe, plugins can be loaded from more than one thread
+    mutable CarlaMutex mutex;
+
     // ----------------------------------------------------------------------------------------------------------------
 
     Lv2WorldClass()
@@ -424,7 +433,10 @@ public:
           needsInit(true),
           allPlugins(nullptr),
           cachedPlugins(nullptr),
-          pluginCount(0) {}
+          pluginCount(0),
+          lazyPath(),
+          lazyBundles(),
+          mutex() {}
 
     ~Lv2WorldClass() override
     {
@@ -453,25 +465,49 @@ public:
             LV2_PATH = DEFAULT_LV2_PATH;
         }
 
-        if (! needsInit)
+        const CarlaMutexLocker cml(mutex);
+
+        if (! needsInit && lazyPath.isEmpty())
+            return;
+
+        loadAll(LV2_PATH);
+    }
+
+    /*
+     * Load a single bundle, for plugins that do not need lilv to be described (see Lv2RdfCache).
+     * Everything else is loaded on the next initIfNeeded() call, or when a requested state is not found.
+     */
+    void loadBundleLazily(const char* const bundle, const char* LV2_PATH)
+    {
+        CARLA_SAFE_ASSERT_RETURN(bundle != nullptr && bundle[0] != '\0',);
+
+        if (LV2_PATH == nullptr || LV2_PATH[0] == '\0')
+        {
+            static const char* const DEFAULT_LV2_PATH = LILV_DEFAULT_LV2_PATH;
+            LV2_PATH = DEFAULT_LV2_PATH;
+        }
+
+        const CarlaMutexLocker cml(mutex);
+
+        if (! needsInit && lazyPath.isEmpty())
+            return;
+        if (! lazyBundles.appendUnique(bundle))
             return;
 
         needsInit = false;
+        lazyPath = LV2_PATH;
 
-        Lilv::World::load_all(LV2_PATH);
+        Lilv::Node bundleNode(new_file_uri(nullptr, bundle));
+        CARLA_SAFE_ASSERT_RETURN(bundleNode.is_uri(),);
 
-        allPlugins = lilv_world_get_all_plugins(this->me);
-        CARLA_SAFE_ASSERT_RETURN(allPlugins != nullptr,);
+        CarlaString sBundle(bundleNode.as_uri());
 
-        if ((pluginCount = lilv_plugins_size(allPlugins)))
-        {
-            cachedPlugins = new const LilvPlugin*[pluginCount+1];
-            carla_zeroPointers(cachedPlugins, pluginCount+1);
+        if (! sBundle.endsWith("/"))
+           sBundle += "/";
 
-            int i = 0;
-            for (LilvIter* it = lilv_plugins_begin(allPlugins); ! lilv_plugins_is_end(allPlugins, it); it = lilv_plugins_next(allPlugins, it))
-                cachedPlugins[i++] = lilv_plugins_get(allPlugins, it);
-        }
+        Lilv::World::load_bundle(Lilv::Node(new_uri(sBundle)));
+
+        allPlugins = lilv_world_get_all_plugins(this->me);
     }
 
     void load_bundle(const char* const bundle)
@@ -527,23 +563,68 @@ public:
         return cPlugin;
     }
 
-    LilvState* getStateFromURI(const LV2_URI uri, const LV2_URID_Map* const uridMap) const
+    LilvState* getStateFromURI(const LV2_URI uri, const LV2_URID_Map* const uridMap)
     {
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
         CARLA_SAFE_ASSERT_RETURN(uridMap != nullptr, nullptr);
         CARLA_SAFE_ASSERT_RETURN(! needsInit, nullptr);
 
+        const CarlaMutexLocker cml(mutex);
+
         LilvNode* const uriNode(lilv_new_uri(this->me, uri));
         CARLA_SAFE_ASSERT_RETURN(uriNode != nullptr, nullptr);
 
         CARLA_SAFE_ASSERT(lilv_world_load_resource(this->me, uriNode) >= 0);
 
-        LilvState* const cState(lilv_state_new_from_world(this->me, uridMap, uriNode));
+        LilvState* cState(lilv_state_new_from_world(this->me, uridMap, uriNode));
+
+        // the state might be described in a bundle not loaded yet
+        if (cState == nullptr && lazyPath.isNotEmpty())
+        {
+            const CarlaString lv2Path(lazyPath);
+            loadAll(lv2Path);
+
+            CARLA_SAFE_ASSERT(lilv_world_load_resource(this->me, uriNode) >= 0);
+            cState = lilv_state_new_from_world(this->me, uridMap, uriNode);
+        }
+
         lilv_node_free(uriNode);
 
         return cState;
     }
 
+private:
+    // must be called with the mutex locked
+    void loadAll(const char* const LV2_PATH)
+    {
+        needsInit = false;
+        lazyPath.clear();
+        lazyBundles.clear();
+
+        Lilv::World::load_all(LV2_PATH);
+
+        allPlugins = lilv_world_get_all_plugins(this->me);
+        CARLA_SAFE_ASSERT_RETURN(allPlugins != nullptr,);
+
+        if (cachedPlugins != nullptr)
+        {
+            delete[] cachedPlugins;
+            cachedPlugins = nullptr;
+        }
+
+        if ((pluginCount = lilv_plugins_size(allPlugins)))
+        {
+            cachedPlugins = new const LilvPlugin*[pluginCount+1];
+            carla_zeroPointers(cachedPlugins, pluginCount+1);
+
+            int i = 0;
+            for (LilvIter* it = lilv_plugins_begin(allPlugins); ! lilv_plugins_is_end(allPlugins, it); it = lilv_plugins_next(allPlugins, it))
+                cachedPlugins[i++] = lilv_plugins_get(allPlugins, it);
+        }
+    }
+
+public:
+
     CARLA_PREVENT_VIRTUAL_HEAP_ALLOCATION
     CARLA_DECLARE_NON_COPY_STRUCT(Lv2WorldClass)
 };
@@ -1677,6 +1758,8 @@ const LV2_RDF_Descriptor* lv2_rdf_new(const LV2_URI uri, const bool loadPresets)
 
     Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
 
+    const CarlaMutexLocker cml(lv2World.mutex);
+
     const LilvPlugin* const cPlugin(lv2World.getPluginFromURI(uri));
     CARLA_SAFE_ASSERT_RETURN(cPlugin != nullptr, nullptr);
 
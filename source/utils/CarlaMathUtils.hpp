@@ -262,6 +262,56 @@ float carla_findMaxNormalizedFloat(const float floats[], const std::size_t count
     return maxf2;
 }
 
+/*
+ * Find the highest absolute value and the RMS value within a float array, both normalized.
+ * This takes a single pass over the data, with independent accumulators per lane so that the loop gets vectorized.
+ */
+static inline
+void carla_findMaxNormalizedAndRmsFloat(const float floats[], const std::size_t count, float& peak, float& rms) noexcept
+{
+    peak = rms = 0.0f;
+
+    CARLA_SAFE_ASSERT_RETURN(floats != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(count > 0,);
+
+    const std::size_t kLanes = 8;
+    float maxs[kLanes] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    float sums[kLanes] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    std::size_t i = 0;
+
+    for (; i + kLanes <= count; i += kLanes)
+    {
+        for (std::size_t j=0; j<kLanes; ++j)
+        {
+            const float value = floats[i+j];
+            const float absValue = std::abs(value);
+            maxs[j] = absValue > maxs[j] ? absValue : maxs[j];
+            sums[j] += value * value;
+        }
+    }
+
+    for (std::size_t j=0; i<count; ++i, ++j)
+    {
+        const float value = floats[i];
+        const float absValue = std::abs(value);
+        maxs[j] = absValue > maxs[j] ? absValue : maxs[j];
+        sums[j] += value * value;
+    }
+
+    float maxf = maxs[0], sum = sums[0];
+
+    for (std::size_t j=1; j<kLanes; ++j)
+    {
+        maxf = maxs[j] > maxf ? maxs[j] : maxf;
+        sum += sums[j];
+    }
+
+    rms = std::sqrt(sum / static_cast<float>(count));
+
+    peak = maxf < 1.0f ? maxf : 1.0f;
+    rms  = rms  < 1.0f ? rms  : 1.0f;
+}
+
 /*
  * Multiply an array with a fixed value, float-specific version.
  */
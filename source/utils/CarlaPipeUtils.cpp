@@ -565,6 +565,89 @@ void waitForChildToStopOrKillIt(pid_t& pid, const uint32_t timeOutMilliseconds)
 }
 #endif
 
+// -----------------------------------------------------------------------
+// binary frames
+//
+// A frame starts a line with kPipeFrameMarker, followed by the payload size as uint32 and the payload itself.
+// The payload is a list of items, each made of a type byte and its data:
+//  - kFrameItemString: uint32 size, string bytes and a null terminator
+//  - kFrameItemBool:   uint8
+//  - kFrameItemFloat:  float
+//  - kFrameItemDouble: double
+// Every item matches a single text line, so readers do not need to care if a frame was used or not.
+
+static const char kPipeFrameMarker = '\x1e';
+
+static const char* const kPipeFramesAnnounceMsg = "__carla-frames__";
+
+static const std::size_t kPipeFrameHeaderSize = sizeof(char) + sizeof(uint32_t);
+
+// how long to wait for the rest of a frame that does not fit the pipe at once
+static const uint32_t kPipeFrameTimeout = 1000; // ms
+
+struct PipeFrameBuffer {
+    char* data;
+    std::size_t size;
+    std::size_t pos;
+    std::size_t allocated;
+
+    PipeFrameBuffer() noexcept
+        : data(nullptr),
+          size(0),
+          pos(0),
+          allocated(0) {}
+
+    ~PipeFrameBuffer() noexcept
+    {
+        std::free(data);
+    }
+
+    bool reserve(const std::size_t needed) noexcept
+    {
+        if (needed <= allocated)
+            return true;
+
+        std::size_t newAllocated = allocated != 0 ? allocated : 0x1000;
+
+        while (newAllocated < needed)
+            newAllocated *= 2;
+
+        char* const newData = static_cast<char*>(std::realloc(data, newAllocated));
+        CARLA_SAFE_ASSERT_RETURN(newData != nullptr, false);
+
+        data = newData;
+        allocated = newAllocated;
+        return true;
+    }
+
+    bool append(const void* const buf, const std::size_t bufSize) noexcept
+    {
+        if (! reserve(size + bufSize))
+            return false;
+
+        std::memcpy(data + size, buf, bufSize);
+        size += bufSize;
+        return true;
+    }
+
+    bool appendItem(const char type, const void* const value, const std::size_t valueSize) noexcept
+    {
+        return append(&type, 1) && append(value, valueSize);
+    }
+
+    bool remaining(const std::size_t needed) const noexcept
+    {
+        return pos + needed <= size;
+    }
+
+    void clear() noexcept
+    {
+        size = pos = 0;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(PipeFrameBuffer)
+};
+
 // -----------------------------------------------------------------------
 
 struct CarlaPipeCommon::PrivateData {
@@ -596,6 +679,15 @@ struct CarlaPipeCommon::PrivateData {
     // for debugging
     bool isServer;
 
+    // we can read binary frames, and told the other side about it
+    bool framesAnnounced;
+
+    // the other side can read binary frames
+    bool framesAccepted;
+
+    // messages are being collected for endFrame()
+    bool writingFrame;
+
     // common write lock
     CarlaMutex writeLock;
 
@@ -603,6 +695,10 @@ struct CarlaPipeCommon::PrivateData {
     mutable char        tmpBuf[0xffff];
     mutable CarlaString tmpStr;
 
+    // frame buffers, send side is protected by writeLock, receive side only used in idlePipe() context
+    PipeFrameBuffer sendFrame;
+    PipeFrameBuffer recvFrame;
+
     PrivateData() noexcept
 #ifdef CARLA_OS_WIN
         : processInfo(),
@@ -616,9 +712,14 @@ struct CarlaPipeCommon::PrivateData {
           pipeClosed(true),
           lastMessageFailed(false),
           isServer(false),
+          framesAnnounced(false),
+          framesAccepted(false),
+          writingFrame(false),
           writeLock(),
           tmpBuf(),
-          tmpStr()
+          tmpStr(),
+          sendFrame(),
+          recvFrame()
     {
 #ifdef CARLA_OS_WIN
         carla_zeroStruct(processInfo);
@@ -632,6 +733,114 @@ struct CarlaPipeCommon::PrivateData {
         carla_zeroChars(tmpBuf, 0xffff);
     }
 
+    // blocking read of a known size, used for frames
+    bool readFully(void* const buf, const std::size_t size) noexcept
+    {
+        char* ptr = static_cast<char*>(buf);
+        std::size_t remaining = size;
+        ssize_t ret;
+
+        const uint32_t timeoutEnd(water::Time::getMillisecondCounter() + kPipeFrameTimeout);
+
+        while (remaining != 0)
+        {
+            try {
+#ifdef CARLA_OS_WIN
+                ret = ReadFileWin32(pipeRecv, ovRecv, ptr, remaining);
+#else
+                ret = ::read(pipeRecv, ptr, remaining);
+#endif
+            } CARLA_SAFE_EXCEPTION_RETURN("CarlaPipeCommon::readFully() - read", false);
+
+#ifdef CARLA_OS_WIN
+            if (ret == -1)
+#else
+            if (ret == -1 && errno == EAGAIN)
+#endif
+            {
+                if (water::Time::getMillisecondCounter() < timeoutEnd)
+                {
+                    carla_msleep(1);
+                    continue;
+                }
+                // the frame start was already consumed, there is no way to find the next message
+                carla_stderr("CarlaPipeCommon::readFully() - timed out with " P_SIZE " bytes remaining", remaining);
+                pipeClosed = true;
+                return false;
+            }
+
+            CARLA_SAFE_ASSERT_INT2_RETURN(ret > 0, ret, remaining, false);
+            CARLA_SAFE_ASSERT_INT2_RETURN(ret <= (ssize_t)remaining, ret, remaining, false);
+
+            ptr += ret;
+            remaining -= static_cast<std::size_t>(ret);
+        }
+
+        return true;
+    }
+
+    // blocking write of a known size, used for frames, which can be larger than the pipe buffer
+    bool writeFully(const char* ptr, const std::size_t size) noexcept
+    {
+        std::size_t remaining = size;
+        ssize_t ret;
+
+        const uint32_t timeoutEnd(water::Time::getMillisecondCounter() + kPipeFrameTimeout);
+
+        while (remaining != 0)
+        {
+            try {
+#ifdef CARLA_OS_WIN
+                ret = WriteFileWin32(pipeSend, ovSend, ptr, remaining);
+#else
+                ret = ::write(pipeSend, ptr, remaining);
+#endif
+            } CARLA_SAFE_EXCEPTION_RETURN("CarlaPipeCommon::writeFully() - write", false);
+
+#ifdef CARLA_OS_WIN
+            if (ret == -2)
+            {
+                pipeClosed = true;
+                return false;
+            }
+#endif
+
+            if (ret > 0)
+            {
+                CARLA_SAFE_ASSERT_INT2_RETURN(ret <= (ssize_t)remaining, ret, remaining, false);
+
+                ptr += ret;
+                remaining -= static_cast<std::size_t>(ret);
+                continue;
+            }
+
+#ifndef CARLA_OS_WIN
+            if (ret == -1 && errno != EAGAIN)
+            {
+                carla_stderr("CarlaPipeCommon::writeFully() - write failed with " P_SIZE " bytes remaining", remaining);
+                return false;
+            }
+#endif
+
+            // the reader has not caught up yet
+            if (water::Time::getMillisecondCounter() < timeoutEnd)
+            {
+                carla_msleep(1);
+                continue;
+            }
+
+            carla_stderr("CarlaPipeCommon::writeFully() - timed out with " P_SIZE " bytes remaining", remaining);
+
+            // the reader would take whatever comes next as the rest of the frame
+            if (remaining != size)
+                pipeClosed = true;
+
+            return false;
+        }
+
+        return true;
+    }
+
     CARLA_DECLARE_NON_COPY_STRUCT(PrivateData)
 };
 
@@ -677,6 +886,10 @@ void CarlaPipeCommon::idlePipe(const bool onlyOnce) noexcept
         {
             pData->pipeClosed = true;
         }
+        else if (std::strcmp(msg, kPipeFramesAnnounceMsg) == 0)
+        {
+            pData->framesAccepted = true;
+        }
         else if (! pData->clientClosingDown)
         {
             try {
@@ -721,6 +934,9 @@ bool CarlaPipeCommon::readNextLineAsBool(bool& value) const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(pData->isReading, false);
 
+    if (_readFrameValue(kFrameItemBool, &value))
+        return true;
+
     if (const char* const msg = _readlineblock(false))
     {
         value = (std::strcmp(msg, "true") == 0);
@@ -819,6 +1035,9 @@ bool CarlaPipeCommon::readNextLineAsFloat(float& value) const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(pData->isReading, false);
 
+    if (_readFrameValue(kFrameItemFloat, &value))
+        return true;
+
     if (const char* const msg = _readlineblock(false))
     {
         {
@@ -835,6 +1054,9 @@ bool CarlaPipeCommon::readNextLineAsDouble(double& value) const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(pData->isReading, false);
 
+    if (_readFrameValue(kFrameItemDouble, &value))
+        return true;
+
     if (const char* const msg = _readlineblock(false))
     {
         {
@@ -946,6 +1168,9 @@ bool CarlaPipeCommon::flushMessages() const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(pData->pipeSend != INVALID_PIPE_VALUE, false);
 
+    if (pData->writingFrame)
+        return true;
+
 #if defined(CARLA_OS_LINUX) || defined(CARLA_OS_GNU_HURD)
 # if defined(__GLIBC__) && (__GLIBC__ * 1000 + __GLIBC_MINOR__) >= 2014
     // the only call that seems to do something
@@ -961,6 +1186,102 @@ bool CarlaPipeCommon::flushMessages() const noexcept
     return true;
 }
 
+// -------------------------------------------------------------------
+// must be locked before calling
+
+void CarlaPipeCommon::beginFrame() const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(! pData->writingFrame,);
+
+    pData->sendFrame.clear();
+    pData->writingFrame = true;
+
+    if (pData->framesAccepted)
+    {
+        // header is filled in endFrame()
+        char header[kPipeFrameHeaderSize] = { kPipeFrameMarker, 0, 0, 0, 0 };
+        pData->sendFrame.append(header, kPipeFrameHeaderSize);
+    }
+}
+
+bool CarlaPipeCommon::endFrame() const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->writingFrame, false);
+
+    pData->writingFrame = false;
+
+    PipeFrameBuffer& frame(pData->sendFrame);
+
+    if (pData->framesAccepted)
+    {
+        if (frame.size <= kPipeFrameHeaderSize)
+            return true;
+
+        const uint32_t payloadSize = static_cast<uint32_t>(frame.size - kPipeFrameHeaderSize);
+        std::memcpy(frame.data + 1, &payloadSize, sizeof(uint32_t));
+    }
+    else if (frame.size == 0)
+    {
+        return true;
+    }
+
+    if (pData->pipeClosed)
+        return false;
+
+    if (pData->pipeSend == INVALID_PIPE_VALUE)
+    {
+        carla_stderr2("CarlaPipe write error, isServer:%s, frame of " P_SIZE " bytes", bool2str(pData->isServer), frame.size);
+        return false;
+    }
+
+    // a partially written frame would desync the protocol, write all of it
+    if (! pData->writeFully(frame.data, frame.size))
+    {
+        pData->lastMessageFailed = true;
+        return false;
+    }
+
+    pData->lastMessageFailed = false;
+
+    flushMessages();
+    return true;
+}
+
+bool CarlaPipeCommon::writeBoolValue(const bool value) const noexcept
+{
+    if (pData->writingFrame && pData->framesAccepted)
+    {
+        const uint8_t value8 = value ? 1 : 0;
+        return pData->sendFrame.appendItem(kFrameItemBool, &value8, sizeof(uint8_t));
+    }
+
+    return value ? _writeMsgBuffer("true\n", 5) : _writeMsgBuffer("false\n", 6);
+}
+
+bool CarlaPipeCommon::writeFloatValue(const float value) const noexcept
+{
+    if (pData->writingFrame && pData->framesAccepted)
+        return pData->sendFrame.appendItem(kFrameItemFloat, &value, sizeof(float));
+
+    return writeDoubleValue(static_cast<double>(value));
+}
+
+bool CarlaPipeCommon::writeDoubleValue(const double value) const noexcept
+{
+    if (pData->writingFrame && pData->framesAccepted)
+        return pData->sendFrame.appendItem(kFrameItemDouble, &value, sizeof(double));
+
+    char tmpBuf[0xff];
+    tmpBuf[0xfe] = '\0';
+
+    {
+        const CarlaScopedLocale csl;
+        std::snprintf(tmpBuf, 0xfe, "%.12g\n", value);
+    }
+
+    return _writeMsgBuffer(tmpBuf, std::strlen(tmpBuf));
+}
+
 // -------------------------------------------------------------------
 
 bool CarlaPipeCommon::writeErrorMessage(const char* const error) const noexcept
@@ -1249,6 +1570,12 @@ const char* CarlaPipeCommon::_readline(const bool allocReturn, const uint16_t si
 
     pData->tmpStr.clear();
 
+    if (pData->recvFrame.pos < pData->recvFrame.size)
+    {
+        readSucess = true;
+        return _readFrameLine(allocReturn);
+    }
+
     if (size == 0 || size == 1)
     {
         for (int i=0; i<0xfffe; ++i)
@@ -1264,6 +1591,28 @@ const char* CarlaPipeCommon::_readline(const bool allocReturn, const uint16_t si
             if (ret != 1)
                 break;
 
+            if (c == kPipeFrameMarker && i == 0 && ! tooBig && pData->framesAnnounced)
+            {
+                PipeFrameBuffer& frame(pData->recvFrame);
+                uint32_t payloadSize = 0;
+
+                frame.clear();
+
+                if (! pData->readFully(&payloadSize, sizeof(uint32_t)))
+                    return nullptr;
+                if (payloadSize == 0)
+                    return nullptr;
+                if (! frame.reserve(payloadSize))
+                    return nullptr;
+                if (! pData->readFully(frame.data, payloadSize))
+                    return nullptr;
+
+                frame.size = payloadSize;
+
+                readSucess = true;
+                return _readFrameLine(allocReturn);
+            }
+
             if (c == '\n')
             {
                 *ptr = '\0';
@@ -1357,6 +1706,129 @@ const char* CarlaPipeCommon::_readline(const bool allocReturn, const uint16_t si
     return allocReturn ? pData->tmpStr.releaseBufferPointer() : pData->tmpStr.buffer();
 }
 
+const char* CarlaPipeCommon::_readFrameLine(const bool allocReturn) const noexcept
+{
+    PipeFrameBuffer& frame(pData->recvFrame);
+    CARLA_SAFE_ASSERT_RETURN(frame.remaining(1), nullptr);
+
+    const char type = frame.data[frame.pos++];
+    char* const buf = pData->tmpBuf;
+    const char* str = nullptr;
+    bool valid = false;
+
+    switch (type)
+    {
+    case kFrameItemString: {
+        uint32_t strSize;
+        CARLA_SAFE_ASSERT_BREAK(frame.remaining(sizeof(uint32_t)));
+        std::memcpy(&strSize, frame.data + frame.pos, sizeof(uint32_t));
+        frame.pos += sizeof(uint32_t);
+
+        CARLA_SAFE_ASSERT_BREAK(frame.remaining(strSize + 1));
+        char* const data = frame.data + frame.pos;
+        frame.pos += strSize + 1;
+
+        for (uint32_t i=0; i<strSize; ++i)
+        {
+            if (data[i] == '\r')
+                data[i] = '\n';
+        }
+
+        str = data;
+        valid = true;
+    }   break;
+
+    case kFrameItemBool:
+        CARLA_SAFE_ASSERT_BREAK(frame.remaining(sizeof(uint8_t)));
+        str = frame.data[frame.pos] != 0 ? "true" : "false";
+        frame.pos += sizeof(uint8_t);
+        valid = true;
+        break;
+
+    case kFrameItemFloat:
+    case kFrameItemDouble: {
+        double value;
+
+        if (type == kFrameItemFloat)
+        {
+            float valuef;
+            CARLA_SAFE_ASSERT_BREAK(frame.remaining(sizeof(float)));
+            std::memcpy(&valuef, frame.data + frame.pos, sizeof(float));
+            frame.pos += sizeof(float);
+            value = static_cast<double>(valuef);
+        }
+        else
+        {
+            CARLA_SAFE_ASSERT_BREAK(frame.remaining(sizeof(double)));
+            std::memcpy(&value, frame.data + frame.pos, sizeof(double));
+            frame.pos += sizeof(double);
+        }
+
+        {
+            const CarlaScopedLocale csl;
+            std::snprintf(buf, 0xfe, "%.12g", value);
+        }
+
+        str = buf;
+        valid = true;
+    }   break;
+
+    default:
+        carla_stderr2("CarlaPipeCommon::_readFrameLine() - invalid item type %i", type);
+        break;
+    }
+
+    // something went wrong, drop the rest of the frame
+    if (! valid)
+    {
+        frame.clear();
+        str = "";
+    }
+
+    if (frame.pos == frame.size)
+        frame.clear();
+
+    if (allocReturn)
+    {
+        pData->tmpStr = str;
+        return pData->tmpStr.releaseBufferPointer();
+    }
+
+    // frame data stays valid until the next frame is read
+    return str;
+}
+
+bool CarlaPipeCommon::_readFrameValue(const FrameItemType type, void* const value) const noexcept
+{
+    PipeFrameBuffer& frame(pData->recvFrame);
+
+    if (! frame.remaining(1) || frame.data[frame.pos] != type)
+        return false;
+
+    switch (type)
+    {
+    case kFrameItemBool:
+        CARLA_SAFE_ASSERT_RETURN(frame.remaining(1 + sizeof(uint8_t)), false);
+        *static_cast<bool*>(value) = frame.data[frame.pos + 1] != 0;
+        frame.pos += 1 + sizeof(uint8_t);
+        return true;
+    case kFrameItemFloat:
+        CARLA_SAFE_ASSERT_RETURN(frame.remaining(1 + sizeof(float)), false);
+        std::memcpy(value, frame.data + frame.pos + 1, sizeof(float));
+        frame.pos += 1 + sizeof(float);
+        return true;
+    case kFrameItemDouble:
+        CARLA_SAFE_ASSERT_RETURN(frame.remaining(1 + sizeof(double)), false);
+        std::memcpy(value, frame.data + frame.pos + 1, sizeof(double));
+        frame.pos += 1 + sizeof(double);
+        return true;
+    case kFrameItemString:
+        break;
+    }
+
+    return false;
+}
+
 const char* CarlaPipeCommon::_readlineblock(const bool allocReturn,
                                             const uint16_t size,
                                             const uint32_t timeOutMilliseconds) const noexcept
@@ -1408,6 +1880,32 @@ bool CarlaPipeCommon::_writeMsgBuffer(const char* const msg, const std::size_t s
     if (pData->pipeClosed)
         return false;
 
+    if (pData->writingFrame)
+    {
+        if (! pData->framesAccepted)
+            return pData->sendFrame.append(msg, size);
+
+        // one string item per line
+        for (std::size_t start = 0, i = 0; i < size; ++i)
+        {
+            if (msg[i] != '\n')
+                continue;
+
+            const uint32_t strSize = static_cast<uint32_t>(i - start);
+
+            if (! pData->sendFrame.appendItem(kFrameItemString, &strSize, sizeof(uint32_t)))
+                return false;
+            if (! pData->sendFrame.append(msg + start, strSize))
+                return false;
+            if (! pData->sendFrame.append("", 1))
+                return false;
+
+            start = i + 1;
+        }
+
+        return true;
+    }
+
     if (pData->pipeSend == INVALID_PIPE_VALUE)
     {
         carla_stderr2("CarlaPipe write error, isServer:%s, message was:\n%s", bool2str(pData->isServer), msg);
@@ -1703,6 +2201,7 @@ bool CarlaPipeServer::startPipeServer(const char* const filename,
         pData->pipeRecv = pipeRecvClient;
         pData->pipeSend = pipeSendClient;
         pData->pipeClosed = false;
+        pData->framesAccepted = false;
         carla_stdout("ALL OK!");
         return true;
     }
@@ -1922,6 +2421,12 @@ bool CarlaPipeClient::initPipeClient(const char* argv[]) noexcept
     if (writeMessage("\n", 1))
         flushMessages();
 
+    // we can read binary frames from now on
+    pData->framesAnnounced = true;
+
+    if (writeMessage("__carla-frames__\n"))
+        flushMessages();
+
     return true;
 }
 
@@ -171,9 +171,43 @@ public:
 
     /*!
      * Flush all messages currently in cache.
+     * Does nothing while a frame is being written.
      */
     bool flushMessages() const noexcept;
 
+    // -------------------------------------------------------------------
+    // write frames, must be locked before calling
+
+    /*!
+     * Start collecting messages into a single frame.
+     * Everything written until endFrame() is sent with a single write, as a length-prefixed binary frame
+     * if the other side has announced support for it, or as regular text lines otherwise.
+     */
+    void beginFrame() const noexcept;
+
+    /*!
+     * Send and flush all messages collected since beginFrame().
+     */
+    bool endFrame() const noexcept;
+
+    /*!
+     * Write a boolean value.
+     * Sent as binary inside frames, or as a "true"/"false" line otherwise.
+     */
+    bool writeBoolValue(bool value) const noexcept;
+
+    /*!
+     * Write a floating point value (single precision).
+     * Sent as binary inside frames, or as a text line otherwise.
+     */
+    bool writeFloatValue(float value) const noexcept;
+
+    /*!
+     * Write a floating point value (double precision).
+     * Sent as binary inside frames, or as a text line otherwise.
+     */
+    bool writeDoubleValue(double value) const noexcept;
+
     // -------------------------------------------------------------------
     // write prepared messages, no lock or flush needed (done internally)
 
@@ -249,9 +283,51 @@ protected:
     /*! @internal */
     bool _writeMsgBuffer(const char* msg, std::size_t size) const noexcept;
 
+    /*! @internal */
+    enum FrameItemType {
+        kFrameItemString = 's',
+        kFrameItemBool   = 'b',
+        kFrameItemFloat  = 'f',
+        kFrameItemDouble = 'd'
+    };
+
+    /*! @internal */
+    bool _readFrameValue(FrameItemType type, void* value) const noexcept;
+
+    /*! @internal */
+    const char* _readFrameLine(bool allocReturn) const noexcept;
+
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPipeCommon)
 };
 
+// -----------------------------------------------------------------------
+// CarlaScopedPipeFrame class
+
+/*!
+ * Helper to write all messages of a scope as a single frame.
+ * The pipe must be locked for the lifetime of this object.
+ */
+class CarlaScopedPipeFrame
+{
+public:
+    CarlaScopedPipeFrame(const CarlaPipeCommon& pipe) noexcept
+        : fPipe(pipe)
+    {
+        fPipe.beginFrame();
+    }
+
+    ~CarlaScopedPipeFrame() noexcept
+    {
+        fPipe.endFrame();
+    }
+
+private:
+    const CarlaPipeCommon& fPipe;
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaScopedPipeFrame)
+};
+
 // -----------------------------------------------------------------------
 // CarlaPipeServer class
 
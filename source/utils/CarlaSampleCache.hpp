@@ -0,0 +1,377 @@
+/*
+ * Carla shared sample cache
+ * Copyright (C) 2011-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_SAMPLE_CACHE_HPP_INCLUDED
+#define CARLA_SAMPLE_CACHE_HPP_INCLUDED
+
+#include "CarlaMathUtils.hpp"
+#include "CarlaMutex.hpp"
+#include "CarlaString.hpp"
+#include "LinkedList.hpp"
+
+extern "C" {
+#include "audio_decoder/ad.h"
+}
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6))
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include "zita-resampler/resampler.h"
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6))
+# pragma GCC diagnostic pop
+#endif
+
+#include <sys/stat.h>
+
+// -----------------------------------------------------------------------
+// CarlaCachedSample struct
+
+/*!
+ * A decoded audio file, shared between all users of the same file.
+ * The data is planar and must never be written to.
+ * Each channel has kPaddingFrames extra zero frames after the last one, so interpolation can read past the end.
+ */
+struct CarlaCachedSample {
+    static const uint kPaddingFrames = 4;
+
+    uint channels;
+    uint64_t frames;
+    double sampleRate;
+    float** buffers;
+
+    CarlaCachedSample() noexcept
+        : channels(0),
+          frames(0),
+          sampleRate(0.0),
+          buffers(nullptr) {}
+
+    CARLA_DECLARE_NON_COPY_STRUCT(CarlaCachedSample)
+};
+
+// -----------------------------------------------------------------------
+// CarlaSampleCache class
+
+/*!
+ * Process-wide cache of decoded audio files.
+ * Entries are keyed by filename, modification time, file size and target sample rate,
+ * and are freed as soon as their last user releases them.
+ * Not realtime safe.
+ */
+class CarlaSampleCache
+{
+public:
+    static CarlaSampleCache& getInstance() noexcept
+    {
+        static CarlaSampleCache cache;
+        return cache;
+    }
+
+    /*!
+     * Get the decoded contents of @a filename, decoding it if not cached yet.
+     * If @a targetSampleRate is non-zero and differs from the file, data is resampled to it.
+     * Returns null on failure, otherwise the result must be given back with release().
+     */
+    const CarlaCachedSample* acquire(const char* const filename, const uint32_t targetSampleRate)
+    {
+        CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', nullptr);
+
+        struct stat st;
+        if (::stat(filename, &st) != 0)
+            return nullptr;
+
+        const int64_t modTime  = static_cast<int64_t>(st.st_mtime);
+        const int64_t fileSize = static_cast<int64_t>(st.st_size);
+
+        Entry* entry = nullptr;
+        bool needsLoad = false;
+
+        {
+            const CarlaMutexLocker cml(fMutex);
+
+            for (LinkedList<Entry*>::Itenerator it = fEntries.begin2(); it.valid(); it.next())
+            {
+                Entry* const e(it.getValue(nullptr));
+                CARLA_SAFE_ASSERT_CONTINUE(e != nullptr);
+
+                if (e->modTime == modTime && e->fileSize == fileSize &&
+                    e->targetSampleRate == targetSampleRate && e->filename == filename)
+                {
+                    entry = e;
+                    break;
+                }
+            }
+
+            if (entry == nullptr)
+            {
+                entry = new Entry(filename, modTime, fileSize, targetSampleRate);
+                fEntries.append(entry);
+                needsLoad = true;
+            }
+
+            ++entry->refCount;
+        }
+
+        // decode outside the lock, so other files can load in parallel
+        if (needsLoad)
+        {
+            const bool ok = _decode(entry);
+
+            const CarlaMutexLocker cml(fMutex);
+            entry->state = ok ? Entry::kStateReady : Entry::kStateFailed;
+        }
+        else
+        {
+            for (;;)
+            {
+                {
+                    const CarlaMutexLocker cml(fMutex);
+
+                    if (entry->state != Entry::kStateLoading)
+                        break;
+                }
+
+                carla_msleep(5);
+            }
+        }
+
+        if (entry->state != Entry::kStateReady)
+        {
+            release(entry);
+            return nullptr;
+        }
+
+        return entry;
+    }
+
+    /*!
+     * Give back a sample obtained from acquire().
+     */
+    void release(const CarlaCachedSample* const sample) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(sample != nullptr,);
+
+        Entry* entry = nullptr;
+
+        {
+            const CarlaMutexLocker cml(fMutex);
+
+            for (LinkedList<Entry*>::Itenerator it = fEntries.begin2(); it.valid(); it.next())
+            {
+                Entry* const e(it.getValue(nullptr));
+
+                if (e != sample)
+                    continue;
+
+                CARLA_SAFE_ASSERT_RETURN(e->refCount > 0,);
+
+                if (--e->refCount == 0)
+                {
+                    fEntries.remove(it);
+                    entry = e;
+                }
+                break;
+            }
+        }
+
+        delete entry;
+    }
+
+private:
+    struct Entry : CarlaCachedSample {
+        enum State {
+            kStateLoading,
+            kStateReady,
+            kStateFailed
+        };
+
+        CarlaString filename;
+        int64_t modTime;
+        int64_t fileSize;
+        uint32_t targetSampleRate;
+        uint refCount;
+        State state;
+
+        Entry(const char* const fname, const int64_t mtime, const int64_t size, const uint32_t srate)
+            : CarlaCachedSample(),
+              filename(fname),
+              modTime(mtime),
+              fileSize(size),
+              targetSampleRate(srate),
+              refCount(0),
+              state(kStateLoading) {}
+
+        ~Entry() noexcept
+        {
+            if (buffers == nullptr)
+                return;
+
+            for (uint c=0; c < channels; ++c)
+                delete[] buffers[c];
+
+            delete[] buffers;
+        }
+
+        CARLA_DECLARE_NON_COPY_STRUCT(Entry)
+    };
+
+    CarlaMutex fMutex;
+    LinkedList<Entry*> fEntries;
+
+    CarlaSampleCache() noexcept
+        : fMutex(),
+          fEntries() {}
+
+    ~CarlaSampleCache() noexcept
+    {
+        CARLA_SAFE_ASSERT(fEntries.count() == 0);
+
+        for (LinkedList<Entry*>::Itenerator it = fEntries.begin2(); it.valid(); it.next())
+            delete it.getValue(nullptr);
+
+        fEntries.clear();
+    }
+
+    static bool _decode(Entry* const entry)
+    {
+        struct adinfo info;
+        carla_zeroStruct(info);
+
+        void* const handle = ad_open(entry->filename, &info);
+        CARLA_SAFE_ASSERT_RETURN(handle != nullptr, false);
+
+        if (info.channels <= 0 || info.frames <= 0)
+        {
+            ad_close(handle);
+            return false;
+        }
+
+        // Fix for misinformation using libsndfile
+        if (info.frames % info.channels)
+            --info.frames;
+
+        const uint channels = static_cast<uint>(info.channels);
+        const uint64_t fileNumFrames = static_cast<uint64_t>(info.frames);
+        const size_t numSamples = static_cast<size_t>(fileNumFrames * channels);
+
+        float* const interleaved = (float*)std::calloc(numSamples, sizeof(float));
+
+        if (interleaved == nullptr)
+        {
+            carla_stderr2("CarlaSampleCache: out of memory decoding '%s'", entry->filename.buffer());
+            ad_close(handle);
+            return false;
+        }
+
+        const ssize_t r = ad_read(handle, interleaved, numSamples);
+        ad_close(handle);
+
+        if (r != static_cast<ssize_t>(numSamples))
+        {
+            carla_stderr2("CarlaSampleCache: failed to read complete file '%s'", entry->filename.buffer());
+            std::free(interleaved);
+            return false;
+        }
+
+        const float* data = interleaved;
+        float* resampled = nullptr;
+        uint64_t numFrames = fileNumFrames;
+        double sampleRate = info.sample_rate;
+
+        if (entry->targetSampleRate != 0 && static_cast<uint32_t>(info.sample_rate) != entry->targetSampleRate)
+        {
+            Resampler resampler;
+
+            if (! resampler.setup(info.sample_rate, entry->targetSampleRate, channels, 32))
+            {
+                carla_stderr2("CarlaSampleCache: resampler setup failed for '%s'", entry->filename.buffer());
+                std::free(interleaved);
+                return false;
+            }
+
+            const double ratio = static_cast<double>(entry->targetSampleRate) / static_cast<double>(info.sample_rate);
+            numFrames = static_cast<uint64_t>(static_cast<double>(fileNumFrames) * ratio + 0.5);
+            sampleRate = entry->targetSampleRate;
+
+            resampled = (float*)std::calloc(numFrames * channels, sizeof(float));
+
+            if (resampled == nullptr)
+            {
+                std::free(interleaved);
+                return false;
+            }
+
+            resampler.inp_count = static_cast<uint>(fileNumFrames);
+            resampler.out_count = static_cast<uint>(numFrames);
+            resampler.inp_data = interleaved;
+            resampler.out_data = resampled;
+            resampler.process();
+            CARLA_SAFE_ASSERT_INT(resampler.inp_count <= 2, resampler.inp_count);
+
+            data = resampled;
+        }
+
+        float** buffers = nullptr;
+
+        try {
+            buffers = new float*[channels];
+            carla_zeroPointers(buffers, channels);
+
+            for (uint c=0; c < channels; ++c)
+                buffers[c] = new float[numFrames + CarlaCachedSample::kPaddingFrames];
+        }
+        catch (...) {
+            carla_stderr2("CarlaSampleCache: out of memory decoding '%s'", entry->filename.buffer());
+            // Entry frees whatever was allocated
+            entry->channels = channels;
+            entry->buffers = buffers;
+            if (resampled != nullptr)
+                std::free(resampled);
+            std::free(interleaved);
+            return false;
+        }
+
+        for (uint c=0; c < channels; ++c)
+        {
+            float* const buffer = buffers[c];
+
+            for (uint64_t i=0; i < numFrames; ++i)
+                buffer[i] = data[i * channels + c];
+
+            carla_zeroFloats(buffer + numFrames, CarlaCachedSample::kPaddingFrames);
+        }
+
+        if (resampled != nullptr)
+            std::free(resampled);
+
+        std::free(interleaved);
+
+        entry->channels   = channels;
+        entry->frames     = numFrames;
+        entry->sampleRate = sampleRate;
+        entry->buffers    = buffers;
+        return true;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaSampleCache)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // CARLA_SAMPLE_CACHE_HPP_INCLUDED
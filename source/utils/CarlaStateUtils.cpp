@@ -201,6 +201,10 @@ CarlaStateSave::CarlaStateSave() noexcept
       balanceRight(1.0f),
       panning(0.0f),
       ctrlChannel(-1),
+      frozenFile(nullptr),
+      frozenStartFrame(0),
+      frozenEndFrame(0),
+      frozenChain(false),
 #endif
       currentProgramIndex(-1),
       currentProgramName(nullptr),
@@ -259,6 +263,16 @@ void CarlaStateSave::clear() noexcept
     balanceRight = 1.0f;
     panning      = 0.0f;
     ctrlChannel  = -1;
+
+    if (frozenFile != nullptr)
+    {
+        delete[] frozenFile;
+        frozenFile = nullptr;
+    }
+
+    frozenStartFrame = 0;
+    frozenEndFrame   = 0;
+    frozenChain      = false;
 #endif
 
     currentProgramIndex = -1;
@@ -370,6 +384,26 @@ bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
                     if (value > 0)
                         options = static_cast<uint>(value);
                 }
+                else if (tag == "FrozenFile")
+                {
+                    frozenFile = xmlSafeStringCharDup(text, false);
+                }
+                else if (tag == "FrozenStartFrame")
+                {
+                    const int64_t value(text.getLargeIntValue());
+                    if (value > 0)
+                        frozenStartFrame = static_cast<uint64_t>(value);
+                }
+                else if (tag == "FrozenEndFrame")
+                {
+                    const int64_t value(text.getLargeIntValue());
+                    if (value > 0)
+                        frozenEndFrame = static_cast<uint64_t>(value);
+                }
+                else if (tag == "FrozenChain")
+                {
+                    frozenChain = (text == "Yes");
+                }
 #else
                 if (false) {}
 #endif
@@ -607,6 +641,16 @@ void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
 
         dataXml << "   <Options>0x" << String::toHexString(static_cast<int>(options)) << "</Options>\n";
 
+        if (frozenFile != nullptr && frozenFile[0] != '\0')
+        {
+            dataXml << "   <FrozenFile>"       << xmlSafeString(frozenFile, true)  << "</FrozenFile>\n";
+            dataXml << "   <FrozenStartFrame>" << String(frozenStartFrame)         << "</FrozenStartFrame>\n";
+            dataXml << "   <FrozenEndFrame>"   << String(frozenEndFrame)           << "</FrozenEndFrame>\n";
+
+            if (frozenChain)
+                dataXml << "   <FrozenChain>Yes</FrozenChain>\n";
+        }
+
         content << dataXml;
     }
 #endif
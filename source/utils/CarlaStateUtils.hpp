@@ -84,6 +84,10 @@ struct CarlaStateSave {
     float  balanceRight;
     float  panning;
     int8_t ctrlChannel;
+    const char* frozenFile;
+    uint64_t frozenStartFrame;
+    uint64_t frozenEndFrame;
+    bool frozenChain;
 #endif
 
     int32_t     currentProgramIndex;
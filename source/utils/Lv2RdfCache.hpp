@@ -0,0 +1,800 @@
+/*
+ * LV2 RDF Cache
+ * Copyright (C) 2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef LV2_RDF_CACHE_HPP_INCLUDED
+#define LV2_RDF_CACHE_HPP_INCLUDED
+
+#include "CarlaMutex.hpp"
+#include "CarlaString.hpp"
+#include "CarlaStringList.hpp"
+
+#include "lv2_rdf.hpp"
+
+#include "water/files/File.h"
+
+#include <cstdio>
+#include <sys/stat.h>
+
+#ifdef CARLA_OS_WIN
+# include <process.h>
+# define LV2_RDF_CACHE_PATH_SEP ';'
+#else
+# include <unistd.h>
+# define LV2_RDF_CACHE_PATH_SEP ':'
+#endif
+
+// -----------------------------------------------------------------------
+// On-disk cache of LV2_RDF_Descriptors, one file per plugin URI.
+// An entry is only valid while its LV2_PATH, the directories in it and the bundles it was read from stay the same,
+// so installing, removing or updating any bundle makes the host go through lilv again.
+
+class Lv2RdfCache
+{
+public:
+    Lv2RdfCache() noexcept
+        : fCacheDir(),
+          fMutex()
+    {
+        try {
+            fCacheDir = getCacheDir().getFullPathName().toRawUTF8();
+        } CARLA_SAFE_EXCEPTION("Lv2RdfCache::getCacheDir");
+    }
+
+    static Lv2RdfCache& getInstance() noexcept
+    {
+        static Lv2RdfCache cache;
+        return cache;
+    }
+
+    /*
+     * Get a new descriptor for @a uri from the cache, or null if not cached or outdated.
+     */
+    LV2_RDF_Descriptor* load(const char* const uri, const char* const lv2Path) const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
+        CARLA_SAFE_ASSERT_RETURN(lv2Path != nullptr, nullptr);
+
+        if (fCacheDir.isEmpty())
+            return nullptr;
+
+        const CarlaString filename(getFilenameForURI(uri));
+
+        std::FILE* const file = std::fopen(filename, "rb");
+
+        if (file == nullptr)
+            return nullptr;
+
+        uint8_t* data = nullptr;
+        long size = 0;
+
+        if (std::fseek(file, 0, SEEK_END) == 0 && (size = std::ftell(file)) > 0 && std::fseek(file, 0, SEEK_SET) == 0)
+        {
+            try {
+                data = new uint8_t[static_cast<size_t>(size)];
+            } CARLA_SAFE_EXCEPTION("Lv2RdfCache::load");
+
+            if (data != nullptr && std::fread(data, static_cast<size_t>(size), 1, file) != 1)
+            {
+                delete[] data;
+                data = nullptr;
+            }
+        }
+
+        std::fclose(file);
+
+        if (data == nullptr)
+            return nullptr;
+
+        LV2_RDF_Descriptor* desc = nullptr;
+
+        try {
+            Reader reader(data, static_cast<size_t>(size));
+            desc = readFile(reader, uri, lv2Path);
+        } CARLA_SAFE_EXCEPTION("Lv2RdfCache::load");
+
+        delete[] data;
+        return desc;
+    }
+
+    /*
+     * Store a descriptor, as returned by lv2_rdf_new() with presets loaded.
+     */
+    void store(const LV2_RDF_Descriptor* const desc, const char* const lv2Path) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(desc != nullptr && desc->URI != nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(lv2Path != nullptr,);
+
+        if (fCacheDir.isEmpty() || desc->Bundle == nullptr)
+            return;
+
+        const CarlaMutexLocker cml(fMutex);
+
+        try {
+            const water::File cacheDir(fCacheDir.buffer());
+
+            if (! cacheDir.isDirectory())
+                cacheDir.createDirectory();
+        } CARLA_SAFE_EXCEPTION_RETURN("Lv2RdfCache::store",);
+
+        const CarlaString filename(getFilenameForURI(desc->URI));
+
+        char tmpSuffix[32];
+#ifdef CARLA_OS_WIN
+        std::snprintf(tmpSuffix, 31, ".%i.tmp", _getpid());
+#else
+        std::snprintf(tmpSuffix, 31, ".%i.tmp", getpid());
+#endif
+        tmpSuffix[31] = '\0';
+
+        const CarlaString tmpFilename(filename + tmpSuffix);
+
+        std::FILE* const file = std::fopen(tmpFilename, "wb");
+        CARLA_SAFE_ASSERT_RETURN(file != nullptr,);
+
+        Writer writer(file);
+        writeFile(writer, desc, lv2Path);
+
+        const bool ok = std::fclose(file) == 0 && writer.ok;
+
+#ifdef CARLA_OS_WIN
+        if (ok)
+            std::remove(filename);
+#endif
+        if (! ok || std::rename(tmpFilename, filename) != 0)
+            std::remove(tmpFilename);
+    }
+
+private:
+    CarlaString fCacheDir;
+    CarlaMutex fMutex;
+
+    // bump this whenever lv2_rdf_new() or the LV2_RDF_* types change
+    static const uint32_t kFileVersion = 1;
+
+    // -------------------------------------------------------------------
+
+    struct Reader {
+        const uint8_t* data;
+        size_t size;
+        size_t pos;
+        bool ok;
+
+        Reader(const uint8_t* const d, const size_t s) noexcept
+            : data(d), size(s), pos(0), ok(true) {}
+
+        bool read(void* const dst, const size_t len) noexcept
+        {
+            if (! ok || len > size - pos)
+                return (ok = false);
+
+            std::memcpy(dst, data + pos, len);
+            pos += len;
+            return true;
+        }
+
+        uint32_t u32() noexcept
+        {
+            uint32_t value = 0;
+            read(&value, sizeof(value));
+            return value;
+        }
+
+        uint64_t u64() noexcept
+        {
+            uint64_t value = 0;
+            read(&value, sizeof(value));
+            return value;
+        }
+
+        float f32() noexcept
+        {
+            float value = 0.0f;
+            read(&value, sizeof(value));
+            return value;
+        }
+
+        // number of elements to allocate, each of them takes at least 1 byte in the file
+        uint32_t count() noexcept
+        {
+            const uint32_t value = u32();
+
+            if (ok && value > size - pos)
+                ok = false;
+
+            return ok ? value : 0;
+        }
+
+        // returns a new string, or null if the stored string was null
+        char* str()
+        {
+            const uint32_t len = u32();
+
+            if (! ok || len == UINT32_MAX)
+                return nullptr;
+
+            if (len > size - pos)
+            {
+                ok = false;
+                return nullptr;
+            }
+
+            char* const value = new char[len + 1];
+            std::memcpy(value, data + pos, len);
+            value[len] = '\0';
+            pos += len;
+            return value;
+        }
+    };
+
+    struct Writer {
+        std::FILE* const file;
+        bool ok;
+
+        Writer(std::FILE* const f) noexcept
+            : file(f), ok(true) {}
+
+        void write(const void* const src, const size_t len) noexcept
+        {
+            if (ok && len != 0 && std::fwrite(src, len, 1, file) != 1)
+                ok = false;
+        }
+
+        void u32(const uint32_t value) noexcept { write(&value, sizeof(value)); }
+        void u64(const uint64_t value) noexcept { write(&value, sizeof(value)); }
+        void f32(const float value) noexcept { write(&value, sizeof(value)); }
+
+        void str(const char* const value) noexcept
+        {
+            if (value == nullptr)
+                return u32(UINT32_MAX);
+
+            const size_t len = std::strlen(value);
+            u32(static_cast<uint32_t>(len));
+            write(value, len);
+        }
+    };
+
+    // -------------------------------------------------------------------
+
+    static water::File getCacheDir()
+    {
+        using water::File;
+
+        if (const char* const xdgCacheHome = std::getenv("XDG_CACHE_HOME"))
+            if (xdgCacheHome[0] != '\0')
+                return File(xdgCacheHome).getChildFile("carla/lv2-rdf");
+
+#if defined(CARLA_OS_WIN)
+        if (const char* const localAppData = std::getenv("LOCALAPPDATA"))
+            if (localAppData[0] != '\0')
+                return File(localAppData).getChildFile("carla/lv2-rdf");
+
+        return File::getSpecialLocation(File::tempDirectory).getChildFile("carla/lv2-rdf");
+#elif defined(CARLA_OS_MAC)
+        return File::getSpecialLocation(File::userHomeDirectory).getChildFile("Library/Caches/carla/lv2-rdf");
+#else
+        return File::getSpecialLocation(File::userHomeDirectory).getChildFile(".cache/carla/lv2-rdf");
+#endif
+    }
+
+    CarlaString getFilenameForURI(const char* uri) const noexcept
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ULL;
+
+        for (; *uri != '\0'; ++uri)
+        {
+            hash ^= static_cast<uint8_t>(*uri);
+            hash *= 1099511628211ULL;
+        }
+
+        char name[32];
+        std::snprintf(name, 31, "%016llx.bin", static_cast<unsigned long long>(hash));
+        name[31] = '\0';
+
+        return fCacheDir + CARLA_OS_SEP_STR + name;
+    }
+
+    static void addToStamp(uint64_t& stamp, const char* const filename) noexcept
+    {
+        struct stat st;
+
+        if (::stat(filename, &st) != 0)
+            return;
+
+        stamp += static_cast<uint64_t>(st.st_mtime) * 1000003ULL + static_cast<uint64_t>(st.st_size);
+    }
+
+    // changes when files are added, removed or modified in the bundle
+    static uint64_t getBundleStamp(const char* const bundle) noexcept
+    {
+        uint64_t stamp = 0;
+
+        try {
+            const water::File bundleDir(bundle);
+
+            if (! bundleDir.isDirectory())
+                return 0;
+
+            addToStamp(stamp, bundleDir.getFullPathName().toRawUTF8());
+
+            water::Array<water::File> files;
+            bundleDir.findChildFiles(files, water::File::findFiles, false, "*.ttl");
+
+            for (int i=0, count=files.size(); i < count; ++i)
+                addToStamp(stamp, files.getReference(i).getFullPathName().toRawUTF8());
+        } CARLA_SAFE_EXCEPTION_RETURN("Lv2RdfCache::getBundleStamp", 0);
+
+        return stamp;
+    }
+
+    // changes when bundles are installed or removed
+    static uint64_t getPathStamp(const char* const lv2Path) noexcept
+    {
+        uint64_t stamp = 0;
+
+        try {
+            for (const char* dir = lv2Path; *dir != '\0';)
+            {
+                const char* const sep = std::strchr(dir, LV2_RDF_CACHE_PATH_SEP);
+                const size_t len = sep != nullptr ? static_cast<size_t>(sep - dir) : std::strlen(dir);
+
+                if (len != 0)
+                {
+                    const water::File pathDir(water::String(dir, len));
+                    addToStamp(stamp, pathDir.getFullPathName().toRawUTF8());
+                }
+
+                dir += sep != nullptr ? len + 1 : len;
+            }
+        } CARLA_SAFE_EXCEPTION_RETURN("Lv2RdfCache::getPathStamp", 0);
+
+        return stamp;
+    }
+
+    // -------------------------------------------------------------------
+
+    static void writeFile(Writer& w, const LV2_RDF_Descriptor* const desc, const char* const lv2Path) noexcept
+    {
+        w.write("CRDF", 4);
+        w.u32(kFileVersion);
+
+        w.str(lv2Path);
+        w.u64(getPathStamp(lv2Path));
+
+        // plugin bundle, followed by any UI bundles outside of it
+        CarlaStringList bundles;
+        bundles.append(desc->Bundle);
+
+        for (uint32_t i=0; i < desc->UICount; ++i)
+        {
+            if (desc->UIs[i].Bundle != nullptr)
+                bundles.appendUnique(desc->UIs[i].Bundle);
+        }
+
+        w.u32(static_cast<uint32_t>(bundles.count()));
+
+        for (CarlaStringList::Itenerator it = bundles.begin2(); it.valid(); it.next())
+        {
+            const char* const bundle = it.getValue(nullptr);
+            w.str(bundle);
+            w.u64(getBundleStamp(bundle));
+        }
+
+        writeDescriptor(w, desc);
+    }
+
+    static LV2_RDF_Descriptor* readFile(Reader& r, const char* const uri, const char* const lv2Path)
+    {
+        char magic[4];
+        r.read(magic, 4);
+
+        if (! r.ok || std::memcmp(magic, "CRDF", 4) != 0 || r.u32() != kFileVersion)
+            return nullptr;
+
+        {
+            char* const cachedPath = r.str();
+            const bool samePath = cachedPath != nullptr && std::strcmp(cachedPath, lv2Path) == 0;
+            delete[] cachedPath;
+
+            if (! samePath || r.u64() != getPathStamp(lv2Path))
+                return nullptr;
+        }
+
+        for (uint32_t i=0, count=r.count(); i < count; ++i)
+        {
+            char* const bundle = r.str();
+            const bool sameBundle = bundle != nullptr && r.u64() == getBundleStamp(bundle);
+            delete[] bundle;
+
+            if (! sameBundle)
+                return nullptr;
+        }
+
+        if (! r.ok)
+            return nullptr;
+
+        LV2_RDF_Descriptor* const desc = new LV2_RDF_Descriptor();
+
+        if (readDescriptor(r, desc) && desc->URI != nullptr && std::strcmp(desc->URI, uri) == 0)
+            return desc;
+
+        delete desc;
+        return nullptr;
+    }
+
+    // -------------------------------------------------------------------
+
+    static void writeMidiMap(Writer& w, const LV2_RDF_PortMidiMap& midiMap) noexcept
+    {
+        w.u32(midiMap.Type);
+        w.u32(midiMap.Number);
+    }
+
+    static void readMidiMap(Reader& r, LV2_RDF_PortMidiMap& midiMap) noexcept
+    {
+        midiMap.Type   = r.u32();
+        midiMap.Number = r.u32();
+    }
+
+    static void writePoints(Writer& w, const LV2_RDF_PortPoints& points) noexcept
+    {
+        w.u32(points.Hints);
+        w.f32(points.Default);
+        w.f32(points.Minimum);
+        w.f32(points.Maximum);
+    }
+
+    static void readPoints(Reader& r, LV2_RDF_PortPoints& points) noexcept
+    {
+        points.Hints   = r.u32();
+        points.Default = r.f32();
+        points.Minimum = r.f32();
+        points.Maximum = r.f32();
+    }
+
+    static void writeUnit(Writer& w, const LV2_RDF_PortUnit& unit) noexcept
+    {
+        w.u32(unit.Hints);
+        w.str(unit.Name);
+        w.str(unit.Render);
+        w.str(unit.Symbol);
+        w.u32(unit.Unit);
+    }
+
+    static void readUnit(Reader& r, LV2_RDF_PortUnit& unit)
+    {
+        unit.Hints  = r.u32();
+        unit.Name   = r.str();
+        unit.Render = r.str();
+        unit.Symbol = r.str();
+        unit.Unit   = r.u32();
+    }
+
+    static void writeExtensions(Writer& w, const uint32_t count, const LV2_URI* const extensions) noexcept
+    {
+        w.u32(count);
+
+        for (uint32_t i=0; i < count; ++i)
+            w.str(extensions[i]);
+    }
+
+    static void readExtensions(Reader& r, uint32_t& count, LV2_URI*& extensions)
+    {
+        if (const uint32_t newCount = r.count())
+        {
+            extensions = new LV2_URI[newCount];
+            carla_zeroPointers(extensions, newCount);
+            count = newCount;
+
+            for (uint32_t i=0; i < newCount; ++i)
+                extensions[i] = r.str();
+        }
+    }
+
+    static void writeFeatures(Writer& w, const uint32_t count, const LV2_RDF_Feature* const features) noexcept
+    {
+        w.u32(count);
+
+        for (uint32_t i=0; i < count; ++i)
+        {
+            w.u32(features[i].Required ? 1 : 0);
+            w.str(features[i].URI);
+        }
+    }
+
+    static void readFeatures(Reader& r, uint32_t& count, LV2_RDF_Feature*& features)
+    {
+        if (const uint32_t newCount = r.count())
+        {
+            features = new LV2_RDF_Feature[newCount];
+            count = newCount;
+
+            for (uint32_t i=0; i < newCount; ++i)
+            {
+                features[i].Required = r.u32() != 0;
+                features[i].URI      = r.str();
+            }
+        }
+    }
+
+    // -------------------------------------------------------------------
+
+    static void writeDescriptor(Writer& w, const LV2_RDF_Descriptor* const desc) noexcept
+    {
+        w.u32(desc->Type[0]);
+        w.u32(desc->Type[1]);
+        w.str(desc->URI);
+        w.str(desc->Name);
+        w.str(desc->Author);
+        w.str(desc->License);
+        w.str(desc->Binary);
+        w.str(desc->Bundle);
+        w.u64(desc->UniqueID);
+
+        w.u32(desc->PortCount);
+
+        for (uint32_t i=0; i < desc->PortCount; ++i)
+        {
+            const LV2_RDF_Port& port(desc->Ports[i]);
+
+            w.u32(port.Types);
+            w.u32(port.Properties);
+            w.u32(port.Designation);
+            w.str(port.Name);
+            w.str(port.Symbol);
+            w.str(port.Comment);
+            w.str(port.GroupURI);
+            writeMidiMap(w, port.MidiMap);
+            writePoints(w, port.Points);
+            writeUnit(w, port.Unit);
+            w.u32(port.MinimumSize);
+
+            w.u32(port.ScalePointCount);
+
+            for (uint32_t j=0; j < port.ScalePointCount; ++j)
+            {
+                w.str(port.ScalePoints[j].Label);
+                w.f32(port.ScalePoints[j].Value);
+            }
+        }
+
+        w.u32(desc->ParameterCount);
+
+        for (uint32_t i=0; i < desc->ParameterCount; ++i)
+        {
+            const LV2_RDF_Parameter& param(desc->Parameters[i]);
+
+            w.str(param.URI);
+            w.u32(param.Type);
+            w.u32(param.Flags);
+            w.str(param.Label);
+            w.str(param.Comment);
+            w.str(param.GroupURI);
+            writeMidiMap(w, param.MidiMap);
+            writePoints(w, param.Points);
+            writeUnit(w, param.Unit);
+        }
+
+        // group URIs are shared with ports and parameters
+        w.u32(desc->PortGroupCount);
+
+        for (uint32_t i=0; i < desc->PortGroupCount; ++i)
+        {
+            const LV2_RDF_PortGroup& portGroup(desc->PortGroups[i]);
+
+            w.str(portGroup.URI);
+            w.str(portGroup.Name);
+            w.str(portGroup.Symbol);
+        }
+
+        w.u32(desc->PresetCount);
+
+        for (uint32_t i=0; i < desc->PresetCount; ++i)
+        {
+            w.str(desc->Presets[i].URI);
+            w.str(desc->Presets[i].Label);
+        }
+
+        writeFeatures(w, desc->FeatureCount, desc->Features);
+        writeExtensions(w, desc->ExtensionCount, desc->Extensions);
+
+        w.u32(desc->UICount);
+
+        for (uint32_t i=0; i < desc->UICount; ++i)
+        {
+            const LV2_RDF_UI& ui(desc->UIs[i]);
+
+            w.u32(ui.Type);
+            w.str(ui.URI);
+            w.str(ui.Binary);
+            w.str(ui.Bundle);
+            writeFeatures(w, ui.FeatureCount, ui.Features);
+            writeExtensions(w, ui.ExtensionCount, ui.Extensions);
+
+            w.u32(ui.PortNotificationCount);
+
+            for (uint32_t j=0; j < ui.PortNotificationCount; ++j)
+            {
+                w.str(ui.PortNotifications[j].Symbol);
+                w.u32(ui.PortNotifications[j].Index);
+                w.u32(ui.PortNotifications[j].Protocol);
+            }
+        }
+    }
+
+    static const char* findGroupURI(const LV2_RDF_Descriptor* const desc, const char* const uri) noexcept
+    {
+        for (uint32_t i=0; i < desc->PortCount; ++i)
+        {
+            if (desc->Ports[i].GroupURI != nullptr && std::strcmp(desc->Ports[i].GroupURI, uri) == 0)
+                return desc->Ports[i].GroupURI;
+        }
+
+        for (uint32_t i=0; i < desc->ParameterCount; ++i)
+        {
+            if (desc->Parameters[i].GroupURI != nullptr && std::strcmp(desc->Parameters[i].GroupURI, uri) == 0)
+                return desc->Parameters[i].GroupURI;
+        }
+
+        return nullptr;
+    }
+
+    // counts are only set after their arrays are allocated, so a partially read descriptor can be deleted
+    static bool readDescriptor(Reader& r, LV2_RDF_Descriptor* const desc)
+    {
+        desc->Type[0]  = r.u32();
+        desc->Type[1]  = r.u32();
+        desc->URI      = r.str();
+        desc->Name     = r.str();
+        desc->Author   = r.str();
+        desc->License  = r.str();
+        desc->Binary   = r.str();
+        desc->Bundle   = r.str();
+        desc->UniqueID = static_cast<ulong>(r.u64());
+
+        if (const uint32_t count = r.count())
+        {
+            desc->Ports = new LV2_RDF_Port[count];
+            desc->PortCount = count;
+
+            for (uint32_t i=0; i < count && r.ok; ++i)
+            {
+                LV2_RDF_Port& port(desc->Ports[i]);
+
+                port.Types       = r.u32();
+                port.Properties  = r.u32();
+                port.Designation = r.u32();
+                port.Name        = r.str();
+                port.Symbol      = r.str();
+                port.Comment     = r.str();
+                port.GroupURI    = r.str();
+                readMidiMap(r, port.MidiMap);
+                readPoints(r, port.Points);
+                readUnit(r, port.Unit);
+                port.MinimumSize = r.u32();
+
+                if (const uint32_t scalePointCount = r.count())
+                {
+                    port.ScalePoints = new LV2_RDF_PortScalePoint[scalePointCount];
+                    port.ScalePointCount = scalePointCount;
+
+                    for (uint32_t j=0; j < scalePointCount; ++j)
+                    {
+                        port.ScalePoints[j].Label = r.str();
+                        port.ScalePoints[j].Value = r.f32();
+                    }
+                }
+            }
+        }
+
+        if (const uint32_t count = r.count())
+        {
+            desc->Parameters = new LV2_RDF_Parameter[count];
+            desc->ParameterCount = count;
+
+            for (uint32_t i=0; i < count && r.ok; ++i)
+            {
+                LV2_RDF_Parameter& param(desc->Parameters[i]);
+
+                param.URI      = r.str();
+                param.Type     = r.u32();
+                param.Flags    = r.u32();
+                param.Label    = r.str();
+                param.Comment  = r.str();
+                param.GroupURI = r.str();
+                readMidiMap(r, param.MidiMap);
+                readPoints(r, param.Points);
+                readUnit(r, param.Unit);
+            }
+        }
+
+        if (const uint32_t count = r.count())
+        {
+            desc->PortGroups = new LV2_RDF_PortGroup[count];
+            desc->PortGroupCount = count;
+
+            for (uint32_t i=0; i < count && r.ok; ++i)
+            {
+                LV2_RDF_PortGroup& portGroup(desc->PortGroups[i]);
+
+                char* const uri = r.str();
+                portGroup.URI    = uri != nullptr ? findGroupURI(desc, uri) : nullptr;
+                portGroup.Name   = r.str();
+                portGroup.Symbol = r.str();
+                delete[] uri;
+
+                if (portGroup.URI == nullptr)
+                    return false;
+            }
+        }
+
+        if (const uint32_t count = r.count())
+        {
+            desc->Presets = new LV2_RDF_Preset[count];
+            desc->PresetCount = count;
+
+            for (uint32_t i=0; i < count; ++i)
+            {
+                desc->Presets[i].URI   = r.str();
+                desc->Presets[i].Label = r.str();
+            }
+        }
+
+        readFeatures(r, desc->FeatureCount, desc->Features);
+        readExtensions(r, desc->ExtensionCount, desc->Extensions);
+
+        if (const uint32_t count = r.count())
+        {
+            desc->UIs = new LV2_RDF_UI[count];
+            desc->UICount = count;
+
+            for (uint32_t i=0; i < count && r.ok; ++i)
+            {
+                LV2_RDF_UI& ui(desc->UIs[i]);
+
+                ui.Type   = r.u32();
+                ui.URI    = r.str();
+                ui.Binary = r.str();
+                ui.Bundle = r.str();
+                readFeatures(r, ui.FeatureCount, ui.Features);
+                readExtensions(r, ui.ExtensionCount, ui.Extensions);
+
+                if (const uint32_t portNotifCount = r.count())
+                {
+                    ui.PortNotifications = new LV2_RDF_UI_PortNotification[portNotifCount];
+                    ui.PortNotificationCount = portNotifCount;
+
+                    for (uint32_t j=0; j < portNotifCount; ++j)
+                    {
+                        ui.PortNotifications[j].Symbol   = r.str();
+                        ui.PortNotifications[j].Index    = r.u32();
+                        ui.PortNotifications[j].Protocol = r.u32();
+                    }
+                }
+            }
+        }
+
+        return r.ok && r.pos == r.size;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2RdfCache)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // LV2_RDF_CACHE_HPP_INCLUDED
@@ -0,0 +1,301 @@
+/*
+ * LV2 URID Map
+ * Copyright (C) 2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef LV2_URID_MAP_HPP_INCLUDED
+#define LV2_URID_MAP_HPP_INCLUDED
+
+#include "CarlaMutex.hpp"
+
+#include "lv2/urid.h"
+
+// -----------------------------------------------------------------------
+// Process-wide URI <-> URID map.
+// Lookups of already mapped URIs and URIDs never lock, only adding new URIs does.
+// Mapped strings stay valid until the map is destroyed.
+
+class Lv2UridMap
+{
+public:
+    Lv2UridMap(const LV2_URID firstURID) noexcept
+        : fFirstURID(firstURID),
+          fCount(0),
+          fTable(nullptr),
+          fMutex()
+    {
+        CARLA_SAFE_ASSERT(firstURID != 0);
+
+        carla_zeroPointers(fChunks, kMaxChunks);
+        fTable = createTable(kInitialTableSize);
+    }
+
+    ~Lv2UridMap() noexcept
+    {
+        for (uint32_t i=0; i < kMaxChunks && fChunks[i] != nullptr; ++i)
+        {
+            Entry* const chunk = fChunks[i];
+
+            for (uint32_t j=0; j < kChunkSize; ++j)
+            {
+                if (chunk[j].uri != nullptr)
+                    delete[] chunk[j].uri;
+            }
+
+            delete[] chunk;
+        }
+
+        for (Table* table = fTable, *prev; table != nullptr; table = prev)
+        {
+            prev = table->prev;
+            delete[] table->slots;
+            delete table;
+        }
+    }
+
+    // -------------------------------------------------------------------
+
+    /*
+     * Next URID to be assigned.
+     * URIDs in [firstURID, getNextURID()) are all valid.
+     */
+    LV2_URID getNextURID() const noexcept
+    {
+        return fFirstURID + fCount;
+    }
+
+    /*
+     * Find the URID of an already mapped URI, returns 0 if not mapped yet.
+     */
+    LV2_URID find(const char* const uri) const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', 0);
+
+        return findWithHash(uri, getHash(uri));
+    }
+
+    /*
+     * Map an URI, adding it if needed.
+     */
+    LV2_URID map(const char* const uri) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', 0);
+
+        const uint32_t hash = getHash(uri);
+
+        if (const LV2_URID urid = findWithHash(uri, hash))
+            return urid;
+
+        const CarlaMutexLocker cml(fMutex);
+
+        // someone else might have added it while we waited for the lock
+        if (const LV2_URID urid = findWithHash(uri, hash))
+            return urid;
+
+        return append(uri, hash);
+    }
+
+    /*
+     * Add a mapping made somewhere else, as received from another process.
+     * Returns true if the map now has @a urid pointing to @a uri.
+     */
+    bool add(const LV2_URID urid, const char* const uri) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(urid >= fFirstURID, false);
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', false);
+
+        const uint32_t hash = getHash(uri);
+        const CarlaMutexLocker cml(fMutex);
+
+        if (const LV2_URID ourURID = findWithHash(uri, hash))
+            return ourURID == urid;
+
+        if (urid != fFirstURID + fCount)
+            return false;
+
+        return append(uri, hash) == urid;
+    }
+
+    /*
+     * Get the URI of a mapped URID, returns null if not mapped.
+     */
+    const char* unmap(const LV2_URID urid) const noexcept
+    {
+        if (urid < fFirstURID)
+            return nullptr;
+
+        const uint32_t index = urid - fFirstURID;
+
+        if (index >= fCount)
+            return nullptr;
+
+        return getEntry(index).uri;
+    }
+
+private:
+    struct Entry {
+        const char* uri;
+        uint32_t hash;
+    };
+
+    // open addressing, slots hold URIDs and 0 means empty
+    struct Table {
+        uint32_t size;
+        LV2_URID* slots;
+        Table* prev;
+    };
+
+    static const uint32_t kChunkSize = 512;
+    static const uint32_t kMaxChunks = 2048;
+    static const uint32_t kInitialTableSize = 1024;
+
+    const LV2_URID fFirstURID;
+    volatile uint32_t fCount;
+    Entry* fChunks[kMaxChunks];
+    Table* volatile fTable;
+    CarlaMutex fMutex;
+
+    // -------------------------------------------------------------------
+
+    static uint32_t getHash(const char* uri) noexcept
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261U;
+
+        for (; *uri != '\0'; ++uri)
+        {
+            hash ^= static_cast<uint8_t>(*uri);
+            hash *= 16777619U;
+        }
+
+        return hash;
+    }
+
+    static Table* createTable(const uint32_t size) noexcept
+    {
+        Table* table;
+
+        try {
+            table = new Table;
+        } CARLA_SAFE_EXCEPTION_RETURN("Lv2UridMap::createTable", nullptr);
+
+        try {
+            table->slots = new LV2_URID[size];
+        } catch(...) {
+            carla_safe_exception("Lv2UridMap::createTable", __FILE__, __LINE__);
+            delete table;
+            return nullptr;
+        }
+
+        table->size = size;
+        table->prev = nullptr;
+        carla_zeroStructs(table->slots, size);
+        return table;
+    }
+
+    const Entry& getEntry(const uint32_t index) const noexcept
+    {
+        return fChunks[index / kChunkSize][index % kChunkSize];
+    }
+
+    LV2_URID findWithHash(const char* const uri, const uint32_t hash) const noexcept
+    {
+        const Table* const table = fTable;
+        CARLA_SAFE_ASSERT_RETURN(table != nullptr, 0);
+
+        const uint32_t mask = table->size - 1;
+
+        for (uint32_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            const LV2_URID urid = static_cast<volatile LV2_URID*>(table->slots)[i];
+
+            if (urid == 0)
+                return 0;
+
+            const Entry& entry(getEntry(urid - fFirstURID));
+
+            if (entry.hash == hash && std::strcmp(entry.uri, uri) == 0)
+                return urid;
+        }
+    }
+
+    static void insertIntoTable(Table* const table, const LV2_URID urid, const uint32_t hash) noexcept
+    {
+        const uint32_t mask = table->size - 1;
+
+        uint32_t i = hash & mask;
+        while (table->slots[i] != 0)
+            i = (i + 1) & mask;
+
+        static_cast<volatile LV2_URID*>(table->slots)[i] = urid;
+    }
+
+    // must be called with the mutex locked, and only after checking @a uri is not mapped yet
+    LV2_URID append(const char* const uri, const uint32_t hash) noexcept
+    {
+        const uint32_t index = fCount;
+        const uint32_t chunkIndex = index / kChunkSize;
+        CARLA_SAFE_ASSERT_RETURN(chunkIndex < kMaxChunks, 0);
+
+        if (fChunks[chunkIndex] == nullptr)
+        {
+            Entry* chunk;
+
+            try {
+                chunk = new Entry[kChunkSize];
+            } CARLA_SAFE_EXCEPTION_RETURN("Lv2UridMap::append", 0);
+
+            carla_zeroStructs(chunk, kChunkSize);
+            __sync_synchronize();
+            fChunks[chunkIndex] = chunk;
+        }
+
+        Entry& entry(fChunks[chunkIndex][index % kChunkSize]);
+        entry.uri  = carla_strdup_safe(uri);
+        entry.hash = hash;
+        CARLA_SAFE_ASSERT_RETURN(entry.uri != nullptr, 0);
+
+        const LV2_URID urid = fFirstURID + index;
+        Table* table = fTable;
+
+        // keep the table at most half full, readers still using the old one are fine with it
+        if ((index + 1) * 2 > table->size)
+        {
+            Table* const newTable = createTable(table->size * 2);
+            CARLA_SAFE_ASSERT_RETURN(newTable != nullptr, 0);
+
+            for (uint32_t i=0; i < index; ++i)
+                insertIntoTable(newTable, fFirstURID + i, getEntry(i).hash);
+
+            newTable->prev = table;
+            table = newTable;
+        }
+
+        __sync_synchronize();
+        insertIntoTable(table, urid, hash);
+        __sync_synchronize();
+
+        fTable = table;
+        fCount = index + 1;
+
+        return urid;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2UridMap)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // LV2_URID_MAP_HPP_INCLUDED